@@ -0,0 +1,135 @@
+#/*
+# * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+# *
+# * Licensed under the Apache License, Version 2.0 (the "License").
+# * You may not use this file except in compliance with the License.
+# * A copy of the License is located at
+# *
+# *  http://aws.amazon.com/apache2.0
+# *
+# * or in the "license" file accompanying this file. This file is distributed
+# * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+# * express or implied. See the License for the specific language governing
+# * permissions and limitations under the License.
+# */
+
+# Reports the flash and static RAM used by the rcluc library and checks them against a budget.
+# Run by the rcluc_footprint target as: cmake -DLIBRARY=<librcluc.a> -DSIZE_TOOL=<size> -DNM_TOOL=<nm>
+#   -DBUDGET=<budget file> -DBACKEND=<rmwu backend> [-DBUILD_TYPE=<build type>] [-DUPDATE=ON] -P rcluc_footprint.cmake
+# Flash is text + data and RAM is data + bss, reported per object file since every subsystem that can be compiled out
+# with configRCLUC_ENABLE_* lives in its own source file. The budget holds one flash and one ram line per backend and
+# build type, as "<backend> <build type> flash <bytes>", since the two change the footprint far more than any change
+# to the code does. With UPDATE=ON the lines of the current backend and build type are rewritten with the current
+# totals instead of being checked, and the other lines are kept.
+
+function(right_align output value)
+  set(padded "           ${value}")
+  string(LENGTH "${padded}" length)
+  math(EXPR start "${length} - 11")
+  string(SUBSTRING "${padded}" ${start} 11 padded)
+  set(${output} "${padded}" PARENT_SCOPE)
+endfunction()
+
+foreach(variable LIBRARY SIZE_TOOL NM_TOOL BUDGET BACKEND)
+  if(NOT ${variable})
+    message(FATAL_ERROR "rcluc_footprint: ${variable} is not set")
+  endif()
+endforeach()
+# A build without CMAKE_BUILD_TYPE compiles with the plain CMAKE_C_FLAGS
+if(NOT BUILD_TYPE)
+  set(BUILD_TYPE "None")
+endif()
+set(key "${BACKEND} ${BUILD_TYPE}")
+
+execute_process(COMMAND ${SIZE_TOOL} ${LIBRARY} OUTPUT_VARIABLE size_output RESULT_VARIABLE size_result)
+if(NOT size_result EQUAL 0)
+  message(FATAL_ERROR "rcluc_footprint: ${SIZE_TOOL} failed on ${LIBRARY}")
+endif()
+
+set(total_flash 0)
+set(total_ram 0)
+message("rcluc footprint of ${LIBRARY} (${key})")
+message("      flash         ram  object")
+string(REPLACE "\n" ";" size_lines "${size_output}")
+foreach(line ${size_lines})
+  if(line MATCHES "^[ \t]*([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)[ \t]+[0-9]+[ \t]+[0-9a-fA-F]+[ \t]+([^ \t]+)")
+    set(object ${CMAKE_MATCH_4})
+    math(EXPR flash "${CMAKE_MATCH_1} + ${CMAKE_MATCH_2}")
+    math(EXPR ram "${CMAKE_MATCH_2} + ${CMAKE_MATCH_3}")
+    math(EXPR total_flash "${total_flash} + ${flash}")
+    math(EXPR total_ram "${total_ram} + ${ram}")
+    right_align(flash_column ${flash})
+    right_align(ram_column ${ram})
+    message("${flash_column} ${ram_column}  ${object}")
+  endif()
+endforeach()
+message("total flash: ${total_flash} bytes, static RAM: ${total_ram} bytes")
+
+# The largest statically allocated objects, such as nodes[] and the stream buffers, tell which configRCLUC_* value to
+# look at first
+execute_process(COMMAND ${NM_TOOL} -S --size-sort -t d ${LIBRARY} OUTPUT_VARIABLE nm_output
+  RESULT_VARIABLE nm_result ERROR_QUIET)
+if(nm_result EQUAL 0)
+  string(REPLACE "\n" ";" nm_lines "${nm_output}")
+  set(ram_symbols "")
+  foreach(line ${nm_lines})
+    if(line MATCHES "^[0-9]+[ \t]+([0-9]+)[ \t]+[bBdDC][ \t]+(.+)$")
+      math(EXPR symbol_size "${CMAKE_MATCH_1}")
+      list(APPEND ram_symbols "${symbol_size} ${CMAKE_MATCH_2}")
+    endif()
+  endforeach()
+  if(ram_symbols)
+    list(REVERSE ram_symbols)
+    list(LENGTH ram_symbols symbol_count)
+    if(symbol_count GREATER 10)
+      set(symbol_count 10)
+    endif()
+    message("largest static RAM objects (bytes):")
+    math(EXPR last "${symbol_count} - 1")
+    foreach(i RANGE ${last})
+      list(GET ram_symbols ${i} symbol)
+      message("  ${symbol}")
+    endforeach()
+  endif()
+endif()
+
+set(budget_lines "")
+if(EXISTS ${BUDGET})
+  file(STRINGS ${BUDGET} budget_lines)
+endif()
+
+if(UPDATE)
+  set(header "# Footprint budget of the rcluc library per backend and build type, checked by rcluc_footprint\n"
+    "# Regenerate with -DRCLUC_FOOTPRINT_UPDATE=ON once an increase is intended\n")
+  set(budget "")
+  foreach(line ${budget_lines})
+    if(line MATCHES "^[a-z]+[ \t]+[A-Za-z]+[ \t]+(flash|ram)[ \t]+[0-9]+" AND NOT line MATCHES "^${key} ")
+      set(budget "${budget}${line}\n")
+    endif()
+  endforeach()
+  file(WRITE ${BUDGET} ${header} "${budget}" "${key} flash ${total_flash}\n" "${key} ram ${total_ram}\n")
+  message("rcluc_footprint: budget of ${key} written to ${BUDGET}")
+  return()
+endif()
+
+set(over_budget OFF)
+set(has_budget OFF)
+foreach(line ${budget_lines})
+  if(line MATCHES "^${key}[ \t]+(flash|ram)[ \t]+([0-9]+)")
+    set(has_budget ON)
+    set(limit ${CMAKE_MATCH_2})
+    set(actual ${total_${CMAKE_MATCH_1}})
+    if(actual GREATER limit)
+      message("rcluc_footprint: ${CMAKE_MATCH_1} is ${actual} bytes, over the budget of ${limit} bytes")
+      set(over_budget ON)
+    endif()
+  endif()
+endforeach()
+if(NOT has_budget)
+  message(FATAL_ERROR
+    "rcluc_footprint: no budget for ${key} in ${BUDGET}, run with -DRCLUC_FOOTPRINT_UPDATE=ON to add it")
+endif()
+if(over_budget)
+  message(FATAL_ERROR "rcluc_footprint: footprint budget exceeded")
+endif()
+message("rcluc_footprint: within budget")
@@ -25,14 +25,69 @@
 #include "rcluc/rcluc_types.h"
 #include "rcluc/rmwu.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  *  @brief Initializes the client library. Must be called before calls to any other rcluc library functions
+ *  Establishes the default session with the agent, which nodes created with rcluc_node_create use.
  *
  *  @param config The configuration data for the rcl client to use when establishing a connection.
  *  @return Returns an error code that will be RCLUC_RET_OK if initialized successfully
  */
 rcluc_ret_t rcluc_init(const rcluc_client_config_t * config);
 
+/**
+ *  @brief Establishes one more session with the agent, for example over a second transport
+ *  Every session has its own stream buffers and is serviced by spinning the nodes created on it with
+ *  rcluc_node_create_on_session, so traffic on one session is never held up by traffic on another. Up to
+ *  configRCLUC_MAX_SESSIONS sessions, including the default one, can exist.
+ *
+ *  @param config The configuration data for the session. The client_key must differ from the one of every other
+ *      session.
+ *  @param session_handle (output) A pointer to a session handle that will be set to the new session
+ *  @return Returns an error code that will be RCLUC_RET_OK if the session was established
+ */
+rcluc_ret_t rcluc_session_create(const rcluc_client_config_t * config, rcluc_session_handle_t * session_handle);
+
+/**
+ *  @brief Restores the connection to the agent after the link was lost or the agent was restarted
+ *  Every session is created again and every node, publisher, subscription and service client is re-created in a single
+ *  batch of requests whose statuses are collected together. Existing handles remain valid. Entities that still exist
+ *  on the agent are reused rather than re-created, which keeps their DDS endpoints matched in the ROS graph.
+ *
+ *  @return Returns an error code that will be RCLUC_RET_OK if the connection and every entity were restored
+ */
+rcluc_ret_t rcluc_restore(void);
+
+/**
+ *  @brief Opens a batch of entity creations
+ *  Nodes, subscriptions, publishers and service clients created while a batch is open are only requested from the
+ *  agent: their create functions return a handle without waiting for the outcome. rcluc_batch_commit then collects the
+ *  outcome of every creation at once, so bringing up a whole graph takes a single round trip to the agent rather than
+ *  one per entity.
+ *
+ *  Destroying entities, publishing and spinning are not available until the batch is committed.
+ *
+ *  @return Returns an error code that will be RCLUC_RET_OK if the batch was opened, or RCLUC_RET_ERR_ALREADY if a
+ *  batch is already open
+ */
+rcluc_ret_t rcluc_batch_begin(void);
+
+/**
+ *  @brief Collects the outcome of every entity created since rcluc_batch_begin
+ *  Entities that could not be created are destroyed and their handles become invalid. Entities created under a node
+ *  that failed fail as well.
+ *
+ *  @param failures (output) An array filled with the entities that failed. May be NULL if failures_length is 0.
+ *  @param failures_length The number of entries in the failures array
+ *  @param failure_count (output) The number of entities that failed, which may be larger than failures_length.
+ *      May be NULL.
+ *  @return Returns an error code that will be RCLUC_RET_OK if every entity of the batch was created
+ */
+rcluc_ret_t rcluc_batch_commit(rcluc_entity_status_t * failures, size_t failures_length, size_t * failure_count);
+
 /**
  *  @brief Initializes a new ROS Node
  *  Used to initialize a preallocated ROS Node structure.
@@ -44,6 +99,20 @@ rcluc_ret_t rcluc_init(const rcluc_client_config_t * config);
  */
 rcluc_ret_t rcluc_node_create(const char * name, const char * namespace_, rcluc_node_handle_t * node_handle);
 
+/**
+ *  @brief Initializes a new ROS Node that communicates over the given session
+ *  The node's subscriptions, publishers and service clients use the session's streams, and spinning the node services
+ *  that session.
+ *
+ *  @param session_handle The session, see rcluc_session_create
+ *  @param name The name of the Node. It is expected for this string to be null terminated.
+ *  @param namespace_ The namespace for the Node. It is expected for this string to be null terminated.
+ *  @param node_handle (output) A pointer to a node_handle that will be set to point to the newly created node
+ *  @return Returns an error code that will be RCLUC_RET_OK if creation is successful
+ */
+rcluc_ret_t rcluc_node_create_on_session(rcluc_session_handle_t session_handle, const char * name,
+    const char * namespace_, rcluc_node_handle_t * node_handle);
+
 /**
  *  @brief Tears down the ROS node
  *  Used to delete an existing ROS node and free any resources that are tied to the node.
@@ -58,10 +127,9 @@ rcluc_ret_t rcluc_node_destroy(rcluc_node_handle_t node_handle);
  *  This will run all the tasks related to a node, such as publishing data and receiving subscribed data. Any callbacks
  *  that are tied to these tasks will be executed as part of this.
  *
- *  TODO: After the implementation of this function come back and document what kind of guarantees we can make about
- *      how much is actually done when you call this function (ie. does it limit the number of received or sent messages
- *      that are transmitted to guarantee it will return). It's hard to give exact time guarantees without risking
- *      interrupting a callback function
+ *  The transport layer is serviced for at most configRCLUC_SPIN_TIMEOUT_MS, after which the subscription callbacks are
+ *  invoked only for the messages that were queued at that point. Messages received while the callbacks run are handled
+ *  by the next call.
  *
  *  @param node_handle The handle for the node with tasks that will be serviced.
  */
@@ -76,6 +144,19 @@ void rcluc_node_spin_once(rcluc_node_handle_t node_handle);
  */
 void rcluc_node_spin_forever(rcluc_node_handle_t node_handle);
 
+/**
+ *  @brief Runs tasks related to a set of nodes, such as nodes on different sessions that are served by the same loop.
+ *  The transport of every node is serviced as by rcluc_node_spin_once, and then the subscription callbacks of all the
+ *  nodes are invoked for the messages queued at that point. With configRCLUC_ENABLE_PRIORITY_DISPATCH they are invoked
+ *  in order of priority across the whole set, so the urgent messages of one node do not wait behind a burst received
+ *  by another one.
+ *
+ *  @param node_handles The handles of the nodes, each listed once. NULL entries are skipped.
+ *  @param node_count The number of handles
+ */
+void rcluc_wait_set_spin_once(const rcluc_node_handle_t * node_handles, size_t node_count);
+
+#if configRCLUC_ENABLE_SUBSCRIPTIONS
 /**
  *  @brief Creates a new topic subscription on a node.
  *  Creates a new topic subscription on a node. Messages that come in on this topic will be desierialized using the
@@ -86,14 +167,20 @@ void rcluc_node_spin_forever(rcluc_node_handle_t node_handle);
  *  @param node_handle The handle for the node that this subscription will be created on
  *  @param topic_name The name of the topic that will be subscribed to. Expected to be a null terminated string
  *  @param message_type The message type information used by the library to handle the message type.
- *  @param callback The function to invoke when a message is received on this subscription
- *  @param queue_length The number of messages to queue for the incoming subscription
+ *  @param callback The function to invoke when a message is received on this subscription. If NULL then spinning the
+ *      node only queues the messages, which the application takes with rcluc_subscription_take or
+ *      rcluc_subscription_take_many. Must be NULL in mailbox mode.
+ *  @param queue_length The number of messages to queue for the incoming subscription. When the queue is full the oldest
+ *      message is dropped. Not used in mailbox mode.
  *  @param message_buffer A pointer to a uint8_t array buffer that contains enough space for at least
- *      (message_size * queue_length). This buffer will be used by the library for the lifetime of the subscription
+ *      RCLUC_SUBSCRIPTION_BUFFER_SIZE(max_serialized_size, queue_length) bytes. Received messages are stored in their
+ *      serialized form, including messages that arrive as fragments. This buffer will be used by the library for the
+ *      lifetime of the subscription
  *  @param config The subscription configuration. If NULL then the default configuration will be used
  *  @param subscription_handle (output) A pointer to a subscription handle that will be set with the handle for the
  *      subscription
- *  @return Returns an error code that will be RCLUC_RET_OK if create is successful
+ *  @return Returns an error code that will be RCLUC_RET_OK if create is successful, or RCLUC_RET_ERR_PARAM if a
+ *      mailbox subscription is given a callback
  */
 rcluc_ret_t rcluc_subscription_create(rcluc_node_handle_t node_handle, const rcluc_message_type_support_t * message_type,
     const char * topic_name, rcluc_subscription_callback_t callback, const size_t queue_length, uint8_t *message_buffer,
@@ -120,6 +207,94 @@ void rcluc_subscription_get_default_config(rcluc_subscription_config_t * config)
  */
 void * rcluc_subscription_get_user_metadata(const rcluc_subscription_handle_t subscription_handle);
 
+/**
+ *  @brief Gets the information about the message being delivered to the subscription's callback
+ *  Only valid when called from inside the subscription callback.
+ *
+ *  @param subscription_handle The handle to the subscription
+ *  @param message_info (output) The information about the message
+ *  @return Returns an error code that will be RCLUC_RET_OK if the information was retrieved
+ */
+rcluc_ret_t rcluc_subscription_get_message_info(const rcluc_subscription_handle_t subscription_handle,
+    rcluc_message_info_t * message_info);
+
+/**
+ *  @brief Keeps the message being delivered to the subscription's callback after the callback returns
+ *  Only valid when called from inside the subscription callback. The serialized message stays in its entry of the
+ *  message_buffer, which is not reused for new messages until every loan on it is released with rcluc_loan_release.
+ *  Each loan held reduces the number of messages the subscription can queue by one, so the queue_length must leave
+ *  room for the loans the application keeps.
+ *
+ *  @param subscription_handle The handle to the subscription
+ *  @param loan (output) The loan, which gives access to the serialized message
+ *  @return Returns an error code that will be RCLUC_RET_OK if the loan was taken, or RCLUC_RET_ERR_INIT if no message
+ *      is being delivered
+ */
+rcluc_ret_t rcluc_subscription_loan_retain(const rcluc_subscription_handle_t subscription_handle, rcluc_loan_t * loan);
+
+/**
+ *  @brief Reads the latest sample received by a subscription in mailbox mode, see
+ *  rcluc_subscription_config_t::mailbox
+ *  Can be called from any context, including another thread or an interrupt handler, while the node is spun. The
+ *  sample is taken from one of two entries of the message_buffer while the next sample is received into the other
+ *  one, and a sequence counter on each entry makes the read start over if the entry was overwritten in the meantime,
+ *  so a message is never made of two samples. The read never blocks: after four attempts that were all overwritten it
+ *  gives up with RCLUC_RET_TIMEOUT, which a caller that preempts the spin at a high rate has to handle by reading again
+ *  later. The sample stays available and can be read again.
+ *
+ *  @param subscription_handle The handle to the subscription
+ *  @param message (output) The message, deserialized unless deserialization is disabled in which case the serialized
+ *      message is copied
+ *  @param message_size The size (in bytes) of message
+ *  @param age (output) The time (in nanoseconds) since the sample was received. May be NULL.
+ *  @return Returns an error code that will be RCLUC_RET_OK if a sample was read, RCLUC_RET_NO_DATA if no sample was
+ *      received yet, or RCLUC_RET_TIMEOUT if new samples kept overwriting the one being read
+ */
+rcluc_ret_t rcluc_subscription_read_latest(const rcluc_subscription_handle_t subscription_handle, void * message,
+    size_t message_size, int64_t * age);
+
+/**
+ *  @brief Takes the oldest message queued by a subscription created without a callback
+ *  Spinning the node receives messages into the subscription's queue, from which the application takes them whenever
+ *  it chooses. Must not be called while the node is spun from another thread.
+ *
+ *  @param subscription_handle The handle to the subscription
+ *  @param message (output) The message, deserialized unless deserialization is disabled in which case the serialized
+ *      message is copied
+ *  @param message_size The size (in bytes) of message
+ *  @param message_info (output) The timestamps of the message. May be NULL.
+ *  @return Returns an error code that will be RCLUC_RET_OK if a message was taken, RCLUC_RET_NO_DATA if the queue is
+ *      empty, or RCLUC_RET_ERR_INIT if the subscription has a callback
+ */
+rcluc_ret_t rcluc_subscription_take(const rcluc_subscription_handle_t subscription_handle, void * message,
+    size_t message_size, rcluc_message_info_t * message_info);
+
+/**
+ *  @brief Takes up to max_count of the oldest messages queued by a subscription created without a callback
+ *  Works like calling rcluc_subscription_take for each message, with the handle checked once, so that a batch of
+ *  messages can be processed in one loop. A message that fails to deserialize is dropped and reported to the
+ *  exception callback, and taking goes on with the next one.
+ *
+ *  @param subscription_handle The handle to the subscription
+ *  @param messages (output) An array of at least max_count messages
+ *  @param message_size The size (in bytes) of each message of the array
+ *  @param message_infos (output) An array of at least max_count timestamps, one for each message. May be NULL.
+ *  @param max_count The largest number of messages to take
+ *  @param count (output) The number of messages taken
+ *  @return Returns an error code that will be RCLUC_RET_OK if at least one message was taken, RCLUC_RET_NO_DATA if the
+ *      queue is empty, or RCLUC_RET_ERR_INIT if the subscription has a callback
+ */
+rcluc_ret_t rcluc_subscription_take_many(const rcluc_subscription_handle_t subscription_handle, void * messages,
+    size_t message_size, rcluc_message_info_t * message_infos, size_t max_count, size_t * count);
+
+/**
+ *  @brief Releases a loan taken with rcluc_subscription_loan_retain, so that its entry can hold new messages again
+ *
+ *  @param loan The loan, which can no longer be used
+ *  @return Returns an error code that will be RCLUC_RET_OK if the loan was released
+ */
+rcluc_ret_t rcluc_loan_release(rcluc_loan_t * loan);
+
 /**
  *  @brief Destroys a subscription to a topic
  *  Destorys a subscription and unregisters it from the node it was created on.
@@ -128,23 +303,28 @@ void * rcluc_subscription_get_user_metadata(const rcluc_subscription_handle_t su
  *  @return Returns an error code that will be RCLUC_RET_OK if destroy is successful
  */
 rcluc_ret_t rcluc_subscription_destroy(rcluc_subscription_handle_t subscription_handle);
+#endif /* configRCLUC_ENABLE_SUBSCRIPTIONS */
 
+#if configRCLUC_ENABLE_PUBLISHERS
 /**
  *  @brief Creates a new ROS publisher
  *  Creates a new ROS publisher. Publishers are used to publish messages on topics in ROS Nodes.
  *
  *  @param node_handle The handle for the ROS Node that this publisher will be created on.
  *  @param message_type The message type information used by the library to handle the message type.
- *  @param queue_length The number of messages to queue for the outgoing publish
+ *  @param topic_name The name of the topic that will be published on. Expected to be a null terminated string
+ *  @param queue_length The number of messages to queue for the outgoing publish, or the size (in bytes) of the
+ *      message_buffer if the publisher has a packed queue, see rcluc_publisher_config_t::packed_queue
  *  @param message_buffer A pointer to a uint8_t array buffer that contains enough space for at least
- *      (message_size * queue_length). This buffer will be used by the library for the lifetime of the publisher.
+ *      (message_size * queue_length), or RCLUC_PUBLISHER_PACKED_BUFFER_SIZE bytes for a packed queue. This buffer will
+ *      be used by the library for the lifetime of the publisher.
  *  @param config The publisher configuration. If NULL then the default configuration will be used
  *  @param publisher_handle (output) A reference to a publisher_handle that will be set to the handle for the new publisher
  *  @return Returns an error code that will be RCLUC_RET_OK if create is successful
  */
 rcluc_ret_t rcluc_publisher_create(rcluc_node_handle_t node_handle,
-    const rcluc_message_type_support_t * message_type, size_t queue_length, uint8_t * message_buffer,
-    const rcluc_publisher_config_t * config, rcluc_publisher_handle_t * publisher_handle);
+    const rcluc_message_type_support_t * message_type, const char * topic_name, size_t queue_length,
+    uint8_t * message_buffer, const rcluc_publisher_config_t * config, rcluc_publisher_handle_t * publisher_handle);
 
 /*
  *  @brief Initializes the provided struct with the default configuration for a publisher.
@@ -179,10 +359,219 @@ rcluc_ret_t rcluc_publisher_destroy(rcluc_publisher_handle_t publisher_handle);
 /**
  *  @brief Publishes a message on a ROS Topic
  *  Publishes the provided message out on the ROS Topic that is referenced by the publisher_handle.
+ *  Messages whose serialized size is larger than configRCLUC_MAX_MESSAGE_SIZE_BYTES are serialized incrementally into
+ *  fragments that are sent over a reliable stream, so they never need to be held in memory in their serialized form.
+ *  This call blocks while it waits for the agent to acknowledge earlier fragments, for at most
+ *  configRCLUC_FRAGMENT_TIMEOUT_MS in total. A message that does not make it in time, or fails to serialize, is cut
+ *  short and dropped by the agent, and RCLUC_RET_TIMEOUT is returned if it ran out of time.
+ *  With a packed queue, a message the transport cannot take right away is serialized into the queue and sent by a
+ *  later spin, and RCLUC_RET_ERR_SPACE is only returned when the queue is full as well.
  *
  *  @param publisher_handle The handle for the ROS Topic this message will be published on
  *  @param message The message that is going to be published on the topic
  *  @return Returns an error code that will be RCLUC_RET_OK if publish is successful
  */
 rcluc_ret_t rcluc_publisher_publish(rcluc_publisher_handle_t publisher_handle, const void * message);
+
+/**
+ *  @brief Publishes several messages on a ROS Topic
+ *  Publishes count messages taken from an array, which is cheaper than calling rcluc_publisher_publish for each of
+ *  them: the handle is validated once and samples are serialized back to back into as few transport messages as
+ *  possible. Messages are published in order and publishing stops at the first one that is not accepted. On a
+ *  publisher with a packed queue the queued messages are sent first, and nothing is published while some of them
+ *  remain queued.
+ *
+ *  @param publisher_handle The handle for the ROS Topic these messages will be published on
+ *  @param messages The first message that is going to be published on the topic
+ *  @param count The number of messages to publish
+ *  @param stride The distance (in bytes) between the start of two consecutive messages, usually the size of the
+ *  message type
+ *  @param published_count (output) The number of messages that were published. May be NULL.
+ *  @return Returns an error code that will be RCLUC_RET_OK if all messages were published, or RCLUC_RET_ERR_SPACE if
+ *  the transport ran out of space after published_count messages. A message that fails to serialize is not sent and
+ *  published_count stops in front of it.
+ */
+rcluc_ret_t rcluc_publisher_publish_many(rcluc_publisher_handle_t publisher_handle, const void * messages,
+    size_t count, size_t stride, size_t * published_count);
+
+/**
+ *  @brief Publishes a message that is already serialized, given as a list of fragments
+ *  The fragments are sent in order as the serialized message, so that a header built by the application and a payload
+ *  it already holds, or loaned from elsewhere, go out without being copied together first. With a transport that has
+ *  a send_fragments function, a best effort message that fits into one transport message is sent straight from the
+ *  fragments. Otherwise they are copied into the output stream like a serialized message would be. The source
+ *  timestamp, if the publisher sends one, is added by the library and is not part of the fragments. On a publisher
+ *  with a packed queue the queued messages are sent first, and RCLUC_RET_ERR_SPACE is returned while some of them
+ *  remain queued.
+ *
+ *  @param publisher_handle The handle for the ROS Topic this message will be published on
+ *  @param fragments The pieces of the serialized message, in order
+ *  @param count The number of pieces
+ *  @return Returns an error code that will be RCLUC_RET_OK if publish is successful
+ */
+rcluc_ret_t rcluc_publisher_publish_fragments(rcluc_publisher_handle_t publisher_handle,
+    const rcluc_buffer_fragment_t * fragments, size_t count);
+
+/**
+ *  @brief Publishes a message that is already serialized in one piece, see rcluc_publisher_publish_fragments
+ *  The bytes are copied into the output stream as they are, without calling the serialization functions of the
+ *  message type, which is what a bridge forwarding CDR data between links needs. Like every publish, it keeps the order
+ *  of the messages of a packed queue: they are sent first, and RCLUC_RET_ERR_SPACE is returned while some remain.
+ *
+ *  @param publisher_handle The handle for the ROS Topic this message will be published on
+ *  @param data The serialized message, without the source timestamp
+ *  @param length The size (in bytes) of the serialized message
+ *  @return Returns an error code that will be RCLUC_RET_OK if publish is successful
+ */
+rcluc_ret_t rcluc_publisher_publish_serialized(rcluc_publisher_handle_t publisher_handle, const uint8_t * data,
+    size_t length);
+
+/**
+ *  @brief Serializes a message with the message type of a publisher, for rcluc_publisher_publish_serialized
+ *  A message that is published again and again unchanged, like a static transform or a heartbeat, can be serialized
+ *  once into a buffer of the application and then published from it, which skips the size computation and the
+ *  serialization on every publish. The buffer has to be serialized again whenever the message changes.
+ *
+ *  @param publisher_handle The handle to the publisher
+ *  @param message The message to serialize
+ *  @param buffer The memory the serialized message is written into
+ *  @param buffer_size The size (in bytes) of buffer
+ *  @param length (output) The size (in bytes) of the serialized message
+ *  @return Returns an error code that will be RCLUC_RET_ERR_SPACE if the serialized message does not fit into the
+ *      buffer
+ */
+rcluc_ret_t rcluc_publisher_serialize(const rcluc_publisher_handle_t publisher_handle, const void * message,
+    uint8_t * buffer, size_t buffer_size, size_t * length);
+
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+/**
+ *  @brief Gets how congested the link under a publisher is and how much the publisher is held back
+ *  A publisher whose priority is below configRCLUC_CONGESTION_PRIORITY is throttled while its output stream is
+ *  congested, and the messages it may not send are dropped with RCLUC_RET_ERR_CONGESTION. Its exception callback is
+ *  invoked with RCLUC_RET_ERR_CONGESTION when the throttling starts.
+ *
+ *  @param publisher_handle The handle to the publisher
+ *  @param status (output) The congestion of the publisher
+ *  @return Returns an error code that will be RCLUC_RET_OK if the status was read
+ */
+rcluc_ret_t rcluc_publisher_get_congestion_status(const rcluc_publisher_handle_t publisher_handle,
+    rcluc_congestion_status_t * status);
+#endif
+#endif /* configRCLUC_ENABLE_PUBLISHERS */
+
+#if configRCLUC_ENABLE_SERVICES
+/**
+ *  @brief Creates a new ROS service client
+ *  Creates a client that sends requests on the service's request topic and receives responses on its response topic.
+ *  Requests are never blocking: rcluc_client_send_request returns as soon as the request has been written and the
+ *  response is dispatched to the callback from the node's spin. Several requests can be in flight at the same time, up
+ *  to configRCLUC_MAX_REQUESTS_IN_FLIGHT.
+ *
+ *  Every request and response is prefixed with a RCLUC_SERVICE_HEADER_SIZE byte request id, which the service server
+ *  is expected to echo back in its response. A service type that declares a uint64 request_id as the first field of
+ *  both its request and its response, such as rcluc/tools/TimeSync.srv, is served by any ROS 2 node that copies it.
+ *
+ *  @param node_handle The handle for the ROS Node that this client will be created on.
+ *  @param service_type The service type information used by the library to handle the request and response types.
+ *  @param service_name The name of the service. Expected to be a null terminated string
+ *  @param callback The function to invoke when a response is received or a request times out
+ *  @param queue_length The number of responses to queue until the next spin
+ *  @param message_buffer A pointer to a uint8_t array buffer that contains enough space for at least
+ *      RCLUC_SUBSCRIPTION_BUFFER_SIZE(max_serialized_size + RCLUC_SERVICE_HEADER_SIZE, queue_length) bytes. This buffer
+ *      will be used by the library for the lifetime of the client.
+ *  @param config The client configuration. If NULL then the default configuration will be used
+ *  @param client_handle (output) A reference to a client_handle that will be set to the handle for the new client
+ *  @return Returns an error code that will be RCLUC_RET_OK if create is successful
+ */
+rcluc_ret_t rcluc_client_create(rcluc_node_handle_t node_handle, const rcluc_service_type_support_t * service_type,
+    const char * service_name, rcluc_client_response_callback_t callback, size_t queue_length, uint8_t * message_buffer,
+    const rcluc_service_client_config_t * config, rcluc_client_handle_t * client_handle);
+
+/*
+ *  @brief Initializes the provided struct with the default configuration for a service client.
+ *  When passed a preallocated struct it will set all the fields to be the default values. You can then override
+ *  these values with your own configuration.
+ *
+ *  @param config The config struct to be filed with the default values
+ */
+void rcluc_client_get_default_config(rcluc_service_client_config_t * config);
+
+/**
+ *  @brief Sends a request to the service
+ *  Writes the request and returns immediately. The response, or a timeout, is reported to the client's callback from
+ *  the node's spin with the same sequence number.
+ *
+ *  @param client_handle The handle for the client
+ *  @param request The request message
+ *  @param sequence_number (output) The sequence number assigned to the request
+ *  @return Returns an error code that will be RCLUC_RET_OK if the request was sent, or RCLUC_RET_ERR_SPACE if the
+ *      request sent configRCLUC_MAX_REQUESTS_IN_FLIGHT requests earlier is still waiting for its response
+ */
+rcluc_ret_t rcluc_client_send_request(rcluc_client_handle_t client_handle, const void * request,
+    int64_t * sequence_number);
+
+/**
+ *  @brief Gets the reference to the user metadata for the service client.
+ *
+ *  @param client_handle The handle to the client
+ *  @return The reference to the user metadata.
+ */
+void * rcluc_client_get_user_metadata(const rcluc_client_handle_t client_handle);
+
+/**
+ *  @brief Destroys the provided service client
+ *  Requests still in flight are dropped without invoking the callback.
+ *
+ *  @param client_handle The handle for the client that is being destroyed
+ *  @return Returns an error code that will be RCLUC_RET_OK if destroy is successful
+ */
+rcluc_ret_t rcluc_client_destroy(rcluc_client_handle_t client_handle);
+
+/**
+ *  @brief Starts synchronizing the clock of the library with the clock of the ROS graph
+ *  A service client is created on the node for the configRCLUC_TIME_SYNC_SERVICE_NAME service and a request is sent
+ *  from the node's spin every period_ms. Each exchange gives an NTP style estimate of the clock offset and round trip
+ *  time, and the offset of the exchange with the lowest round trip time among the last
+ *  configRCLUC_TIME_SYNC_FILTER_SAMPLES exchanges is used by rcluc_time_now.
+ *
+ *  The server answers a request holding the client's transmit time (int64, nanoseconds) with a response holding that
+ *  time followed by the time the request was received and the time the response was sent (int64, nanoseconds), as
+ *  defined by rcluc/tools/TimeSync.srv. Nothing in a standard ROS 2 installation serves it: run
+ *  rcluc/tools/rcluc_time_sync_server.py, or a server of the application, on a node whose clock is the one to follow.
+ *
+ *  @param node_handle The node whose spin drives the synchronization. It needs a free service client slot.
+ *  @param period_ms The time (in milliseconds) between two requests
+ *  @return Returns an error code that will be RCLUC_RET_OK if the synchronization was started
+ */
+rcluc_ret_t rcluc_time_sync_start(rcluc_node_handle_t node_handle, uint32_t period_ms);
+
+/**
+ *  @brief Stops the time synchronization. rcluc_time_now keeps using the last offset.
+ *
+ *  @return Returns an error code that will be RCLUC_RET_OK if the synchronization was stopped
+ */
+rcluc_ret_t rcluc_time_sync_stop(void);
+
+/**
+ *  @brief Gets the current estimate of the time synchronization
+ *
+ *  @param status (output) The synchronization status
+ *  @return Returns an error code that will be RCLUC_RET_OK if the status was retrieved
+ */
+rcluc_ret_t rcluc_time_sync_get_status(rcluc_time_sync_status_t * status);
+#endif /* configRCLUC_ENABLE_SERVICES */
+
+/**
+ *  @brief Gets the current time
+ *  This is the time of the ROS graph once the time synchronization has completed an exchange, and the time of a local
+ *  monotonic clock before that.
+ *
+ *  @return The current time in nanoseconds
+ */
+int64_t rcluc_time_now(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,372 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Header-only C++ interface to the rcluc library
+ *
+ *  Message types are described by specializing rcluc::MessageTraits. Publishers serialize their messages with the
+ *  traits of their type, which the compiler can inline, and hand the library the serialized bytes. The type support
+ *  handed to the library is generated from the traits as well, for the work the library does on its own, so the
+ *  library calls a type through function pointers that have the signature it expects. Queue buffers are members of
+ *  the publisher and subscription objects and are sized at compile time, so nothing is allocated on the heap. The
+ *  interface does not use exceptions or RTTI and reports errors with rcluc_ret_t like the C interface.
+ */
+
+#ifndef RCLUC__RCLUC_HPP_
+#define RCLUC__RCLUC_HPP_
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+#include "rcluc/rcluc.h"
+#include "rcluc/rcluc_cdr.h"
+
+namespace rcluc {
+
+/**
+ *  @brief Describes a ROS message type to the library. Must be specialized for every message type T with:
+ *
+ *  - static constexpr const char * type_name: the name of the type as it is known to the ROS graph
+ *  - static constexpr size_t max_serialized_size: the largest size (in bytes) of a serialized message
+ *  - static rcluc_ret_t serialize(const T & message, rcluc_cdr_buffer_t * buffer)
+ *  - static rcluc_ret_t deserialize(const uint8_t * data, size_t length, T & message)
+ *  - static size_t serialized_size(const T & message)
+ */
+template <typename T>
+struct MessageTraits;
+
+/**
+ *  @brief The rcluc_message_type_support_t of a message type, built from its MessageTraits at compile time
+ */
+template <typename T>
+struct TypeSupport {
+    static rcluc_ret_t serialize(const void * message, rcluc_cdr_buffer_t * buffer) {
+        return MessageTraits<T>::serialize(*static_cast<const T *>(message), buffer);
+    }
+
+    static rcluc_ret_t deserialize(void * data, size_t length, void * message, size_t message_size) {
+        if (NULL == data || NULL == message) {
+            return RCLUC_RET_NULL_PTR;
+        } else if (message_size < sizeof(T)) {
+            return RCLUC_RET_ERR_SPACE;
+        }
+        return MessageTraits<T>::deserialize(static_cast<const uint8_t *>(data), length, *static_cast<T *>(message));
+    }
+
+    static size_t serialized_size(const void * message) {
+        return MessageTraits<T>::serialized_size(*static_cast<const T *>(message));
+    }
+
+    static const rcluc_message_type_support_t value;
+};
+
+template <typename T>
+const rcluc_message_type_support_t TypeSupport<T>::value = {
+    MessageTraits<T>::type_name,
+    sizeof(T),
+    MessageTraits<T>::max_serialized_size,
+    &TypeSupport<T>::serialize,
+    &TypeSupport<T>::deserialize,
+    &TypeSupport<T>::serialized_size
+};
+
+/**
+ *  @brief A ROS Node. The node is destroyed with the object.
+ */
+class Node {
+public:
+    Node() : handle_(NULL) {}
+
+    ~Node() {
+        if (NULL != handle_) {
+            (void) rcluc_node_destroy(handle_);
+        }
+    }
+
+    Node(const Node &) = delete;
+    Node & operator=(const Node &) = delete;
+
+    /**
+     *  @brief Creates the node, see rcluc_node_create
+     */
+    rcluc_ret_t create(const char * name, const char * namespace_ = "") {
+        if (NULL != handle_) {
+            return RCLUC_RET_ERR_ALREADY;
+        }
+        return rcluc_node_create(name, namespace_, &handle_);
+    }
+
+    /**
+     *  @brief Creates the node on a session other than the default one, see rcluc_node_create_on_session
+     */
+    rcluc_ret_t create(rcluc_session_handle_t session, const char * name, const char * namespace_ = "") {
+        if (NULL != handle_) {
+            return RCLUC_RET_ERR_ALREADY;
+        }
+        return rcluc_node_create_on_session(session, name, namespace_, &handle_);
+    }
+
+    /**
+     *  @brief Dispatches the work that is ready for the node, see rcluc_node_spin_once
+     */
+    void spin_once() {
+        rcluc_node_spin_once(handle_);
+    }
+
+    /**
+     *  @brief Dispatches the work of the node until it is destroyed, see rcluc_node_spin_forever
+     */
+    void spin_forever() {
+        rcluc_node_spin_forever(handle_);
+    }
+
+    rcluc_node_handle_t handle() const {
+        return handle_;
+    }
+
+private:
+    rcluc_node_handle_t handle_;
+};
+
+#if configRCLUC_ENABLE_PUBLISHERS
+/**
+ *  @brief A ROS Topic publisher for messages of type T. The publisher is destroyed with the object.
+ *
+ *  @tparam T The message type, which must have a MessageTraits specialization
+ *  @tparam Depth The number of messages of max_serialized_size to hold in a packed queue, see
+ *      rcluc_publisher_config_t::packed_queue, or 0 to hand every message straight to the transport
+ */
+template <typename T, size_t Depth = 0>
+class Publisher {
+public:
+    /**
+     *  @brief The size (in bytes) of the packed queue held by the publisher. Each record has room for a source
+     *  timestamp so that the same object works whether or not source timestamps are enabled in the configuration.
+     */
+    static constexpr size_t buffer_size = (0 == Depth) ? 0
+        : RCLUC_PUBLISHER_PACKED_BUFFER_SIZE(MessageTraits<T>::max_serialized_size + RCLUC_SOURCE_TIMESTAMP_SIZE, Depth);
+
+    Publisher() : handle_(NULL) {}
+
+    ~Publisher() {
+        if (NULL != handle_) {
+            (void) rcluc_publisher_destroy(handle_);
+        }
+    }
+
+    Publisher(const Publisher &) = delete;
+    Publisher & operator=(const Publisher &) = delete;
+
+    /**
+     *  @brief Creates the publisher on a node, see rcluc_publisher_create
+     *
+     *  @param config The publisher configuration. If NULL then the default configuration will be used. The
+     *      packed_queue of the configuration follows Depth and is ignored.
+     */
+    rcluc_ret_t create(Node & node, const char * topic_name, const rcluc_publisher_config_t * config = NULL) {
+        rcluc_publisher_config_t publisher_config;
+        if (NULL != handle_) {
+            return RCLUC_RET_ERR_ALREADY;
+        } else if (NULL == config) {
+            rcluc_publisher_get_default_config(&publisher_config);
+        } else {
+            publisher_config = *config;
+        }
+        publisher_config.packed_queue = (0 == Depth) ? 0 : 1;
+        // The library only uses the buffer for a packed queue, but does not take a NULL one
+        return rcluc_publisher_create(node.handle(), &TypeSupport<T>::value, topic_name,
+                (0 == Depth) ? 1 : buffer_size, buffer_.data(), &publisher_config, &handle_);
+    }
+
+    /**
+     *  @brief Publishes a message, see rcluc_publisher_publish
+     *
+     *  A message that fits into configRCLUC_MAX_MESSAGE_SIZE_BYTES is serialized on the stack with
+     *  MessageTraits<T>::serialize and published serialized. Larger messages are left to the library, which serializes
+     *  them straight into their fragments, and so are the messages of a packed queue, which the library queues
+     *  unserialized when the transport has no room.
+     */
+    rcluc_ret_t publish(const T & message) {
+        if (0 != Depth || MessageTraits<T>::max_serialized_size > configRCLUC_MAX_MESSAGE_SIZE_BYTES) {
+            return rcluc_publisher_publish(handle_, &message);
+        }
+        std::array<uint8_t, serialize_size> serialized;
+        size_t length = 0;
+        rcluc_ret_t status = serialize(message, serialized.data(), serialized.size(), &length);
+        if (RCLUC_RET_OK != status) {
+            return status;
+        }
+        return rcluc_publisher_publish_serialized(handle_, serialized.data(), length);
+    }
+
+    /**
+     *  @brief Serializes a message with MessageTraits<T>::serialize, for publish_serialized, see
+     *  rcluc_publisher_serialize
+     */
+    static rcluc_ret_t serialize(const T & message, uint8_t * buffer, size_t buffer_size, size_t * length) {
+        rcluc_cdr_buffer_t cdr_buffer;
+        if (NULL == buffer || NULL == length) {
+            return RCLUC_RET_NULL_PTR;
+        }
+        rcluc_cdr_init(&cdr_buffer, buffer, buffer_size);
+        rcluc_ret_t status = MessageTraits<T>::serialize(message, &cdr_buffer);
+        if (RCLUC_RET_OK == status) {
+            status = cdr_buffer.error;
+        }
+        *length = (RCLUC_RET_OK == status) ? rcluc_cdr_get_length(&cdr_buffer) : 0;
+        return status;
+    }
+
+    /**
+     *  @brief Publishes a message that is already serialized in one piece, see rcluc_publisher_publish_serialized
+     */
+    rcluc_ret_t publish_serialized(const uint8_t * data, size_t length) {
+        return rcluc_publisher_publish_serialized(handle_, data, length);
+    }
+
+    /**
+     *  @brief Publishes an array of messages, see rcluc_publisher_publish_many
+     */
+    rcluc_ret_t publish(const T * messages, size_t count, size_t * published_count = NULL) {
+        return rcluc_publisher_publish_many(handle_, messages, count, sizeof(T), published_count);
+    }
+
+    /**
+     *  @brief Publishes a message that is already serialized, see rcluc_publisher_publish_fragments
+     */
+    rcluc_ret_t publish_fragments(const rcluc_buffer_fragment_t * fragments, size_t count) {
+        return rcluc_publisher_publish_fragments(handle_, fragments, count);
+    }
+
+    rcluc_publisher_handle_t handle() const {
+        return handle_;
+    }
+
+private:
+    // The stack buffer of publish, which only serializes messages up to configRCLUC_MAX_MESSAGE_SIZE_BYTES
+    static constexpr size_t serialize_size =
+        (MessageTraits<T>::max_serialized_size < configRCLUC_MAX_MESSAGE_SIZE_BYTES)
+        ? MessageTraits<T>::max_serialized_size : configRCLUC_MAX_MESSAGE_SIZE_BYTES;
+
+    rcluc_publisher_handle_t handle_;
+    std::array<uint8_t, (0 == Depth) ? 1 : buffer_size> buffer_;
+};
+#endif /* configRCLUC_ENABLE_PUBLISHERS */
+
+#if configRCLUC_ENABLE_SUBSCRIPTIONS
+/**
+ *  @brief A ROS Topic subscription for messages of type T. The subscription is destroyed with the object.
+ *  Messages are handed to the callback object as a const T & from the node's spin.
+ *
+ *  @tparam T The message type, which must have a MessageTraits specialization
+ *  @tparam Depth The number of messages to queue between two spins
+ *  @tparam Callback A callable type invoked as callback(const T & message)
+ */
+template <typename T, size_t Depth, typename Callback>
+class Subscription {
+public:
+    static_assert(Depth > 0, "A subscription needs a queue of at least one message");
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT != RCLUC_SUBSCRIPTION_DESERIALIZATION_DISABLED
+    static_assert(sizeof(T) <= configRCLUC_MAX_MESSAGE_SIZE_BYTES,
+            "Deserialized messages must fit into configRCLUC_MAX_MESSAGE_SIZE_BYTES");
+#endif
+
+    /**
+     *  @brief The size (in bytes) of the queue held by the subscription. Each entry has room for a source timestamp
+     *  so that the same object works whether or not source timestamps are enabled in the configuration.
+     */
+    static constexpr size_t buffer_size =
+        RCLUC_SUBSCRIPTION_BUFFER_SIZE(MessageTraits<T>::max_serialized_size + RCLUC_SOURCE_TIMESTAMP_SIZE, Depth);
+
+    explicit Subscription(const Callback & callback = Callback()) : handle_(NULL), callback_(callback) {}
+
+    ~Subscription() {
+        if (NULL != handle_) {
+            (void) rcluc_subscription_destroy(handle_);
+        }
+    }
+
+    Subscription(const Subscription &) = delete;
+    Subscription & operator=(const Subscription &) = delete;
+
+    /**
+     *  @brief Creates the subscription on a node, see rcluc_subscription_create
+     *
+     *  @param config The subscription configuration. If NULL then the default configuration will be used. The
+     *      user_metadata of the configuration is used by the wrapper and is ignored.
+     */
+    rcluc_ret_t create(Node & node, const char * topic_name, const rcluc_subscription_config_t * config = NULL) {
+        rcluc_subscription_config_t subscription_config;
+        if (NULL != handle_) {
+            return RCLUC_RET_ERR_ALREADY;
+        } else if (NULL == config) {
+            rcluc_subscription_get_default_config(&subscription_config);
+        } else {
+            subscription_config = *config;
+        }
+        subscription_config.user_metadata = this;
+        subscription_config.max_serialized_size = MessageTraits<T>::max_serialized_size;
+        return rcluc_subscription_create(node.handle(), &TypeSupport<T>::value, topic_name, on_message, Depth,
+                buffer_.data(), &subscription_config, &handle_);
+    }
+
+    /**
+     *  @brief Gets the information about the message being delivered, see rcluc_subscription_get_message_info
+     */
+    rcluc_ret_t get_message_info(rcluc_message_info_t * message_info) const {
+        return rcluc_subscription_get_message_info(handle_, message_info);
+    }
+
+    /**
+     *  @brief Keeps the message being delivered after the callback returns, see rcluc_subscription_loan_retain
+     */
+    rcluc_ret_t loan_retain(rcluc_loan_t * loan) const {
+        return rcluc_subscription_loan_retain(handle_, loan);
+    }
+
+    rcluc_subscription_handle_t handle() const {
+        return handle_;
+    }
+
+private:
+    static void on_message(const rcluc_subscription_handle_t subscription, const void * message, const void * args) {
+        Subscription * self = static_cast<Subscription *>(const_cast<void *>(args));
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT == RCLUC_SUBSCRIPTION_DESERIALIZATION_DISABLED
+        // The library hands over the serialized sample, its length comes with the message info
+        rcluc_message_info_t info;
+        if (RCLUC_RET_OK == rcluc_subscription_get_message_info(subscription, &info)
+                && RCLUC_RET_OK == MessageTraits<T>::deserialize(static_cast<const uint8_t *>(message),
+                info.serialized_length, self->message_)) {
+            self->callback_(static_cast<const T &>(self->message_));
+        }
+#else
+        (void) subscription;
+        self->callback_(*static_cast<const T *>(message));
+#endif
+    }
+
+    rcluc_subscription_handle_t handle_;
+    Callback callback_;
+    std::array<uint8_t, buffer_size> buffer_;
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT == RCLUC_SUBSCRIPTION_DESERIALIZATION_DISABLED
+    T message_;
+#endif
+};
+#endif /* configRCLUC_ENABLE_SUBSCRIPTIONS */
+
+} // namespace rcluc
+
+#endif /* ifndef RCLUC__RCLUC_HPP_ */
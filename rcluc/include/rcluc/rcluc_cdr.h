@@ -0,0 +1,307 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Defines the CDR serialization layer used by the rcluc message type support.
+ *
+ *  The buffer used by these functions is a window onto the serialized stream. When a flush function is set, writing
+ *  past the end of the window hands the filled window to the flush function, which is expected to provide the next
+ *  window with rcluc_cdr_set_window. This allows messages to be serialized incrementally into fixed size fragments
+ *  without ever holding the complete serialized form in memory.
+ */
+
+#ifndef RCLUC__RCLUC_CDR_H_
+#define RCLUC__RCLUC_CDR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rcluc/rcluc_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  @brief The byte order used to encode data in a CDR buffer
+ */
+typedef enum {
+    RCLUC_CDR_BIG_ENDIAN = 0,
+    RCLUC_CDR_LITTLE_ENDIAN = 1
+} rcluc_cdr_endianness_t;
+
+/**
+ *  @brief The construct for a function that is invoked when a CDR buffer window is full.
+ *  The function is responsible for consuming the bytes in the current window and then providing the next window by
+ *  calling rcluc_cdr_set_window.
+ *
+ *  @param buffer The buffer whose window is full
+ *  @param args The user arguments given to rcluc_cdr_set_flush
+ *  @return Returns an error code that will be RCLUC_RET_OK if a new window has been provided
+ */
+typedef rcluc_ret_t (*rcluc_cdr_flush_func_t)(rcluc_cdr_buffer_t * buffer, void * args);
+
+/**
+ *  @brief A CDR buffer used to serialize or deserialize a message.
+ *
+ *  @var rcluc_cdr_buffer_s::data
+ *      The current window of the buffer
+ *  @var rcluc_cdr_buffer_s::capacity
+ *      The size (in bytes) of the current window
+ *  @var rcluc_cdr_buffer_s::position
+ *      The offset of the next byte to be read or written within the current window
+ *  @var rcluc_cdr_buffer_s::origin
+ *      The number of bytes of the stream that came before the current window. Used to keep alignment relative to the
+ *      start of the stream when the buffer is made of several windows.
+ *  @var rcluc_cdr_buffer_s::endianness
+ *      The byte order of the data in the buffer
+ *  @var rcluc_cdr_buffer_s::flush
+ *      The function invoked when the window is full. If NULL then running out of space is an error.
+ *  @var rcluc_cdr_buffer_s::flush_args
+ *      The user arguments passed to the flush function
+ *  @var rcluc_cdr_buffer_s::error
+ *      The first error that occurred on the buffer. Once set all further operations on the buffer fail.
+ */
+struct rcluc_cdr_buffer_s {
+    uint8_t * data;
+    size_t capacity;
+    size_t position;
+    size_t origin;
+    rcluc_cdr_endianness_t endianness;
+    rcluc_cdr_flush_func_t flush;
+    void * flush_args;
+    rcluc_ret_t error;
+};
+
+/**
+ *  @brief Initializes a CDR buffer over a single contiguous window
+ *
+ *  @param buffer The buffer to initialize
+ *  @param data The memory that will hold the serialized data
+ *  @param capacity The size (in bytes) of data
+ */
+void rcluc_cdr_init(rcluc_cdr_buffer_t * buffer, uint8_t * data, size_t capacity);
+
+/**
+ *  @brief Sets the function invoked when the current window of the buffer is full
+ *
+ *  @param buffer The buffer to configure
+ *  @param flush The function that consumes a full window and provides the next one
+ *  @param args User arguments passed to the flush function
+ */
+void rcluc_cdr_set_flush(rcluc_cdr_buffer_t * buffer, rcluc_cdr_flush_func_t flush, void * args);
+
+/**
+ *  @brief Moves the buffer on to a new window.
+ *  The bytes of the current window are accounted for in the origin of the buffer so that alignment is preserved.
+ *
+ *  @param buffer The buffer to update
+ *  @param data The memory for the new window
+ *  @param capacity The size (in bytes) of the new window
+ */
+void rcluc_cdr_set_window(rcluc_cdr_buffer_t * buffer, uint8_t * data, size_t capacity);
+
+/**
+ *  @brief Gets the total number of bytes read or written since the buffer was initialized
+ *
+ *  @param buffer The buffer
+ *  @return The number of bytes processed across all windows
+ */
+size_t rcluc_cdr_get_length(const rcluc_cdr_buffer_t * buffer);
+
+/**
+ *  @brief Gets the number of padding bytes needed to align data of a given size at an offset in the stream
+ *
+ *  @param offset The offset in the serialized stream
+ *  @param data_size The size of the primitive that will be aligned
+ *  @return The number of padding bytes
+ */
+size_t rcluc_cdr_alignment(size_t offset, size_t data_size);
+
+/**
+ *  @brief Gets the size of a serialized string, including its alignment, length prefix and terminating null character
+ *
+ *  @param offset The offset in the serialized stream where the string will start
+ *  @param string The null terminated string
+ *  @return The offset in the serialized stream after the string
+ */
+size_t rcluc_cdr_string_end(size_t offset, const char * string);
+
+/**
+ *  @brief Gets the size of a serialized array of primitives, including its alignment
+ *
+ *  @param offset The offset in the serialized stream where the array will start
+ *  @param count The number of elements
+ *  @param element_size The size (in bytes) of an element: 1, 2, 4 or 8
+ *  @return The offset in the serialized stream after the array
+ */
+size_t rcluc_cdr_array_end(size_t offset, size_t count, size_t element_size);
+
+/**
+ *  @brief Gets the size of a serialized sequence of primitives, including its alignment and length prefix
+ *
+ *  @param offset The offset in the serialized stream where the sequence will start
+ *  @param count The number of elements
+ *  @param element_size The size (in bytes) of an element: 1, 2, 4 or 8
+ *  @return The offset in the serialized stream after the sequence
+ */
+size_t rcluc_cdr_sequence_end(size_t offset, size_t count, size_t element_size);
+
+/**
+ *  @brief Serializes a primitive value.
+ *  The value is aligned to its own size relative to the start of the stream and written in the byte order of the buffer.
+ */
+rcluc_ret_t rcluc_cdr_serialize_uint8(rcluc_cdr_buffer_t * buffer, uint8_t value);
+rcluc_ret_t rcluc_cdr_serialize_uint16(rcluc_cdr_buffer_t * buffer, uint16_t value);
+rcluc_ret_t rcluc_cdr_serialize_uint32(rcluc_cdr_buffer_t * buffer, uint32_t value);
+rcluc_ret_t rcluc_cdr_serialize_uint64(rcluc_cdr_buffer_t * buffer, uint64_t value);
+rcluc_ret_t rcluc_cdr_serialize_float(rcluc_cdr_buffer_t * buffer, float value);
+rcluc_ret_t rcluc_cdr_serialize_double(rcluc_cdr_buffer_t * buffer, double value);
+
+/**
+ *  @brief Serializes a string as a CDR string (a uint32 length, including the null character, followed by the bytes)
+ *
+ *  @param buffer The buffer to write into
+ *  @param string The null terminated string
+ *  @return Returns an error code that will be RCLUC_RET_OK if the string is serialized successfully
+ */
+rcluc_ret_t rcluc_cdr_serialize_string(rcluc_cdr_buffer_t * buffer, const char * string);
+
+/**
+ *  @brief Serializes a fixed size array of primitives, such as a float32[N] field
+ *  The array is aligned to its element size and copied in one block when the byte order of the buffer is the one of
+ *  the host. Otherwise the elements are byte swapped a block at a time.
+ *
+ *  @param buffer The buffer to write into
+ *  @param elements The array, in the byte order of the host
+ *  @param count The number of elements
+ *  @param element_size The size (in bytes) of an element: 1, 2, 4 or 8
+ *  @return Returns an error code that will be RCLUC_RET_OK if the array is serialized successfully
+ */
+rcluc_ret_t rcluc_cdr_serialize_array(rcluc_cdr_buffer_t * buffer, const void * elements, size_t count,
+    size_t element_size);
+
+/**
+ *  @brief Serializes a sequence of primitives, such as a uint8[] field, as a uint32 element count followed by the
+ *  elements, see rcluc_cdr_serialize_array
+ */
+rcluc_ret_t rcluc_cdr_serialize_sequence(rcluc_cdr_buffer_t * buffer, const void * elements, size_t count,
+    size_t element_size);
+
+/**
+ *  @brief Writes raw bytes to the buffer without any alignment
+ *
+ *  @param buffer The buffer to write into
+ *  @param bytes The bytes to write
+ *  @param size The number of bytes to write
+ *  @return Returns an error code that will be RCLUC_RET_OK if the bytes are written successfully
+ */
+rcluc_ret_t rcluc_cdr_serialize_bytes(rcluc_cdr_buffer_t * buffer, const uint8_t * bytes, size_t size);
+
+/**
+ *  @brief Deserializes a primitive value.
+ *  The value is read from the next position aligned to its own size relative to the start of the stream.
+ */
+rcluc_ret_t rcluc_cdr_deserialize_uint8(rcluc_cdr_buffer_t * buffer, uint8_t * value);
+rcluc_ret_t rcluc_cdr_deserialize_uint16(rcluc_cdr_buffer_t * buffer, uint16_t * value);
+rcluc_ret_t rcluc_cdr_deserialize_uint32(rcluc_cdr_buffer_t * buffer, uint32_t * value);
+rcluc_ret_t rcluc_cdr_deserialize_uint64(rcluc_cdr_buffer_t * buffer, uint64_t * value);
+rcluc_ret_t rcluc_cdr_deserialize_float(rcluc_cdr_buffer_t * buffer, float * value);
+rcluc_ret_t rcluc_cdr_deserialize_double(rcluc_cdr_buffer_t * buffer, double * value);
+
+/**
+ *  @brief Deserializes a CDR string into a fixed size character array
+ *
+ *  @param buffer The buffer to read from
+ *  @param string (output) The array the string is copied into. It is always null terminated on success.
+ *  @param string_size The size of the string array
+ *  @return Returns an error code that will be RCLUC_RET_ERR_SPACE if the string does not fit into the array
+ */
+rcluc_ret_t rcluc_cdr_deserialize_string(rcluc_cdr_buffer_t * buffer, char * string, size_t string_size);
+
+/**
+ *  @brief Deserializes a fixed size array of primitives
+ *  The array is copied in one block and, if the byte order of the buffer is not the one of the host, byte swapped in
+ *  place.
+ *
+ *  @param buffer The buffer to read from
+ *  @param elements (output) The array
+ *  @param count The number of elements
+ *  @param element_size The size (in bytes) of an element: 1, 2, 4 or 8
+ *  @return Returns an error code that will be RCLUC_RET_OK if the array is deserialized successfully
+ */
+rcluc_ret_t rcluc_cdr_deserialize_array(rcluc_cdr_buffer_t * buffer, void * elements, size_t count,
+    size_t element_size);
+
+/**
+ *  @brief Deserializes a sequence of primitives into a fixed size array, see rcluc_cdr_deserialize_array
+ *
+ *  @param buffer The buffer to read from
+ *  @param elements (output) The array
+ *  @param capacity The number of elements the array can hold
+ *  @param element_size The size (in bytes) of an element: 1, 2, 4 or 8
+ *  @param count (output) The number of elements of the sequence
+ *  @return Returns an error code that will be RCLUC_RET_ERR_SPACE if the sequence does not fit into the array
+ */
+rcluc_ret_t rcluc_cdr_deserialize_sequence(rcluc_cdr_buffer_t * buffer, void * elements, size_t capacity,
+    size_t element_size, size_t * count);
+
+/**
+ *  @brief Reads raw bytes from the buffer without any alignment
+ *
+ *  @param buffer The buffer to read from
+ *  @param bytes (output) The memory the bytes are copied into
+ *  @param size The number of bytes to read
+ *  @return Returns an error code that will be RCLUC_RET_OK if the bytes are read successfully
+ */
+rcluc_ret_t rcluc_cdr_deserialize_bytes(rcluc_cdr_buffer_t * buffer, uint8_t * bytes, size_t size);
+
+/**
+ *  @brief Reads a primitive field straight from a contiguous serialized message, without deserializing the fields
+ *  before it. The field is aligned to its own size relative to the start of the message, so the end of the previous
+ *  field can be given as the offset.
+ *
+ *  @param data The serialized message, in the byte order of configRCLUC_CDR_ENDIANNESS
+ *  @param length The size (in bytes) of the serialized message
+ *  @param offset The offset of the field, before its alignment
+ *  @param value (output) The value of the field
+ *  @return Returns an error code that will be RCLUC_RET_ERR_SPACE if the field goes past the end of the message
+ */
+rcluc_ret_t rcluc_cdr_get_uint8(const uint8_t * data, size_t length, size_t offset, uint8_t * value);
+rcluc_ret_t rcluc_cdr_get_uint16(const uint8_t * data, size_t length, size_t offset, uint16_t * value);
+rcluc_ret_t rcluc_cdr_get_uint32(const uint8_t * data, size_t length, size_t offset, uint32_t * value);
+rcluc_ret_t rcluc_cdr_get_uint64(const uint8_t * data, size_t length, size_t offset, uint64_t * value);
+rcluc_ret_t rcluc_cdr_get_float(const uint8_t * data, size_t length, size_t offset, float * value);
+rcluc_ret_t rcluc_cdr_get_double(const uint8_t * data, size_t length, size_t offset, double * value);
+
+/**
+ *  @brief Gets a string field of a contiguous serialized message in place, see rcluc_cdr_get_uint8
+ *
+ *  @param data The serialized message
+ *  @param length The size (in bytes) of the serialized message
+ *  @param offset The offset of the field, before its alignment
+ *  @param string (output) The null terminated string, in the message
+ *  @param end (output, optional) The offset in the message after the string, where the next field starts
+ *  @return Returns an error code that will be RCLUC_RET_ERR_SPACE if the string goes past the end of the message, or
+ *      RCLUC_RET_ERROR if it is not null terminated
+ */
+rcluc_ret_t rcluc_cdr_get_string(const uint8_t * data, size_t length, size_t offset, const char ** string,
+    size_t * end);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ifndef RCLUC__RCLUC_CDR_H_ */
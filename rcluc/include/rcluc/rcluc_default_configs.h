@@ -23,6 +23,58 @@
 #ifndef RCLUC__RCLUC_DEFAULT_CONFIGS_H_
 #define RCLUC__RCLUC_DEFAULT_CONFIGS_H_
 
+#ifdef RCLUC_CONFIG_HEADER
+/*
+ *  The application may collect its configuration in a header instead of passing every value on the command line, in
+ *  which case RCLUC_CONFIG_HEADER is its quoted path, for example -DRCLUC_CONFIG_HEADER=\"rcluc_config.h\"
+ */
+#include RCLUC_CONFIG_HEADER
+#endif
+
+#ifndef configRCLUC_ENABLE_SUBSCRIPTIONS
+/**
+ *  @brief Set to 0 to compile out topic subscriptions, along with their queues and content filters
+ */
+#define configRCLUC_ENABLE_SUBSCRIPTIONS 1
+#endif
+
+#ifndef configRCLUC_ENABLE_PUBLISHERS
+/**
+ *  @brief Set to 0 to compile out topic publishers
+ */
+#define configRCLUC_ENABLE_PUBLISHERS 1
+#endif
+
+#ifndef configRCLUC_ENABLE_SERVICES
+/**
+ *  @brief Set to 0 to compile out service clients and the time synchronization, which is built on a service client
+ */
+#define configRCLUC_ENABLE_SERVICES 1
+#endif
+
+#ifndef configRCLUC_MAX_SESSIONS
+/**
+ *  @brief The maximum number of sessions with the agent, each over its own transport and with its own stream buffers
+ */
+#define configRCLUC_MAX_SESSIONS 1
+#endif
+
+#ifndef configRCLUC_RMWU_SHM
+/**
+ *  @brief Set to 1 when the rmwu layer is the shared memory implementation, which exchanges messages between processes
+ *  of the same Linux host without an agent. Set by the build from RCLUC_RMWU_BACKEND.
+ */
+#define configRCLUC_RMWU_SHM 0
+#endif
+
+#ifndef configRCLUC_SHM_SLOT_COUNT
+/**
+ *  @brief The number of samples a topic keeps in shared memory. A subscriber that falls further behind loses the oldest
+ *  samples. Only used by the shared memory rmwu implementation.
+ */
+#define configRCLUC_SHM_SLOT_COUNT 16
+#endif
+
 #ifndef configRCLUC_MAX_NUM_NODES
 /**
  *  @brief The maximum number of Ros Nodes that can be created
@@ -44,6 +96,169 @@
 #define configRCLUC_MAX_PUBLISHERS_PER_NODE 1
 #endif
 
+#ifndef configRCLUC_MAX_CLIENTS_PER_NODE
+/**
+ *  @brief The maximum number of service clients that can be created on each ROS Node instance
+ */
+#define configRCLUC_MAX_CLIENTS_PER_NODE 1
+#endif
+
+#ifndef configRCLUC_MAX_REQUESTS_IN_FLIGHT
+/**
+ *  @brief The maximum number of requests each service client can have waiting for a response. Must be a power of two.
+ */
+#define configRCLUC_MAX_REQUESTS_IN_FLIGHT 4
+#endif
+
+#ifndef configRCLUC_SERVICE_REQUEST_TIMEOUT_MS
+/**
+ *  @brief The default time (in milliseconds) a service client waits for the response to a request
+ */
+#define configRCLUC_SERVICE_REQUEST_TIMEOUT_MS 1000
+#endif
+
+/**
+ *  @def configRCLUC_GET_TIME_NS
+ *  @brief Reads a monotonic clock, as an int64_t in nanoseconds. All the timeouts, the reception timestamps and the
+ *  time synchronization of the library run on this clock.
+ *  Left undefined, the rmwu layer reads CLOCK_MONOTONIC with clock_gettime, which only POSIX systems have. Other
+ *  platforms define it to their own clock from the configuration header, which also declares the function, for example
+ *  #define configRCLUC_GET_TIME_NS() board_get_time_ns()
+ */
+#if !defined(configRCLUC_GET_TIME_NS) && !defined(__unix__) && !defined(__APPLE__)
+#error "Define configRCLUC_GET_TIME_NS() to read a monotonic clock on platforms without clock_gettime"
+#endif
+
+/**
+ *  @def configRCLUC_ATOMIC_LOAD
+ *  @def configRCLUC_ATOMIC_STORE
+ *  @def configRCLUC_ATOMIC_FENCE
+ *  @brief The atomic accesses the subscription mailboxes, the recorder and the log ring use to share words with
+ *  other contexts. Left undefined, the library uses C11 <stdatomic.h>, or the __atomic builtins of GCC and Clang, and
+ *  stops with an error on compilers that have neither. A port defines all three in the configuration header, for
+ *  example with interrupts masked around the access on a single core:
+ *  #define configRCLUC_ATOMIC_LOAD(variable) board_atomic_load_u32(&(variable))
+ *  #define configRCLUC_ATOMIC_STORE(variable, value) board_atomic_store_u32(&(variable), (value))
+ *  #define configRCLUC_ATOMIC_FENCE() board_memory_barrier()
+ *  Loads must acquire, stores must release and the fence must be a full barrier. The words are volatile uint32_t.
+ */
+
+#ifndef configRCLUC_TIME_SYNC_SERVICE_NAME
+/**
+ *  @brief The name of the ROS service answering the time synchronization requests of rcluc_time_sync_start, of type
+ *  rcluc_msgs/srv/TimeSync (see rcluc/tools/TimeSync.srv). rcluc/tools/rcluc_time_sync_server.py serves it from a
+ *  ROS 2 node on the host running the agent.
+ */
+#define configRCLUC_TIME_SYNC_SERVICE_NAME "rcluc/time_sync"
+#endif
+
+#ifndef configRCLUC_TIME_SYNC_FILTER_SAMPLES
+/**
+ *  @brief The number of recent time synchronization exchanges the clock offset is chosen from.
+ *  The exchange with the lowest round trip time wins, as it is the least affected by queuing delays.
+ */
+#define configRCLUC_TIME_SYNC_FILTER_SAMPLES 8
+#endif
+
+#ifndef configRCLUC_ENABLE_LOGGING
+/**
+ *  @brief Set to 1 to compile in the deferred logging of rcluc_log.h. The RCLUC_LOG_* macros compile to nothing otherwise.
+ */
+#define configRCLUC_ENABLE_LOGGING 0
+#endif
+
+#ifndef configRCLUC_LOG_LEVEL
+/**
+ *  @brief The lowest severity of the log records to keep, the RCLUC_LOG_* macros of lower severities compile to nothing
+ */
+#define configRCLUC_LOG_LEVEL RCLUC_LOG_LEVEL_DEBUG
+#endif
+
+#ifndef configRCLUC_LOG_BUFFER_SIZE
+/**
+ *  @brief The size (in bytes) of the ring buffer holding the log records until a spin publishes them. A record takes 20
+ *  bytes plus 8 bytes per argument. Records that do not fit are dropped and counted.
+ */
+#define configRCLUC_LOG_BUFFER_SIZE 512
+#endif
+
+#ifndef configRCLUC_LOG_BATCH_SIZE
+/**
+ *  @brief The largest number of bytes of log records published in one message. Must be at least the size of the
+ *  largest record, 84 bytes.
+ */
+#define configRCLUC_LOG_BATCH_SIZE 256
+#endif
+
+#ifndef configRCLUC_LOG_TOPIC_NAME
+/**
+ *  @brief The topic the log records are published on by rcluc_log_start
+ */
+#define configRCLUC_LOG_TOPIC_NAME "rcluc/log"
+#endif
+
+#ifndef configRCLUC_ENABLE_RECORDER
+/**
+ *  @brief Set to 1 to compile in the recording and replay of the serialized samples of rcluc_record.h. Set by the build
+ *  from RCLUC_RECORDER.
+ */
+#define configRCLUC_ENABLE_RECORDER 0
+#endif
+
+#ifndef configRCLUC_RECORD_MAX_TOPICS
+/**
+ *  @brief The largest number of topics in a log that rcluc_replay_next can tell apart
+ */
+#define configRCLUC_RECORD_MAX_TOPICS 16
+#endif
+
+#ifndef configRCLUC_ENABLE_CONGESTION_CONTROL
+/**
+ *  @brief Set to 1 to throttle and drop the messages of low priority publishers while their output stream is congested,
+ *  see rcluc_publisher_config_t::priority
+ */
+#define configRCLUC_ENABLE_CONGESTION_CONTROL 0
+#endif
+
+#ifndef configRCLUC_CONGESTION_PRIORITY
+/**
+ *  @brief Publishers with a lower priority are throttled under congestion, the others are never held back
+ */
+#define configRCLUC_CONGESTION_PRIORITY RCLUC_PRIORITY_DEFAULT
+#endif
+
+#ifndef configRCLUC_CONGESTION_HIGH_PERCENT
+/**
+ *  @brief The occupancy of an output stream at which it counts as congested. Low priority publishers are throttled
+ *  harder on every spin that finds the stream this full, and their messages are dropped outright while it is.
+ */
+#define configRCLUC_CONGESTION_HIGH_PERCENT 75
+#endif
+
+#ifndef configRCLUC_CONGESTION_LOW_PERCENT
+/**
+ *  @brief The occupancy of an output stream below which throttled publishers are let through more often again, on
+ *  every spin
+ */
+#define configRCLUC_CONGESTION_LOW_PERCENT 25
+#endif
+
+#ifndef configRCLUC_CONGESTION_MAX_THROTTLE_SHIFT
+/**
+ *  @brief The hardest throttling of a low priority publisher, which then publishes one message out of
+ *  2^configRCLUC_CONGESTION_MAX_THROTTLE_SHIFT
+ */
+#define configRCLUC_CONGESTION_MAX_THROTTLE_SHIFT 4
+#endif
+
+#ifndef configRCLUC_ENABLE_PRIORITY_DISPATCH
+/**
+ *  @brief Set to 1 for a spin to invoke the callbacks of a node in order of subscription priority instead of one
+ *  subscription after the other, see rcluc_subscription_config_t::priority
+ */
+#define configRCLUC_ENABLE_PRIORITY_DISPATCH 0
+#endif
+
 #ifndef configRCLUC_MAX_MESSAGE_SIZE_BYTES
 /**
  *  @brief The maximum size (in bytes) for messages being sent or received on Topics.
@@ -58,7 +273,7 @@
 #define configRCLUC_MAX_TOPIC_NAME_LEN 32
 #endif
 
-#ifndef configRCLUC_SUPPORT_SUBSCRIPTION_DESERIALIZATION
+#ifndef configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT
 /**
  *  @brief Defines what type of deserialization is supported. By default deserialization is disabled.
  *  There are two supported modes of deserialization supported. You can define deserialization support to be either of
@@ -74,4 +289,59 @@
 #define configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT RCLUC_SUBSCRIPTION_DESERIALIZATION_DISABLED
 #endif
 
+#ifndef configRCLUC_CDR_ENDIANNESS
+/**
+ *  @brief The byte order used when serializing messages.
+ */
+#define configRCLUC_CDR_ENDIANNESS RCLUC_CDR_LITTLE_ENDIAN
+#endif
+
+#ifndef configRCLUC_SPIN_TIMEOUT_MS
+/**
+ *  @brief The maximum time (in milliseconds) a single spin will wait for incoming data from the transport layer.
+ */
+#define configRCLUC_SPIN_TIMEOUT_MS 10
+#endif
+
+#ifndef configRCLUC_ENTITY_CREATION_TIMEOUT_MS
+/**
+ *  @brief The maximum time (in milliseconds) to wait for the agent to confirm the creation or deletion of an entity.
+ */
+#define configRCLUC_ENTITY_CREATION_TIMEOUT_MS 1000
+#endif
+
+#ifndef configRCLUC_BEST_EFFORT_STREAM_BUFFER_SIZE
+/**
+ *  @brief The size (in bytes) of the buffer for the best effort output stream. Messages with a serialized size up to
+ *  configRCLUC_MAX_MESSAGE_SIZE_BYTES are written to this stream by best effort publishers.
+ */
+#define configRCLUC_BEST_EFFORT_STREAM_BUFFER_SIZE (configRCLUC_MAX_MESSAGE_SIZE_BYTES + 32)
+#endif
+
+#ifndef configRCLUC_RELIABLE_STREAM_HISTORY
+/**
+ *  @brief The number of messages the reliable streams can hold while waiting for them to be acknowledged.
+ */
+#define configRCLUC_RELIABLE_STREAM_HISTORY 4
+#endif
+
+#ifndef configRCLUC_RELIABLE_STREAM_BUFFER_SIZE
+/**
+ *  @brief The size (in bytes) of the buffer for each of the reliable input and output streams. The buffer is split into
+ *  configRCLUC_RELIABLE_STREAM_HISTORY slots. Messages that do not fit into a single slot are sent as fragments.
+ *  Received fragments are handed to the subscription one at a time and reassembled in its message_buffer, so received
+ *  messages are bounded by the slots of the subscription, not by this buffer.
+ */
+#define configRCLUC_RELIABLE_STREAM_BUFFER_SIZE \
+    ((configRCLUC_MAX_MESSAGE_SIZE_BYTES + 32) * configRCLUC_RELIABLE_STREAM_HISTORY)
+#endif
+
+#ifndef configRCLUC_FRAGMENT_TIMEOUT_MS
+/**
+ *  @brief The maximum time (in milliseconds) a publish of a message that is larger than
+ *  configRCLUC_MAX_MESSAGE_SIZE_BYTES waits, over all of its fragments, for the reliable stream to free up space.
+ */
+#define configRCLUC_FRAGMENT_TIMEOUT_MS 1000
+#endif
+
 #endif
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Declares the nodes, publishers and subscriptions of an application at compile time
+ *
+ *  The graph is listed once as an X-macro taking one macro per kind of entity:
+ *
+ *      #define RCLUC_GRAPH(NODE, PUBLISHER, SUBSCRIPTION) \
+ *          NODE(hello_node, "HelloWorld", "") \
+ *          PUBLISHER(hello_node, hello_publisher, "HelloWorldTopic", rcluc_HelloWorld_t, \
+ *              &rcluc_HelloWorld_type_support, 2, RCLUC_TOPIC_RELIABILITY_BEST_EFFORT) \
+ *          SUBSCRIPTION(hello_node, hello_subscription, "HelloWorldTopic", &rcluc_HelloWorld_type_support, \
+ *              RCLUC_HELLOWORLD_MAX_SERIALIZED_SIZE, 4, on_hello, RCLUC_TOPIC_RELIABILITY_RELIABLE)
+ *
+ *  with the entries:
+ *  - NODE(node, name, namespace_)
+ *  - PUBLISHER(node, publisher, topic_name, message_t, type_support, queue_length, reliability)
+ *  - SUBSCRIPTION(node, subscription, topic_name, type_support, max_serialized_size, queue_length, callback,
+ *      reliability)
+ *
+ *  node, publisher and subscription name the handle variables of the entities. RCLUC_GRAPH_DEFINE(RCLUC_GRAPH) in one
+ *  source file defines these handles, a message_buffer of the exact size for every publisher and subscription, and the
+ *  constant table rcluc_graph_entities that rcluc_graph_create walks to create the whole graph in one batch.
+ *  RCLUC_GRAPH_DECLARE(RCLUC_GRAPH) declares the handles for the other source files. Including rcluc_graph_config.h
+ *  from the configuration header also sizes the library's tables for the graph.
+ */
+
+#ifndef RCLUC__RCLUC_GRAPH_H_
+#define RCLUC__RCLUC_GRAPH_H_
+
+#include "rcluc/rcluc.h"
+#include "rcluc/rcluc_graph_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  @struct rcluc_graph_entity_t
+ *  @brief An entry of the constant table of a graph, generated by RCLUC_GRAPH_DEFINE
+ *
+ *  @var rcluc_graph_entity_t::kind
+ *      The kind of the entity
+ *  @var rcluc_graph_entity_t::handle
+ *      The handle variable of the entity, which is set when the entity is created
+ *  @var rcluc_graph_entity_t::node
+ *      The handle variable of the node of a publisher or subscription
+ *  @var rcluc_graph_entity_t::name
+ *      The name of a node, or the topic name of a publisher or subscription
+ *  @var rcluc_graph_entity_t::namespace_
+ *      The namespace of a node
+ *  @var rcluc_graph_entity_t::message_type
+ *      The message type of a publisher or subscription
+ *  @var rcluc_graph_entity_t::queue_length
+ *      The queue length of a publisher or subscription
+ *  @var rcluc_graph_entity_t::message_buffer
+ *      The message_buffer of a publisher or subscription
+ *  @var rcluc_graph_entity_t::callback
+ *      The callback of a subscription
+ *  @var rcluc_graph_entity_t::max_serialized_size
+ *      The max_serialized_size of a subscription
+ *  @var rcluc_graph_entity_t::reliability
+ *      The reliability of a publisher or subscription
+ */
+typedef struct {
+    rcluc_entity_kind_t kind;
+    void * handle;
+    const rcluc_node_handle_t * node;
+    const char * name;
+    const char * namespace_;
+    const rcluc_message_type_support_t * message_type;
+    size_t queue_length;
+    uint8_t * message_buffer;
+    rcluc_subscription_callback_t callback;
+    size_t max_serialized_size;
+    rcluc_topic_reliability_t reliability;
+} rcluc_graph_entity_t;
+
+/**
+ *  @brief Creates every entity of a graph in a single batch, see rcluc_batch_begin
+ *  Entities are created in the order of the table, nodes first. The handle variable of every entity that was created
+ *  is set, and the handle variables of the entities that failed are set to NULL.
+ *
+ *  @param entities The table of the graph, rcluc_graph_entities
+ *  @param count The number of entries of the table, rcluc_graph_entity_count
+ *  @param failures (output) An array filled with the entities that failed, see rcluc_batch_commit. May be NULL if
+ *      failures_length is 0.
+ *  @param failures_length The number of entries in the failures array
+ *  @param failure_count (output) The number of entities that failed. May be NULL.
+ *  @return Returns an error code that will be RCLUC_RET_OK if every entity of the graph was created
+ */
+rcluc_ret_t rcluc_graph_create(const rcluc_graph_entity_t * entities, size_t count, rcluc_entity_status_t * failures,
+    size_t failures_length, size_t * failure_count);
+
+#define RCLUC_GRAPH_DECLARE_NODE(node, name, namespace_) \
+    extern rcluc_node_handle_t node;
+#define RCLUC_GRAPH_DECLARE_PUBLISHER(node, publisher, topic_name, message_t, type_support, queue_length, reliability) \
+    extern rcluc_publisher_handle_t publisher;
+#define RCLUC_GRAPH_DECLARE_SUBSCRIPTION(node, subscription, topic_name, type_support, max_serialized_size, \
+        queue_length, callback, reliability) \
+    extern rcluc_subscription_handle_t subscription;
+
+#define RCLUC_GRAPH_STORAGE_NODE(node, name, namespace_) \
+    rcluc_node_handle_t node = NULL;
+#define RCLUC_GRAPH_STORAGE_PUBLISHER(node, publisher, topic_name, message_t, type_support, queue_length, reliability) \
+    rcluc_publisher_handle_t publisher = NULL; \
+    static uint8_t rcluc_graph_buffer_##publisher[sizeof(message_t) * (queue_length)];
+#define RCLUC_GRAPH_STORAGE_SUBSCRIPTION(node, subscription, topic_name, type_support, max_serialized_size, \
+        queue_length, callback, reliability) \
+    rcluc_subscription_handle_t subscription = NULL; \
+    static uint8_t rcluc_graph_buffer_##subscription[RCLUC_SUBSCRIPTION_BUFFER_SIZE(max_serialized_size, queue_length)];
+
+#define RCLUC_GRAPH_ENTRY_NODE(node, name, namespace_) \
+    {RCLUC_ENTITY_NODE, &node, NULL, name, namespace_, NULL, 0, NULL, NULL, 0, RCLUC_TOPIC_RELIABILITY_RELIABLE},
+#define RCLUC_GRAPH_ENTRY_PUBLISHER(node, publisher, topic_name, message_t, type_support, queue_length, reliability) \
+    {RCLUC_ENTITY_PUBLISHER, &publisher, &node, topic_name, NULL, type_support, queue_length, \
+        rcluc_graph_buffer_##publisher, NULL, 0, reliability},
+#define RCLUC_GRAPH_ENTRY_SUBSCRIPTION(node, subscription, topic_name, type_support, max_serialized_size, \
+        queue_length, callback, reliability) \
+    {RCLUC_ENTITY_SUBSCRIPTION, &subscription, &node, topic_name, NULL, type_support, queue_length, \
+        rcluc_graph_buffer_##subscription, callback, max_serialized_size, reliability},
+
+/**
+ *  @brief Declares the handle variables and the table of a graph
+ */
+#define RCLUC_GRAPH_DECLARE(GRAPH) \
+    GRAPH(RCLUC_GRAPH_DECLARE_NODE, RCLUC_GRAPH_DECLARE_PUBLISHER, RCLUC_GRAPH_DECLARE_SUBSCRIPTION) \
+    extern const rcluc_graph_entity_t rcluc_graph_entities[]; \
+    extern const size_t rcluc_graph_entity_count;
+
+/**
+ *  @brief Defines the handle variables, the message buffers and the table of a graph. Must be used in a single source
+ *  file, where the type supports and callbacks named by the graph are declared.
+ */
+#define RCLUC_GRAPH_DEFINE(GRAPH) \
+    GRAPH(RCLUC_GRAPH_STORAGE_NODE, RCLUC_GRAPH_STORAGE_PUBLISHER, RCLUC_GRAPH_STORAGE_SUBSCRIPTION) \
+    const rcluc_graph_entity_t rcluc_graph_entities[] = { \
+        GRAPH(RCLUC_GRAPH_ENTRY_NODE, RCLUC_GRAPH_SKIP_ENTRY, RCLUC_GRAPH_SKIP_ENTRY) \
+        GRAPH(RCLUC_GRAPH_SKIP_ENTRY, RCLUC_GRAPH_ENTRY_PUBLISHER, RCLUC_GRAPH_ENTRY_SUBSCRIPTION) \
+    }; \
+    const size_t rcluc_graph_entity_count = sizeof(rcluc_graph_entities) / sizeof(rcluc_graph_entities[0]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ifndef RCLUC__RCLUC_GRAPH_H_ */
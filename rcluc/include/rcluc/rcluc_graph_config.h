@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Sizes the library for the graph declared by the application, see rcluc_graph.h
+ *
+ *  Include this file from the configuration header given with RCLUC_CONFIG_HEADER, after the header that defines
+ *  RCLUC_GRAPH. The number of nodes, publishers and subscriptions is then taken from the graph, and publishers or
+ *  subscriptions are compiled out if the graph has none. Every node gets room for all the publishers and subscriptions
+ *  of the graph, which is exact for the usual single node application. Values defined before this file is included
+ *  are kept.
+ *
+ *  This file only defines macros so that it can be included before the rest of the library.
+ */
+
+#ifndef RCLUC__RCLUC_GRAPH_CONFIG_H_
+#define RCLUC__RCLUC_GRAPH_CONFIG_H_
+
+/**
+ *  @brief Graph entry macros that count an entry, or ignore it
+ */
+#define RCLUC_GRAPH_COUNT_ENTRY(...) + 1
+#define RCLUC_GRAPH_SKIP_ENTRY(...)
+
+/**
+ *  @brief The number of entities of each kind in a graph. These expand to integer constants that can be used in #if.
+ */
+#define RCLUC_GRAPH_NODE_COUNT(GRAPH) (0 GRAPH(RCLUC_GRAPH_COUNT_ENTRY, RCLUC_GRAPH_SKIP_ENTRY, RCLUC_GRAPH_SKIP_ENTRY))
+#define RCLUC_GRAPH_PUBLISHER_COUNT(GRAPH) \
+    (0 GRAPH(RCLUC_GRAPH_SKIP_ENTRY, RCLUC_GRAPH_COUNT_ENTRY, RCLUC_GRAPH_SKIP_ENTRY))
+#define RCLUC_GRAPH_SUBSCRIPTION_COUNT(GRAPH) \
+    (0 GRAPH(RCLUC_GRAPH_SKIP_ENTRY, RCLUC_GRAPH_SKIP_ENTRY, RCLUC_GRAPH_COUNT_ENTRY))
+
+#ifdef RCLUC_GRAPH
+
+#ifndef configRCLUC_MAX_NUM_NODES
+#define configRCLUC_MAX_NUM_NODES RCLUC_GRAPH_NODE_COUNT(RCLUC_GRAPH)
+#endif
+
+#ifndef configRCLUC_ENABLE_PUBLISHERS
+#define configRCLUC_ENABLE_PUBLISHERS (RCLUC_GRAPH_PUBLISHER_COUNT(RCLUC_GRAPH) > 0)
+#endif
+
+#ifndef configRCLUC_MAX_PUBLISHERS_PER_NODE
+#define configRCLUC_MAX_PUBLISHERS_PER_NODE \
+    ((RCLUC_GRAPH_PUBLISHER_COUNT(RCLUC_GRAPH) > 0) ? RCLUC_GRAPH_PUBLISHER_COUNT(RCLUC_GRAPH) : 1)
+#endif
+
+#ifndef configRCLUC_ENABLE_SUBSCRIPTIONS
+#define configRCLUC_ENABLE_SUBSCRIPTIONS (RCLUC_GRAPH_SUBSCRIPTION_COUNT(RCLUC_GRAPH) > 0)
+#endif
+
+#ifndef configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE
+#define configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE \
+    ((RCLUC_GRAPH_SUBSCRIPTION_COUNT(RCLUC_GRAPH) > 0) ? RCLUC_GRAPH_SUBSCRIPTION_COUNT(RCLUC_GRAPH) : 1)
+#endif
+
+#endif /* ifdef RCLUC_GRAPH */
+
+#endif /* ifndef RCLUC__RCLUC_GRAPH_CONFIG_H_ */
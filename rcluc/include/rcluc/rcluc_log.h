@@ -0,0 +1,179 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Deferred logging, which leaves the formatting of the messages to the host
+ *
+ *  RCLUC_LOG_INFO("Sent %u messages in %f s", count, seconds) does not format anything on the microcontroller. It
+ *  appends a binary record to a ring buffer: the level, the synchronized time (see rcluc_time_now), the address of the
+ *  format string and every argument as a raw 64 bit word. The format string itself stays in flash. The spin of the node
+ *  given to rcluc_log_start publishes the records in batches on configRCLUC_LOG_TOPIC_NAME, and
+ *  rcluc/tools/rcluc_log_bridge.py formats them with the format strings read from the firmware's ELF file and
+ *  republishes them on /rosout.
+ *
+ *  Up to RCLUC_LOG_MAX_ARGS arguments of integer, floating point or pointer types are supported. A %s argument is
+ *  recorded as its address, so it must be a string that is in the ELF file, like a string literal.
+ *
+ *  The records are written by one context at a time, for example the application task, while the spin may run in
+ *  another one. The arguments are not evaluated if the level is below configRCLUC_LOG_LEVEL or if
+ *  configRCLUC_ENABLE_LOGGING is 0.
+ */
+
+#ifndef RCLUC__RCLUC_LOG_H_
+#define RCLUC__RCLUC_LOG_H_
+
+#include "rcluc/rcluc.h"
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  @brief The largest number of arguments of a log record, not counting the format string
+ */
+#define RCLUC_LOG_MAX_ARGS 8
+
+/**
+ *  @brief Publishes the log records on configRCLUC_LOG_TOPIC_NAME from the spin of a node. The records written before
+ *  are kept in the buffer and published by the first spin.
+ *
+ *  @param node_handle The node whose spin publishes the records
+ *  @return Returns RCLUC_RET_ERR_ALREADY if the records are already published by a node
+ */
+rcluc_ret_t rcluc_log_start(rcluc_node_handle_t node_handle);
+
+/**
+ *  @brief Stops publishing the log records. Records written afterwards are buffered until the next rcluc_log_start.
+ *
+ *  @return Returns RCLUC_RET_ERR_ALREADY if the records are not published
+ */
+rcluc_ret_t rcluc_log_stop(void);
+
+/**
+ *  @brief Appends a record to the log buffer, through the RCLUC_LOG_* macros
+ *
+ *  @param level The severity of the record, one of RCLUC_LOG_LEVEL_*
+ *  @param words The address of the format string followed by the arguments, see RCLUC_LOG_ARG
+ *  @param count The number of words, between 1 and RCLUC_LOG_MAX_ARGS + 1
+ */
+void rcluc_log_write(uint8_t level, const uint64_t * words, size_t count);
+
+/**
+ *  @brief The number of records dropped because the buffer was full, since rcluc_log_start. The count is also sent
+ *  with every batch.
+ */
+uint32_t rcluc_log_get_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+inline uint64_t rcluc_log_arg(bool value) { return (uint64_t)value; }
+inline uint64_t rcluc_log_arg(char value) { return (uint64_t)(int64_t)value; }
+inline uint64_t rcluc_log_arg(signed char value) { return (uint64_t)(int64_t)value; }
+inline uint64_t rcluc_log_arg(unsigned char value) { return (uint64_t)value; }
+inline uint64_t rcluc_log_arg(short value) { return (uint64_t)(int64_t)value; }
+inline uint64_t rcluc_log_arg(unsigned short value) { return (uint64_t)value; }
+inline uint64_t rcluc_log_arg(int value) { return (uint64_t)(int64_t)value; }
+inline uint64_t rcluc_log_arg(unsigned int value) { return (uint64_t)value; }
+inline uint64_t rcluc_log_arg(long value) { return (uint64_t)(int64_t)value; }
+inline uint64_t rcluc_log_arg(unsigned long value) { return (uint64_t)value; }
+inline uint64_t rcluc_log_arg(long long value) { return (uint64_t)value; }
+inline uint64_t rcluc_log_arg(unsigned long long value) { return (uint64_t)value; }
+inline uint64_t rcluc_log_arg(const void * value) { return (uint64_t)(uintptr_t)value; }
+inline uint64_t rcluc_log_arg(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+inline uint64_t rcluc_log_arg(float value) { return rcluc_log_arg((double)value); }
+
+/**
+ *  @brief Converts an argument of a log record to its 64 bit word, as printf would see it after the default argument
+ *  promotions: signed integers are sign extended, floating point values are stored as the bits of a double.
+ */
+#define RCLUC_LOG_ARG(x) rcluc_log_arg(x)
+#else
+static inline uint64_t rcluc_log_arg_integer(int64_t value) {
+    return (uint64_t)value;
+}
+
+static inline uint64_t rcluc_log_arg_unsigned(uint64_t value) {
+    return value;
+}
+
+static inline uint64_t rcluc_log_arg_pointer(const void * value) {
+    return (uint64_t)(uintptr_t)value;
+}
+
+static inline uint64_t rcluc_log_arg_double(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+#define RCLUC_LOG_ARG(x) _Generic((x), \
+    float: rcluc_log_arg_double, \
+    double: rcluc_log_arg_double, \
+    unsigned long: rcluc_log_arg_unsigned, \
+    unsigned long long: rcluc_log_arg_unsigned, \
+    char *: rcluc_log_arg_pointer, \
+    const char *: rcluc_log_arg_pointer, \
+    void *: rcluc_log_arg_pointer, \
+    const void *: rcluc_log_arg_pointer, \
+    default: rcluc_log_arg_integer)(x)
+#endif /* __cplusplus */
+
+/* Applies RCLUC_LOG_ARG to the format string and each of up to RCLUC_LOG_MAX_ARGS arguments */
+#define RCLUC_LOG_COUNT_(...) RCLUC_LOG_COUNT_N_(__VA_ARGS__, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define RCLUC_LOG_COUNT_N_(_1, _2, _3, _4, _5, _6, _7, _8, _9, N, ...) N
+#define RCLUC_LOG_CONCAT_(a, b) RCLUC_LOG_CONCAT2_(a, b)
+#define RCLUC_LOG_CONCAT2_(a, b) a##b
+#define RCLUC_LOG_MAP_(...) RCLUC_LOG_CONCAT_(RCLUC_LOG_MAP_, RCLUC_LOG_COUNT_(__VA_ARGS__))(__VA_ARGS__)
+#define RCLUC_LOG_MAP_1(x) RCLUC_LOG_ARG(x)
+#define RCLUC_LOG_MAP_2(x, ...) RCLUC_LOG_ARG(x), RCLUC_LOG_MAP_1(__VA_ARGS__)
+#define RCLUC_LOG_MAP_3(x, ...) RCLUC_LOG_ARG(x), RCLUC_LOG_MAP_2(__VA_ARGS__)
+#define RCLUC_LOG_MAP_4(x, ...) RCLUC_LOG_ARG(x), RCLUC_LOG_MAP_3(__VA_ARGS__)
+#define RCLUC_LOG_MAP_5(x, ...) RCLUC_LOG_ARG(x), RCLUC_LOG_MAP_4(__VA_ARGS__)
+#define RCLUC_LOG_MAP_6(x, ...) RCLUC_LOG_ARG(x), RCLUC_LOG_MAP_5(__VA_ARGS__)
+#define RCLUC_LOG_MAP_7(x, ...) RCLUC_LOG_ARG(x), RCLUC_LOG_MAP_6(__VA_ARGS__)
+#define RCLUC_LOG_MAP_8(x, ...) RCLUC_LOG_ARG(x), RCLUC_LOG_MAP_7(__VA_ARGS__)
+#define RCLUC_LOG_MAP_9(x, ...) RCLUC_LOG_ARG(x), RCLUC_LOG_MAP_8(__VA_ARGS__)
+
+#if configRCLUC_ENABLE_LOGGING
+/**
+ *  @brief Appends a log record of the given level, the first argument after the level being the format string
+ */
+#define RCLUC_LOG(level, ...) \
+    do { \
+        if ((level) >= configRCLUC_LOG_LEVEL) { \
+            const uint64_t rcluc_log_words_[] = { RCLUC_LOG_MAP_(__VA_ARGS__) }; \
+            rcluc_log_write((level), rcluc_log_words_, sizeof(rcluc_log_words_) / sizeof(rcluc_log_words_[0])); \
+        } \
+    } while (0)
+#else
+#define RCLUC_LOG(level, ...) do { } while (0)
+#endif /* configRCLUC_ENABLE_LOGGING */
+
+#define RCLUC_LOG_DEBUG(...) RCLUC_LOG(RCLUC_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define RCLUC_LOG_INFO(...) RCLUC_LOG(RCLUC_LOG_LEVEL_INFO, __VA_ARGS__)
+#define RCLUC_LOG_WARN(...) RCLUC_LOG(RCLUC_LOG_LEVEL_WARN, __VA_ARGS__)
+#define RCLUC_LOG_ERROR(...) RCLUC_LOG(RCLUC_LOG_LEVEL_ERROR, __VA_ARGS__)
+#define RCLUC_LOG_FATAL(...) RCLUC_LOG(RCLUC_LOG_LEVEL_FATAL, __VA_ARGS__)
+
+#endif /* ifndef RCLUC__RCLUC_LOG_H_ */
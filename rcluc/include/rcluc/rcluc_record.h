@@ -0,0 +1,233 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Records the serialized samples published and received by the application, and replays them
+ *
+ *  The recording is an append-only log in a buffer given by the application, or in a memory mapped file on Linux. It
+ *  starts with an rcluc_record_log_header_t and holds one record per sample, an rcluc_record_header_t followed by the
+ *  serialized bytes as they went over the wire, including the source timestamp if the topic carries one, padded to 4
+ *  bytes. The first record of each topic is an RCLUC_RECORD_KIND_TOPIC record: a flags byte, the topic name and the
+ *  type name, each terminated by a NUL. Every value is in the byte order of the device. The length in the log header is
+ *  only updated once a record is complete, so a log cut short by a reset is still valid up to its last record.
+ *
+ *  Samples are recorded when the publisher hands them to the transport, and when a subscription delivers them to the
+ *  application through its callback or rcluc_subscription_take. Samples read through a mailbox are not recorded.
+ *  Recording and publishing happen in one context at a time, like the spin.
+ *
+ *  rcluc_replay_step feeds the received samples of a log back into the subscriptions of the application, at the
+ *  original speed or as fast as they are consumed, to rerun the application on a captured stream of inputs.
+ *  rcluc_replay_next walks the samples of a log for tools that publish them instead, like the TrafficReplay example.
+ */
+
+#ifndef RCLUC__RCLUC_RECORD_H_
+#define RCLUC__RCLUC_RECORD_H_
+
+#include "rcluc/rcluc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  @brief The magic number at the start of a log, "RCLR" in a little endian log
+ */
+#define RCLUC_RECORD_LOG_MAGIC 0x524C4352u
+#define RCLUC_RECORD_LOG_VERSION 1
+
+#define RCLUC_RECORD_KIND_TOPIC 0
+#define RCLUC_RECORD_KIND_PUBLISHED 1
+#define RCLUC_RECORD_KIND_RECEIVED 2
+
+/**
+ *  @brief Flag of a topic record whose samples start with a source timestamp
+ */
+#define RCLUC_RECORD_FLAG_SOURCE_TIMESTAMP 0x1u
+
+/**
+ *  @struct rcluc_record_log_header_t
+ *  @brief The header at the start of a log
+ *
+ *  @var rcluc_record_log_header_t::magic
+ *      RCLUC_RECORD_LOG_MAGIC
+ *  @var rcluc_record_log_header_t::version
+ *      RCLUC_RECORD_LOG_VERSION
+ *  @var rcluc_record_log_header_t::length
+ *      The number of bytes of complete records after the header
+ *  @var rcluc_record_log_header_t::dropped
+ *      The number of samples that were not recorded because the log was full
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t length;
+    uint32_t dropped;
+} rcluc_record_log_header_t;
+
+/**
+ *  @struct rcluc_record_header_t
+ *  @brief The header of a record of a log
+ *
+ *  @var rcluc_record_header_t::topic_id
+ *      The topic of the sample, numbered from 1 in the order in which the publishers and subscriptions first appear in
+ *      the log
+ *  @var rcluc_record_header_t::kind
+ *      One of RCLUC_RECORD_KIND_*
+ *  @var rcluc_record_header_t::length
+ *      The number of bytes following the header, without the padding
+ *  @var rcluc_record_header_t::timestamp
+ *      The time (see rcluc_time_now) at which the sample was published or received
+ */
+typedef struct {
+    uint16_t topic_id;
+    uint8_t kind;
+    uint8_t reserved;
+    uint32_t length;
+    int64_t timestamp;
+} rcluc_record_header_t;
+
+/**
+ *  @struct rcluc_record_t
+ *  @brief A sample read from a log by rcluc_replay_next
+ *
+ *  @var rcluc_record_t::topic_id
+ *      The topic of the sample in the log
+ *  @var rcluc_record_t::kind
+ *      RCLUC_RECORD_KIND_PUBLISHED or RCLUC_RECORD_KIND_RECEIVED
+ *  @var rcluc_record_t::flags
+ *      The RCLUC_RECORD_FLAG_* flags of the topic
+ *  @var rcluc_record_t::timestamp
+ *      The time at which the sample was published or received
+ *  @var rcluc_record_t::topic_name
+ *      The ROS name of the topic
+ *  @var rcluc_record_t::type_name
+ *      The DDS type name of the topic
+ *  @var rcluc_record_t::data
+ *      The serialized sample, in the log
+ *  @var rcluc_record_t::length
+ *      The size (in bytes) of the serialized sample
+ */
+typedef struct {
+    uint16_t topic_id;
+    uint8_t kind;
+    uint8_t flags;
+    int64_t timestamp;
+    const char * topic_name;
+    const char * type_name;
+    const uint8_t * data;
+    size_t length;
+} rcluc_record_t;
+
+/**
+ *  @struct rcluc_replay_t
+ *  @brief The position of a replay in a log, see rcluc_replay_init
+ */
+typedef struct {
+    const uint8_t * log;
+    size_t end;
+    size_t position;
+    uint32_t speed_percent;
+    int64_t start_time;
+    int64_t first_timestamp;
+    const char * topic_names[configRCLUC_RECORD_MAX_TOPICS];
+    const char * type_names[configRCLUC_RECORD_MAX_TOPICS];
+    uint8_t topic_flags[configRCLUC_RECORD_MAX_TOPICS];
+    void * mapping;
+    size_t mapping_size;
+} rcluc_replay_t;
+
+/**
+ *  @brief Starts recording into a buffer. A recording already running is stopped first.
+ *
+ *  @param buffer The buffer of the log, which must remain valid and 4 byte aligned until rcluc_record_stop
+ *  @param size The size (in bytes) of the buffer
+ *  @return Returns RCLUC_RET_ERR_PARAM if the buffer cannot hold the log header
+ */
+rcluc_ret_t rcluc_record_start(uint8_t * buffer, size_t size);
+
+#ifdef __linux__
+/**
+ *  @brief Starts recording into a memory mapped file, which is cut to the length of the log by rcluc_record_stop
+ *
+ *  @param path The path of the file, which is created or overwritten
+ *  @param size The largest size (in bytes) of the log
+ *  @return Returns RCLUC_RET_ERROR if the file cannot be created or mapped
+ */
+rcluc_ret_t rcluc_record_start_file(const char * path, size_t size);
+#endif
+
+/**
+ *  @brief Stops recording
+ *
+ *  @param length (output, optional) The size (in bytes) of the log, header included
+ *  @return Returns RCLUC_RET_ERR_ALREADY if nothing is being recorded
+ */
+rcluc_ret_t rcluc_record_stop(size_t * length);
+
+/**
+ *  @brief Prepares the replay of a log
+ *
+ *  @param replay The replay to initialize
+ *  @param log The log, which must remain valid during the replay
+ *  @param size The size (in bytes) of the log
+ *  @param speed_percent The replay speed relative to the original timing, for example 100 for the original speed and
+ *      200 for twice as fast. 0 replays the samples as fast as possible.
+ *  @return Returns RCLUC_RET_ERR_PARAM if the log does not start with a valid header
+ */
+rcluc_ret_t rcluc_replay_init(rcluc_replay_t * replay, const uint8_t * log, size_t size, uint32_t speed_percent);
+
+#ifdef __linux__
+/**
+ *  @brief Prepares the replay of a log in a file, which is memory mapped until rcluc_replay_close
+ *
+ *  @return Returns RCLUC_RET_ERROR if the file cannot be mapped, see also rcluc_replay_init
+ */
+rcluc_ret_t rcluc_replay_open_file(rcluc_replay_t * replay, const char * path, uint32_t speed_percent);
+
+/**
+ *  @brief Unmaps the file of a replay opened with rcluc_replay_open_file
+ */
+void rcluc_replay_close(rcluc_replay_t * replay);
+#endif
+
+/**
+ *  @brief Reads the next sample of a log once it is due
+ *
+ *  @param replay The replay
+ *  @param record (output) The sample
+ *  @return Returns RCLUC_RET_TIMEOUT if the next sample is not due yet, and RCLUC_RET_NO_DATA at the end of the log
+ */
+rcluc_ret_t rcluc_replay_next(rcluc_replay_t * replay, rcluc_record_t * record);
+
+/**
+ *  @brief Writes the received samples of a log that are due into the queues of the subscriptions of the application
+ *  on the same topic, which dispatch them on their next spin or rcluc_subscription_take. When replaying as fast as
+ *  possible, a step writes the next received sample only.
+ *
+ *  A subscription only gets the samples of a topic with the same source timestamp setting. Published samples are
+ *  skipped, they are the outputs the replay should reproduce.
+ *
+ *  @param replay The replay
+ *  @return Returns RCLUC_RET_NO_DATA at the end of the log, once the step before wrote the last samples
+ */
+rcluc_ret_t rcluc_replay_step(rcluc_replay_t * replay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ifndef RCLUC__RCLUC_RECORD_H_ */
@@ -61,9 +61,23 @@ typedef uint16_t rcluc_ret_t;
  *  This could be memory or free elements in a buffer.
  */
 #define RCLUC_RET_ERR_SPACE     7
+/**
+ * @brief Indicates that no data has been received yet
+ */
+#define RCLUC_RET_NO_DATA       8
+/**
+ * @brief Indicates that a message was dropped because the link under the publisher is congested, see
+ *  configRCLUC_ENABLE_CONGESTION_CONTROL
+ */
+#define RCLUC_RET_ERR_CONGESTION 9
 
 
 
+/**
+ *  @brief An handle to a session with the agent being managed by the rcluc library
+ */
+typedef struct rcluc_session_s* rcluc_session_handle_t;
+
 /**
  *  @brief An handle to a ROS Node instance being managed by the rcluc library
  */
@@ -79,6 +93,11 @@ typedef struct rcluc_subscription_s* rcluc_subscription_handle_t;
  */
 typedef struct rcluc_publisher_s* rcluc_publisher_handle_t;
 
+/**
+ *  @brief An handle to a ROS Service Client instance being managed by the rcluc library
+ */
+typedef struct rcluc_client_s* rcluc_client_handle_t;
+
 /**
  *  @struct rcluc_client_config_t
  *  @brief The configuration information for a rcluc client
@@ -116,36 +135,59 @@ typedef enum {
 typedef rcluc_ret_t (*rcluc_message_deserialization_func_t)(void * message_buffer, size_t message_buffer_size,
     void * deserialized_buffer, size_t deserialized_buffer_size);
 
+/**
+ *  @brief A buffer used by the CDR serialization layer. See rcluc_cdr.h
+ */
+typedef struct rcluc_cdr_buffer_s rcluc_cdr_buffer_t;
+
 /**
  *  @brief The construct for a message serialization function.
  *  This is the function type for a serialization function that can be used to serialize messages before they are sent
  *  out on a topic.
  *
- *  This function is responsible for ensuring that the serialized data is not more than configRCLUC_MAX_MESSAGE_SIZE_BYTES
- *  in length.
+ *  The serialized data must be written through the rcluc_cdr_serialize_* functions. The buffer may be a window onto a
+ *  larger stream (for example when a message is sent as fragments), so the function must not assume that the whole
+ *  serialized message is held in contiguous memory.
  *
  *  @param message The message that needs to be serialized into a buffer
- *  @param serializedBuffer (output) The serialized message data will be set here
+ *  @param buffer (output) The CDR buffer the serialized message data will be written to
  *  @return Returns an error code that will be RCLUC_RET_OK if the message is serialized successfully
  */
-typedef rcluc_ret_t (*rcluc_message_serialization_func_t)(void * message, void * serializedBuffer);
+typedef rcluc_ret_t (*rcluc_message_serialization_func_t)(const void * message, rcluc_cdr_buffer_t * buffer);
+
+/**
+ *  @brief The construct for a function returning the serialized size of a message.
+ *
+ *  @param message The message to get the serialized size of
+ *  @return The size (in bytes) that the message will have once serialized
+ */
+typedef size_t (*rcluc_message_serialized_size_func_t)(const void * message);
 
 /**
  *  @brief Contains the metadata about a ROS Message required for the rcluc library to operate on it
  *  Contains metadata and functions required by the rcluc library to work with ROS Messages from the generator.
  *  The rmwu generator should provide a getter function to retrieve this information for every compiled message type.
  *
+ *  @var rcluc_message_type_support_t::type_name
+ *      The name of the type as it is known to the ROS graph
  *  @var rcluc_message_type_support_t::message_size
  *      The size of the ROS Messae in bytes.
+ *  @var rcluc_message_type_support_t::max_serialized_size
+ *      The largest size (in bytes) a message of this type can have once serialized.
  *  @var rcluc_message_type_support_t::serialize
  *      A function used to serialize the ROS message into the format required by the RMWU layer
  *  @var rcluc_message_type_support_t::deserialize
  *      A function used to deserialize the ROS message into the format required by the RMWU layer
+ *  @var rcluc_message_type_support_t::get_serialized_size
+ *      A function returning the size a given message will have once serialized
  */
 typedef struct {
+    const char * type_name;
     size_t message_size;
+    size_t max_serialized_size;
     rcluc_message_serialization_func_t serialize;
     rcluc_message_deserialization_func_t deserialize;
+    rcluc_message_serialized_size_func_t get_serialized_size;
 } rcluc_message_type_support_t;
 
 /**
@@ -167,6 +209,90 @@ typedef struct {
     rcluc_topic_reliability_t reliability;
 } rcluc_subscription_qos_policy_t;
 
+/**
+ *  @brief The type of a message field checked by a content filter
+ */
+typedef enum {
+    RCLUC_FILTER_FIELD_UINT8,
+    RCLUC_FILTER_FIELD_INT8,
+    RCLUC_FILTER_FIELD_UINT16,
+    RCLUC_FILTER_FIELD_INT16,
+    RCLUC_FILTER_FIELD_UINT32,
+    RCLUC_FILTER_FIELD_INT32,
+    RCLUC_FILTER_FIELD_UINT64,
+    RCLUC_FILTER_FIELD_INT64,
+    RCLUC_FILTER_FIELD_FLOAT,
+    RCLUC_FILTER_FIELD_DOUBLE
+} rcluc_filter_field_type_t;
+
+/**
+ *  @brief The comparison a content filter check makes between a message field and its constant
+ */
+typedef enum {
+    RCLUC_FILTER_OP_EQ,
+    RCLUC_FILTER_OP_NE,
+    RCLUC_FILTER_OP_LT,
+    RCLUC_FILTER_OP_LE,
+    RCLUC_FILTER_OP_GT,
+    RCLUC_FILTER_OP_GE
+} rcluc_filter_op_t;
+
+/**
+ *  @brief The constant a content filter check compares a field against. The member matching the signedness of the
+ *  field type is used: signed_value for signed integers, unsigned_value for unsigned integers and float_value for
+ *  floating point numbers.
+ */
+typedef union {
+    int64_t signed_value;
+    uint64_t unsigned_value;
+    double float_value;
+} rcluc_filter_value_t;
+
+/**
+ *  @struct rcluc_filter_check_t
+ *  @brief A single comparison of a content filter, evaluated as (field op constant)
+ *
+ *  @var rcluc_filter_check_t::offset
+ *      The offset (in bytes) of the field within the serialized message, after any source timestamp. Only fields in
+ *      front of the first variable length member of a message have a fixed offset.
+ *  @var rcluc_filter_check_t::type
+ *      The type of the field. The offset must be aligned to the size of the type as required by CDR.
+ *  @var rcluc_filter_check_t::op
+ *      The comparison to make. A NaN, in a floating point field or as the constant, compares as IEEE 754 says: only
+ *      RCLUC_FILTER_OP_NE holds.
+ *  @var rcluc_filter_check_t::constant
+ *      The constant the field is compared against
+ */
+typedef struct {
+    uint16_t offset;
+    rcluc_filter_field_type_t type;
+    rcluc_filter_op_t op;
+    rcluc_filter_value_t constant;
+} rcluc_filter_check_t;
+
+/**
+ *  @struct rcluc_content_filter_t
+ *  @brief A content filter for a subscription
+ *  A sample is accepted only if all of the checks hold. The checks are evaluated on the serialized sample as soon as it
+ *  is received, so samples that do not match never take a queue entry, are never deserialized and never reach the
+ *  callback.
+ *
+ *  @var rcluc_content_filter_t::checks
+ *      The checks of the filter. It is up to the user to ensure that they remain valid for the lifetime of the
+ *      subscription.
+ *  @var rcluc_content_filter_t::check_count
+ *      The number of checks
+ */
+typedef struct {
+    const rcluc_filter_check_t * checks;
+    size_t check_count;
+} rcluc_content_filter_t;
+
+/**
+ *  @brief The priority of a publisher or subscription that does not set one
+ */
+#define RCLUC_PRIORITY_DEFAULT 128
+
 /**
  *  @struct rcluc_subscription_config_t
  *  @brief The configuration information for a ROS subscription
@@ -181,11 +307,39 @@ typedef struct {
  *      A pointer to user supplied metadata that they want associated with the subscription. You can use the subscription
  *      handle to access this data from the callbacks. It is up to the user to ensure that the data at this pointer
  *      remains valid for the lifetime of the subscription.
+ *  @var rcluc_subscription_config_t::max_serialized_size
+ *      The largest serialized message (in bytes) the subscription should be able to receive. This determines the size of
+ *      each queue entry in the message_buffer, see RCLUC_SUBSCRIPTION_BUFFER_SIZE. If 0 then the max_serialized_size of
+ *      the message type is used, or configRCLUC_MAX_MESSAGE_SIZE_BYTES if the message type is unbounded.
+ *  @var rcluc_subscription_config_t::source_timestamp
+ *      Set to 1 to receive the messages of publishers that write a source timestamp in front of every message, see
+ *      rcluc_publisher_config_t::source_timestamp. The timestamp is available through
+ *      rcluc_subscription_get_message_info. Such a subscription does not receive the messages of ROS 2 nodes or of
+ *      publishers without a source timestamp. The default is 0.
+ *  @var rcluc_subscription_config_t::filter
+ *      A content filter samples must match to be delivered to the callback. It is up to the user to ensure that the
+ *      filter remains valid for the lifetime of the subscription. If NULL then every sample is delivered, which is the
+ *      default.
+ *  @var rcluc_subscription_config_t::mailbox
+ *      Set to 1 to keep only the latest sample, which the application reads with rcluc_subscription_read_latest
+ *      instead of receiving it in a callback. The message_buffer must hold
+ *      RCLUC_SUBSCRIPTION_MAILBOX_BUFFER_SIZE(max_serialized_size) bytes, the callback must be NULL and the
+ *      queue_length is not used. The default is 0.
+ *  @var rcluc_subscription_config_t::priority
+ *      How urgent the samples of the subscription are, higher is more urgent. With
+ *      configRCLUC_ENABLE_PRIORITY_DISPATCH, a spin invokes the callbacks of the samples queued on all the
+ *      subscriptions of the node in order of priority, and of reception within a priority. The default is
+ *      RCLUC_PRIORITY_DEFAULT.
  */
 typedef struct {
     rcluc_subscription_qos_policy_t qos;
     rcluc_subscription_exception_callback_t exception_callback;
     void * user_metadata;
+    size_t max_serialized_size;
+    uint8_t source_timestamp;
+    const rcluc_content_filter_t * filter;
+    uint8_t mailbox;
+    uint8_t priority;
 } rcluc_subscription_config_t;
 
 /**
@@ -235,15 +389,326 @@ typedef struct {
  *      A pointer to user supplied metadata that they want associated with the publisher. You can use the publisher
  *      handle to access this data from the callbacks. It is up to the user to ensure that the data at this pointer
  *      remains valid for the lifetime of the publisher.
+ *  @var rcluc_publisher_config_t::source_timestamp
+ *      Set to 1 to write the time returned by rcluc_time_now, as an int64 in nanoseconds, in front of every message
+ *      published. The topic then gets a type name of its own, see RCLUC_SOURCE_TIMESTAMP_TYPE_SUFFIX, and only
+ *      rcluc subscriptions created with rcluc_subscription_config_t::source_timestamp set receive these messages. The
+ *      default is 0.
+ *  @var rcluc_publisher_config_t::packed_queue
+ *      Set to 1 to use the message_buffer as a packed queue of serialized messages. queue_length is then the size (in
+ *      bytes) of the message_buffer, see RCLUC_PUBLISHER_PACKED_BUFFER_SIZE. A message that cannot be handed to the
+ *      transport when it is published, because the output stream is full or a batch is active, is serialized into the
+ *      queue as a length prefixed record right behind the previous one, and the queued messages are sent in order by
+ *      the next spins of the node. The default is 0.
+ *  @var rcluc_publisher_config_t::priority
+ *      How much the messages of the publisher matter when the link under it is congested. With
+ *      configRCLUC_ENABLE_CONGESTION_CONTROL, publishers with a priority below configRCLUC_CONGESTION_PRIORITY are
+ *      throttled and then dropped while their output stream is congested, so that the others keep the link. The default
+ *      is RCLUC_PRIORITY_DEFAULT.
  */
 typedef struct {
     rcluc_publisher_qos_policy_t qos;
     rcluc_publisher_exception_callback_t exception_callback;
     void * user_metadata;
+    uint8_t source_timestamp;
+    uint8_t packed_queue;
+    uint8_t priority;
 } rcluc_publisher_config_t;
 
+/**
+ *  @brief The size (in bytes) of the source timestamp written in front of a message
+ */
+#define RCLUC_SOURCE_TIMESTAMP_SIZE 8
+
+/**
+ *  @brief Appended to the DDS type name of a topic whose messages carry a source timestamp.
+ *  DDS-XRCE 1.0 has no room for the metadata of a sample, so the timestamp travels in front of the serialized message.
+ *  The type name of its own keeps ROS 2 nodes, which would read the timestamp as the start of the message, from
+ *  matching these topics: stamped topics only connect rcluc publishers and subscriptions that both set source_timestamp.
+ */
+#define RCLUC_SOURCE_TIMESTAMP_TYPE_SUFFIX "_SourceTimestamp_"
+
+/**
+ *  @struct rcluc_buffer_fragment_t
+ *  @brief One piece of a message that is sent as a list of pieces, see rcluc_publisher_publish_fragments
+ *
+ *  @var rcluc_buffer_fragment_t::data
+ *      The first byte of the piece
+ *  @var rcluc_buffer_fragment_t::length
+ *      The size (in bytes) of the piece
+ */
+typedef struct {
+    const uint8_t * data;
+    size_t length;
+} rcluc_buffer_fragment_t;
+
+/**
+ *  @struct rcluc_message_info_t
+ *  @brief Information about a received message, see rcluc_subscription_get_message_info
+ *
+ *  @var rcluc_message_info_t::source_timestamp
+ *      The time (in nanoseconds, see rcluc_time_now) at which the publisher published the message, or 0 if the
+ *      subscription does not receive source timestamps
+ *  @var rcluc_message_info_t::reception_timestamp
+ *      The time (in nanoseconds, see rcluc_time_now) at which the transport received the message
+ *  @var rcluc_message_info_t::serialized_length
+ *      The size (in bytes) of the serialized message, without the source timestamp
+ */
+typedef struct {
+    int64_t source_timestamp;
+    int64_t reception_timestamp;
+    size_t serialized_length;
+} rcluc_message_info_t;
+
+/**
+ *  @struct rcluc_time_sync_status_t
+ *  @brief The current estimate of the time synchronization with the agent, see rcluc_time_sync_get_status
+ *
+ *  @var rcluc_time_sync_status_t::is_synchronized
+ *      1 once at least one round trip to the time server completed
+ *  @var rcluc_time_sync_status_t::offset
+ *      The offset (in nanoseconds) to add to the local clock to get the time of the time server
+ *  @var rcluc_time_sync_status_t::round_trip_time
+ *      The round trip time (in nanoseconds) of the exchange the offset was taken from
+ *  @var rcluc_time_sync_status_t::samples
+ *      The number of completed exchanges
+ */
+typedef struct {
+    uint8_t is_synchronized;
+    int64_t offset;
+    int64_t round_trip_time;
+    uint32_t samples;
+} rcluc_time_sync_status_t;
+
+/**
+ *  @struct rcluc_link_status_t
+ *  @brief The feedback of the transport about the output stream of a publisher
+ *
+ *  @var rcluc_link_status_t::occupancy_percent
+ *      How full the output stream of the publisher is, from 0 to 100. A reliable stream fills up with the messages
+ *      written since the agent last acknowledged all of them, and is full once it refuses a message, a best effort
+ *      stream fills up with the messages written since it was last sent.
+ *  @var rcluc_link_status_t::pending_acks
+ *      The number of reliable messages of the session that the agent has not acknowledged yet
+ *  @var rcluc_link_status_t::send_failures
+ *      The number of transport messages of the session that could not be sent
+ */
+typedef struct {
+    uint8_t occupancy_percent;
+    uint16_t pending_acks;
+    uint32_t send_failures;
+} rcluc_link_status_t;
+
+/**
+ *  @struct rcluc_congestion_status_t
+ *  @brief The congestion of a publisher, see rcluc_publisher_get_congestion_status
+ *
+ *  @var rcluc_congestion_status_t::link
+ *      The feedback of the transport about the output stream of the publisher
+ *  @var rcluc_congestion_status_t::admit_interval
+ *      The publisher is throttled to one message out of admit_interval, 1 when it is not throttled
+ *  @var rcluc_congestion_status_t::dropped
+ *      The number of messages dropped because of congestion since the publisher was created
+ */
+typedef struct {
+    rcluc_link_status_t link;
+    uint16_t admit_interval;
+    uint32_t dropped;
+} rcluc_congestion_status_t;
+
+/**
+ *  @brief Bookkeeping kept by the library in front of every sample stored in a subscription's message_buffer.
+ *  This is only exposed so that the size of the message_buffer can be computed at compile time.
+ *
+ *  @var rcluc_subscription_slot_header_t::length
+ *      The number of serialized bytes held in the slot
+ *  @var rcluc_subscription_slot_header_t::flags
+ *      Library state about the sample
+ *  @var rcluc_subscription_slot_header_t::loans
+ *      The number of loans held on the sample, see rcluc_subscription_loan_retain
+ *  @var rcluc_subscription_slot_header_t::arrival
+ *      The position of the sample in the order in which the samples of all subscriptions were received, which wraps
+ *      around
+ *  @var rcluc_subscription_slot_header_t::reception_timestamp
+ *      The local time (in nanoseconds) at which the sample was received
+ */
+typedef struct {
+    uint32_t length;
+    uint8_t flags;
+    uint8_t loans;
+    uint16_t arrival;
+    int64_t reception_timestamp;
+} rcluc_subscription_slot_header_t;
+
+/**
+ *  @struct rcluc_loan_t
+ *  @brief A received message kept in the subscription's message_buffer after its callback returned, see
+ *  rcluc_subscription_loan_retain
+ *
+ *  @var rcluc_loan_t::data
+ *      The serialized message, without its source timestamp. This is the message passed to the callback when
+ *      deserialization is disabled.
+ *  @var rcluc_loan_t::length
+ *      The size (in bytes) of the serialized message
+ *  @var rcluc_loan_t::slot
+ *      The queue entry holding the message. Used by the library only.
+ */
+typedef struct {
+    const uint8_t * data;
+    size_t length;
+    uint8_t * slot;
+} rcluc_loan_t;
+
+/**
+ *  @brief The size (in bytes) of a single queue entry of a subscription's message_buffer
+ *
+ *  @param max_serialized_size The largest serialized message the subscription should be able to receive
+ */
+#define RCLUC_SUBSCRIPTION_SLOT_SIZE(max_serialized_size) \
+    (sizeof(rcluc_subscription_slot_header_t) + ((((size_t)(max_serialized_size)) + 7u) & ~((size_t)7u)))
+
+/**
+ *  @brief The size (in bytes) required for the message_buffer of a subscription
+ *
+ *  @param max_serialized_size The largest serialized message the subscription should be able to receive. The shm
+ *      backend copies larger messages straight into the message_buffer. The micro-RTPS backend only receives messages
+ *      that fit into a slot of its reliable input stream, see configRCLUC_RELIABLE_STREAM_BUFFER_SIZE.
+ *  @param queue_length The number of messages to queue for the subscription
+ */
+#define RCLUC_SUBSCRIPTION_BUFFER_SIZE(max_serialized_size, queue_length) \
+    (((size_t)(queue_length)) * RCLUC_SUBSCRIPTION_SLOT_SIZE(max_serialized_size))
+
+/**
+ *  @brief The size (in bytes) of the length in front of every record of a publisher's packed queue
+ */
+#define RCLUC_PUBLISHER_RECORD_HEADER_SIZE 4
+
+/**
+ *  @brief The size (in bytes) a serialized message takes in a publisher's packed queue
+ *
+ *  @param serialized_size The size of the serialized message, including the source timestamp if the publisher sends one
+ */
+#define RCLUC_PUBLISHER_RECORD_SIZE(serialized_size) \
+    (RCLUC_PUBLISHER_RECORD_HEADER_SIZE + ((((size_t)(serialized_size)) + 3u) & ~((size_t)3u)))
+
+/**
+ *  @brief The size (in bytes) required for the message_buffer of a publisher with a packed queue, see
+ *  rcluc_publisher_config_t::packed_queue
+ *  The queue holds at least queue_length messages of serialized_size bytes, or any mix of smaller and larger ones
+ *  that adds up to the same byte budget. One record more is counted for the space left unused when a record does not
+ *  fit before the end of the buffer and starts over at its beginning.
+ *
+ *  @param serialized_size The typical size of a serialized message, including the source timestamp if the publisher
+ *      sends one
+ *  @param queue_length The number of such messages to queue
+ */
+#define RCLUC_PUBLISHER_PACKED_BUFFER_SIZE(serialized_size, queue_length) \
+    ((((size_t)(queue_length)) + 1u) * RCLUC_PUBLISHER_RECORD_SIZE(serialized_size))
+
+/**
+ *  @brief The size (in bytes) required for the message_buffer of a subscription in mailbox mode, which holds the
+ *  latest sample and the one being received
+ *
+ *  @param max_serialized_size The largest serialized message the subscription should be able to receive
+ */
+#define RCLUC_SUBSCRIPTION_MAILBOX_BUFFER_SIZE(max_serialized_size) \
+    RCLUC_SUBSCRIPTION_BUFFER_SIZE(max_serialized_size, 2)
+
+/**
+ *  @brief Contains the metadata about a ROS Service required for the rcluc library to operate on it
+ *
+ *  @var rcluc_service_type_support_t::request
+ *      The type support for the request message of the service
+ *  @var rcluc_service_type_support_t::response
+ *      The type support for the response message of the service
+ */
+typedef struct {
+    const rcluc_message_type_support_t * request;
+    const rcluc_message_type_support_t * response;
+} rcluc_service_type_support_t;
+
+/**
+ *  @brief The construct for a service client response callback function
+ *  This is the function type invoked by the node's spin when the response to a request arrives, or when the request
+ *  times out.
+ *
+ *  @param client A handle to the client the request was sent from
+ *  @param sequence_number The sequence number returned by rcluc_client_send_request for the request
+ *  @param response A reference to the response. This will either be the raw data received or the deserialized data if
+ *      the library is configured to deserialize data. NULL if the request failed.
+ *  @param status RCLUC_RET_OK if a response was received, RCLUC_RET_TIMEOUT if the request timed out or the error that
+ *      occurred while deserializing the response
+ *  @param args A reference to the user provided data that was given when the client was created
+ */
+typedef void (*rcluc_client_response_callback_t)(const rcluc_client_handle_t client, int64_t sequence_number,
+    const void * response, rcluc_ret_t status, const void * args);
+
+/**
+ *  @struct rcluc_service_client_config_t
+ *  @brief The configuration information for a ROS service client
+ *
+ *  @var rcluc_service_client_config_t::qos
+ *      The quality of service policy used for both the request and the response topics. The default is RELIABLE
+ *  @var rcluc_service_client_config_t::request_timeout_ms
+ *      The time (in milliseconds) after which a request without a response is completed with RCLUC_RET_TIMEOUT.
+ *      0 means requests never time out.
+ *  @var rcluc_service_client_config_t::max_serialized_size
+ *      The largest serialized response (in bytes) the client should be able to receive. If 0 then the
+ *      max_serialized_size of the response type is used, or configRCLUC_MAX_MESSAGE_SIZE_BYTES if it is unbounded.
+ *  @var rcluc_service_client_config_t::user_metadata
+ *      A pointer to user supplied metadata that they want associated with the client. It is passed to the response
+ *      callback.
+ */
+typedef struct {
+    rcluc_publisher_qos_policy_t qos;
+    uint32_t request_timeout_ms;
+    size_t max_serialized_size;
+    void * user_metadata;
+} rcluc_service_client_config_t;
+
+/**
+ *  @brief The size (in bytes) of the header in front of every serialized service response queued by a client.
+ *  The header holds the id the rmwu layer gave the request the response answers (a uint64), which the server echoes
+ *  from the front of the request.
+ */
+#define RCLUC_SERVICE_HEADER_SIZE 8
+
+/**
+ *  @brief The kinds of entities created by the rcluc library
+ */
+typedef enum {
+    RCLUC_ENTITY_NODE,
+    RCLUC_ENTITY_SUBSCRIPTION,
+    RCLUC_ENTITY_PUBLISHER,
+    RCLUC_ENTITY_CLIENT
+} rcluc_entity_kind_t;
+
+/**
+ *  @struct rcluc_entity_status_t
+ *  @brief The outcome of the creation of an entity of a batch, see rcluc_batch_commit
+ *
+ *  @var rcluc_entity_status_t::kind
+ *      The kind of the entity, which tells the type of the handle
+ *  @var rcluc_entity_status_t::handle
+ *      The handle that was returned by the create function of the entity. It is no longer valid.
+ *  @var rcluc_entity_status_t::status
+ *      The reason the creation failed
+ */
+typedef struct {
+    rcluc_entity_kind_t kind;
+    const void * handle;
+    rcluc_ret_t status;
+} rcluc_entity_status_t;
+
 #define RCLUC_SUBSCRIPTION_DESERIALIZATION_DISABLED 0
 #define RCLUC_SUBSCRIPTION_DESERIALIZATION_STATIC_ALLOCATION 1
 #define RCLUC_SUBSCRIPTION_DESERIALIZATION_STACK_ALLOCATION 2
 
+/* The severities of log records, with the values of the levels of rcl_interfaces/msg/Log */
+#define RCLUC_LOG_LEVEL_DEBUG 10
+#define RCLUC_LOG_LEVEL_INFO 20
+#define RCLUC_LOG_LEVEL_WARN 30
+#define RCLUC_LOG_LEVEL_ERROR 40
+#define RCLUC_LOG_LEVEL_FATAL 50
+
 #endif
@@ -25,24 +25,95 @@
 #include "rcluc/rmwu_types.h"
 #include "rcluc/rcluc_types.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  *  @brief Initializes the client library. Must be called before calls to any other rmwu library functions
+ *  Forgets every entity and session and establishes the first session with the agent.
  *
  *  @param config The configuration data for the rcl client to use when establishing a connection.
+ *  @param session (output) A pointer to a preallocated rmwu session that is set to the first session
  *  @return Returns an error code that will be RCLUC_RET_OK if initialized successfully
  */
-rcluc_ret_t rmwu_init(const rcluc_client_config_t * config);
+rcluc_ret_t rmwu_init(const rcluc_client_config_t * config, rmwu_session_t * session);
+
+/**
+ *  @brief Establishes one more session with the agent, over the transport given in the configuration
+ *  Every session has its own streams and is serviced by spinning the nodes created on it.
+ *
+ *  @param config The configuration data for the session. The client_key must differ from the other sessions.
+ *  @param session (output) A pointer to a preallocated rmwu session that is set to the new session
+ *  @return Returns an error code that will be RCLUC_RET_OK if the session was established, or RCLUC_RET_ERR_SPACE if
+ *      configRCLUC_MAX_SESSIONS sessions already exist
+ */
+rcluc_ret_t rmwu_session_create(const rcluc_client_config_t * config, rmwu_session_t * session);
+
+/**
+ *  @brief Re-establishes every session with the agent and re-creates every entity that exists
+ *  The rmwu implementation remembers the entities it created, so nodes, publishers and subscriptions keep their
+ *  handles and object ids across the restore. Entities that survived on the agent are reused.
+ *
+ *  @return Returns an error code that will be RCLUC_RET_OK if every entity was restored
+ */
+rcluc_ret_t rmwu_restore(void);
+
+/**
+ *  @brief Opens a batch of entity creations
+ *  Until rmwu_commit_batch is called, the create functions only send their requests to the agent and return without
+ *  waiting for the outcome. Destroying entities, publishing and spinning are not allowed while a batch is open and
+ *  return RCLUC_RET_ERR_INIT.
+ *
+ *  @return Returns RCLUC_RET_ERR_ALREADY if a batch is already open
+ */
+rcluc_ret_t rmwu_begin_batch(void);
+
+/**
+ *  @brief Collects the outcome of every creation of the open batch
+ *  The outcome of each entity is then available from rmwu_node_get_status, rmwu_publisher_get_status,
+ *  rmwu_subscription_get_status and rmwu_client_get_status. Entities that failed still have to be destroyed.
+ *
+ *  @return Returns an error code that will be RCLUC_RET_OK if every entity of the batch was created
+ */
+rcluc_ret_t rmwu_commit_batch(void);
+
+/**
+ *  @brief Gets the outcome of the creation of a node
+ *
+ *  @param node The node
+ *  @return Returns an error code that will be RCLUC_RET_OK if the node was created
+ */
+rcluc_ret_t rmwu_node_get_status(const rmwu_node_t * node);
+
+/**
+ *  @brief Gets the outcome of the creation of a subscription
+ *
+ *  @param subscription The subscription
+ *  @return Returns an error code that will be RCLUC_RET_OK if the subscription was created
+ */
+rcluc_ret_t rmwu_subscription_get_status(const rmwu_subscription_t * subscription);
+
+/**
+ *  @brief Gets the outcome of the creation of a publisher
+ *
+ *  @param publisher The publisher
+ *  @return Returns an error code that will be RCLUC_RET_OK if the publisher was created
+ */
+rcluc_ret_t rmwu_publisher_get_status(const rmwu_publisher_t * publisher);
 
 /**
  *  @brief Initializes the RMWU information for a ROS Node
  *  Used to create a new ROS Node by the underlying RMWU implementation
  *
+ *  @param session The session the Node and everything created under it communicate over
  *  @param name The name of the Node. It is expected for this string to be null terminated.
  *  @param namespace_ The namespace for the Node. It is expected for this string to be null terminated.
  *  @param node (output) A pointer to a preallocated rmwu node that should be initialized by the rmwu library
  *  @return Returns an error code that will be RCLUC_RET_OK if created successfully
  */
-rcluc_ret_t rmwu_node_create(const char * name, const char * namespace_, rmwu_node_t * node);
+rcluc_ret_t rmwu_node_create(const rmwu_session_t * session, const char * name, const char * namespace_,
+    rmwu_node_t * node);
 
 /**
  *  @brief Tears down the ROS node
@@ -55,29 +126,23 @@ rcluc_ret_t rmwu_node_destroy(rmwu_node_t * node);
 
 /**
  *  @brief Creates a new topic subscription in the underyling rmwu library
- *  Creates a new topic subscription in the underlying rmwu library.
+ *  Creates a new topic subscription in the underlying rmwu library. Received messages are not queued by the rmwu layer,
+ *  they are handed to the on_data listener as they arrive. Queuing, deserialization and callbacks are common to every
+ *  rmwu implementation and are handled by the rcluc layer.
  *
  *  @param node A reference to the node the subscription is being created on.
- *  @param topic_name The name of the topic that will be subscribed to. Expected to be a null terminated string
  *  @param message_type The message type information used by the library to handle the message type.
- *  @param callback The function to invoke when a message is received on this subscription
- *  @param queue_length The number of messages to queue for the incoming subscription
- *  @param message_buffer A pointer to a uint8_t array buffer that contains enough space for at least
- *      (message_size * queue_length). This buffer will be used by the library for the lifetime of the subscription
- *  @param config The subscription configuration. If NULL then the default configuration will be used
+ *  @param topic_name The name of the topic that will be subscribed to. Expected to be a null terminated string
+ *  @param config The subscription configuration.
+ *  @param on_data The function invoked with the serialized data received on the subscription
+ *  @param on_data_args The arguments passed to on_data
  *  @param subscription (output) A preallocated subscription object that will be initialized and hold the rmwu context
  *      for the new subscription
  *  @return Returns an error code that will be RCLUC_RET_OK if create is successful
- *
- *  TODO: Decide how many of these rcluc structs we want to pass down. It might make more sense keep the cnfiguration and
- *      message_type at the rcluc library layer. When doing the implementation for the RMWU we should think if it's somethig
- *      every RMWU implementation will need to do in the same way and if so then we should move it up a layer.
- *  TODO: During implementation decide if the callback passed down is the user level callback or if we should
- *      intercept it with a callback function in the rcluc layer to do message conversion etc there instead
  */
 rcluc_ret_t rmwu_subscription_create(rmwu_node_t * node, const rcluc_message_type_support_t * message_type,
-    const char * topic_name, rcluc_subscription_callback_t callback, const size_t queue_length, uint8_t *message_buffer,
-    const rcluc_subscription_config_t * config, rmwu_subscription_t * subscription);
+    const char * topic_name, const rcluc_subscription_config_t * config, rmwu_subscription_data_func_t on_data,
+    void * on_data_args, rmwu_subscription_t * subscription);
 
 /**
  *  @brief Destroys a subscription to a topic
@@ -94,20 +159,14 @@ rcluc_ret_t rmwu_subscription_destroy(rmwu_subscription_t * subscription);
  *
  *  @param node A reference to the node the publisher is being created on.
  *  @param message_type The message type information used by the library to handle the message type.
- *  @param queue_length The number of messages to queue for the outgoing publish
- *  @param message_buffer A pointer to a uint8_t array buffer that contains enough space for at least
- *      (message_size * queue_length). This buffer will be used by the library for the lifetime of the publisher.
- *  @param config The publisher configuration. If NULL then the default configuration will be used
- *  @param publisher_handle (output) A reference to a publisher_handle that will be set to the handle for the new publisher
+ *  @param topic_name The name of the topic that will be published on. Expected to be a null terminated string
+ *  @param config The publisher configuration.
+ *  @param publisher (output) A preallocated publisher object that will be initialized and hold the rmwu context for the
+ *      new publisher
  *  @return Returns an error code that will be RCLUC_RET_OK if create is successful
- *
- *  TODO: Decide how many of these rcluc structs we want to pass down. It might make more sense keep the cnfiguration and
- *      message_type at the rcluc library layer. When doing the implementation for the RMWU we should think if it's somethig
- *      every RMWU implementation will need to do in the same way and if so then we should move it up a layer.
  */
 rcluc_ret_t rmwu_publisher_create(rmwu_node_t * node, const rcluc_message_type_support_t * message_type,
-    size_t queue_length, uint8_t * message_buffer, const rcluc_publisher_config_t * config,
-    rmwu_publisher_t * publisher);
+    const char * topic_name, const rcluc_publisher_config_t * config, rmwu_publisher_t * publisher);
 
 /**
  *  @brief Destroys the provided ROS publisher
@@ -120,12 +179,144 @@ rcluc_ret_t rmwu_publisher_destroy(rmwu_publisher_t * publisher);
 
 /**
  *  @brief Publishes a message on a ROS Topic
- *  Publishes the provided message out on the ROS Topic that is referenced by publisher
+ *  Publishes the provided message out on the ROS Topic that is referenced by publisher. Messages whose serialized size
+ *  is larger than configRCLUC_MAX_MESSAGE_SIZE_BYTES are serialized incrementally and sent as fragments over a reliable
+ *  stream, regardless of the reliability of the publisher. The fragments wait at most configRCLUC_FRAGMENT_TIMEOUT_MS
+ *  in total for room in the stream history. A message that fails part way is terminated with an empty last fragment,
+ *  so that the agent drops it instead of joining the next message to it.
  *
- *  @param publisher_handle The handle for the ROS Topic this message will be published on
+ *  @param publisher The handle for the ROS Topic this message will be published on
  *  @param message The message that is going to be published on the topic
  *  @return Returns an error code that will be RCLUC_RET_OK if publish is successful
  */
 rcluc_ret_t rmwu_publisher_publish(rmwu_publisher_t * publisher, const void * message);
 
+/**
+ *  @brief Publishes several messages of the same type on a topic
+ *  Samples are grouped into runs that fit into a single message of the publisher's stream. The stream is reserved
+ *  once per run and the samples of the run are serialized back to back into it.
+ *
+ *  @param publisher The publisher
+ *  @param messages The first message to publish
+ *  @param count The number of messages to publish
+ *  @param stride The distance (in bytes) between the start of two consecutive messages
+ *  @param published_count (output) The number of messages that were accepted by the stream
+ *  @return Returns RCLUC_RET_ERR_SPACE if the stream ran out of space before all messages were accepted
+ */
+rcluc_ret_t rmwu_publisher_publish_many(rmwu_publisher_t * publisher, const void * messages, size_t count,
+    size_t stride, size_t * published_count);
+
+/**
+ *  @brief Publishes a sample that is already serialized, given as a list of fragments
+ *  The fragments are the serialized message without the source timestamp, which is added in front of them if the
+ *  publisher sends one. A best effort sample that fits into one transport message goes out through the transport's
+ *  send_fragments function if it has one, with the headers in a small buffer of their own and the fragments sent from
+ *  where they are. Otherwise the fragments are copied into the publisher's stream, or into reliable fragments if the
+ *  sample is larger than configRCLUC_MAX_MESSAGE_SIZE_BYTES.
+ *
+ *  @param publisher The publisher
+ *  @param fragments The pieces of the serialized message, in order
+ *  @param count The number of pieces
+ *  @return Returns an error code that will be RCLUC_RET_OK if publish is successful
+ */
+rcluc_ret_t rmwu_publisher_publish_fragments(rmwu_publisher_t * publisher, const rcluc_buffer_fragment_t * fragments,
+    size_t count);
+
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+/**
+ *  @brief Gets the feedback of the transport about the output stream of a publisher
+ *  The rcluc layer throttles low priority publishers from it. The feedback is refreshed as messages are written and
+ *  by every spin of the session.
+ *
+ *  @param publisher The publisher
+ *  @param status (output) The occupancy of the publisher's stream and the link feedback of its session
+ *  @return Returns an error code that will be RCLUC_RET_OK if the status was read
+ */
+rcluc_ret_t rmwu_publisher_get_link_status(const rmwu_publisher_t * publisher, rcluc_link_status_t * status);
+#endif
+
+#if configRCLUC_ENABLE_SERVICES
+/**
+ *  @brief Creates a service client, which sends requests to a ROS service and receives its replies
+ *  The requests are published on the service's request topic "rq/<service_name>Request" behind their request id, and
+ *  the server is expected to put the same id in front of its reply on the reply topic "rr/<service_name>Reply". Replies
+ *  are handed to on_data with the id of the request they answer in front, as a uint64 of RCLUC_SERVICE_HEADER_SIZE
+ *  bytes. Replies to the requests of other clients may be handed over as well and have to be ignored.
+ *
+ *  @param node The node to create the client on
+ *  @param service_type The request and response types of the service
+ *  @param service_name The DDS name of the service, without the "rq/" and "rr/" prefixes of its topics
+ *  @param reliability The reliability of the requests and replies
+ *  @param on_data The function to invoke with the serialized replies
+ *  @param on_data_args The first argument of on_data
+ *  @param client (output) The new client
+ *  @return Returns an error code that will be RCLUC_RET_OK if create is successful
+ */
+rcluc_ret_t rmwu_client_create(rmwu_node_t * node, const rcluc_service_type_support_t * service_type,
+    const char * service_name, rcluc_topic_reliability_t reliability, rmwu_subscription_data_func_t on_data,
+    void * on_data_args, rmwu_client_t * client);
+
+/**
+ *  @brief Destroys a service client
+ *
+ *  @param client The client
+ *  @return Returns an error code that will be RCLUC_RET_OK if destroy is successful
+ */
+rcluc_ret_t rmwu_client_destroy(rmwu_client_t * client);
+
+/**
+ *  @brief Gets the outcome of the creation of a service client
+ *
+ *  @param client The client
+ *  @return Returns an error code that will be RCLUC_RET_OK if the client was created
+ */
+rcluc_ret_t rmwu_client_get_status(const rmwu_client_t * client);
+
+/**
+ *  @brief Sends a request to the service
+ *  The request id is unique to the client, and its low 16 bits are the low 16 bits of sequence_number so that the
+ *  rcluc layer finds the request a reply answers from the id alone.
+ *
+ *  @param client The client
+ *  @param request The request message
+ *  @param sequence_number The sequence number the rcluc layer gave the request
+ *  @param request_id (output) The id that the reply to the request carries in front of it
+ *  @return Returns an error code that will be RCLUC_RET_OK if the request was written
+ */
+rcluc_ret_t rmwu_client_send_request(rmwu_client_t * client, const void * request, int64_t sequence_number,
+    uint64_t * request_id);
+#endif /* configRCLUC_ENABLE_SERVICES */
+
+/**
+ *  @brief Services the transport layer for a node
+ *  Sends any pending output data of the node's session and waits up to timeout_ms for incoming data. Data received on
+ *  the session is handed to the on_data listeners of its subscriptions before this function returns.
+ *
+ *  @param node The node to service
+ *  @param timeout_ms The maximum time (in milliseconds) to wait for incoming data
+ *  @return Returns an error code that will be RCLUC_RET_OK if the transport was serviced successfully
+ */
+rcluc_ret_t rmwu_node_spin_once(rmwu_node_t * node, uint32_t timeout_ms);
+
+/**
+ *  @brief Gets the time of a monotonic clock
+ *  Used by the rcluc layer to drive timeouts from spin.
+ *
+ *  @return The current time in milliseconds
+ */
+int64_t rmwu_get_time_ms(void);
+
+/**
+ *  @brief Gets the time of the same monotonic clock as rmwu_get_time_ms at a higher resolution
+ *  Used by the rcluc layer to timestamp messages and to synchronize with the agent's clock. The clock is read through
+ *  configRCLUC_GET_TIME_NS if the configuration defines it.
+ *
+ *  @return The current time in nanoseconds
+ */
+int64_t rmwu_get_time_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* ifndef RCLUC__RMWU_H_ */
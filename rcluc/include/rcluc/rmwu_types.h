@@ -21,20 +21,117 @@
 #ifndef RCLUC__RMWU_TYPES_H_
 #define RCLUC__RMWU_TYPES_H_
 
+#include "rcluc/rcluc_default_configs.h"
+#include "rcluc/rcluc_types.h"
+#if !configRCLUC_RMWU_SHM
 #include <micrortps/client/client.h>
+#endif
+
+/**
+ *  @brief The construct for the function an rmwu implementation invokes when it receives data for a subscription.
+ *  Serialized data is handed to the rcluc layer as it arrives. A message that the transport received in several
+ *  fragments may be delivered in several calls with increasing offsets so that it can be reassembled directly into
+ *  its final destination. The micro-RTPS backend hands over the samples it receives as fragments one fragment at a
+ *  time, and a sample cut short by a lost fragment is followed by the next sample starting over at offset 0.
+ *
+ *  @param args The listener arguments given when the subscription was created
+ *  @param data The serialized bytes that were received
+ *  @param offset The offset of data within the complete serialized message
+ *  @param length The number of bytes in data
+ *  @param total_length The size (in bytes) of the complete serialized message
+ *  @return Returns an error code that will be RCLUC_RET_OK if the data was accepted
+ */
+typedef rcluc_ret_t (*rmwu_subscription_data_func_t)(void * args, const uint8_t * data, size_t offset, size_t length,
+    size_t total_length);
 
 /* Forward declare these so they can be instantiated in the rcluc implementation without exact details exposed from the
  * rmwu implementation.
  */
 //TODO: Figure out a way to make these protected for the rmwu implementation while rcluc.c can know the size of the struct
+typedef struct {
+    uint8_t index;
+} rmwu_session_t;
+#if configRCLUC_RMWU_SHM
+/* Shared memory implementation, see rmwu_shm.c */
+typedef struct {
+    uint8_t session;
+} rmwu_node_t;
+typedef struct {
+    const rmwu_node_t * node;
+    void * topic;
+    uint32_t next_sample;
+    rmwu_subscription_data_func_t on_data;
+    void * on_data_args;
+} rmwu_subscription_t;
+typedef struct {
+    void * topic;
+    uint8_t session;
+    const rcluc_message_type_support_t * message_type;
+    uint8_t source_timestamp;
+    int64_t timestamp;
+} rmwu_publisher_t;
+/* A service client publishes its requests and subscribes to the replies, both behind the request id */
+typedef struct {
+    rmwu_publisher_t requests;
+    rmwu_subscription_t replies;
+    uint64_t request_id_base;
+} rmwu_client_t;
+
+/* Topics of different domains use different shared memory segments, so no transport configuration is needed */
+typedef struct {
+    uint8_t unused;
+} rmwu_transport_config_t;
+#else
 typedef struct {
     mrObjectId participant_id;
+    uint8_t session;
 } rmwu_node_t;
-typedef struct {} rmwu_subscription_t;
-typedef struct {} rmwu_publisher_t;
+typedef struct {
+    mrObjectId topic_id;
+    mrObjectId subscriber_id;
+    mrObjectId datareader_id;
+    rmwu_subscription_data_func_t on_data;
+    void * on_data_args;
+} rmwu_subscription_t;
+typedef struct {
+    mrObjectId topic_id;
+    mrObjectId publisher_id;
+    mrObjectId datawriter_id;
+    mrStreamId stream_id;
+    uint8_t session;
+    const rcluc_message_type_support_t * message_type;
+    uint8_t source_timestamp;
+    int64_t timestamp;
+} rmwu_publisher_t;
+/* A service client publishes its requests and subscribes to the replies, both behind the request id */
+typedef struct {
+    rmwu_publisher_t requests;
+    rmwu_subscription_t replies;
+    uint64_t request_id_base;
+} rmwu_client_t;
 
+/**
+ *  @brief Sends one transport message given as a list of fragments, in order, without first copying them together
+ *  This is where a transport plugs in sendmsg or a DMA descriptor chain. The fragments are only valid during the call.
+ *
+ *  @param args The send_fragments_args of the transport configuration
+ *  @param fragments The pieces of the message
+ *  @param count The number of pieces
+ *  @return true if the whole message was sent
+ */
+typedef bool (*rmwu_transport_send_fragments_func_t)(void * args, const rcluc_buffer_fragment_t * fragments,
+    size_t count);
+
+/*
+ * send_fragments is optional. Without it, samples that are already serialized are copied into the output streams like
+ * any other sample. send_fragments_mtu is the largest message (in bytes) it can send.
+ */
 typedef struct {
     mrCommunication * comm;
+    rmwu_transport_send_fragments_func_t send_fragments;
+    void * send_fragments_args;
+    size_t send_fragments_mtu;
 } rmwu_transport_config_t;
+#endif /* configRCLUC_RMWU_SHM */
 
 #endif /* ifndef RCLUC__RMWU_TYPES_H_ */
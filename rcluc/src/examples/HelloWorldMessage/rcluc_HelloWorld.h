@@ -24,32 +24,103 @@
 #define RCLUC__RCLUC_HELLOWORLD_H_
 
 #include <stdint.h>
+#include <string.h>
 #include "rcluc/rcluc_types.h"
+#include "rcluc/rcluc_cdr.h"
+
+/**
+ *  @brief The largest size (in bytes) of a serialized HelloWorld message
+ */
+#define RCLUC_HELLOWORLD_MAX_SERIALIZED_SIZE (4 + 4 + 255)
 
 typedef struct {
     uint32_t index;
     char message[255];
 } rcluc_HelloWorld_t;
 
-rcluc_ret_t rcluc_HelloWorld_deserialize(void * message_buffer, size_t message_buffer_size,
+/**
+ *  @brief The offsets of the fields in a serialized HelloWorld message, up to the first field of variable size
+ */
+#define RCLUC_HELLOWORLD_CDR_OFFSET_INDEX 0
+#define RCLUC_HELLOWORLD_CDR_OFFSET_MESSAGE 4
+
+static inline rcluc_ret_t rcluc_HelloWorld_deserialize(const void * message_buffer, size_t message_buffer_size,
         rcluc_HelloWorld_t * deserialized_message, size_t deserialized_message_size) {
-    //TODO
-    return RCLUC_RET_ERROR;
+    rcluc_cdr_buffer_t buffer;
+    if (NULL == message_buffer || NULL == deserialized_message) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (deserialized_message_size < sizeof(rcluc_HelloWorld_t)) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    // The buffer is only read from
+    rcluc_cdr_init(&buffer, (uint8_t *)message_buffer, message_buffer_size);
+    (void) rcluc_cdr_deserialize_uint32(&buffer, &deserialized_message->index);
+    return rcluc_cdr_deserialize_string(&buffer, deserialized_message->message, sizeof(deserialized_message->message));
+}
+
+static inline rcluc_ret_t rcluc_HelloWorld_serialize(const rcluc_HelloWorld_t * message, rcluc_cdr_buffer_t * buffer) {
+    (void) rcluc_cdr_serialize_uint32(buffer, message->index);
+    return rcluc_cdr_serialize_string(buffer, message->message);
+}
+
+static inline size_t rcluc_HelloWorld_get_serialized_size(const rcluc_HelloWorld_t * message) {
+    return rcluc_cdr_string_end(4, message->message);
+}
+
+/* The functions of the type support take the messages as void pointers, and call the typed functions above */
+static inline rcluc_ret_t rcluc_HelloWorld_type_deserialize(void * message_buffer, size_t message_buffer_size,
+        void * deserialized_message, size_t deserialized_message_size) {
+    return rcluc_HelloWorld_deserialize(message_buffer, message_buffer_size,
+        (rcluc_HelloWorld_t *)deserialized_message, deserialized_message_size);
 }
 
-rcluc_ret_t rcluc_HelloWorld_serialize(rcluc_HelloWorld_t * message, void * serializedBuffer) {
-    //TODO:
-    return RCLUC_RET_ERROR;
+static inline rcluc_ret_t rcluc_HelloWorld_type_serialize(const void * message, rcluc_cdr_buffer_t * buffer) {
+    return rcluc_HelloWorld_serialize((const rcluc_HelloWorld_t *)message, buffer);
+}
+
+static inline size_t rcluc_HelloWorld_type_get_serialized_size(const void * message) {
+    return rcluc_HelloWorld_get_serialized_size((const rcluc_HelloWorld_t *)message);
 }
 
 static const rcluc_message_type_support_t rcluc_HelloWorld_type_support = {
+    "HelloWorld",
     sizeof(rcluc_HelloWorld_t),
-    (rcluc_message_serialization_func_t)rcluc_HelloWorld_serialize,
-    (rcluc_message_deserialization_func_t)rcluc_HelloWorld_deserialize
+    RCLUC_HELLOWORLD_MAX_SERIALIZED_SIZE,
+    rcluc_HelloWorld_type_serialize,
+    rcluc_HelloWorld_type_deserialize,
+    rcluc_HelloWorld_type_get_serialized_size
 };
 
-const rcluc_message_type_support_t* rcluc_HelloWorld_get_type_support() {
+static inline const rcluc_message_type_support_t* rcluc_HelloWorld_get_type_support() {
     return &rcluc_HelloWorld_type_support;
 }
 
-#endif /* ifndef RMWU__RMWU_HELLOWORLD_H_ */
+/**
+ *  @brief Reads the index field of a serialized HelloWorld message without deserializing it
+ *
+ *  @param message_buffer The serialized message
+ *  @param message_buffer_size The size (in bytes) of the serialized message
+ *  @param index (output) The index
+ *  @return Returns an error code that will be RCLUC_RET_OK if the field is read successfully
+ */
+static inline rcluc_ret_t rcluc_HelloWorld_cdr_get_index(const void * message_buffer, size_t message_buffer_size,
+        uint32_t * index) {
+    return rcluc_cdr_get_uint32((const uint8_t *)message_buffer, message_buffer_size, RCLUC_HELLOWORLD_CDR_OFFSET_INDEX,
+        index);
+}
+
+/**
+ *  @brief Gets the message field of a serialized HelloWorld message in place, without copying it
+ *
+ *  @param message_buffer The serialized message
+ *  @param message_buffer_size The size (in bytes) of the serialized message
+ *  @param message (output) The null terminated string, which points into the serialized message
+ *  @return Returns an error code that will be RCLUC_RET_OK if the field is read successfully
+ */
+static inline rcluc_ret_t rcluc_HelloWorld_cdr_get_message(const void * message_buffer, size_t message_buffer_size,
+        const char ** message) {
+    return rcluc_cdr_get_string((const uint8_t *)message_buffer, message_buffer_size,
+        RCLUC_HELLOWORLD_CDR_OFFSET_MESSAGE, message, NULL);
+}
+
+#endif /* ifndef RCLUC__RCLUC_HELLOWORLD_H_ */
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief C++ message traits for HelloWorld, used by the rcluc.hpp interface
+ *
+ *  The file is writen manually for now, but will eventually be automatically generated.
+ */
+
+#ifndef RCLUC__RCLUC_HELLOWORLD_HPP_
+#define RCLUC__RCLUC_HELLOWORLD_HPP_
+
+#include "rcluc/rcluc.hpp"
+#include "rcluc_HelloWorld.h"
+
+namespace rcluc {
+
+template <>
+struct MessageTraits<rcluc_HelloWorld_t> {
+    static constexpr const char * type_name = "HelloWorld";
+    static constexpr size_t max_serialized_size = RCLUC_HELLOWORLD_MAX_SERIALIZED_SIZE;
+
+    static rcluc_ret_t serialize(const rcluc_HelloWorld_t & message, rcluc_cdr_buffer_t * buffer) {
+        return rcluc_HelloWorld_serialize(&message, buffer);
+    }
+
+    static rcluc_ret_t deserialize(const uint8_t * data, size_t length, rcluc_HelloWorld_t & message) {
+        return rcluc_HelloWorld_deserialize(data, length, &message, sizeof(message));
+    }
+
+    static size_t serialized_size(const rcluc_HelloWorld_t & message) {
+        return rcluc_HelloWorld_get_serialized_size(&message);
+    }
+};
+
+} // namespace rcluc
+
+#endif /* ifndef RCLUC__RCLUC_HELLOWORLD_HPP_ */
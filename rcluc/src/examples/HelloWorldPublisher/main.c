@@ -26,6 +26,10 @@
 #include <stdio.h>
 #include <micrortps/client/client.h>
 
+#if !configRCLUC_ENABLE_PUBLISHERS
+#error "The publisher example needs configRCLUC_ENABLE_PUBLISHERS"
+#endif
+
 #define MAX_MESSAGES_IN_BUFFER      2
 #define TIME_BETWEEN_PUBLISH_SEC    1
 
@@ -71,8 +75,8 @@ int main(int args, char** argv)
     rcluc_publisher_get_default_config(&publisher_config);
     publisher_config.exception_callback = exception_callback;
 
-    err = rcluc_publisher_create(node, rcluc_HelloWorld_get_type_support(), MAX_MESSAGES_IN_BUFFER, buffer,
-        &publisher_config, &publisher);
+    err = rcluc_publisher_create(node, rcluc_HelloWorld_get_type_support(), "HelloWorldTopic", MAX_MESSAGES_IN_BUFFER,
+        buffer, &publisher_config, &publisher);
     if (RCLUC_RET_OK != err) {
         printf("File: %s, $Line: %d, Error: %d\n", __FILE__, __LINE__, err);
         return err;
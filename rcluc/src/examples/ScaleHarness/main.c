@@ -0,0 +1,249 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Runs many simulated clients against the mock agent in one process and reports how they scale
+ *
+ *  Usage: ScaleHarness [clients] [messages per client] [port]
+ *
+ *  Every client is a session of its own, with its own UDP transport and client key, holding one node and one
+ *  publisher. The harness reports the time each client took to connect and create its entities, the rate at which the
+ *  agent received the samples and the latency percentiles from publish to reception by the agent. The number of
+ *  clients is limited by configRCLUC_MAX_SESSIONS, see rcluc_scale_config.h. Run it for growing numbers of clients to
+ *  see how a fleet behaves on a single agent.
+ *
+ *  Experimental, see mock_agent.h: built with -DRCLUC_SCALE_HARNESS=ON.
+ */
+
+#include "rcluc/rcluc.h"
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc/rmwu_types.h"
+#include "rcluc_HelloWorld.h"
+#include "mock_agent.h"
+#include <micrortps/client/client.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !configRCLUC_ENABLE_PUBLISHERS
+#error "The scale harness needs configRCLUC_ENABLE_PUBLISHERS"
+#endif
+
+#define HARNESS_DEFAULT_MESSAGES    100
+#define HARNESS_MAX_MESSAGES        1000
+#define HARNESS_DEFAULT_PORT        2019
+#define HARNESS_CLIENT_KEY_BASE     0x5CA10000u
+#define HARNESS_DRAIN_TIMEOUT_NS    (2 * 1000000000LL)
+/* The sample index carries the client in its upper bits so that the agent side finds the publish time */
+#define HARNESS_ROUND_BITS          20
+#define HARNESS_ROUND_MASK          ((1u << HARNESS_ROUND_BITS) - 1)
+
+typedef struct {
+    mrUDPTransport transport;
+    rmwu_transport_config_t transport_config;
+    rcluc_session_handle_t session;
+    rcluc_node_handle_t node;
+    rcluc_publisher_handle_t publisher;
+    uint8_t buffer[sizeof(rcluc_HelloWorld_t)];
+    char name[24];
+    int64_t connect_ns;
+    int64_t publish_ns[HARNESS_MAX_MESSAGES];
+} harness_client_t;
+
+static harness_client_t clients[configRCLUC_MAX_SESSIONS];
+static int64_t latencies[configRCLUC_MAX_SESSIONS * HARNESS_MAX_MESSAGES];
+static size_t latency_count = 0;
+static int64_t last_reception_ns = 0;
+static size_t client_count = 0;
+static mock_agent_t agent;
+static volatile int agent_running = 1;
+
+static int64_t now_ns(void) {
+    struct timespec now;
+    (void) clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+static int compare_int64(const void * a, const void * b) {
+    int64_t left = *(const int64_t *)a;
+    int64_t right = *(const int64_t *)b;
+    return (left > right) - (left < right);
+}
+
+/* Runs in the agent thread, the only writer of latencies and latency_count */
+static void on_agent_data(void * args, uint32_t client_key, const uint8_t * data, size_t length) {
+    rcluc_cdr_buffer_t buffer;
+    uint32_t index = 0;
+    int64_t received_ns = now_ns();
+    (void) args;
+    (void) client_key;
+    rcluc_cdr_init(&buffer, (uint8_t *)data, length);
+    if (RCLUC_RET_OK != rcluc_cdr_deserialize_uint32(&buffer, &index)) {
+        return;
+    }
+    size_t client = index >> HARNESS_ROUND_BITS;
+    size_t round = index & HARNESS_ROUND_MASK;
+    size_t count = __atomic_load_n(&latency_count, __ATOMIC_RELAXED);
+    if (client >= client_count || round >= HARNESS_MAX_MESSAGES || count >= sizeof(latencies) / sizeof(latencies[0])) {
+        return;
+    }
+    latencies[count] = received_ns - clients[client].publish_ns[round];
+    __atomic_store_n(&last_reception_ns, received_ns, __ATOMIC_RELAXED);
+    __atomic_store_n(&latency_count, count + 1, __ATOMIC_RELEASE);
+}
+
+static void * agent_thread(void * args) {
+    (void) args;
+    while (agent_running) {
+        (void) mock_agent_spin_once(&agent, 10);
+    }
+    return NULL;
+}
+
+static rcluc_ret_t connect_client(harness_client_t * client, size_t index, uint16_t port) {
+    rcluc_client_config_t client_config = {0};
+    rcluc_publisher_config_t publisher_config = {0};
+    rcluc_ret_t err = RCLUC_RET_OK;
+    int64_t start_ns = now_ns();
+
+    if (!mr_init_udp_transport(&client->transport, "127.0.0.1", port)) {
+        return RCLUC_RET_ERROR;
+    }
+    client->transport_config.comm = &client->transport.comm;
+    client_config.transport_layer_config = &client->transport_config;
+    client_config.client_key = HARNESS_CLIENT_KEY_BASE + (uint32_t)index;
+    (void) snprintf(client->name, sizeof(client->name), "ScaleClient%u", (unsigned int)index);
+
+    // The first client opens the default session, the others one session each
+    if (0 == index) {
+        err = rcluc_init(&client_config);
+        if (RCLUC_RET_OK == err) {
+            err = rcluc_node_create(client->name, "", &client->node);
+        }
+    } else {
+        err = rcluc_session_create(&client_config, &client->session);
+        if (RCLUC_RET_OK == err) {
+            err = rcluc_node_create_on_session(client->session, client->name, "", &client->node);
+        }
+    }
+    if (RCLUC_RET_OK == err) {
+        rcluc_publisher_get_default_config(&publisher_config);
+        err = rcluc_publisher_create(client->node, rcluc_HelloWorld_get_type_support(), "ScaleTopic", 1,
+            client->buffer, &publisher_config, &client->publisher);
+    }
+    client->connect_ns = now_ns() - start_ns;
+    return err;
+}
+
+static double percentile_us(const int64_t * sorted, size_t count, unsigned int percent) {
+    if (0 == count) {
+        return 0;
+    }
+    size_t index = (count * percent) / 100;
+    if (index >= count) {
+        index = count - 1;
+    }
+    return (double)sorted[index] / 1000.0;
+}
+
+int main(int argc, char ** argv) {
+    rcluc_ret_t err = RCLUC_RET_OK;
+    pthread_t thread;
+    size_t requested_clients = configRCLUC_MAX_SESSIONS;
+    size_t messages = HARNESS_DEFAULT_MESSAGES;
+    uint16_t port = HARNESS_DEFAULT_PORT;
+    rcluc_HelloWorld_t hello_world = {0};
+    int64_t connect_total_ns = 0;
+    int64_t connect_max_ns = 0;
+    strncpy(hello_world.message, "scale", sizeof(hello_world.message) - 1);
+
+    if (argc > 1) {
+        requested_clients = (size_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        messages = (size_t)strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3) {
+        port = (uint16_t)strtoul(argv[3], NULL, 0);
+    }
+    if (0 == requested_clients || requested_clients > configRCLUC_MAX_SESSIONS) {
+        printf("Clients must be between 1 and configRCLUC_MAX_SESSIONS (%d)\n", configRCLUC_MAX_SESSIONS);
+        return 1;
+    } else if (messages > HARNESS_MAX_MESSAGES) {
+        printf("Messages per client must be at most %d\n", HARNESS_MAX_MESSAGES);
+        return 1;
+    }
+
+    if (RCLUC_RET_OK != mock_agent_open(&agent, port, on_agent_data, NULL)) {
+        printf("Error at opening the mock agent on port %u\n", (unsigned int)port);
+        return 1;
+    }
+    if (0 != pthread_create(&thread, NULL, agent_thread, NULL)) {
+        printf("Error at starting the mock agent\n");
+        return 1;
+    }
+
+    for (client_count = 0; client_count < requested_clients; ++client_count) {
+        err = connect_client(&clients[client_count], client_count, port);
+        if (RCLUC_RET_OK != err) {
+            printf("Client %u failed to connect, Error: %d\n", (unsigned int)client_count, err);
+            break;
+        }
+        connect_total_ns += clients[client_count].connect_ns;
+        if (clients[client_count].connect_ns > connect_max_ns) {
+            connect_max_ns = clients[client_count].connect_ns;
+        }
+    }
+
+    // Every round publishes one sample per client, then spins the clients to flush their streams
+    int64_t start_ns = now_ns();
+    for (size_t round = 0; round < messages; ++round) {
+        for (size_t i = 0; i < client_count; ++i) {
+            hello_world.index = (uint32_t)((i << HARNESS_ROUND_BITS) | round);
+            clients[i].publish_ns[round] = now_ns();
+            if (RCLUC_RET_OK != rcluc_publisher_publish(clients[i].publisher, &hello_world)) {
+                clients[i].publish_ns[round] = 0;
+            }
+            rcluc_node_spin_once(clients[i].node);
+        }
+    }
+
+    size_t expected = client_count * messages;
+    int64_t drain_deadline_ns = now_ns() + HARNESS_DRAIN_TIMEOUT_NS;
+    while (__atomic_load_n(&latency_count, __ATOMIC_ACQUIRE) < expected && now_ns() < drain_deadline_ns) {
+        for (size_t i = 0; i < client_count; ++i) {
+            rcluc_node_spin_once(clients[i].node);
+        }
+    }
+    agent_running = 0;
+    (void) pthread_join(thread, NULL);
+    mock_agent_close(&agent);
+
+    size_t received = latency_count;
+    double elapsed_s = (double)(last_reception_ns - start_ns) / 1e9;
+    qsort(latencies, received, sizeof(latencies[0]), compare_int64);
+
+    printf("clients,connect_mean_ms,connect_max_ms,entities,sent,received,rate_msg_s,p50_us,p90_us,p99_us,max_us\n");
+    printf("%u,%.3f,%.3f,%u,%u,%u,%.0f,%.1f,%.1f,%.1f,%.1f\n", (unsigned int)client_count,
+        (0 == client_count) ? 0.0 : (double)connect_total_ns / (double)client_count / 1e6, (double)connect_max_ns / 1e6,
+        (unsigned int)agent.stats.entities, (unsigned int)expected, (unsigned int)received,
+        (elapsed_s > 0) ? (double)received / elapsed_s : 0.0, percentile_us(latencies, received, 50),
+        percentile_us(latencies, received, 90), percentile_us(latencies, received, 99),
+        (0 == received) ? 0.0 : (double)latencies[received - 1] / 1000.0);
+    return (client_count == requested_clients && received == expected) ? 0 : 1;
+}
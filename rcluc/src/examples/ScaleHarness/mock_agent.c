@@ -0,0 +1,438 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the mock DDS-XRCE agent
+ */
+
+#include "mock_agent.h"
+#include <arpa/inet.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Submessage ids as defined by the DDS-XRCE specification */
+#define XRCE_CREATE_CLIENT              0
+#define XRCE_CREATE                     1
+#define XRCE_DELETE                     3
+#define XRCE_STATUS_AGENT               4
+#define XRCE_STATUS                     5
+#define XRCE_WRITE_DATA                 7
+#define XRCE_DATA                       9
+#define XRCE_ACKNACK                    10
+#define XRCE_HEARTBEAT                  11
+#define XRCE_FRAGMENT                   13
+
+#define XRCE_FLAG_LITTLE_ENDIAN         (1 << 0)
+#define XRCE_FLAG_LAST_FRAGMENT         (1 << 1)
+/* The data format of WRITE_DATA, of which only FORMAT_DATA (0) is handled */
+#define XRCE_FLAG_FORMAT_MASK           0x0E
+
+/* Session ids below this value carry the client key in the message header */
+#define XRCE_SESSION_ID_WITHOUT_KEY     0x80
+#define XRCE_STREAM_NONE                0x00
+#define XRCE_STREAM_BUILTIN_RELIABLE    0x80
+#define XRCE_STATUS_OK                  0x00
+
+#define XRCE_HEADER_SIZE                4
+#define XRCE_SUBHEADER_SIZE             4
+#define XRCE_CLIENT_KEY_SIZE            4
+/* A CLIENT_Representation of at least this size, counted from the cookie, has a client_timestamp before the key */
+#define XRCE_CLIENT_WITH_TIMESTAMP_SIZE 21
+#define XRCE_WRITE_DATA_HEADER_SIZE     8
+
+static const uint8_t xrce_cookie[4] = {'X', 'R', 'C', 'E'};
+
+static uint16_t read_uint16(const uint8_t * data, uint8_t little_endian) {
+    return little_endian ? (uint16_t)(data[0] | (data[1] << 8)) : (uint16_t)((data[0] << 8) | data[1]);
+}
+
+static uint32_t read_uint32(const uint8_t * data, uint8_t little_endian) {
+    if (little_endian) {
+        return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    }
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | (uint32_t)data[3];
+}
+
+static void write_uint16(uint8_t * data, uint16_t value) {
+    data[0] = (uint8_t)value;
+    data[1] = (uint8_t)(value >> 8);
+}
+
+static void write_uint32(uint8_t * data, uint32_t value) {
+    write_uint16(data, (uint16_t)value);
+    write_uint16(&data[2], (uint16_t)(value >> 16));
+}
+
+static size_t align_to_4(size_t offset) {
+    return (offset + 3) & ~((size_t)3);
+}
+
+/* Sends a single submessage to a client on stream_id, numbered with sequence */
+static rcluc_ret_t send_numbered(mock_agent_t * agent, mock_agent_client_t * client, uint8_t stream_id,
+        uint16_t sequence, uint8_t id, uint8_t flags, const uint8_t * payload, size_t length) {
+    uint8_t message[XRCE_HEADER_SIZE + XRCE_CLIENT_KEY_SIZE + XRCE_SUBHEADER_SIZE + MOCK_AGENT_MESSAGE_SIZE];
+    size_t offset = XRCE_HEADER_SIZE;
+    if (length > MOCK_AGENT_MESSAGE_SIZE) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    message[0] = client->session_id;
+    message[1] = stream_id;
+    write_uint16(&message[2], sequence);
+    if (client->session_id < XRCE_SESSION_ID_WITHOUT_KEY) {
+        memcpy(&message[offset], client->key, XRCE_CLIENT_KEY_SIZE);
+        offset += XRCE_CLIENT_KEY_SIZE;
+    }
+    message[offset] = id;
+    message[offset + 1] = flags;
+    write_uint16(&message[offset + 2], (uint16_t)length);
+    memcpy(&message[offset + XRCE_SUBHEADER_SIZE], payload, length);
+    if (sendto(agent->socket, message, offset + XRCE_SUBHEADER_SIZE + length, 0,
+            (const struct sockaddr *)&client->address, sizeof(client->address)) < 0) {
+        return RCLUC_RET_ERROR;
+    }
+    return RCLUC_RET_OK;
+}
+
+/* Sends a single submessage to a client, numbered on the agent's reliable stream unless stream_id is none */
+static void send_submessage(mock_agent_t * agent, mock_agent_client_t * client, uint8_t stream_id, uint8_t id,
+        const uint8_t * payload, uint16_t length) {
+    uint16_t sequence = (XRCE_STREAM_NONE == stream_id) ? 0 : client->output_sequence++;
+    (void) send_numbered(agent, client, stream_id, sequence, id, XRCE_FLAG_LITTLE_ENDIAN, payload, length);
+}
+
+static void send_acknack(mock_agent_t * agent, mock_agent_client_t * client, uint8_t stream_id,
+        uint16_t first_unacked) {
+    uint8_t payload[5] = {0};
+    write_uint16(payload, first_unacked);
+    payload[4] = stream_id;
+    send_submessage(agent, client, XRCE_STREAM_NONE, XRCE_ACKNACK, payload, sizeof(payload));
+}
+
+static void on_create_client(mock_agent_t * agent, mock_agent_client_t * client, const uint8_t * payload,
+        size_t length) {
+    uint8_t reply[24] = {0};
+    uint16_t reply_length = 11;
+    const uint8_t * cookie = NULL;
+    // The representation follows a base object request in some client versions, the cookie tells where it starts
+    for (size_t offset = 0; offset <= 4 && offset + sizeof(xrce_cookie) <= length && NULL == cookie; offset += 4) {
+        if (0 == memcmp(&payload[offset], xrce_cookie, sizeof(xrce_cookie))) {
+            cookie = &payload[offset];
+        }
+    }
+    if (NULL == cookie) {
+        agent->stats.dropped++;
+        return;
+    }
+    size_t remaining = length - (size_t)(cookie - payload);
+    size_t key_offset = 8;
+    client->with_timestamp = remaining >= XRCE_CLIENT_WITH_TIMESTAMP_SIZE;
+    if (client->with_timestamp) {
+        key_offset = 16;
+    }
+    if (remaining < key_offset + XRCE_CLIENT_KEY_SIZE) {
+        agent->stats.dropped++;
+        return;
+    }
+    memcpy(client->key, &cookie[key_offset], XRCE_CLIENT_KEY_SIZE);
+    client->output_sequence = 0;
+    client->data_sequence = 0;
+    client->fragments_length = 0;
+    agent->stats.sessions++;
+
+    // STATUS_AGENT: the result followed by the AGENT_Representation
+    reply[0] = XRCE_STATUS_OK;
+    memcpy(&reply[2], xrce_cookie, sizeof(xrce_cookie));
+    reply[6] = 1;
+    reply[8] = 0x0F;
+    reply[9] = 0x0F;
+    if (client->with_timestamp) {
+        struct timespec now;
+        (void) clock_gettime(CLOCK_REALTIME, &now);
+        write_uint32(&reply[12], (uint32_t)now.tv_sec);
+        write_uint32(&reply[16], (uint32_t)now.tv_nsec);
+        reply_length = 21;
+    }
+    send_submessage(agent, client, XRCE_STREAM_NONE, XRCE_STATUS_AGENT, reply, reply_length);
+}
+
+/* Answers a CREATE or DELETE with STATUS_OK for the same request and object */
+static void on_object_request(mock_agent_t * agent, mock_agent_client_t * client, const uint8_t * payload,
+        size_t length, uint8_t is_creation) {
+    uint8_t reply[6] = {0};
+    if (length < 4) {
+        agent->stats.dropped++;
+        return;
+    }
+    memcpy(reply, payload, 4);
+    reply[4] = XRCE_STATUS_OK;
+    if (is_creation) {
+        agent->stats.entities++;
+    }
+    send_submessage(agent, client, XRCE_STREAM_BUILTIN_RELIABLE, XRCE_STATUS, reply, sizeof(reply));
+}
+
+static void on_write_data(mock_agent_t * agent, mock_agent_client_t * client, uint8_t flags, const uint8_t * payload,
+        size_t length) {
+    uint32_t topic_length = 0;
+    if (0 != (flags & XRCE_FLAG_FORMAT_MASK) || length < XRCE_WRITE_DATA_HEADER_SIZE) {
+        agent->stats.dropped++;
+        return;
+    }
+    topic_length = read_uint32(&payload[4], flags & XRCE_FLAG_LITTLE_ENDIAN);
+    if (topic_length > length - XRCE_WRITE_DATA_HEADER_SIZE) {
+        agent->stats.dropped++;
+        return;
+    }
+    agent->stats.samples++;
+    agent->stats.sample_bytes += topic_length;
+    if (NULL != agent->on_data) {
+        agent->on_data(agent->on_data_args, read_uint32(client->key, 0), &payload[XRCE_WRITE_DATA_HEADER_SIZE],
+                topic_length);
+    }
+}
+
+static void handle_submessages(mock_agent_t * agent, mock_agent_client_t * client, const uint8_t * data,
+        size_t length);
+
+static void on_fragment(mock_agent_t * agent, mock_agent_client_t * client, uint8_t flags, const uint8_t * payload,
+        size_t length) {
+    agent->stats.fragments++;
+    if (client->fragments_length + length > sizeof(client->fragments)) {
+        client->fragments_length = 0;
+        agent->stats.dropped++;
+        return;
+    }
+    memcpy(&client->fragments[client->fragments_length], payload, length);
+    client->fragments_length += length;
+    if (0 != (flags & XRCE_FLAG_LAST_FRAGMENT)) {
+        // The fragments carry a whole submessage, subheader included
+        size_t fragments_length = client->fragments_length;
+        client->fragments_length = 0;
+        handle_submessages(agent, client, client->fragments, fragments_length);
+    }
+}
+
+static void handle_submessages(mock_agent_t * agent, mock_agent_client_t * client, const uint8_t * data,
+        size_t length) {
+    size_t offset = 0;
+    while (offset + XRCE_SUBHEADER_SIZE <= length) {
+        uint8_t id = data[offset];
+        uint8_t flags = data[offset + 1];
+        size_t submessage_length = read_uint16(&data[offset + 2], 1);
+        const uint8_t * payload = &data[offset + XRCE_SUBHEADER_SIZE];
+        if (offset + XRCE_SUBHEADER_SIZE + submessage_length > length) {
+            agent->stats.dropped++;
+            return;
+        }
+
+        switch (id) {
+        case XRCE_CREATE_CLIENT:
+            on_create_client(agent, client, payload, submessage_length);
+            break;
+        case XRCE_CREATE:
+        case XRCE_DELETE:
+            on_object_request(agent, client, payload, submessage_length, XRCE_CREATE == id);
+            break;
+        case XRCE_WRITE_DATA:
+            on_write_data(agent, client, flags, payload, submessage_length);
+            break;
+        case XRCE_FRAGMENT:
+            on_fragment(agent, client, flags, payload, submessage_length);
+            break;
+        case XRCE_HEARTBEAT:
+            if (submessage_length >= 5) {
+                uint16_t last_unacked = read_uint16(&payload[2], flags & XRCE_FLAG_LITTLE_ENDIAN);
+                send_acknack(agent, client, payload[4], (uint16_t)(last_unacked + 1));
+            }
+            break;
+        default:
+            // ACKNACKs are not needed since nothing is retransmitted, and datareaders are never fed
+            break;
+        }
+        offset = align_to_4(offset + XRCE_SUBHEADER_SIZE + submessage_length);
+    }
+}
+
+static mock_agent_client_t * find_client(mock_agent_t * agent, const struct sockaddr_in * address, uint8_t create) {
+    mock_agent_client_t * free_client = NULL;
+    for (size_t i = 0; i < MOCK_AGENT_MAX_CLIENTS; ++i) {
+        mock_agent_client_t * client = &agent->clients[i];
+        if (client->is_used && client->address.sin_port == address->sin_port
+                && client->address.sin_addr.s_addr == address->sin_addr.s_addr) {
+            return client;
+        } else if (!client->is_used && NULL == free_client) {
+            free_client = client;
+        }
+    }
+    if (create && NULL != free_client) {
+        memset(free_client, 0, sizeof(*free_client));
+        free_client->is_used = 1;
+        free_client->address = *address;
+    }
+    return create ? free_client : NULL;
+}
+
+static void handle_message(mock_agent_t * agent, const struct sockaddr_in * address, const uint8_t * message,
+        size_t length) {
+    size_t offset = XRCE_HEADER_SIZE;
+    mock_agent_client_t * client = NULL;
+    if (length < XRCE_HEADER_SIZE) {
+        agent->stats.dropped++;
+        return;
+    }
+    uint8_t session_id = message[0];
+    uint8_t stream_id = message[1];
+    uint16_t sequence = read_uint16(&message[2], 1);
+    if (session_id < XRCE_SESSION_ID_WITHOUT_KEY) {
+        offset += XRCE_CLIENT_KEY_SIZE;
+    }
+    if (length < offset + XRCE_SUBHEADER_SIZE) {
+        agent->stats.dropped++;
+        return;
+    }
+
+    // Only a CREATE_CLIENT opens a session for a new address
+    client = find_client(agent, address, XRCE_CREATE_CLIENT == message[offset]);
+    if (NULL == client) {
+        agent->stats.dropped++;
+        return;
+    }
+    client->session_id = session_id;
+    if (session_id < XRCE_SESSION_ID_WITHOUT_KEY) {
+        memcpy(client->key, &message[XRCE_HEADER_SIZE], XRCE_CLIENT_KEY_SIZE);
+    }
+
+    handle_submessages(agent, client, &message[offset], length - offset);
+    if (stream_id >= XRCE_STREAM_BUILTIN_RELIABLE) {
+        send_acknack(agent, client, stream_id, (uint16_t)(sequence + 1));
+    }
+}
+
+rcluc_ret_t mock_agent_open(mock_agent_t * agent, uint16_t port, mock_agent_data_func_t on_data, void * on_data_args) {
+    struct sockaddr_in address;
+    int receive_buffer_size = 4 * 1024 * 1024;
+    if (NULL == agent) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    memset(agent, 0, sizeof(*agent));
+    agent->on_data = on_data;
+    agent->on_data_args = on_data_args;
+    agent->socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (agent->socket < 0) {
+        return RCLUC_RET_ERROR;
+    }
+    // Hundreds of clients flushing at once overflow the default socket buffer
+    (void) setsockopt(agent->socket, SOL_SOCKET, SO_RCVBUF, &receive_buffer_size, sizeof(receive_buffer_size));
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (0 != bind(agent->socket, (const struct sockaddr *)&address, sizeof(address))) {
+        (void) close(agent->socket);
+        agent->socket = -1;
+        return RCLUC_RET_ERROR;
+    }
+    return RCLUC_RET_OK;
+}
+
+rcluc_ret_t mock_agent_spin_once(mock_agent_t * agent, uint32_t timeout_ms) {
+    uint8_t message[MOCK_AGENT_MESSAGE_SIZE];
+    struct pollfd poll_fd;
+    rcluc_ret_t status = RCLUC_RET_TIMEOUT;
+    if (NULL == agent) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (agent->socket < 0) {
+        return RCLUC_RET_ERR_INIT;
+    }
+
+    poll_fd.fd = agent->socket;
+    poll_fd.events = POLLIN;
+    if (poll(&poll_fd, 1, (int)timeout_ms) <= 0) {
+        return RCLUC_RET_TIMEOUT;
+    }
+    for (;;) {
+        struct sockaddr_in address;
+        socklen_t address_length = sizeof(address);
+        ssize_t length = recvfrom(agent->socket, message, sizeof(message), MSG_DONTWAIT, (struct sockaddr *)&address,
+                &address_length);
+        if (length < 0) {
+            break;
+        }
+        handle_message(agent, &address, message, (size_t)length);
+        status = RCLUC_RET_OK;
+    }
+    return status;
+}
+
+rcluc_ret_t mock_agent_write_data(mock_agent_t * agent, uint32_t client_key, uint8_t stream_id, uint16_t object_id,
+        const uint8_t * data, size_t length, size_t fragment_length) {
+    uint8_t submessage[XRCE_SUBHEADER_SIZE + XRCE_WRITE_DATA_HEADER_SIZE + MOCK_AGENT_MESSAGE_SIZE];
+    mock_agent_client_t * client = NULL;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL == agent || (NULL == data && length > 0)) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (length > MOCK_AGENT_MESSAGE_SIZE) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    for (size_t i = 0; i < MOCK_AGENT_MAX_CLIENTS && NULL == client; ++i) {
+        if (agent->clients[i].is_used && client_key == read_uint32(agent->clients[i].key, 0)) {
+            client = &agent->clients[i];
+        }
+    }
+    if (NULL == client) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+
+    // DATA: the request id 0, the object id and the length of the sample in front of it, like WRITE_DATA
+    size_t payload_length = XRCE_WRITE_DATA_HEADER_SIZE + length;
+    submessage[0] = XRCE_DATA;
+    submessage[1] = XRCE_FLAG_LITTLE_ENDIAN;
+    write_uint16(&submessage[2], (uint16_t)payload_length);
+    memset(&submessage[XRCE_SUBHEADER_SIZE], 0, 2);
+    submessage[XRCE_SUBHEADER_SIZE + 2] = (uint8_t)(object_id >> 8);
+    submessage[XRCE_SUBHEADER_SIZE + 3] = (uint8_t)object_id;
+    write_uint32(&submessage[XRCE_SUBHEADER_SIZE + 4], (uint32_t)length);
+    memcpy(&submessage[XRCE_SUBHEADER_SIZE + XRCE_WRITE_DATA_HEADER_SIZE], data, length);
+    if (0 == fragment_length || payload_length <= fragment_length) {
+        return send_numbered(agent, client, stream_id, client->data_sequence++, XRCE_DATA, XRCE_FLAG_LITTLE_ENDIAN,
+                &submessage[XRCE_SUBHEADER_SIZE], payload_length);
+    }
+
+    // The fragments carry the whole submessage, subheader included
+    size_t total = XRCE_SUBHEADER_SIZE + payload_length;
+    for (size_t offset = 0; offset < total && RCLUC_RET_OK == status; offset += fragment_length) {
+        size_t chunk = (total - offset < fragment_length) ? total - offset : fragment_length;
+        uint8_t flags = XRCE_FLAG_LITTLE_ENDIAN;
+        if (offset + chunk == total) {
+            flags |= XRCE_FLAG_LAST_FRAGMENT;
+        }
+        status = send_numbered(agent, client, stream_id, client->data_sequence++, XRCE_FRAGMENT, flags,
+                &submessage[offset], chunk);
+    }
+    return status;
+}
+
+void mock_agent_close(mock_agent_t * agent) {
+    if (NULL != agent && agent->socket >= 0) {
+        (void) close(agent->socket);
+        agent->socket = -1;
+        memset(agent->clients, 0, sizeof(agent->clients));
+    }
+}
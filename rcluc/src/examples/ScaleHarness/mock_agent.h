@@ -0,0 +1,133 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief A minimal DDS-XRCE agent over local UDP for exercising many clients at once
+ *
+ *  The mock agent accepts sessions, answers every entity creation and deletion with STATUS_OK, acknowledges the
+ *  reliable streams of its clients, and hands every sample written with WRITE_DATA to a callback, reassembling the
+ *  samples that arrive as fragments. It keeps no DDS state: data only goes to a datareader when the application calls
+ *  mock_agent_write_data, and nothing it sends is retransmitted, which is fine over the loopback interface it is meant
+ *  for.
+ *
+ *  Experimental: the unit tests check the mock agent against the XRCE submessages of rmwu_xrce.c, but it has not been
+ *  run against the micro-RTPS client library, so ScaleHarness is only built with -DRCLUC_SCALE_HARNESS=ON.
+ */
+
+#ifndef RCLUC__MOCK_AGENT_H_
+#define RCLUC__MOCK_AGENT_H_
+
+#include "rcluc/rcluc_types.h"
+#include <netinet/in.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ *  @brief The largest number of clients the mock agent keeps a session for
+ */
+#define MOCK_AGENT_MAX_CLIENTS          256
+
+/**
+ *  @brief The largest XRCE message, and the largest sample reassembled from fragments
+ */
+#define MOCK_AGENT_MESSAGE_SIZE         2048
+
+/**
+ *  @brief Receives a sample written by a client
+ *
+ *  @param args The on_data_args given to mock_agent_open
+ *  @param client_key The key of the client that wrote the sample
+ *  @param data The serialized sample
+ *  @param length The length (in bytes) of the serialized sample
+ */
+typedef void (*mock_agent_data_func_t)(void * args, uint32_t client_key, const uint8_t * data, size_t length);
+
+typedef struct {
+    uint8_t is_used;
+    struct sockaddr_in address;
+    uint8_t session_id;
+    uint8_t key[4];
+    uint8_t with_timestamp;
+    uint16_t output_sequence;
+    uint16_t data_sequence;
+    uint8_t fragments[MOCK_AGENT_MESSAGE_SIZE];
+    size_t fragments_length;
+} mock_agent_client_t;
+
+/**
+ *  @struct mock_agent_stats_t
+ *  @brief Counters of what the mock agent received
+ */
+typedef struct {
+    size_t sessions;
+    size_t entities;
+    size_t samples;
+    size_t sample_bytes;
+    size_t fragments;
+    size_t dropped;
+} mock_agent_stats_t;
+
+typedef struct {
+    int socket;
+    mock_agent_client_t clients[MOCK_AGENT_MAX_CLIENTS];
+    mock_agent_data_func_t on_data;
+    void * on_data_args;
+    mock_agent_stats_t stats;
+} mock_agent_t;
+
+/**
+ *  @brief Opens the agent's UDP socket on the loopback interface
+ *
+ *  @param agent The agent to open
+ *  @param port The UDP port the clients send to
+ *  @param on_data The function to invoke for every sample written by a client. May be NULL.
+ *  @param on_data_args The argument given to on_data
+ *  @return Returns an error code that will be RCLUC_RET_OK if the socket was opened
+ */
+rcluc_ret_t mock_agent_open(mock_agent_t * agent, uint16_t port, mock_agent_data_func_t on_data, void * on_data_args);
+
+/**
+ *  @brief Handles the messages received by the agent until none arrives for timeout_ms
+ *
+ *  @param agent The agent
+ *  @param timeout_ms The time (in milliseconds) to wait for a message
+ *  @return Returns an error code that will be RCLUC_RET_OK if at least one message was handled, or RCLUC_RET_TIMEOUT
+ */
+rcluc_ret_t mock_agent_spin_once(mock_agent_t * agent, uint32_t timeout_ms);
+
+/**
+ *  @brief Sends a sample to a datareader of a client in a DATA submessage on one of the client's reliable input
+ *  streams. A sample whose submessage is longer than fragment_length goes as FRAGMENT submessages of at most
+ *  fragment_length bytes, each in a message of its own.
+ *
+ *  @param agent The agent
+ *  @param client_key The key of the client
+ *  @param stream_id The reliable input stream of the client that its datareader requested data on
+ *  @param object_id The datareader, as the 12 bit id followed by the 4 bit entity kind
+ *  @param data The serialized sample
+ *  @param length The length (in bytes) of the serialized sample, at most MOCK_AGENT_MESSAGE_SIZE
+ *  @param fragment_length The largest fragment (in bytes), 0 to always send the submessage whole
+ *  @return Returns an error code that will be RCLUC_RET_OK if the sample was sent
+ */
+rcluc_ret_t mock_agent_write_data(mock_agent_t * agent, uint32_t client_key, uint8_t stream_id, uint16_t object_id,
+    const uint8_t * data, size_t length, size_t fragment_length);
+
+/**
+ *  @brief Closes the agent's socket and forgets its clients
+ */
+void mock_agent_close(mock_agent_t * agent);
+
+#endif /* ifndef RCLUC__MOCK_AGENT_H_ */
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Configuration for running the scale harness with many clients in one process
+ *
+ *  Pass it with -DRCLUC_CONFIG_HEADER=<path to this file>. Each client is a session with one node and one publisher,
+ *  which keeps the entity tables of the library within their 8 bit name index. A spin does not wait for incoming data
+ *  so that a round over all the clients is not paced by the spin timeout.
+ */
+
+#ifndef RCLUC__RCLUC_SCALE_CONFIG_H_
+#define RCLUC__RCLUC_SCALE_CONFIG_H_
+
+#define configRCLUC_MAX_SESSIONS            100
+#define configRCLUC_MAX_NUM_NODES           100
+#define configRCLUC_MAX_PUBLISHERS_PER_NODE 1
+#define configRCLUC_ENABLE_SUBSCRIPTIONS    0
+#define configRCLUC_ENABLE_SERVICES         0
+#define configRCLUC_SPIN_TIMEOUT_MS         0
+
+#endif /* ifndef RCLUC__RCLUC_SCALE_CONFIG_H_ */
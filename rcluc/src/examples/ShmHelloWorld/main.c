@@ -0,0 +1,140 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief An example of a publisher and a subscriber in two processes of the same host, over shared memory
+ *
+ *  Usage: ShmHelloWorld pub [count] | ShmHelloWorld sub [count] [log]
+ *
+ *  Needs the library built with -DRCLUC_RMWU_BACKEND=shm. Start the subscriber first, it only receives the samples
+ *  published after it was created. Both stop after count samples, or run forever without it. With the library built
+ *  with -DRCLUC_RECORDER=ON the subscriber records what it receives into the log file, for TrafficReplay.
+ */
+
+#include "rcluc/rcluc.h"
+#include "rcluc/rcluc_record.h"
+#include "rcluc_HelloWorld.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !configRCLUC_RMWU_SHM
+#error "The shared memory example needs the library built with RCLUC_RMWU_BACKEND=shm"
+#endif
+
+#define MAX_MESSAGES_IN_BUFFER      2
+#define TIME_BETWEEN_PUBLISH_NS     100000000
+#define RECORD_LOG_SIZE             (1024 * 1024)
+
+static unsigned long received = 0;
+
+static void on_hello_world(const rcluc_subscription_handle_t subscription, const void * message, const void * args) {
+    (void) args;
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT == RCLUC_SUBSCRIPTION_DESERIALIZATION_DISABLED
+    // The fields are read in place, within the serialized length of the message
+    rcluc_message_info_t info;
+    uint32_t index;
+    const char * text;
+    if (RCLUC_RET_OK != rcluc_subscription_get_message_info(subscription, &info)
+            || RCLUC_RET_OK != rcluc_HelloWorld_cdr_get_index(message, info.serialized_length, &index)
+            || RCLUC_RET_OK != rcluc_HelloWorld_cdr_get_message(message, info.serialized_length, &text)) {
+        return;
+    }
+#else
+    (void) subscription;
+    const rcluc_HelloWorld_t * hello_world = (const rcluc_HelloWorld_t *)message;
+    uint32_t index = hello_world->index;
+    const char * text = hello_world->message;
+#endif
+    printf("Received %u: %s\n", (unsigned int)index, text);
+    received++;
+}
+
+static rcluc_ret_t run_publisher(rcluc_node_handle_t node, unsigned long count) {
+    static uint8_t buffer[MAX_MESSAGES_IN_BUFFER * sizeof(rcluc_HelloWorld_t)];
+    struct timespec period = {0, TIME_BETWEEN_PUBLISH_NS};
+    rcluc_publisher_config_t publisher_config;
+    rcluc_publisher_handle_t publisher;
+    rcluc_HelloWorld_t hello_world = {0};
+    strncpy(hello_world.message, "Hello World over shared memory!", sizeof(hello_world.message) - 1);
+
+    rcluc_publisher_get_default_config(&publisher_config);
+    rcluc_ret_t err = rcluc_publisher_create(node, rcluc_HelloWorld_get_type_support(), "HelloWorldTopic",
+        MAX_MESSAGES_IN_BUFFER, buffer, &publisher_config, &publisher);
+    while (RCLUC_RET_OK == err && (0 == count || hello_world.index < count)) {
+        hello_world.index++;
+        err = rcluc_publisher_publish(publisher, &hello_world);
+        rcluc_node_spin_once(node);
+        (void) nanosleep(&period, NULL);
+    }
+    return err;
+}
+
+static rcluc_ret_t run_subscriber(rcluc_node_handle_t node, unsigned long count, const char * log) {
+    static uint8_t buffer[RCLUC_SUBSCRIPTION_BUFFER_SIZE(RCLUC_HELLOWORLD_MAX_SERIALIZED_SIZE, MAX_MESSAGES_IN_BUFFER)];
+    rcluc_subscription_config_t subscription_config;
+    rcluc_subscription_handle_t subscription;
+
+    rcluc_subscription_get_default_config(&subscription_config);
+    rcluc_ret_t err = rcluc_subscription_create(node, rcluc_HelloWorld_get_type_support(), "HelloWorldTopic",
+        on_hello_world, MAX_MESSAGES_IN_BUFFER, buffer, &subscription_config, &subscription);
+#if configRCLUC_ENABLE_RECORDER
+    if (RCLUC_RET_OK == err && NULL != log) {
+        err = rcluc_record_start_file(log, RECORD_LOG_SIZE);
+    }
+#else
+    (void) log;
+#endif
+    while (RCLUC_RET_OK == err && (0 == count || received < count)) {
+        rcluc_node_spin_once(node);
+    }
+#if configRCLUC_ENABLE_RECORDER
+    if (NULL != log) {
+        (void) rcluc_record_stop(NULL);
+    }
+#endif
+    return err;
+}
+
+int main(int argc, char ** argv) {
+    rcluc_client_config_t client_config = {0};
+    rcluc_node_handle_t node;
+    unsigned long count = 0;
+    rcluc_ret_t err = RCLUC_RET_OK;
+
+    if (argc < 2 || (0 != strcmp(argv[1], "pub") && 0 != strcmp(argv[1], "sub"))) {
+        printf("Usage: %s pub [count] | sub [count] [log]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 2) {
+        count = strtoul(argv[2], NULL, 0);
+    }
+
+    // No transport to set up, the topics are shared memory segments of this host
+    err = rcluc_init(&client_config);
+    if (RCLUC_RET_OK == err) {
+        err = rcluc_node_create(('p' == argv[1][0]) ? "ShmHelloWorldPublisher" : "ShmHelloWorldSubscriber", "", &node);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = ('p' == argv[1][0]) ? run_publisher(node, count)
+            : run_subscriber(node, count, (argc > 3) ? argv[3] : NULL);
+    }
+    if (RCLUC_RET_OK != err) {
+        printf("File: %s, $Line: %d, Error: %d\n", __FILE__, __LINE__, err);
+    }
+    return err;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Publishes the samples of one topic of a log recorded with rcluc_record.h, for the subscriptions of other
+ *  processes of the same host
+ *
+ *  Usage: TrafficReplay <log> <topic> [speed percent]
+ *
+ *  Needs the library built with -DRCLUC_RMWU_BACKEND=shm -DRCLUC_RECORDER=ON. The speed is relative to the recorded
+ *  timing, 100 by default, and 0 publishes as fast as possible. Both the published and the received samples of the
+ *  topic are replayed, and the source timestamps are those of the replay. `ShmHelloWorld sub 20 hello.log` records a
+ *  log to try it with.
+ */
+
+#include "rcluc/rcluc.h"
+#include "rcluc/rcluc_record.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !configRCLUC_RMWU_SHM || !configRCLUC_ENABLE_RECORDER
+#error "The replay example needs the library built with RCLUC_RMWU_BACKEND=shm and RCLUC_RECORDER=ON"
+#endif
+
+#define REPLAY_DEFAULT_SPEED_PERCENT    100
+#define REPLAY_POLL_PERIOD_NS           100000
+
+/* Finds the type of the topic and the size of its largest sample, which sizes the shared memory slots */
+static rcluc_ret_t scan_topic(const char * path, const char * topic_name, rcluc_message_type_support_t * message_type,
+        uint8_t * flags) {
+    rcluc_replay_t replay = {0};
+    rcluc_record_t record;
+    rcluc_ret_t status = rcluc_replay_open_file(&replay, path, 0);
+    message_type->type_name = NULL;
+    message_type->max_serialized_size = 0;
+    while (RCLUC_RET_OK == status && RCLUC_RET_OK == (status = rcluc_replay_next(&replay, &record))) {
+        if (0 == strcmp(record.topic_name, topic_name)) {
+            size_t prefix = (record.flags & RCLUC_RECORD_FLAG_SOURCE_TIMESTAMP) ? RCLUC_SOURCE_TIMESTAMP_SIZE : 0;
+            // The type name is in the log, which is mapped again for the replay itself
+            if (NULL == message_type->type_name) {
+                message_type->type_name = strdup(record.type_name);
+            }
+            *flags = record.flags;
+            if (record.length - prefix > message_type->max_serialized_size) {
+                message_type->max_serialized_size = record.length - prefix;
+            }
+        }
+    }
+    rcluc_replay_close(&replay);
+    if (RCLUC_RET_NO_DATA != status) {
+        return status;
+    }
+    return (NULL == message_type->type_name) ? RCLUC_RET_NO_DATA : RCLUC_RET_OK;
+}
+
+int main(int argc, char ** argv) {
+    static rcluc_message_type_support_t message_type = {0};
+    static uint8_t buffer[1];
+    struct timespec period = {0, REPLAY_POLL_PERIOD_NS};
+    rcluc_client_config_t client_config = {0};
+    rcluc_publisher_config_t publisher_config;
+    rcluc_publisher_handle_t publisher;
+    rcluc_node_handle_t node;
+    rcluc_replay_t replay = {0};
+    rcluc_record_t record;
+    uint32_t speed_percent = REPLAY_DEFAULT_SPEED_PERCENT;
+    unsigned long published = 0;
+    uint8_t flags = 0;
+
+    if (argc < 3) {
+        printf("Usage: %s <log> <topic> [speed percent]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 3) {
+        speed_percent = (uint32_t)strtoul(argv[3], NULL, 0);
+    }
+
+    rcluc_ret_t err = scan_topic(argv[1], argv[2], &message_type, &flags);
+    if (RCLUC_RET_NO_DATA == err) {
+        printf("No sample of %s in %s\n", argv[2], argv[1]);
+        return 1;
+    }
+    if (RCLUC_RET_OK == err) {
+        err = rcluc_init(&client_config);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = rcluc_node_create("TrafficReplay", "", &node);
+    }
+    if (RCLUC_RET_OK == err) {
+        // The samples are published as they were recorded, the publisher only puts a new timestamp in front
+        rcluc_publisher_get_default_config(&publisher_config);
+        publisher_config.source_timestamp = (flags & RCLUC_RECORD_FLAG_SOURCE_TIMESTAMP) ? 1 : 0;
+        err = rcluc_publisher_create(node, &message_type, argv[2], 1, buffer, &publisher_config, &publisher);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = rcluc_replay_open_file(&replay, argv[1], speed_percent);
+    }
+
+    while (RCLUC_RET_OK == err) {
+        rcluc_ret_t status = rcluc_replay_next(&replay, &record);
+        if (RCLUC_RET_TIMEOUT == status) {
+            (void) nanosleep(&period, NULL);
+        } else if (RCLUC_RET_NO_DATA == status) {
+            break;
+        } else if (RCLUC_RET_OK == status && 0 == strcmp(record.topic_name, argv[2])) {
+            size_t prefix = publisher_config.source_timestamp ? RCLUC_SOURCE_TIMESTAMP_SIZE : 0;
+            err = rcluc_publisher_publish_serialized(publisher, record.data + prefix, record.length - prefix);
+            published++;
+        }
+    }
+    rcluc_replay_close(&replay);
+
+    if (RCLUC_RET_OK != err) {
+        printf("File: %s, $Line: %d, Error: %d\n", __FILE__, __LINE__, err);
+    } else {
+        printf("Replayed %lu samples of %s\n", published, argv[2]);
+    }
+    return err;
+}
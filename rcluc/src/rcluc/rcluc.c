@@ -19,48 +19,552 @@
  */
 
 #include "rcluc/rcluc.h"
+#include "rcluc/rcluc_cdr.h"
 #include "rcluc/rmwu.h"
 #include "rcluc/rcluc_types.h"
 #include "rcluc/rmwu_types.h"
+#include "rcluc_internal.h"
+#include <stdio.h>
 #include <string.h>
 
-struct rcluc_subscription_s {
-    uint8_t is_used;
-    rmwu_subscription_t rmwu_subscription;
-    void * user_metadata;
-};
-
-struct rcluc_publisher_s {
-    uint8_t is_used;
-    rmwu_publisher_t rmwu_publisher;
-    void * user_metadata;
-};
-
-struct rcluc_node_s {
-    uint8_t is_used;
-    rmwu_node_t rmwu_node;
-    struct rcluc_subscription_s subscriptions[configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE];
-    struct rcluc_publisher_s publishers[configRCLUC_MAX_PUBLISHERS_PER_NODE];
-};
-
+static struct rcluc_session_s sessions[configRCLUC_MAX_SESSIONS] = {0};
 static struct rcluc_node_s nodes[configRCLUC_MAX_NUM_NODES] = {0};
+static uint8_t batch_active = 0;
+
+#if configRCLUC_ENABLE_SUBSCRIPTIONS
+static void subscription_exception(rcluc_subscription_handle_t subscription, rcluc_ret_t error) {
+    if (NULL != subscription->exception_callback) {
+        subscription->exception_callback(subscription, error);
+    }
+}
+
+/* Evaluates the content filter of a subscription on a serialized sample that still has its source timestamp */
+static uint8_t subscription_filter_match(rcluc_subscription_handle_t subscription, const uint8_t * data,
+        size_t length) {
+    size_t prefix = subscription->source_timestamp ? RCLUC_SOURCE_TIMESTAMP_SIZE : 0;
+    if (length < prefix) {
+        return 0;
+    }
+    return rcluc_filter_match(subscription->filter, &data[prefix], length - prefix);
+}
+
+/* Writes a sample of a mailbox subscription into the entry that does not hold the latest sample. The sequence
+ * counter of the entry is odd from the first fragment until the sample is complete, then the entry is published as the
+ * latest one. */
+static rcluc_ret_t subscription_mailbox_write(rcluc_subscription_handle_t subscription, const uint8_t * data,
+        size_t offset, size_t length, size_t total_length, uint32_t flags) {
+    rcluc_queue_t * queue = &subscription->queue;
+    rcluc_subscription_slot_header_t header = {0};
+    uint32_t entry = (RCLUC_MAILBOX_EMPTY == subscription->mailbox_latest) ? 0 : 1 - subscription->mailbox_latest;
+    uint32_t sequence = subscription->mailbox_sequence[entry];
+    uint8_t * slot = &queue->buffer[entry * queue->slot_size];
+
+    if (total_length > queue->slot_size - sizeof(header) || offset + length > total_length) {
+        queue->receiving_length = 0;
+        return RCLUC_RET_ERR_SPACE;
+    }
+
+    if (0 == offset) {
+        if (0 == (sequence & 1u)) {
+            RCLUC_ATOMIC_STORE(subscription->mailbox_sequence[entry], sequence + 1);
+            RCLUC_ATOMIC_FENCE();
+        }
+        queue->receiving_length = total_length;
+        queue->receiving_flags = flags;
+    } else if (queue->receiving_length != total_length) {
+        // A fragment of a sample whose start was dropped
+        return RCLUC_RET_ERROR;
+    }
+
+    memcpy(&slot[sizeof(header) + offset], data, length);
+    if (offset + length < total_length) {
+        return RCLUC_RET_OK;
+    }
+
+    queue->receiving_length = 0;
+    // A sample that does not match stays unpublished, the entry is simply written again by the next sample
+    if (0 != (queue->receiving_flags & RCLUC_QUEUE_FLAG_UNFILTERED)
+            && !subscription_filter_match(subscription, &slot[sizeof(header)], total_length)) {
+        return RCLUC_RET_OK;
+    }
+    header.length = (uint32_t)total_length;
+    header.reception_timestamp = rmwu_get_time_ns();
+    memcpy(slot, &header, sizeof(header));
+    RCLUC_ATOMIC_STORE(subscription->mailbox_sequence[entry], subscription->mailbox_sequence[entry] + 1);
+    RCLUC_ATOMIC_STORE(subscription->mailbox_latest, entry);
+    return RCLUC_RET_OK;
+}
+
+/* Receives serialized data from the rmwu layer */
+static rcluc_ret_t subscription_on_data(void * args, const uint8_t * data, size_t offset, size_t length,
+        size_t total_length) {
+    rcluc_subscription_handle_t subscription = (rcluc_subscription_handle_t)args;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    uint32_t flags = 0;
+
+    if (NULL != subscription->filter && 0 == offset) {
+        size_t prefix = subscription->source_timestamp ? RCLUC_SOURCE_TIMESTAMP_SIZE : 0;
+        if (length == total_length || length >= prefix + subscription->filter_extent) {
+            // Samples that do not match are dropped before they can push older samples out of the queue
+            if (!subscription_filter_match(subscription, data, length)) {
+                rcluc_queue_discard(&subscription->queue);
+                return RCLUC_RET_OK;
+            }
+        } else {
+            flags = RCLUC_QUEUE_FLAG_UNFILTERED;
+        }
+    }
+
+    if (subscription->mailbox) {
+        status = subscription_mailbox_write(subscription, data, offset, length, total_length, flags);
+    } else {
+        status = rcluc_queue_write(&subscription->queue, data, offset, length, total_length, flags);
+    }
+    if (RCLUC_RET_ERR_SPACE == status) {
+        subscription_exception(subscription, status);
+    }
+    return status;
+}
+
+static void subscription_deliver(rcluc_subscription_handle_t subscription, uint8_t * serialized_message,
+        size_t length) {
+    if (subscription->source_timestamp) {
+        rcluc_cdr_buffer_t buffer;
+        uint64_t source_timestamp = 0;
+        rcluc_cdr_init(&buffer, serialized_message, length);
+        if (RCLUC_RET_OK != rcluc_cdr_deserialize_uint64(&buffer, &source_timestamp)) {
+            subscription_exception(subscription, buffer.error);
+            return;
+        }
+        subscription->message_info.source_timestamp = (int64_t)source_timestamp;
+        serialized_message += RCLUC_SOURCE_TIMESTAMP_SIZE;
+        length -= RCLUC_SOURCE_TIMESTAMP_SIZE;
+    }
+    subscription->message_info.serialized_length = length;
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT == RCLUC_SUBSCRIPTION_DESERIALIZATION_DISABLED
+    subscription->callback(subscription, serialized_message, subscription->user_metadata);
+#else
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT == RCLUC_SUBSCRIPTION_DESERIALIZATION_STATIC_ALLOCATION
+    uint64_t * message = subscription->deserialized_message;
+#else
+    uint64_t message[RCLUC_DESERIALIZED_MESSAGE_WORDS];
+#endif
+    rcluc_ret_t status = subscription->message_type->deserialize(serialized_message, length, message,
+            subscription->message_type->message_size);
+    if (RCLUC_RET_OK == status) {
+        subscription->callback(subscription, message, subscription->user_metadata);
+    } else {
+        subscription_exception(subscription, status);
+    }
+#endif
+}
+
+/* Invokes the callback for the oldest queued message and removes it from the queue */
+static void subscription_dispatch_one(rcluc_subscription_handle_t subscription) {
+    size_t length = 0;
+    int64_t reception_timestamp = 0;
+    uint32_t flags = 0;
+
+    uint8_t * serialized_message = rcluc_queue_peek(&subscription->queue, &length, &reception_timestamp, &flags);
+    subscription->message_info.reception_timestamp = rcluc_time_from_local(reception_timestamp);
+    if (0 == (flags & RCLUC_QUEUE_FLAG_UNFILTERED) || subscription_filter_match(subscription, serialized_message,
+            length)) {
+#if configRCLUC_ENABLE_RECORDER
+        rcluc_record_reception(subscription, serialized_message, length, reception_timestamp);
+#endif
+        subscription->is_delivering = 1;
+        subscription_deliver(subscription, serialized_message, length);
+        subscription->is_delivering = 0;
+    }
+    rcluc_queue_pop(&subscription->queue);
+}
+
+#if configRCLUC_ENABLE_PRIORITY_DISPATCH
+/* A subscription with messages left to dispatch, and the arrival of the oldest of them */
+typedef struct {
+    rcluc_subscription_handle_t subscription;
+    size_t pending;
+    uint16_t arrival;
+} rcluc_dispatch_entry_t;
+
+/* The most urgent subscription first, and the one whose oldest message arrived first within a priority */
+static uint8_t dispatch_entry_precedes(const rcluc_dispatch_entry_t * entry, const rcluc_dispatch_entry_t * other) {
+    if (entry->subscription->priority != other->subscription->priority) {
+        return entry->subscription->priority > other->subscription->priority;
+    }
+    return (int16_t)(uint16_t)(entry->arrival - other->arrival) < 0;
+}
+
+/* Moves an entry down the heap until it precedes both of its children */
+static void dispatch_heap_sift_down(rcluc_dispatch_entry_t * heap, size_t count, size_t index) {
+    for (;;) {
+        size_t first = index;
+        size_t left = (2 * index) + 1;
+        size_t right = left + 1;
+        if (left < count && dispatch_entry_precedes(&heap[left], &heap[first])) {
+            first = left;
+        }
+        if (right < count && dispatch_entry_precedes(&heap[right], &heap[first])) {
+            first = right;
+        }
+        if (first == index) {
+            return;
+        }
+        rcluc_dispatch_entry_t entry = heap[index];
+        heap[index] = heap[first];
+        heap[first] = entry;
+        index = first;
+    }
+}
+
+/* Adds the subscriptions of a node that have messages queued for their callback to the entries to dispatch */
+static size_t dispatch_gather(rcluc_node_handle_t node, rcluc_dispatch_entry_t * heap, size_t count, size_t capacity) {
+    for (size_t i = 0; i < configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE && count < capacity; ++i) {
+        rcluc_subscription_handle_t subscription = &node->subscriptions[i];
+        if (subscription->is_used && NULL != subscription->callback && subscription->queue.count > 0) {
+            heap[count].subscription = subscription;
+            heap[count].pending = subscription->queue.count;
+            heap[count].arrival = rcluc_queue_peek_arrival(&subscription->queue);
+            count++;
+        }
+    }
+    return count;
+}
+
+/*
+ * Invokes the callbacks for the messages that were queued when the dispatch started, the most urgent subscription
+ * first and the oldest message first within a priority. The entries form a heap on the oldest message of each
+ * subscription, so each message costs a logarithm of the number of subscriptions rather than a scan of all of them.
+ */
+static void dispatch_by_priority(rcluc_dispatch_entry_t * heap, size_t count) {
+    for (size_t i = count / 2; i > 0; --i) {
+        dispatch_heap_sift_down(heap, count, i - 1);
+    }
+    while (count > 0) {
+        rcluc_subscription_handle_t subscription = heap[0].subscription;
+        // A callback may have destroyed the subscription
+        if (subscription->is_used && subscription->queue.count > 0) {
+            subscription_dispatch_one(subscription);
+            heap[0].pending--;
+        } else {
+            heap[0].pending = 0;
+        }
+        if (heap[0].pending > 0 && subscription->is_used && subscription->queue.count > 0) {
+            heap[0].arrival = rcluc_queue_peek_arrival(&subscription->queue);
+        } else {
+            heap[0] = heap[--count];
+        }
+        dispatch_heap_sift_down(heap, count, 0);
+    }
+}
+
+/* Invokes the callbacks for the messages that were queued on the node when the dispatch started, by priority */
+static void node_dispatch(rcluc_node_handle_t node) {
+    rcluc_dispatch_entry_t heap[configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE];
+    dispatch_by_priority(heap, dispatch_gather(node, heap, 0, configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE));
+}
+#else
+/* Invokes the callbacks for the messages that were queued when the dispatch started, a subscription at a time */
+static void node_dispatch(rcluc_node_handle_t node) {
+    for (size_t i = 0; i < configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE; ++i) {
+        rcluc_subscription_handle_t subscription = &node->subscriptions[i];
+        if (subscription->is_used && NULL != subscription->callback) {
+            size_t pending = subscription->queue.count;
+            while (pending > 0 && subscription->is_used) {
+                subscription_dispatch_one(subscription);
+                pending--;
+            }
+        }
+    }
+}
+#endif /* configRCLUC_ENABLE_PRIORITY_DISPATCH */
+#endif /* configRCLUC_ENABLE_SUBSCRIPTIONS */
+
+#if configRCLUC_ENABLE_PUBLISHERS
+static void publisher_exception(rcluc_publisher_handle_t publisher, rcluc_ret_t error) {
+    if (NULL != publisher->exception_callback) {
+        publisher->exception_callback(publisher, error);
+    }
+}
+
+/* Drops the messages of a low priority publisher that the congestion of its link does not let through */
+static rcluc_ret_t publisher_admit(rcluc_publisher_handle_t publisher) {
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+    return rcluc_congestion_admit(publisher);
+#else
+    (void) publisher;
+    return RCLUC_RET_OK;
+#endif
+}
+
+/* Hands a message to the transport */
+static rcluc_ret_t publisher_send(rcluc_publisher_handle_t publisher, const void * message) {
+    rcluc_ret_t status = rmwu_publisher_publish(&publisher->rmwu_publisher, message);
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+    rcluc_congestion_report(publisher, status);
+#endif
+#if configRCLUC_ENABLE_RECORDER
+    if (RCLUC_RET_OK == status) {
+        rcluc_record_message(&publisher->record, &publisher->rmwu_publisher, message);
+    }
+#endif
+    return status;
+}
+
+/* Serializes a message that the transport did not take into the publisher's packed queue */
+static rcluc_ret_t publisher_enqueue(rcluc_publisher_handle_t publisher, const void * message) {
+    const rmwu_publisher_t * rmwu_publisher = &publisher->rmwu_publisher;
+    rcluc_cdr_buffer_t buffer;
+    size_t length = rmwu_publisher->message_type->get_serialized_size(message);
+    if (rmwu_publisher->source_timestamp) {
+        length += RCLUC_SOURCE_TIMESTAMP_SIZE;
+    }
+    uint8_t * record = rcluc_packed_queue_reserve(&publisher->queue, length);
+    if (NULL == record) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+
+    rcluc_cdr_init(&buffer, record, length);
+    if (rmwu_publisher->source_timestamp) {
+        (void) rcluc_cdr_serialize_uint64(&buffer, (uint64_t)rmwu_publisher->timestamp);
+    }
+    rcluc_ret_t status = rmwu_publisher->message_type->serialize(message, &buffer);
+    if (RCLUC_RET_OK == status && rcluc_cdr_get_length(&buffer) != length) {
+        status = RCLUC_RET_ERROR;
+    }
+    if (RCLUC_RET_OK == status) {
+        rcluc_packed_queue_commit(&publisher->queue);
+    }
+    return status;
+}
+
+/* Hands the queued messages of a publisher to the transport, in order, until it stops taking them */
+static void publisher_flush(rcluc_publisher_handle_t publisher) {
+    rcluc_buffer_fragment_t fragment;
+    size_t length = 0;
+    uint8_t * record = NULL;
+
+    while (NULL != (record = rcluc_packed_queue_peek(&publisher->queue, &length))) {
+        fragment.data = record;
+        fragment.length = length;
+        if (publisher->rmwu_publisher.source_timestamp) {
+            // The record holds the time of the publish, which goes out instead of the time of the flush
+            rcluc_cdr_buffer_t buffer;
+            uint64_t timestamp = 0;
+            rcluc_cdr_init(&buffer, record, length);
+            (void) rcluc_cdr_deserialize_uint64(&buffer, &timestamp);
+            publisher->rmwu_publisher.timestamp = (int64_t)timestamp;
+            fragment.data += RCLUC_SOURCE_TIMESTAMP_SIZE;
+            fragment.length -= RCLUC_SOURCE_TIMESTAMP_SIZE;
+        }
+        rcluc_ret_t status = rmwu_publisher_publish_fragments(&publisher->rmwu_publisher, &fragment, 1);
+        if (RCLUC_RET_ERR_SPACE == status) {
+            break;
+        } else if (RCLUC_RET_OK != status) {
+            publisher_exception(publisher, status);
+        }
+#if configRCLUC_ENABLE_RECORDER
+        if (RCLUC_RET_OK == status) {
+            rcluc_record_fragments(&publisher->record, &publisher->rmwu_publisher, &fragment, 1);
+        }
+#endif
+        rcluc_packed_queue_pop(&publisher->queue);
+    }
+}
+
+/*
+ * Sends the messages a packed publisher has queued ahead of one that bypasses its queue, so that messages of the same
+ * writer never overtake each other. The new message has to wait if some of them are still queued.
+ */
+static rcluc_ret_t publisher_flush_ahead(rcluc_publisher_handle_t publisher) {
+    if (0 == publisher->packed) {
+        return RCLUC_RET_OK;
+    }
+    if (0 == batch_active) {
+        publisher_flush(publisher);
+    }
+    return (0 == publisher->queue.count) ? RCLUC_RET_OK : RCLUC_RET_ERR_SPACE;
+}
+#endif /* configRCLUC_ENABLE_PUBLISHERS */
+
+rcluc_ret_t rcluc_format_topic_name(const char * prefix, const char * name, const char * suffix, char * topic_name) {
+    if (strlen(name) > configRCLUC_MAX_TOPIC_NAME_LEN) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    // Names are always written relative to the root namespace
+    while ('/' == *name) {
+        ++name;
+    }
+    int length = snprintf(topic_name, RCLUC_DDS_TOPIC_NAME_SIZE, "%s%s%s", prefix, name, suffix);
+    if (length < 0 || length >= RCLUC_DDS_TOPIC_NAME_SIZE) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    return RCLUC_RET_OK;
+}
 
 rcluc_ret_t rcluc_init(const rcluc_client_config_t * config) {
-    return rmwu_init(config);
+    rcluc_ret_t status = RCLUC_RET_OK;
+    memset(sessions, 0, sizeof(sessions));
+    status = rmwu_init(config, &sessions[0].rmwu_session);
+    if (RCLUC_RET_OK == status) {
+        sessions[0].is_used = 1;
+        sessions[0].client_key = config->client_key;
+    }
+    return status;
+}
+
+rcluc_ret_t rcluc_session_create(const rcluc_client_config_t * config, rcluc_session_handle_t * session_handle) {
+    rcluc_session_handle_t new_session = NULL;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL == config || NULL == session_handle) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (0 == sessions[0].is_used) {
+        return RCLUC_RET_ERR_INIT;
+    }
+
+    status = RCLUC_RET_ERR_SPACE;
+    for (size_t i = 0; i < configRCLUC_MAX_SESSIONS && NULL == new_session; ++i) {
+        if (0 == sessions[i].is_used) {
+            new_session = &sessions[i];
+        }
+    }
+
+    if (NULL != new_session) {
+        status = rmwu_session_create(config, &new_session->rmwu_session);
+        if (RCLUC_RET_OK == status) {
+            new_session->is_used = 1;
+            new_session->client_key = config->client_key;
+            *session_handle = new_session;
+        }
+    }
+    return status;
+}
+
+rcluc_ret_t rcluc_restore(void) {
+    return rmwu_restore();
+}
+
+uint8_t rcluc_batch_is_active(void) {
+    return batch_active;
+}
+
+rcluc_ret_t rcluc_batch_begin(void) {
+    rcluc_ret_t status = rmwu_begin_batch();
+    if (RCLUC_RET_OK == status) {
+        batch_active = 1;
+    }
+    return status;
+}
+
+static void batch_report(rcluc_entity_kind_t kind, const void * handle, rcluc_ret_t status,
+        rcluc_entity_status_t * failures, size_t failures_length, size_t * failure_count) {
+    if (*failure_count < failures_length) {
+        failures[*failure_count].kind = kind;
+        failures[*failure_count].handle = handle;
+        failures[*failure_count].status = status;
+    }
+    (*failure_count)++;
+}
+
+/* Settles the pending entities of a node once the batch they were created in is committed */
+static void batch_settle_node(rcluc_node_handle_t node, rcluc_entity_status_t * failures, size_t failures_length,
+        size_t * failure_count) {
+    rcluc_ret_t node_status = node->is_pending ? rmwu_node_get_status(&node->rmwu_node) : RCLUC_RET_OK;
+
+#if configRCLUC_ENABLE_SUBSCRIPTIONS
+    for (size_t i = 0; i < configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE; ++i) {
+        rcluc_subscription_handle_t subscription = &node->subscriptions[i];
+        if (subscription->is_used && subscription->is_pending) {
+            rcluc_ret_t status = rmwu_subscription_get_status(&subscription->rmwu_subscription);
+            subscription->is_pending = 0;
+            if (RCLUC_RET_OK != status) {
+                batch_report(RCLUC_ENTITY_SUBSCRIPTION, subscription, status, failures, failures_length,
+                        failure_count);
+                (void) rcluc_subscription_destroy(subscription);
+            }
+        }
+    }
+#endif
+
+#if configRCLUC_ENABLE_PUBLISHERS
+    for (size_t i = 0; i < configRCLUC_MAX_PUBLISHERS_PER_NODE; ++i) {
+        rcluc_publisher_handle_t publisher = &node->publishers[i];
+        if (publisher->is_used && publisher->is_pending) {
+            rcluc_ret_t status = rmwu_publisher_get_status(&publisher->rmwu_publisher);
+            publisher->is_pending = 0;
+            if (RCLUC_RET_OK != status) {
+                batch_report(RCLUC_ENTITY_PUBLISHER, publisher, status, failures, failures_length, failure_count);
+                (void) rcluc_publisher_destroy(publisher);
+            }
+        }
+    }
+#endif
+
+#if configRCLUC_ENABLE_SERVICES
+    for (size_t i = 0; i < configRCLUC_MAX_CLIENTS_PER_NODE; ++i) {
+        rcluc_client_handle_t client = &node->clients[i];
+        if (client->is_used && client->is_pending) {
+            rcluc_ret_t status = rmwu_client_get_status(&client->rmwu_client);
+            client->is_pending = 0;
+            if (RCLUC_RET_OK != status) {
+                batch_report(RCLUC_ENTITY_CLIENT, client, status, failures, failures_length, failure_count);
+                (void) rcluc_client_destroy(client);
+            }
+        }
+    }
+#endif
+
+    node->is_pending = 0;
+    if (RCLUC_RET_OK != node_status) {
+        batch_report(RCLUC_ENTITY_NODE, node, node_status, failures, failures_length, failure_count);
+        (void) rcluc_node_destroy(node);
+        // The participant never existed on the agent, so failing to delete it must not keep the node alive
+        node->is_used = 0;
+    }
+}
+
+rcluc_ret_t rcluc_batch_commit(rcluc_entity_status_t * failures, size_t failures_length, size_t * failure_count) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    size_t failed = 0;
+    if (NULL == failures && failures_length > 0) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (0 == batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+
+    status = rmwu_commit_batch();
+    batch_active = 0;
+    for (size_t i = 0; i < configRCLUC_MAX_NUM_NODES; ++i) {
+        if (nodes[i].is_used) {
+            batch_settle_node(&nodes[i], failures, failures_length, &failed);
+        }
+    }
+
+    if (NULL != failure_count) {
+        *failure_count = failed;
+    }
+    return status;
 }
 
 rcluc_ret_t rcluc_node_create(const char * name, const char * namespace_, rcluc_node_handle_t * node_handle) {
+    return rcluc_node_create_on_session(&sessions[0], name, namespace_, node_handle);
+}
+
+rcluc_ret_t rcluc_node_create_on_session(rcluc_session_handle_t session_handle, const char * name,
+        const char * namespace_, rcluc_node_handle_t * node_handle) {
     rcluc_node_handle_t new_node = NULL;
     rcluc_ret_t status = RCLUC_RET_OK;
 
     // Check inputs to make sure they're not null
-    if (NULL == name || NULL == namespace_ || NULL == node_handle) {
+    if (NULL == session_handle || NULL == name || NULL == namespace_ || NULL == node_handle) {
         return RCLUC_RET_NULL_PTR;
+    } else if (0 == session_handle->is_used) {
+        return RCLUC_RET_ERR_INIT;
     }
 
     // Find the next free node on the list
     status = RCLUC_RET_ERR_SPACE;
-    for (size_t i = 0; i < configRCLUC_MAX_NUM_NODES; ++i) {
+    for (size_t i = 0; i < configRCLUC_MAX_NUM_NODES && NULL == new_node; ++i) {
         if (0 == nodes[i].is_used) {
             nodes[i].is_used = 1;
             new_node = &nodes[i];
@@ -68,7 +572,12 @@ rcluc_ret_t rcluc_node_create(const char * name, const char * namespace_, rcluc_
     }
 
     if (NULL != new_node) {
-        status = rmwu_node_create(name, namespace_, &(new_node->rmwu_node));
+        new_node->is_pending = batch_active;
+        new_node->session = session_handle;
+    }
+
+    if (NULL != new_node) {
+        status = rmwu_node_create(&session_handle->rmwu_session, name, namespace_, &(new_node->rmwu_node));
 
         // If the node was created successfully then set the return value, otherwise mark the node as free again.
         if (RCLUC_RET_OK == status) {
@@ -100,35 +609,147 @@ rcluc_ret_t rcluc_node_destroy(rcluc_node_handle_t node_handle) {
     return status;
 }
 
+/* Sends what the publishers of a node have queued and services its transport */
+static void node_spin_transport(rcluc_node_handle_t node_handle) {
+#if configRCLUC_ENABLE_PUBLISHERS
+    if (0 == batch_active) {
+        for (size_t i = 0; i < configRCLUC_MAX_PUBLISHERS_PER_NODE; ++i) {
+            if (node_handle->publishers[i].is_used && node_handle->publishers[i].queue.count > 0) {
+                publisher_flush(&node_handle->publishers[i]);
+            }
+        }
+#if configRCLUC_ENABLE_LOGGING
+        rcluc_log_spin(node_handle);
+#endif
+    }
+#endif
+
+    (void) rmwu_node_spin_once(&node_handle->rmwu_node, configRCLUC_SPIN_TIMEOUT_MS);
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+    rcluc_congestion_spin(node_handle);
+#endif
+}
+
+/* Handles the responses received by the service clients of a node */
+static void node_spin_services(rcluc_node_handle_t node_handle) {
+#if configRCLUC_ENABLE_SERVICES
+    for (size_t i = 0; i < configRCLUC_MAX_CLIENTS_PER_NODE; ++i) {
+        if (node_handle->clients[i].is_used) {
+            rcluc_client_spin(&node_handle->clients[i]);
+        }
+    }
+
+    rcluc_time_sync_spin(node_handle);
+#else
+    (void) node_handle;
+#endif
+}
+
 void rcluc_node_spin_once(rcluc_node_handle_t node_handle) {
-    if (NULL == node_handle) {
+    if (NULL == node_handle || 0 == node_handle->is_used) {
         return;
     }
-    //TODO
+    node_spin_transport(node_handle);
+#if configRCLUC_ENABLE_SUBSCRIPTIONS
+    node_dispatch(node_handle);
+#endif
+    node_spin_services(node_handle);
+}
+
+void rcluc_wait_set_spin_once(const rcluc_node_handle_t * node_handles, size_t node_count) {
+    if (NULL == node_handles) {
+        return;
+    }
+    for (size_t i = 0; i < node_count; ++i) {
+        if (NULL != node_handles[i] && node_handles[i]->is_used) {
+            node_spin_transport(node_handles[i]);
+        }
+    }
+
+#if configRCLUC_ENABLE_SUBSCRIPTIONS
+#if configRCLUC_ENABLE_PRIORITY_DISPATCH
+    rcluc_dispatch_entry_t heap[configRCLUC_MAX_NUM_NODES * configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE];
+    size_t count = 0;
+    for (size_t i = 0; i < node_count; ++i) {
+        if (NULL != node_handles[i] && node_handles[i]->is_used) {
+            count = dispatch_gather(node_handles[i], heap, count, sizeof(heap) / sizeof(heap[0]));
+        }
+    }
+    dispatch_by_priority(heap, count);
+#else
+    for (size_t i = 0; i < node_count; ++i) {
+        if (NULL != node_handles[i] && node_handles[i]->is_used) {
+            node_dispatch(node_handles[i]);
+        }
+    }
+#endif /* configRCLUC_ENABLE_PRIORITY_DISPATCH */
+#endif /* configRCLUC_ENABLE_SUBSCRIPTIONS */
 
+    for (size_t i = 0; i < node_count; ++i) {
+        if (NULL != node_handles[i] && node_handles[i]->is_used) {
+            node_spin_services(node_handles[i]);
+        }
+    }
 }
 
 void rcluc_node_spin_forever(rcluc_node_handle_t node_handle) {
     if (NULL == node_handle) {
         return;
     }
-    //TODO
-
+    while (node_handle->is_used) {
+        rcluc_node_spin_once(node_handle);
+    }
 }
 
+#if configRCLUC_ENABLE_SUBSCRIPTIONS
 rcluc_ret_t rcluc_subscription_create(rcluc_node_handle_t node_handle, const rcluc_message_type_support_t * message_type,
         const char * topic_name, rcluc_subscription_callback_t callback, const size_t queue_length, uint8_t *message_buffer,
         const rcluc_subscription_config_t * config, rcluc_subscription_handle_t * subscription_handle) {
 
     rcluc_ret_t status = RCLUC_RET_OK;
     rcluc_subscription_handle_t new_subscription = NULL;
-    if (NULL == node_handle || NULL == message_type || NULL == topic_name || NULL == callback || NULL == message_buffer
-            || NULL == config || NULL == subscription_handle) {
+    rcluc_subscription_config_t default_config;
+    size_t max_serialized_size = 0;
+    size_t filter_extent = 0;
+    char dds_topic_name[RCLUC_DDS_TOPIC_NAME_SIZE];
+    if (NULL == node_handle || NULL == message_type || NULL == topic_name || NULL == message_buffer
+            || NULL == subscription_handle) {
         return RCLUC_RET_NULL_PTR;
     }
+    if (NULL == config) {
+        rcluc_subscription_get_default_config(&default_config);
+        config = &default_config;
+    }
+    // Without a callback messages are taken by the application. A mailbox is read with rcluc_subscription_read_latest,
+    // so it needs no queue length and never invokes a callback.
+    if ((0 == queue_length && 0 == config->mailbox) || (NULL != callback && config->mailbox)) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT != RCLUC_SUBSCRIPTION_DESERIALIZATION_DISABLED
+    if (message_type->message_size > configRCLUC_MAX_MESSAGE_SIZE_BYTES) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+#endif
+
+    max_serialized_size = config->max_serialized_size;
+    if (0 == max_serialized_size) {
+        max_serialized_size = message_type->max_serialized_size;
+    }
+    if (0 == max_serialized_size) {
+        max_serialized_size = configRCLUC_MAX_MESSAGE_SIZE_BYTES;
+    }
+    if (config->source_timestamp) {
+        max_serialized_size += RCLUC_SOURCE_TIMESTAMP_SIZE;
+    }
+    if (NULL != config->filter) {
+        status = rcluc_filter_validate(config->filter, &filter_extent);
+        if (RCLUC_RET_OK != status) {
+            return status;
+        }
+    }
 
     status = RCLUC_RET_ERR_SPACE;
-    for (size_t i = 0; i < configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE; ++i) {
+    for (size_t i = 0; i < configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE && NULL == new_subscription; ++i) {
         if (0 == node_handle->subscriptions[i].is_used) {
             node_handle->subscriptions[i].is_used = 1;
             new_subscription = &node_handle->subscriptions[i];
@@ -136,8 +757,32 @@ rcluc_ret_t rcluc_subscription_create(rcluc_node_handle_t node_handle, const rcl
     }
 
     if (NULL != new_subscription) {
-        status = rmwu_subscription_create(&(node_handle->rmwu_node), message_type, topic_name, callback, queue_length,
-                message_buffer, config, &new_subscription->rmwu_subscription);
+        new_subscription->message_type = message_type;
+        new_subscription->callback = callback;
+        new_subscription->exception_callback = config->exception_callback;
+        new_subscription->is_pending = batch_active;
+        new_subscription->source_timestamp = config->source_timestamp;
+        new_subscription->filter = config->filter;
+        new_subscription->filter_extent = filter_extent;
+        new_subscription->is_delivering = 0;
+        new_subscription->mailbox = config->mailbox;
+        new_subscription->mailbox_sequence[0] = 0;
+        new_subscription->mailbox_sequence[1] = 0;
+        new_subscription->mailbox_latest = RCLUC_MAILBOX_EMPTY;
+#if configRCLUC_ENABLE_PRIORITY_DISPATCH
+        new_subscription->priority = config->priority;
+#endif
+        memset(&new_subscription->message_info, 0, sizeof(new_subscription->message_info));
+        rcluc_queue_init(&new_subscription->queue, message_buffer, config->mailbox ? 2 : queue_length,
+                max_serialized_size);
+        status = rcluc_format_topic_name("rt/", topic_name, "", dds_topic_name);
+        if (RCLUC_RET_OK == status) {
+#if configRCLUC_ENABLE_RECORDER
+            rcluc_record_topic_init(&new_subscription->record, topic_name);
+#endif
+            status = rmwu_subscription_create(&(node_handle->rmwu_node), message_type, dds_topic_name, config,
+                    subscription_on_data, new_subscription, &new_subscription->rmwu_subscription);
+        }
 
         // If the subscription was created successfully then set the return value, otherwise mark it as free again.
         if (RCLUC_RET_OK == status) {
@@ -157,6 +802,11 @@ void rcluc_subscription_get_default_config(rcluc_subscription_config_t * config)
         config->qos.reliability = RCLUC_TOPIC_RELIABILITY_BEST_EFFORT;
         config->exception_callback = NULL;
         config->user_metadata = NULL;
+        config->max_serialized_size = 0;
+        config->source_timestamp = 0;
+        config->filter = NULL;
+        config->mailbox = 0;
+        config->priority = RCLUC_PRIORITY_DEFAULT;
     }
 }
 
@@ -168,6 +818,209 @@ void * rcluc_subscription_get_user_metadata(const rcluc_subscription_handle_t su
     return metadata;
 }
 
+rcluc_ret_t rcluc_subscription_get_message_info(const rcluc_subscription_handle_t subscription_handle,
+        rcluc_message_info_t * message_info) {
+    if (NULL == subscription_handle || NULL == message_info) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    *message_info = subscription_handle->message_info;
+    return RCLUC_RET_OK;
+}
+
+rcluc_ret_t rcluc_subscription_loan_retain(const rcluc_subscription_handle_t subscription_handle, rcluc_loan_t * loan) {
+    size_t length = 0;
+    size_t prefix = 0;
+    uint8_t * serialized_message = NULL;
+    if (NULL == subscription_handle || NULL == loan) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (0 == subscription_handle->is_delivering) {
+        return RCLUC_RET_ERR_INIT;
+    }
+
+    serialized_message = rcluc_queue_peek(&subscription_handle->queue, &length, NULL, NULL);
+    loan->slot = rcluc_queue_retain(&subscription_handle->queue);
+    if (NULL == serialized_message || NULL == loan->slot) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    prefix = subscription_handle->source_timestamp ? RCLUC_SOURCE_TIMESTAMP_SIZE : 0;
+    loan->data = &serialized_message[prefix];
+    loan->length = length - prefix;
+    return RCLUC_RET_OK;
+}
+
+/*
+ * Copies a serialized sample out to the message of the application, deserializing it unless deserialization is
+ * disabled. The source timestamp in front of the sample and its length go to message_info if it is not NULL.
+ */
+static rcluc_ret_t subscription_unpack(const rcluc_subscription_handle_t subscription, uint8_t * serialized_message,
+        size_t length, void * message, size_t message_size, rcluc_message_info_t * message_info) {
+    if (subscription->source_timestamp) {
+        rcluc_cdr_buffer_t buffer;
+        uint64_t source_timestamp = 0;
+        rcluc_cdr_init(&buffer, serialized_message, length);
+        if (RCLUC_RET_OK != rcluc_cdr_deserialize_uint64(&buffer, &source_timestamp)) {
+            return buffer.error;
+        }
+        if (NULL != message_info) {
+            message_info->source_timestamp = (int64_t)source_timestamp;
+        }
+        serialized_message += RCLUC_SOURCE_TIMESTAMP_SIZE;
+        length -= RCLUC_SOURCE_TIMESTAMP_SIZE;
+    }
+    if (NULL != message_info) {
+        message_info->serialized_length = length;
+    }
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT == RCLUC_SUBSCRIPTION_DESERIALIZATION_DISABLED
+    if (length > message_size) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    memcpy(message, serialized_message, length);
+    return RCLUC_RET_OK;
+#else
+    if (message_size < subscription->message_type->message_size) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    return subscription->message_type->deserialize(serialized_message, length, message, message_size);
+#endif
+}
+
+/* Copies a serialized sample of a mailbox out to the message of the application */
+static rcluc_ret_t subscription_mailbox_copy(const rcluc_subscription_handle_t subscription, uint8_t * slot,
+        void * message, size_t message_size, int64_t * reception_timestamp) {
+    rcluc_subscription_slot_header_t header;
+    size_t prefix = subscription->source_timestamp ? RCLUC_SOURCE_TIMESTAMP_SIZE : 0;
+    memcpy(&header, slot, sizeof(header));
+    *reception_timestamp = header.reception_timestamp;
+    // The header may be torn by a concurrent write, which the sequence check catches, but it must not be trusted
+    if (header.length > subscription->queue.slot_size - sizeof(header) || header.length < prefix) {
+        return RCLUC_RET_ERROR;
+    }
+    return subscription_unpack(subscription, &slot[sizeof(header)], header.length, message, message_size, NULL);
+}
+
+rcluc_ret_t rcluc_subscription_read_latest(const rcluc_subscription_handle_t subscription_handle, void * message,
+        size_t message_size, int64_t * age) {
+    rcluc_ret_t status = RCLUC_RET_TIMEOUT;
+    int64_t reception_timestamp = 0;
+    if (NULL == subscription_handle || NULL == message) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (0 == subscription_handle->mailbox) {
+        return RCLUC_RET_ERR_INIT;
+    }
+
+    for (size_t attempt = 0; attempt < RCLUC_MAILBOX_READ_ATTEMPTS; ++attempt) {
+        uint32_t entry = RCLUC_ATOMIC_LOAD(subscription_handle->mailbox_latest);
+        if (RCLUC_MAILBOX_EMPTY == entry) {
+            return RCLUC_RET_NO_DATA;
+        }
+        uint32_t sequence = RCLUC_ATOMIC_LOAD(subscription_handle->mailbox_sequence[entry]);
+        if (0 != (sequence & 1u)) {
+            // The writer took this entry again after a newer sample was published in the other one
+            continue;
+        }
+        status = subscription_mailbox_copy(subscription_handle,
+                &subscription_handle->queue.buffer[entry * subscription_handle->queue.slot_size], message,
+                message_size, &reception_timestamp);
+        RCLUC_ATOMIC_FENCE();
+        if (RCLUC_ATOMIC_LOAD(subscription_handle->mailbox_sequence[entry]) == sequence) {
+            if (RCLUC_RET_OK == status && NULL != age) {
+                *age = rmwu_get_time_ns() - reception_timestamp;
+            }
+            return status;
+        }
+        status = RCLUC_RET_TIMEOUT;
+    }
+    return status;
+}
+
+/* Takes the oldest queued sample that passes the content filter, and returns RCLUC_RET_NO_DATA once there is none */
+static rcluc_ret_t subscription_take(const rcluc_subscription_handle_t subscription, void * message,
+        size_t message_size, rcluc_message_info_t * message_info) {
+    size_t length = 0;
+    int64_t reception_timestamp = 0;
+    uint32_t flags = 0;
+    uint8_t * serialized_message = NULL;
+    rcluc_ret_t status = RCLUC_RET_NO_DATA;
+
+    while (RCLUC_RET_NO_DATA == status
+            && NULL != (serialized_message = rcluc_queue_peek(&subscription->queue, &length, &reception_timestamp,
+                &flags))) {
+        if (0 == (flags & RCLUC_QUEUE_FLAG_UNFILTERED) || subscription_filter_match(subscription, serialized_message,
+                length)) {
+            if (NULL != message_info) {
+                message_info->source_timestamp = 0;
+                message_info->reception_timestamp = rcluc_time_from_local(reception_timestamp);
+            }
+            status = subscription_unpack(subscription, serialized_message, length, message, message_size,
+                    message_info);
+#if configRCLUC_ENABLE_RECORDER
+            if (RCLUC_RET_ERR_SPACE != status) {
+                rcluc_record_reception(subscription, serialized_message, length, reception_timestamp);
+            }
+#endif
+        }
+        // A message the application has no room for stays queued, any other outcome consumes it
+        if (RCLUC_RET_ERR_SPACE != status) {
+            rcluc_queue_pop(&subscription->queue);
+        }
+    }
+    return status;
+}
+
+rcluc_ret_t rcluc_subscription_take(const rcluc_subscription_handle_t subscription_handle, void * message,
+        size_t message_size, rcluc_message_info_t * message_info) {
+    if (NULL == subscription_handle || NULL == message) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (NULL != subscription_handle->callback || subscription_handle->mailbox) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    return subscription_take(subscription_handle, message, message_size, message_info);
+}
+
+rcluc_ret_t rcluc_subscription_take_many(const rcluc_subscription_handle_t subscription_handle, void * messages,
+        size_t message_size, rcluc_message_info_t * message_infos, size_t max_count, size_t * count) {
+    uint8_t * next = (uint8_t *)messages;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL != count) {
+        *count = 0;
+    }
+    if (NULL == subscription_handle || NULL == messages || NULL == count) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (NULL != subscription_handle->callback || subscription_handle->mailbox) {
+        return RCLUC_RET_ERR_INIT;
+    }
+
+    while (*count < max_count) {
+        status = subscription_take(subscription_handle, next, message_size,
+                (NULL == message_infos) ? NULL : &message_infos[*count]);
+        if (RCLUC_RET_OK == status) {
+            next += message_size;
+            (*count)++;
+        } else if (RCLUC_RET_NO_DATA == status || RCLUC_RET_ERR_SPACE == status) {
+            break;
+        } else {
+            subscription_exception(subscription_handle, status);
+        }
+    }
+    if (*count > 0) {
+        return RCLUC_RET_OK;
+    }
+    return (RCLUC_RET_OK == status) ? RCLUC_RET_NO_DATA : status;
+}
+
+rcluc_ret_t rcluc_loan_release(rcluc_loan_t * loan) {
+    if (NULL == loan) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (NULL == loan->slot) {
+        return RCLUC_RET_ERR_ALREADY;
+    }
+    rcluc_queue_release(loan->slot);
+    loan->slot = NULL;
+    loan->data = NULL;
+    loan->length = 0;
+    return RCLUC_RET_OK;
+}
+
 rcluc_ret_t rcluc_subscription_destroy(rcluc_subscription_handle_t subscription_handle) {
     rcluc_ret_t status = RCLUC_RET_OK;
     if (NULL == subscription_handle) {
@@ -188,20 +1041,24 @@ rcluc_ret_t rcluc_subscription_destroy(rcluc_subscription_handle_t subscription_
 
     return status;
 }
+#endif /* configRCLUC_ENABLE_SUBSCRIPTIONS */
 
+#if configRCLUC_ENABLE_PUBLISHERS
 rcluc_ret_t rcluc_publisher_create(rcluc_node_handle_t node_handle,
-        const rcluc_message_type_support_t * message_type, size_t queue_length, uint8_t * message_buffer,
-        const rcluc_publisher_config_t * config, rcluc_publisher_handle_t * publisher_handle) {
+        const rcluc_message_type_support_t * message_type, const char * topic_name, size_t queue_length,
+        uint8_t * message_buffer, const rcluc_publisher_config_t * config, rcluc_publisher_handle_t * publisher_handle) {
     rcluc_ret_t status = RCLUC_RET_OK;
     rcluc_publisher_handle_t new_publisher = NULL;
-    if (NULL == node_handle || NULL == message_type || NULL == message_buffer || NULL == config || NULL == publisher_handle) {
+    char dds_topic_name[RCLUC_DDS_TOPIC_NAME_SIZE];
+    if (NULL == node_handle || NULL == message_type || NULL == topic_name || NULL == message_buffer || NULL == config
+            || NULL == publisher_handle) {
         return RCLUC_RET_NULL_PTR;
     } else if (queue_length <= 0) {
         return RCLUC_RET_ERR_PARAM;
     }
 
     status = RCLUC_RET_ERR_SPACE;
-    for (size_t i = 0; i < configRCLUC_MAX_PUBLISHERS_PER_NODE; ++i) {
+    for (size_t i = 0; i < configRCLUC_MAX_PUBLISHERS_PER_NODE && NULL == new_publisher; ++i) {
         if (0 == node_handle->publishers[i].is_used) {
             node_handle->publishers[i].is_used = 1;
             new_publisher = &node_handle->publishers[i];
@@ -209,12 +1066,25 @@ rcluc_ret_t rcluc_publisher_create(rcluc_node_handle_t node_handle,
     }
 
     if (NULL != new_publisher) {
-        status = rmwu_publisher_create(&(node_handle->rmwu_node), message_type, queue_length, message_buffer, config,
-                &new_publisher->rmwu_publisher);
+        new_publisher->is_pending = batch_active;
+        status = rcluc_format_topic_name("rt/", topic_name, "", dds_topic_name);
+        if (RCLUC_RET_OK == status) {
+            status = rmwu_publisher_create(&(node_handle->rmwu_node), message_type, dds_topic_name, config,
+                    &new_publisher->rmwu_publisher);
+        }
 
         // If the publisher was created successfully then set the return value, otherwise mark it as free again.
         if (RCLUC_RET_OK == status) {
             new_publisher->user_metadata = config->user_metadata;
+            new_publisher->exception_callback = config->exception_callback;
+            new_publisher->packed = config->packed_queue;
+#if configRCLUC_ENABLE_RECORDER
+            rcluc_record_topic_init(&new_publisher->record, topic_name);
+#endif
+            rcluc_packed_queue_init(&new_publisher->queue, message_buffer, config->packed_queue ? queue_length : 0);
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+            rcluc_congestion_init(new_publisher, config->priority);
+#endif
             *publisher_handle = new_publisher;
         } else {
             new_publisher->is_used = 0;
@@ -231,6 +1101,9 @@ void rcluc_publisher_get_default_config(rcluc_publisher_config_t * config) {
     config->qos.reliability = RCLUC_TOPIC_RELIABILITY_BEST_EFFORT;
     config->exception_callback = NULL;
     config->user_metadata = NULL;
+    config->source_timestamp = 0;
+    config->packed_queue = 0;
+    config->priority = RCLUC_PRIORITY_DEFAULT;
 }
 
 void * rcluc_publisher_get_user_metadata(const rcluc_publisher_handle_t publisher_handle) {
@@ -262,8 +1135,127 @@ rcluc_ret_t rcluc_publisher_destroy(rcluc_publisher_handle_t publisher_handle) {
 }
 
 rcluc_ret_t rcluc_publisher_publish(rcluc_publisher_handle_t publisher_handle, const void * message) {
+    rcluc_ret_t status = RCLUC_RET_ERR_SPACE;
     if (NULL == publisher_handle || NULL == message) {
         return RCLUC_RET_NULL_PTR;
+    } else if (RCLUC_RET_OK != publisher_admit(publisher_handle)) {
+        return RCLUC_RET_ERR_CONGESTION;
+    }
+    if (publisher_handle->rmwu_publisher.source_timestamp) {
+        publisher_handle->rmwu_publisher.timestamp = rcluc_time_now();
+    }
+    if (0 == publisher_handle->packed) {
+        return publisher_send(publisher_handle, message);
+    }
+
+    // Messages already queued go first, so a new one only skips the queue when it is empty
+    if (0 == publisher_handle->queue.count && 0 == batch_active) {
+        status = publisher_send(publisher_handle, message);
+    }
+    if (RCLUC_RET_ERR_SPACE == status || (RCLUC_RET_ERR_INIT == status && batch_active)) {
+        status = publisher_enqueue(publisher_handle, message);
+    }
+    return status;
+}
+
+rcluc_ret_t rcluc_publisher_publish_many(rcluc_publisher_handle_t publisher_handle, const void * messages,
+        size_t count, size_t stride, size_t * published_count) {
+    size_t published = 0;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL != published_count) {
+        *published_count = 0;
+    }
+    if (NULL == publisher_handle || NULL == messages) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    if (0 == stride && count > 1) {
+        return RCLUC_RET_ERR_PARAM;
+    } else if (RCLUC_RET_OK != publisher_admit(publisher_handle)) {
+        return RCLUC_RET_ERR_CONGESTION;
+    } else if (RCLUC_RET_OK != publisher_flush_ahead(publisher_handle)) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    if (publisher_handle->rmwu_publisher.source_timestamp) {
+        publisher_handle->rmwu_publisher.timestamp = rcluc_time_now();
+    }
+    status = rmwu_publisher_publish_many(&publisher_handle->rmwu_publisher, messages, count, stride, &published);
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+    rcluc_congestion_report(publisher_handle, status);
+#endif
+#if configRCLUC_ENABLE_RECORDER
+    for (size_t i = 0; i < published; ++i) {
+        rcluc_record_message(&publisher_handle->record, &publisher_handle->rmwu_publisher,
+                (const uint8_t *)messages + i * stride);
+    }
+#endif
+    if (NULL != published_count) {
+        *published_count = published;
+    }
+    return status;
+}
+
+rcluc_ret_t rcluc_publisher_publish_fragments(rcluc_publisher_handle_t publisher_handle,
+        const rcluc_buffer_fragment_t * fragments, size_t count) {
+    if (NULL == publisher_handle || (NULL == fragments && count > 0)) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (RCLUC_RET_OK != publisher_admit(publisher_handle)) {
+        return RCLUC_RET_ERR_CONGESTION;
+    } else if (RCLUC_RET_OK != publisher_flush_ahead(publisher_handle)) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    if (publisher_handle->rmwu_publisher.source_timestamp) {
+        publisher_handle->rmwu_publisher.timestamp = rcluc_time_now();
+    }
+    rcluc_ret_t status = rmwu_publisher_publish_fragments(&publisher_handle->rmwu_publisher, fragments, count);
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+    rcluc_congestion_report(publisher_handle, status);
+#endif
+#if configRCLUC_ENABLE_RECORDER
+    if (RCLUC_RET_OK == status) {
+        rcluc_record_fragments(&publisher_handle->record, &publisher_handle->rmwu_publisher, fragments, count);
+    }
+#endif
+    return status;
+}
+
+rcluc_ret_t rcluc_publisher_publish_serialized(rcluc_publisher_handle_t publisher_handle, const uint8_t * data,
+        size_t length) {
+    rcluc_buffer_fragment_t fragment;
+    fragment.data = data;
+    fragment.length = length;
+    // Goes through publish_fragments, which sends the packed queue of the publisher first
+    return rcluc_publisher_publish_fragments(publisher_handle, &fragment, 1);
+}
+
+rcluc_ret_t rcluc_publisher_serialize(const rcluc_publisher_handle_t publisher_handle, const void * message,
+        uint8_t * buffer, size_t buffer_size, size_t * length) {
+    rcluc_cdr_buffer_t cdr_buffer;
+    if (NULL == publisher_handle || NULL == message || NULL == buffer || NULL == length) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    rcluc_cdr_init(&cdr_buffer, buffer, buffer_size);
+    rcluc_ret_t status = publisher_handle->rmwu_publisher.message_type->serialize(message, &cdr_buffer);
+    if (RCLUC_RET_OK == status) {
+        status = cdr_buffer.error;
+    }
+    *length = (RCLUC_RET_OK == status) ? rcluc_cdr_get_length(&cdr_buffer) : 0;
+    return status;
+}
+#endif /* configRCLUC_ENABLE_PUBLISHERS */
+
+#if configRCLUC_ENABLE_RECORDER
+void rcluc_replay_deliver(const rcluc_record_t * record) {
+#if configRCLUC_ENABLE_SUBSCRIPTIONS
+    uint8_t source_timestamp = (record->flags & RCLUC_RECORD_FLAG_SOURCE_TIMESTAMP) ? 1 : 0;
+    for (size_t i = 0; i < configRCLUC_MAX_NUM_NODES; ++i) {
+        for (size_t j = 0; nodes[i].is_used && j < configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE; ++j) {
+            rcluc_subscription_handle_t subscription = &nodes[i].subscriptions[j];
+            if (subscription->is_used && subscription->source_timestamp == source_timestamp
+                    && 0 == strcmp(subscription->record.topic_name, record->topic_name)) {
+                (void) subscription_on_data(subscription, record->data, 0, record->length, record->length);
+            }
+        }
     }
-    return rmwu_publisher_publish(&publisher_handle->rmwu_publisher, message);
+#endif
 }
+#endif /* configRCLUC_ENABLE_RECORDER */
@@ -0,0 +1,485 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the CDR serialization layer
+ */
+
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc/rcluc_default_configs.h"
+#include <string.h>
+
+/* The number of bytes byte swapped at a time when serializing an array whose byte order differs from the host */
+#define RCLUC_CDR_SWAP_BLOCK_SIZE 64
+
+void rcluc_cdr_init(rcluc_cdr_buffer_t * buffer, uint8_t * data, size_t capacity) {
+    if (NULL == buffer) {
+        return;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    buffer->position = 0;
+    buffer->origin = 0;
+    buffer->endianness = configRCLUC_CDR_ENDIANNESS;
+    buffer->flush = NULL;
+    buffer->flush_args = NULL;
+    buffer->error = RCLUC_RET_OK;
+}
+
+void rcluc_cdr_set_flush(rcluc_cdr_buffer_t * buffer, rcluc_cdr_flush_func_t flush, void * args) {
+    if (NULL == buffer) {
+        return;
+    }
+    buffer->flush = flush;
+    buffer->flush_args = args;
+}
+
+void rcluc_cdr_set_window(rcluc_cdr_buffer_t * buffer, uint8_t * data, size_t capacity) {
+    if (NULL == buffer) {
+        return;
+    }
+    buffer->origin += buffer->position;
+    buffer->data = data;
+    buffer->capacity = capacity;
+    buffer->position = 0;
+}
+
+size_t rcluc_cdr_get_length(const rcluc_cdr_buffer_t * buffer) {
+    return buffer->origin + buffer->position;
+}
+
+size_t rcluc_cdr_alignment(size_t offset, size_t data_size) {
+    if (data_size <= 1) {
+        return 0;
+    }
+    return (data_size - (offset % data_size)) & (data_size - 1);
+}
+
+size_t rcluc_cdr_string_end(size_t offset, const char * string) {
+    offset += rcluc_cdr_alignment(offset, 4) + 4;
+    return offset + strlen(string) + 1;
+}
+
+size_t rcluc_cdr_array_end(size_t offset, size_t count, size_t element_size) {
+    if (0 == count) {
+        return offset;
+    }
+    return offset + rcluc_cdr_alignment(offset, element_size) + (count * element_size);
+}
+
+size_t rcluc_cdr_sequence_end(size_t offset, size_t count, size_t element_size) {
+    offset += rcluc_cdr_alignment(offset, 4) + 4;
+    return rcluc_cdr_array_end(offset, count, element_size);
+}
+
+static rcluc_cdr_endianness_t host_endianness(void) {
+    const uint16_t probe = 1;
+    return (1 == *(const uint8_t *)&probe) ? RCLUC_CDR_LITTLE_ENDIAN : RCLUC_CDR_BIG_ENDIAN;
+}
+
+/* Reverses the bytes of every element, written as plain loops over whole words so that the compiler can vectorize */
+static void swap_elements(uint8_t * data, size_t count, size_t element_size) {
+    switch (element_size) {
+    case 2:
+        for (size_t i = 0; i < count; ++i) {
+            uint16_t value;
+            memcpy(&value, &data[i * 2], sizeof(value));
+            value = (uint16_t)((value >> 8) | (value << 8));
+            memcpy(&data[i * 2], &value, sizeof(value));
+        }
+        break;
+    case 4:
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t value;
+            memcpy(&value, &data[i * 4], sizeof(value));
+            value = ((value >> 24) & 0xFFu) | ((value >> 8) & 0xFF00u) | ((value << 8) & 0xFF0000u) | (value << 24);
+            memcpy(&data[i * 4], &value, sizeof(value));
+        }
+        break;
+    case 8:
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t value;
+            memcpy(&value, &data[i * 8], sizeof(value));
+            value = ((value >> 56) & 0xFFull) | ((value >> 40) & 0xFF00ull) | ((value >> 24) & 0xFF0000ull)
+                    | ((value >> 8) & 0xFF000000ull) | ((value << 8) & 0xFF00000000ull)
+                    | ((value << 24) & 0xFF0000000000ull) | ((value << 40) & 0xFF000000000000ull) | (value << 56);
+            memcpy(&data[i * 8], &value, sizeof(value));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static uint8_t is_primitive_size(size_t element_size) {
+    return 1 == element_size || 2 == element_size || 4 == element_size || 8 == element_size;
+}
+
+/*
+ * Makes sure there is at least one byte available in the current window, asking the flush function for the next window
+ * if needed. Returns the number of bytes available.
+ */
+static size_t cdr_reserve(rcluc_cdr_buffer_t * buffer) {
+    if (RCLUC_RET_OK != buffer->error) {
+        return 0;
+    }
+    if (buffer->position >= buffer->capacity) {
+        if (NULL == buffer->flush) {
+            buffer->error = RCLUC_RET_ERR_SPACE;
+            return 0;
+        }
+        buffer->error = buffer->flush(buffer, buffer->flush_args);
+        if (RCLUC_RET_OK == buffer->error && buffer->position >= buffer->capacity) {
+            buffer->error = RCLUC_RET_ERR_SPACE;
+        }
+        if (RCLUC_RET_OK != buffer->error) {
+            return 0;
+        }
+    }
+    return buffer->capacity - buffer->position;
+}
+
+/* Copies bytes into the buffer, spanning as many windows as needed */
+static rcluc_ret_t cdr_write(rcluc_cdr_buffer_t * buffer, const uint8_t * bytes, size_t size) {
+    while (size > 0) {
+        size_t available = cdr_reserve(buffer);
+        if (0 == available) {
+            return buffer->error;
+        }
+        size_t chunk = (size < available) ? size : available;
+        if (NULL == bytes) {
+            memset(&buffer->data[buffer->position], 0, chunk);
+        } else {
+            memcpy(&buffer->data[buffer->position], bytes, chunk);
+            bytes += chunk;
+        }
+        buffer->position += chunk;
+        size -= chunk;
+    }
+    return buffer->error;
+}
+
+/* Copies bytes out of the buffer, spanning as many windows as needed */
+static rcluc_ret_t cdr_read(rcluc_cdr_buffer_t * buffer, uint8_t * bytes, size_t size) {
+    while (size > 0) {
+        size_t available = cdr_reserve(buffer);
+        if (0 == available) {
+            return buffer->error;
+        }
+        size_t chunk = (size < available) ? size : available;
+        if (NULL != bytes) {
+            memcpy(bytes, &buffer->data[buffer->position], chunk);
+            bytes += chunk;
+        }
+        buffer->position += chunk;
+        size -= chunk;
+    }
+    return buffer->error;
+}
+
+static rcluc_ret_t cdr_write_primitive(rcluc_cdr_buffer_t * buffer, uint64_t value, size_t size) {
+    uint8_t bytes[8];
+    size_t padding = rcluc_cdr_alignment(rcluc_cdr_get_length(buffer), size);
+    for (size_t i = 0; i < size; ++i) {
+        size_t shift = (RCLUC_CDR_LITTLE_ENDIAN == buffer->endianness) ? i : (size - 1 - i);
+        bytes[i] = (uint8_t)(value >> (8 * shift));
+    }
+    if (RCLUC_RET_OK == cdr_write(buffer, NULL, padding)) {
+        (void) cdr_write(buffer, bytes, size);
+    }
+    return buffer->error;
+}
+
+static rcluc_ret_t cdr_read_primitive(rcluc_cdr_buffer_t * buffer, uint64_t * value, size_t size) {
+    uint8_t bytes[8];
+    size_t padding = rcluc_cdr_alignment(rcluc_cdr_get_length(buffer), size);
+    *value = 0;
+    if (RCLUC_RET_OK == cdr_read(buffer, NULL, padding) && RCLUC_RET_OK == cdr_read(buffer, bytes, size)) {
+        for (size_t i = 0; i < size; ++i) {
+            size_t shift = (RCLUC_CDR_LITTLE_ENDIAN == buffer->endianness) ? i : (size - 1 - i);
+            *value |= ((uint64_t)bytes[i]) << (8 * shift);
+        }
+    }
+    return buffer->error;
+}
+
+rcluc_ret_t rcluc_cdr_serialize_uint8(rcluc_cdr_buffer_t * buffer, uint8_t value) {
+    return cdr_write_primitive(buffer, value, sizeof(value));
+}
+
+rcluc_ret_t rcluc_cdr_serialize_uint16(rcluc_cdr_buffer_t * buffer, uint16_t value) {
+    return cdr_write_primitive(buffer, value, sizeof(value));
+}
+
+rcluc_ret_t rcluc_cdr_serialize_uint32(rcluc_cdr_buffer_t * buffer, uint32_t value) {
+    return cdr_write_primitive(buffer, value, sizeof(value));
+}
+
+rcluc_ret_t rcluc_cdr_serialize_uint64(rcluc_cdr_buffer_t * buffer, uint64_t value) {
+    return cdr_write_primitive(buffer, value, sizeof(value));
+}
+
+rcluc_ret_t rcluc_cdr_serialize_float(rcluc_cdr_buffer_t * buffer, float value) {
+    uint32_t raw;
+    memcpy(&raw, &value, sizeof(raw));
+    return cdr_write_primitive(buffer, raw, sizeof(raw));
+}
+
+rcluc_ret_t rcluc_cdr_serialize_double(rcluc_cdr_buffer_t * buffer, double value) {
+    uint64_t raw;
+    memcpy(&raw, &value, sizeof(raw));
+    return cdr_write_primitive(buffer, raw, sizeof(raw));
+}
+
+rcluc_ret_t rcluc_cdr_serialize_string(rcluc_cdr_buffer_t * buffer, const char * string) {
+    size_t length = strlen(string) + 1;
+    if (RCLUC_RET_OK == rcluc_cdr_serialize_uint32(buffer, (uint32_t)length)) {
+        (void) cdr_write(buffer, (const uint8_t *)string, length);
+    }
+    return buffer->error;
+}
+
+rcluc_ret_t rcluc_cdr_serialize_array(rcluc_cdr_buffer_t * buffer, const void * elements, size_t count,
+        size_t element_size) {
+    const uint8_t * bytes = (const uint8_t *)elements;
+    if (NULL == elements && count > 0) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (!is_primitive_size(element_size)) {
+        return RCLUC_RET_ERR_PARAM;
+    } else if (0 == count) {
+        return buffer->error;
+    }
+
+    if (RCLUC_RET_OK != cdr_write(buffer, NULL, rcluc_cdr_alignment(rcluc_cdr_get_length(buffer), element_size))) {
+        return buffer->error;
+    }
+    if (1 == element_size || host_endianness() == buffer->endianness) {
+        return cdr_write(buffer, bytes, count * element_size);
+    }
+
+    while (count > 0 && RCLUC_RET_OK == buffer->error) {
+        uint8_t block[RCLUC_CDR_SWAP_BLOCK_SIZE];
+        size_t block_count = RCLUC_CDR_SWAP_BLOCK_SIZE / element_size;
+        if (block_count > count) {
+            block_count = count;
+        }
+        memcpy(block, bytes, block_count * element_size);
+        swap_elements(block, block_count, element_size);
+        (void) cdr_write(buffer, block, block_count * element_size);
+        bytes += block_count * element_size;
+        count -= block_count;
+    }
+    return buffer->error;
+}
+
+rcluc_ret_t rcluc_cdr_serialize_sequence(rcluc_cdr_buffer_t * buffer, const void * elements, size_t count,
+        size_t element_size) {
+    if (count > UINT32_MAX) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    if (RCLUC_RET_OK == rcluc_cdr_serialize_uint32(buffer, (uint32_t)count)) {
+        (void) rcluc_cdr_serialize_array(buffer, elements, count, element_size);
+    }
+    return buffer->error;
+}
+
+rcluc_ret_t rcluc_cdr_serialize_bytes(rcluc_cdr_buffer_t * buffer, const uint8_t * bytes, size_t size) {
+    if (NULL == bytes) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    return cdr_write(buffer, bytes, size);
+}
+
+rcluc_ret_t rcluc_cdr_deserialize_uint8(rcluc_cdr_buffer_t * buffer, uint8_t * value) {
+    uint64_t raw;
+    (void) cdr_read_primitive(buffer, &raw, sizeof(*value));
+    *value = (uint8_t)raw;
+    return buffer->error;
+}
+
+rcluc_ret_t rcluc_cdr_deserialize_uint16(rcluc_cdr_buffer_t * buffer, uint16_t * value) {
+    uint64_t raw;
+    (void) cdr_read_primitive(buffer, &raw, sizeof(*value));
+    *value = (uint16_t)raw;
+    return buffer->error;
+}
+
+rcluc_ret_t rcluc_cdr_deserialize_uint32(rcluc_cdr_buffer_t * buffer, uint32_t * value) {
+    uint64_t raw;
+    (void) cdr_read_primitive(buffer, &raw, sizeof(*value));
+    *value = (uint32_t)raw;
+    return buffer->error;
+}
+
+rcluc_ret_t rcluc_cdr_deserialize_uint64(rcluc_cdr_buffer_t * buffer, uint64_t * value) {
+    return cdr_read_primitive(buffer, value, sizeof(*value));
+}
+
+rcluc_ret_t rcluc_cdr_deserialize_float(rcluc_cdr_buffer_t * buffer, float * value) {
+    uint64_t raw;
+    uint32_t raw32;
+    (void) cdr_read_primitive(buffer, &raw, sizeof(raw32));
+    raw32 = (uint32_t)raw;
+    memcpy(value, &raw32, sizeof(*value));
+    return buffer->error;
+}
+
+rcluc_ret_t rcluc_cdr_deserialize_double(rcluc_cdr_buffer_t * buffer, double * value) {
+    uint64_t raw;
+    (void) cdr_read_primitive(buffer, &raw, sizeof(raw));
+    memcpy(value, &raw, sizeof(*value));
+    return buffer->error;
+}
+
+rcluc_ret_t rcluc_cdr_deserialize_string(rcluc_cdr_buffer_t * buffer, char * string, size_t string_size) {
+    uint32_t length = 0;
+    if (RCLUC_RET_OK != rcluc_cdr_deserialize_uint32(buffer, &length)) {
+        return buffer->error;
+    }
+    if (0 == length || length > string_size) {
+        buffer->error = RCLUC_RET_ERR_SPACE;
+        return buffer->error;
+    }
+    if (RCLUC_RET_OK == cdr_read(buffer, (uint8_t *)string, length)) {
+        string[length - 1] = '\0';
+    }
+    return buffer->error;
+}
+
+rcluc_ret_t rcluc_cdr_deserialize_array(rcluc_cdr_buffer_t * buffer, void * elements, size_t count,
+        size_t element_size) {
+    if (NULL == elements && count > 0) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (!is_primitive_size(element_size)) {
+        return RCLUC_RET_ERR_PARAM;
+    } else if (0 == count) {
+        return buffer->error;
+    }
+
+    if (RCLUC_RET_OK == cdr_read(buffer, NULL, rcluc_cdr_alignment(rcluc_cdr_get_length(buffer), element_size))
+            && RCLUC_RET_OK == cdr_read(buffer, (uint8_t *)elements, count * element_size)
+            && 1 != element_size && host_endianness() != buffer->endianness) {
+        swap_elements((uint8_t *)elements, count, element_size);
+    }
+    return buffer->error;
+}
+
+rcluc_ret_t rcluc_cdr_deserialize_sequence(rcluc_cdr_buffer_t * buffer, void * elements, size_t capacity,
+        size_t element_size, size_t * count) {
+    uint32_t length = 0;
+    if (NULL == count) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    *count = 0;
+    if (RCLUC_RET_OK != rcluc_cdr_deserialize_uint32(buffer, &length)) {
+        return buffer->error;
+    }
+    if (length > capacity) {
+        buffer->error = RCLUC_RET_ERR_SPACE;
+        return buffer->error;
+    }
+    if (RCLUC_RET_OK == rcluc_cdr_deserialize_array(buffer, elements, length, element_size)) {
+        *count = length;
+    }
+    return buffer->error;
+}
+
+rcluc_ret_t rcluc_cdr_deserialize_bytes(rcluc_cdr_buffer_t * buffer, uint8_t * bytes, size_t size) {
+    if (NULL == bytes) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    return cdr_read(buffer, bytes, size);
+}
+
+/* Reads a primitive at an offset of a contiguous message, the alignment being relative to the start of the message */
+static rcluc_ret_t cdr_get_primitive(const uint8_t * data, size_t length, size_t offset, uint64_t * value,
+        size_t size) {
+    rcluc_cdr_buffer_t buffer;
+    *value = 0;
+    if (NULL == data) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    // The buffer is only read from
+    rcluc_cdr_init(&buffer, (uint8_t *)data, length);
+    if (RCLUC_RET_OK == cdr_read(&buffer, NULL, offset)) {
+        (void) cdr_read_primitive(&buffer, value, size);
+    }
+    return buffer.error;
+}
+
+rcluc_ret_t rcluc_cdr_get_uint8(const uint8_t * data, size_t length, size_t offset, uint8_t * value) {
+    uint64_t raw;
+    rcluc_ret_t status = cdr_get_primitive(data, length, offset, &raw, sizeof(*value));
+    *value = (uint8_t)raw;
+    return status;
+}
+
+rcluc_ret_t rcluc_cdr_get_uint16(const uint8_t * data, size_t length, size_t offset, uint16_t * value) {
+    uint64_t raw;
+    rcluc_ret_t status = cdr_get_primitive(data, length, offset, &raw, sizeof(*value));
+    *value = (uint16_t)raw;
+    return status;
+}
+
+rcluc_ret_t rcluc_cdr_get_uint32(const uint8_t * data, size_t length, size_t offset, uint32_t * value) {
+    uint64_t raw;
+    rcluc_ret_t status = cdr_get_primitive(data, length, offset, &raw, sizeof(*value));
+    *value = (uint32_t)raw;
+    return status;
+}
+
+rcluc_ret_t rcluc_cdr_get_uint64(const uint8_t * data, size_t length, size_t offset, uint64_t * value) {
+    return cdr_get_primitive(data, length, offset, value, sizeof(*value));
+}
+
+rcluc_ret_t rcluc_cdr_get_float(const uint8_t * data, size_t length, size_t offset, float * value) {
+    uint64_t raw;
+    uint32_t raw32;
+    rcluc_ret_t status = cdr_get_primitive(data, length, offset, &raw, sizeof(raw32));
+    raw32 = (uint32_t)raw;
+    memcpy(value, &raw32, sizeof(*value));
+    return status;
+}
+
+rcluc_ret_t rcluc_cdr_get_double(const uint8_t * data, size_t length, size_t offset, double * value) {
+    uint64_t raw;
+    rcluc_ret_t status = cdr_get_primitive(data, length, offset, &raw, sizeof(raw));
+    memcpy(value, &raw, sizeof(*value));
+    return status;
+}
+
+rcluc_ret_t rcluc_cdr_get_string(const uint8_t * data, size_t length, size_t offset, const char ** string,
+        size_t * end) {
+    uint32_t size = 0;
+    rcluc_ret_t status = rcluc_cdr_get_uint32(data, length, offset, &size);
+    if (NULL == string) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (RCLUC_RET_OK != status) {
+        return status;
+    }
+    // The characters follow the length prefix, which ends on the next multiple of 4 after the offset
+    offset += rcluc_cdr_alignment(offset, sizeof(size)) + sizeof(size);
+    if (size > length - offset) {
+        return RCLUC_RET_ERR_SPACE;
+    } else if (0 == size || '\0' != data[offset + size - 1]) {
+        return RCLUC_RET_ERROR;
+    }
+    *string = (const char *)&data[offset];
+    if (NULL != end) {
+        *end = offset + size;
+    }
+    return RCLUC_RET_OK;
+}
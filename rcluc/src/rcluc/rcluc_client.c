@@ -0,0 +1,265 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the ROS service clients of the rcluc library
+ */
+
+#include "rcluc/rcluc.h"
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc_internal.h"
+#include <string.h>
+
+#if configRCLUC_ENABLE_SERVICES
+
+#if (configRCLUC_MAX_REQUESTS_IN_FLIGHT & (configRCLUC_MAX_REQUESTS_IN_FLIGHT - 1)) != 0 \
+        || configRCLUC_MAX_REQUESTS_IN_FLIGHT > 0x10000
+#error "configRCLUC_MAX_REQUESTS_IN_FLIGHT must be a power of two, and at most 65536"
+#endif
+
+/*
+ * The in-flight entry of a request, from the low bits of its sequence number. The request id carries the same low 16
+ * bits, see rmwu_client_send_request, so a response finds its entry the same way.
+ */
+#define REQUEST_INDEX(id) ((size_t)(id) & (configRCLUC_MAX_REQUESTS_IN_FLIGHT - 1))
+
+/* Receives serialized responses from the rmwu layer. They are queued until the next spin. */
+static rcluc_ret_t client_on_data(void * args, const uint8_t * data, size_t offset, size_t length,
+        size_t total_length) {
+    rcluc_client_handle_t client = (rcluc_client_handle_t)args;
+    return rcluc_queue_write(&client->response_queue, data, offset, length, total_length, 0);
+}
+
+static void client_deliver(rcluc_client_handle_t client, int64_t sequence_number, uint8_t * serialized_response,
+        size_t length) {
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT == RCLUC_SUBSCRIPTION_DESERIALIZATION_DISABLED
+    (void) length;
+    client->callback(client, sequence_number, serialized_response, RCLUC_RET_OK, client->user_metadata);
+#else
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT == RCLUC_SUBSCRIPTION_DESERIALIZATION_STATIC_ALLOCATION
+    uint64_t * response = client->deserialized_response;
+#else
+    uint64_t response[RCLUC_DESERIALIZED_MESSAGE_WORDS];
+#endif
+    rcluc_ret_t status = client->service_type->response->deserialize(serialized_response, length, response,
+            client->service_type->response->message_size);
+    client->callback(client, sequence_number, (RCLUC_RET_OK == status) ? response : NULL, status,
+            client->user_metadata);
+#endif
+}
+
+/*
+ * Matches a response to its request by the request id the rmwu layer puts in front of it, which points straight at the
+ * in-flight entry of the request. Responses for other clients and responses to requests that already timed out do not
+ * match the request id kept in the entry and are ignored.
+ */
+static void client_dispatch_response(rcluc_client_handle_t client, uint8_t * serialized_response, size_t length) {
+    rcluc_cdr_buffer_t buffer;
+    uint64_t request_id = 0;
+    rcluc_pending_request_t * request = NULL;
+
+    if (length < RCLUC_SERVICE_HEADER_SIZE) {
+        return;
+    }
+    rcluc_cdr_init(&buffer, serialized_response, length);
+    if (RCLUC_RET_OK != rcluc_cdr_deserialize_uint64(&buffer, &request_id)) {
+        return;
+    }
+    request = &client->pending_requests[REQUEST_INDEX(request_id)];
+    if (0 == request->is_used || request->request_id != request_id) {
+        return;
+    }
+    request->is_used = 0;
+    client->requests_in_flight--;
+
+    client_deliver(client, request->sequence_number, &serialized_response[RCLUC_SERVICE_HEADER_SIZE],
+            length - RCLUC_SERVICE_HEADER_SIZE);
+}
+
+static void client_expire_requests(rcluc_client_handle_t client) {
+    int64_t now = rmwu_get_time_ms();
+    for (size_t i = 0; i < configRCLUC_MAX_REQUESTS_IN_FLIGHT && client->requests_in_flight > 0; ++i) {
+        rcluc_pending_request_t * request = &client->pending_requests[i];
+        if (request->is_used && request->deadline_ms <= now) {
+            request->is_used = 0;
+            client->requests_in_flight--;
+            client->callback(client, request->sequence_number, NULL, RCLUC_RET_TIMEOUT, client->user_metadata);
+        }
+    }
+}
+
+void rcluc_client_spin(rcluc_client_handle_t client) {
+    size_t pending = client->response_queue.count;
+    size_t length = 0;
+
+    while (pending > 0 && client->is_used) {
+        uint8_t * serialized_response = rcluc_queue_peek(&client->response_queue, &length,
+                &client->response_reception_timestamp, NULL);
+        client_dispatch_response(client, serialized_response, length);
+        rcluc_queue_pop(&client->response_queue);
+        pending--;
+    }
+
+    if (client->is_used && client->requests_in_flight > 0) {
+        client_expire_requests(client);
+    }
+}
+
+rcluc_ret_t rcluc_client_create(rcluc_node_handle_t node_handle, const rcluc_service_type_support_t * service_type,
+        const char * service_name, rcluc_client_response_callback_t callback, size_t queue_length,
+        uint8_t * message_buffer, const rcluc_service_client_config_t * config, rcluc_client_handle_t * client_handle) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    rcluc_client_handle_t new_client = NULL;
+    rcluc_service_client_config_t default_config;
+    size_t max_serialized_size = 0;
+    char dds_service_name[RCLUC_DDS_TOPIC_NAME_SIZE];
+
+    if (NULL == node_handle || NULL == service_type || NULL == service_type->request || NULL == service_type->response
+            || NULL == service_name || NULL == callback || NULL == message_buffer || NULL == client_handle) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (0 == queue_length) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT != RCLUC_SUBSCRIPTION_DESERIALIZATION_DISABLED
+    if (service_type->response->message_size > configRCLUC_MAX_MESSAGE_SIZE_BYTES) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+#endif
+
+    if (NULL == config) {
+        rcluc_client_get_default_config(&default_config);
+        config = &default_config;
+    }
+
+    // The rmwu layer derives the names of the request and reply topics from the name of the service
+    status = rcluc_format_topic_name("", service_name, "", dds_service_name);
+    if (RCLUC_RET_OK != status) {
+        return status;
+    }
+
+    max_serialized_size = config->max_serialized_size;
+    if (0 == max_serialized_size) {
+        max_serialized_size = service_type->response->max_serialized_size;
+    }
+    if (0 == max_serialized_size) {
+        max_serialized_size = configRCLUC_MAX_MESSAGE_SIZE_BYTES;
+    }
+
+    status = RCLUC_RET_ERR_SPACE;
+    for (size_t i = 0; i < configRCLUC_MAX_CLIENTS_PER_NODE && NULL == new_client; ++i) {
+        if (0 == node_handle->clients[i].is_used) {
+            node_handle->clients[i].is_used = 1;
+            new_client = &node_handle->clients[i];
+        }
+    }
+
+    if (NULL != new_client) {
+        new_client->service_type = service_type;
+        new_client->is_pending = rcluc_batch_is_active();
+        new_client->callback = callback;
+        new_client->user_metadata = config->user_metadata;
+        new_client->request_timeout_ms = config->request_timeout_ms;
+        new_client->next_sequence_number = 1;
+        new_client->requests_in_flight = 0;
+        memset(new_client->pending_requests, 0, sizeof(new_client->pending_requests));
+        rcluc_queue_init(&new_client->response_queue, message_buffer, queue_length,
+                max_serialized_size + RCLUC_SERVICE_HEADER_SIZE);
+
+        status = rmwu_client_create(&node_handle->rmwu_node, service_type, dds_service_name,
+                config->qos.reliability, client_on_data, new_client, &new_client->rmwu_client);
+
+        if (RCLUC_RET_OK == status) {
+            *client_handle = new_client;
+        } else {
+            new_client->is_used = 0;
+        }
+    }
+
+    return status;
+}
+
+void rcluc_client_get_default_config(rcluc_service_client_config_t * config) {
+    if (NULL == config) {
+        return;
+    }
+    memset(config, 0, sizeof(rcluc_service_client_config_t));
+    config->qos.reliability = RCLUC_TOPIC_RELIABILITY_RELIABLE;
+    config->request_timeout_ms = configRCLUC_SERVICE_REQUEST_TIMEOUT_MS;
+    config->max_serialized_size = 0;
+    config->user_metadata = NULL;
+}
+
+rcluc_ret_t rcluc_client_send_request(rcluc_client_handle_t client_handle, const void * request,
+        int64_t * sequence_number) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    rcluc_pending_request_t * pending_request = NULL;
+    uint64_t request_id = 0;
+
+    if (NULL == client_handle || NULL == request || NULL == sequence_number) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (0 == client_handle->is_used) {
+        return RCLUC_RET_ERR_INIT;
+    }
+
+    // The entry is still taken by the request sent configRCLUC_MAX_REQUESTS_IN_FLIGHT requests earlier
+    pending_request = &client_handle->pending_requests[REQUEST_INDEX(client_handle->next_sequence_number)];
+    if (pending_request->is_used) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+
+    status = rmwu_client_send_request(&client_handle->rmwu_client, request, client_handle->next_sequence_number,
+            &request_id);
+    if (RCLUC_RET_OK == status) {
+        pending_request->is_used = 1;
+        pending_request->sequence_number = client_handle->next_sequence_number++;
+        pending_request->request_id = request_id;
+        pending_request->deadline_ms = (0 == client_handle->request_timeout_ms) ? INT64_MAX
+                : rmwu_get_time_ms() + client_handle->request_timeout_ms;
+        client_handle->requests_in_flight++;
+        *sequence_number = pending_request->sequence_number;
+    }
+    return status;
+}
+
+void * rcluc_client_get_user_metadata(const rcluc_client_handle_t client_handle) {
+    if (NULL == client_handle) {
+        return NULL;
+    }
+    return client_handle->user_metadata;
+}
+
+rcluc_ret_t rcluc_client_destroy(rcluc_client_handle_t client_handle) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL == client_handle) {
+        return RCLUC_RET_NULL_PTR;
+    }
+
+    if (0 == client_handle->is_used) {
+        status = RCLUC_RET_ERR_ALREADY;
+    }
+
+    if (RCLUC_RET_OK == status) {
+        status = rmwu_client_destroy(&client_handle->rmwu_client);
+    }
+
+    if (RCLUC_RET_OK == status) {
+        client_handle->is_used = 0;
+    }
+
+    return status;
+}
+
+#endif /* configRCLUC_ENABLE_SERVICES */
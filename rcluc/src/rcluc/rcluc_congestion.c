@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the congestion control of low priority publishers
+ *
+ *  A publisher below configRCLUC_CONGESTION_PRIORITY lets one message out of 2^shift through to the transport. Every
+ *  spin that finds its output stream above configRCLUC_CONGESTION_HIGH_PERCENT, new send failures on its session, or a
+ *  publish since the last spin that had to be dropped or did not find room in the stream, doubles the throttling up to
+ *  configRCLUC_CONGESTION_MAX_THROTTLE_SHIFT. Every spin that finds the stream below
+ *  configRCLUC_CONGESTION_LOW_PERCENT halves it again. The throttling only moves once per spin, so that a burst of
+ *  publishes does not silence a publisher at once, but a message is dropped outright whenever the stream is above
+ *  configRCLUC_CONGESTION_HIGH_PERCENT when it is published, since it would only wait for room or take the room of a
+ *  more important message.
+ */
+
+#include "rcluc/rcluc.h"
+#include "rcluc_internal.h"
+#include <string.h>
+
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+
+#if !configRCLUC_ENABLE_PUBLISHERS
+#error "configRCLUC_ENABLE_CONGESTION_CONTROL needs configRCLUC_ENABLE_PUBLISHERS"
+#endif
+
+#if configRCLUC_CONGESTION_MAX_THROTTLE_SHIFT > 15
+#error "configRCLUC_CONGESTION_MAX_THROTTLE_SHIFT must be below 16"
+#endif
+
+static uint8_t congestion_is_throttled(const rcluc_congestion_t * congestion) {
+    return (congestion->priority < configRCLUC_CONGESTION_PRIORITY) ? 1 : 0;
+}
+
+void rcluc_congestion_init(rcluc_publisher_handle_t publisher, uint8_t priority) {
+    rcluc_congestion_t * congestion = &publisher->congestion;
+    rcluc_link_status_t link;
+    memset(congestion, 0, sizeof(*congestion));
+    congestion->priority = priority;
+    // Failures of the session from before the publisher existed are none of its business
+    if (RCLUC_RET_OK == rmwu_publisher_get_link_status(&publisher->rmwu_publisher, &link)) {
+        congestion->send_failures = link.send_failures;
+    }
+}
+
+rcluc_ret_t rcluc_congestion_admit(rcluc_publisher_handle_t publisher) {
+    rcluc_congestion_t * congestion = &publisher->congestion;
+    rcluc_link_status_t link;
+    if (0 == congestion_is_throttled(congestion)) {
+        return RCLUC_RET_OK;
+    }
+
+    if (RCLUC_RET_OK == rmwu_publisher_get_link_status(&publisher->rmwu_publisher, &link)
+            && link.occupancy_percent >= configRCLUC_CONGESTION_HIGH_PERCENT) {
+        congestion->is_congested = 1;
+        congestion->dropped++;
+        return RCLUC_RET_ERR_CONGESTION;
+    }
+    congestion->sequence++;
+    if (0 != (congestion->sequence & ((1u << congestion->shift) - 1))) {
+        congestion->dropped++;
+        return RCLUC_RET_ERR_CONGESTION;
+    }
+    return RCLUC_RET_OK;
+}
+
+void rcluc_congestion_report(rcluc_publisher_handle_t publisher, rcluc_ret_t status) {
+    // No room in the stream, or fragments the agent never acknowledged: the link does not keep up
+    if (RCLUC_RET_ERR_SPACE == status || RCLUC_RET_TIMEOUT == status) {
+        publisher->congestion.is_congested = 1;
+    }
+}
+
+void rcluc_congestion_spin(rcluc_node_handle_t node) {
+    rcluc_link_status_t link;
+    for (size_t i = 0; i < configRCLUC_MAX_PUBLISHERS_PER_NODE; ++i) {
+        rcluc_publisher_handle_t publisher = &node->publishers[i];
+        rcluc_congestion_t * congestion = &publisher->congestion;
+        if (0 == publisher->is_used || 0 == congestion_is_throttled(congestion)
+                || RCLUC_RET_OK != rmwu_publisher_get_link_status(&publisher->rmwu_publisher, &link)) {
+            continue;
+        }
+
+        uint8_t is_congested = congestion->is_congested || link.send_failures != congestion->send_failures
+                || link.occupancy_percent >= configRCLUC_CONGESTION_HIGH_PERCENT;
+        congestion->is_congested = 0;
+        congestion->send_failures = link.send_failures;
+        if (is_congested) {
+            // The application hears of it once, when the publisher starts being throttled
+            if (0 == congestion->shift && NULL != publisher->exception_callback) {
+                publisher->exception_callback(publisher, RCLUC_RET_ERR_CONGESTION);
+            }
+            if (congestion->shift < configRCLUC_CONGESTION_MAX_THROTTLE_SHIFT) {
+                congestion->shift++;
+            }
+        } else if (link.occupancy_percent <= configRCLUC_CONGESTION_LOW_PERCENT && congestion->shift > 0) {
+            congestion->shift--;
+        }
+    }
+}
+
+rcluc_ret_t rcluc_publisher_get_congestion_status(const rcluc_publisher_handle_t publisher_handle,
+        rcluc_congestion_status_t * status) {
+    if (NULL == publisher_handle || NULL == status) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    status->admit_interval = (uint16_t)(1u << publisher_handle->congestion.shift);
+    status->dropped = publisher_handle->congestion.dropped;
+    return rmwu_publisher_get_link_status(&publisher_handle->rmwu_publisher, &status->link);
+}
+
+#endif /* configRCLUC_ENABLE_CONGESTION_CONTROL */
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the content filters evaluated on serialized samples
+ */
+
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc_internal.h"
+
+#if configRCLUC_ENABLE_SUBSCRIPTIONS
+
+static size_t field_size(rcluc_filter_field_type_t type) {
+    switch (type) {
+    case RCLUC_FILTER_FIELD_UINT8:
+    case RCLUC_FILTER_FIELD_INT8:
+        return 1;
+    case RCLUC_FILTER_FIELD_UINT16:
+    case RCLUC_FILTER_FIELD_INT16:
+        return 2;
+    case RCLUC_FILTER_FIELD_UINT32:
+    case RCLUC_FILTER_FIELD_INT32:
+    case RCLUC_FILTER_FIELD_FLOAT:
+        return 4;
+    case RCLUC_FILTER_FIELD_UINT64:
+    case RCLUC_FILTER_FIELD_INT64:
+    case RCLUC_FILTER_FIELD_DOUBLE:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+/* Applies op to the sign of (field - constant), where order is negative, zero or positive */
+static uint8_t compare(rcluc_filter_op_t op, int order) {
+    switch (op) {
+    case RCLUC_FILTER_OP_EQ:
+        return 0 == order;
+    case RCLUC_FILTER_OP_NE:
+        return 0 != order;
+    case RCLUC_FILTER_OP_LT:
+        return order < 0;
+    case RCLUC_FILTER_OP_LE:
+        return order <= 0;
+    case RCLUC_FILTER_OP_GT:
+        return order > 0;
+    case RCLUC_FILTER_OP_GE:
+        return order >= 0;
+    default:
+        return 0;
+    }
+}
+
+#define ORDER(a, b) (((a) > (b)) - ((a) < (b)))
+
+static uint8_t check_match(const rcluc_filter_check_t * check, const uint8_t * data, size_t length) {
+    rcluc_cdr_buffer_t buffer;
+    uint8_t u8 = 0;
+    uint16_t u16 = 0;
+    uint32_t u32 = 0;
+    uint64_t u64 = 0;
+    float f32 = 0;
+    double f64 = 0;
+    int order = 0;
+
+    if ((size_t)check->offset + field_size(check->type) > length) {
+        return 0;
+    }
+    // Offsets are aligned, so starting the buffer at the offset reads the field without any padding
+    rcluc_cdr_init(&buffer, (uint8_t *)&data[check->offset], length - check->offset);
+
+    switch (check->type) {
+    case RCLUC_FILTER_FIELD_UINT8:
+        (void) rcluc_cdr_deserialize_uint8(&buffer, &u8);
+        order = ORDER((uint64_t)u8, check->constant.unsigned_value);
+        break;
+    case RCLUC_FILTER_FIELD_INT8:
+        (void) rcluc_cdr_deserialize_uint8(&buffer, &u8);
+        order = ORDER((int64_t)(int8_t)u8, check->constant.signed_value);
+        break;
+    case RCLUC_FILTER_FIELD_UINT16:
+        (void) rcluc_cdr_deserialize_uint16(&buffer, &u16);
+        order = ORDER((uint64_t)u16, check->constant.unsigned_value);
+        break;
+    case RCLUC_FILTER_FIELD_INT16:
+        (void) rcluc_cdr_deserialize_uint16(&buffer, &u16);
+        order = ORDER((int64_t)(int16_t)u16, check->constant.signed_value);
+        break;
+    case RCLUC_FILTER_FIELD_UINT32:
+        (void) rcluc_cdr_deserialize_uint32(&buffer, &u32);
+        order = ORDER((uint64_t)u32, check->constant.unsigned_value);
+        break;
+    case RCLUC_FILTER_FIELD_INT32:
+        (void) rcluc_cdr_deserialize_uint32(&buffer, &u32);
+        order = ORDER((int64_t)(int32_t)u32, check->constant.signed_value);
+        break;
+    case RCLUC_FILTER_FIELD_UINT64:
+        (void) rcluc_cdr_deserialize_uint64(&buffer, &u64);
+        order = ORDER(u64, check->constant.unsigned_value);
+        break;
+    case RCLUC_FILTER_FIELD_INT64:
+        (void) rcluc_cdr_deserialize_uint64(&buffer, &u64);
+        order = ORDER((int64_t)u64, check->constant.signed_value);
+        break;
+    case RCLUC_FILTER_FIELD_FLOAT:
+        (void) rcluc_cdr_deserialize_float(&buffer, &f32);
+        // A NaN, in the field or as the constant, is neither smaller, equal nor larger than the other, so only NE holds
+        if (f32 != f32 || check->constant.float_value != check->constant.float_value) {
+            return RCLUC_FILTER_OP_NE == check->op;
+        }
+        order = ORDER((double)f32, check->constant.float_value);
+        break;
+    case RCLUC_FILTER_FIELD_DOUBLE:
+        (void) rcluc_cdr_deserialize_double(&buffer, &f64);
+        if (f64 != f64 || check->constant.float_value != check->constant.float_value) {
+            return RCLUC_FILTER_OP_NE == check->op;
+        }
+        order = ORDER(f64, check->constant.float_value);
+        break;
+    default:
+        return 0;
+    }
+    return compare(check->op, order);
+}
+
+rcluc_ret_t rcluc_filter_validate(const rcluc_content_filter_t * filter, size_t * extent) {
+    size_t size = 0;
+    if (NULL == filter || NULL == extent) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (NULL == filter->checks && filter->check_count > 0) {
+        return RCLUC_RET_NULL_PTR;
+    }
+
+    *extent = 0;
+    for (size_t i = 0; i < filter->check_count; ++i) {
+        const rcluc_filter_check_t * check = &filter->checks[i];
+        size = field_size(check->type);
+        if (0 == size || check->op > RCLUC_FILTER_OP_GE || 0 != rcluc_cdr_alignment(check->offset, size)) {
+            return RCLUC_RET_ERR_PARAM;
+        }
+        if ((size_t)check->offset + size > *extent) {
+            *extent = (size_t)check->offset + size;
+        }
+    }
+    return RCLUC_RET_OK;
+}
+
+uint8_t rcluc_filter_match(const rcluc_content_filter_t * filter, const uint8_t * data, size_t length) {
+    for (size_t i = 0; i < filter->check_count; ++i) {
+        if (!check_match(&filter->checks[i], data, length)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+#endif /* configRCLUC_ENABLE_SUBSCRIPTIONS */
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the creation of a graph declared at compile time
+ */
+
+#include "rcluc/rcluc_graph.h"
+
+static rcluc_ret_t create_entity(const rcluc_graph_entity_t * entity) {
+#if configRCLUC_ENABLE_PUBLISHERS
+    rcluc_publisher_config_t publisher_config;
+#endif
+#if configRCLUC_ENABLE_SUBSCRIPTIONS
+    rcluc_subscription_config_t subscription_config;
+#endif
+
+    switch (entity->kind) {
+    case RCLUC_ENTITY_NODE:
+        return rcluc_node_create(entity->name, entity->namespace_, (rcluc_node_handle_t *)entity->handle);
+#if configRCLUC_ENABLE_PUBLISHERS
+    case RCLUC_ENTITY_PUBLISHER:
+        rcluc_publisher_get_default_config(&publisher_config);
+        publisher_config.qos.reliability = entity->reliability;
+        return rcluc_publisher_create(*entity->node, entity->message_type, entity->name, entity->queue_length,
+            entity->message_buffer, &publisher_config, (rcluc_publisher_handle_t *)entity->handle);
+#endif
+#if configRCLUC_ENABLE_SUBSCRIPTIONS
+    case RCLUC_ENTITY_SUBSCRIPTION:
+        rcluc_subscription_get_default_config(&subscription_config);
+        subscription_config.qos.reliability = entity->reliability;
+        subscription_config.max_serialized_size = entity->max_serialized_size;
+        return rcluc_subscription_create(*entity->node, entity->message_type, entity->name, entity->callback,
+            entity->queue_length, entity->message_buffer, &subscription_config,
+            (rcluc_subscription_handle_t *)entity->handle);
+#endif
+    default:
+        return RCLUC_RET_ERR_PARAM;
+    }
+}
+
+/* Clears the handle variable of every entity of the table that the batch reported as failed */
+static void clear_failed_handles(const rcluc_graph_entity_t * entities, size_t count,
+    const rcluc_entity_status_t * failures, size_t failure_count) {
+    for (size_t i = 0; i < failure_count; ++i) {
+        for (size_t j = 0; j < count; ++j) {
+            void ** handle = (void **)entities[j].handle;
+            if (entities[j].kind == failures[i].kind && *handle == failures[i].handle) {
+                *handle = NULL;
+            }
+        }
+    }
+}
+
+rcluc_ret_t rcluc_graph_create(const rcluc_graph_entity_t * entities, size_t count, rcluc_entity_status_t * failures,
+    size_t failures_length, size_t * failure_count) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    rcluc_ret_t commit_status = RCLUC_RET_OK;
+    size_t failed = 0;
+    if (NULL == entities || (NULL == failures && failures_length > 0)) {
+        return RCLUC_RET_NULL_PTR;
+    }
+
+    status = rcluc_batch_begin();
+    if (RCLUC_RET_OK != status) {
+        return status;
+    }
+
+    // The table lists the nodes first, so a publisher or subscription always finds its node handle set. Creation
+    // stops at the first entity that cannot be queued, the batch is still committed to settle the ones before it.
+    for (size_t i = 0; i < count && RCLUC_RET_OK == status; ++i) {
+        status = create_entity(&entities[i]);
+    }
+
+    commit_status = rcluc_batch_commit(failures, failures_length, &failed);
+    clear_failed_handles(entities, count, failures, failed < failures_length ? failed : failures_length);
+    if (NULL != failure_count) {
+        *failure_count = failed;
+    }
+
+    if (RCLUC_RET_OK != status) {
+        return status;
+    }
+    return commit_status;
+}
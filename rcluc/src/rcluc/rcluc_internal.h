@@ -0,0 +1,507 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Definitions shared between the source files of the rcluc library. Not part of the public interface.
+ */
+
+#ifndef RCLUC__RCLUC_INTERNAL_H_
+#define RCLUC__RCLUC_INTERNAL_H_
+
+#include "rcluc/rcluc.h"
+#include "rcluc/rmwu.h"
+#include "rcluc/rcluc_types.h"
+#include "rcluc/rmwu_types.h"
+#include "rcluc/rcluc_record.h"
+
+/**
+ *  @brief The number of 64 bit words needed to hold a deserialized message
+ */
+#define RCLUC_DESERIALIZED_MESSAGE_WORDS ((configRCLUC_MAX_MESSAGE_SIZE_BYTES + 7) / 8)
+
+/**
+ *  @brief The size of the buffer needed to hold a DDS topic name built by rcluc_format_topic_name
+ */
+#define RCLUC_DDS_TOPIC_NAME_SIZE (configRCLUC_MAX_TOPIC_NAME_LEN + 16)
+
+/**
+ *  @brief Atomic accesses to the words shared with readers in other contexts, such as the mailbox sequence counters,
+ *  which are declared rcluc_atomic_uint32_t. Loads acquire, stores release and the fence is sequentially consistent.
+ *  The port hooks of the configuration come first (see configRCLUC_ATOMIC_LOAD), then C11 atomics, then the __atomic
+ *  builtins of GCC and Clang.
+ */
+#if defined(configRCLUC_ATOMIC_LOAD) && defined(configRCLUC_ATOMIC_STORE) && defined(configRCLUC_ATOMIC_FENCE)
+typedef volatile uint32_t rcluc_atomic_uint32_t;
+#define RCLUC_ATOMIC_LOAD(variable) configRCLUC_ATOMIC_LOAD(variable)
+#define RCLUC_ATOMIC_STORE(variable, value) configRCLUC_ATOMIC_STORE(variable, value)
+#define RCLUC_ATOMIC_FENCE() configRCLUC_ATOMIC_FENCE()
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+typedef _Atomic uint32_t rcluc_atomic_uint32_t;
+#define RCLUC_ATOMIC_LOAD(variable) atomic_load_explicit(&(variable), memory_order_acquire)
+#define RCLUC_ATOMIC_STORE(variable, value) atomic_store_explicit(&(variable), (value), memory_order_release)
+#define RCLUC_ATOMIC_FENCE() atomic_thread_fence(memory_order_seq_cst)
+#elif defined(__ATOMIC_ACQUIRE)
+typedef uint32_t rcluc_atomic_uint32_t;
+#define RCLUC_ATOMIC_LOAD(variable) __atomic_load_n(&(variable), __ATOMIC_ACQUIRE)
+#define RCLUC_ATOMIC_STORE(variable, value) __atomic_store_n(&(variable), (value), __ATOMIC_RELEASE)
+#define RCLUC_ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#error "Define configRCLUC_ATOMIC_LOAD, _STORE and _FENCE for compilers without C11 atomics or __atomic builtins"
+#endif
+
+/**
+ *  @brief Value of rcluc_subscription_s::mailbox_latest before the first sample is received
+ */
+#define RCLUC_MAILBOX_EMPTY 0xFFFFFFFFu
+
+/**
+ *  @brief The number of times rcluc_subscription_read_latest starts over before giving up on a sample being written
+ */
+#define RCLUC_MAILBOX_READ_ATTEMPTS 4
+
+/**
+ *  @brief A queue of serialized samples held in a user provided message_buffer.
+ *  Each entry is a rcluc_subscription_slot_header_t followed by the serialized bytes of the sample. Samples are
+ *  written at tail and read from head. Entries on loan are skipped by writes until they are released, so the queued
+ *  samples are not always contiguous.
+ */
+typedef struct {
+    uint8_t * buffer;
+    size_t queue_length;
+    size_t slot_size;
+    size_t head;
+    size_t tail;
+    size_t count;
+    size_t receiving_length;
+    uint32_t receiving_flags;
+} rcluc_queue_t;
+
+/**
+ *  @brief Flag of a queued sample whose content filter could not be evaluated when its first fragment was received
+ */
+#define RCLUC_QUEUE_FLAG_UNFILTERED 0x1u
+
+/**
+ *  @brief Flag set by the queue on the entries that hold a sample still to be read
+ */
+#define RCLUC_QUEUE_FLAG_QUEUED 0x80u
+
+/**
+ *  @brief The topic of a publisher or subscription as it appears in the log being recorded, see rcluc_record.h
+ *
+ *  @var rcluc_record_topic_t::topic_name
+ *      The ROS name of the topic, without leading slashes
+ *  @var rcluc_record_topic_t::generation
+ *      The recording the topic_id belongs to, the topic is written to the log again when a new recording starts
+ *  @var rcluc_record_topic_t::topic_id
+ *      The topic_id of the samples in the log
+ */
+typedef struct {
+    char topic_name[configRCLUC_MAX_TOPIC_NAME_LEN + 1];
+    uint16_t generation;
+    uint16_t topic_id;
+} rcluc_record_topic_t;
+
+struct rcluc_subscription_s {
+    uint8_t is_used;
+    rmwu_subscription_t rmwu_subscription;
+    void * user_metadata;
+    const rcluc_message_type_support_t * message_type;
+    rcluc_subscription_callback_t callback;
+    rcluc_subscription_exception_callback_t exception_callback;
+    uint8_t is_pending;
+    rcluc_queue_t queue;
+    uint8_t source_timestamp;
+    rcluc_message_info_t message_info;
+    const rcluc_content_filter_t * filter;
+    size_t filter_extent;
+    uint8_t is_delivering;
+    uint8_t mailbox;
+    /* Mailbox mode: odd while the entry is being written, and the entry holding the latest complete sample */
+    rcluc_atomic_uint32_t mailbox_sequence[2];
+    rcluc_atomic_uint32_t mailbox_latest;
+#if configRCLUC_ENABLE_PRIORITY_DISPATCH
+    uint8_t priority;
+#endif
+#if configRCLUC_ENABLE_RECORDER
+    rcluc_record_topic_t record;
+#endif
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT == RCLUC_SUBSCRIPTION_DESERIALIZATION_STATIC_ALLOCATION
+    uint64_t deserialized_message[RCLUC_DESERIALIZED_MESSAGE_WORDS];
+#endif
+};
+
+/**
+ *  @brief A queue of serialized samples packed back to back into a user provided message_buffer.
+ *  Each record is a uint32 length followed by the serialized bytes of the sample, padded to 4 bytes. A record that
+ *  does not fit before the end of the buffer starts over at its beginning, behind a record whose length is UINT32_MAX
+ *  when there is room for one.
+ */
+typedef struct {
+    uint8_t * buffer;
+    size_t size;
+    size_t head;
+    size_t tail;
+    size_t count;
+    size_t reserved;
+} rcluc_packed_queue_t;
+
+/**
+ *  @brief The congestion control state of a publisher, see rcluc_congestion.c
+ *
+ *  @var rcluc_congestion_t::priority
+ *      The priority of the publisher, rcluc_publisher_config_t::priority
+ *  @var rcluc_congestion_t::shift
+ *      The publisher is throttled to one message out of 2^shift
+ *  @var rcluc_congestion_t::is_congested
+ *      Set when a publish found the link congested since the last spin
+ *  @var rcluc_congestion_t::sequence
+ *      Counts the messages offered while the stream has room, to let one out of 2^shift through
+ *  @var rcluc_congestion_t::send_failures
+ *      The send failures of the session at the last spin
+ *  @var rcluc_congestion_t::dropped
+ *      The number of messages dropped
+ */
+typedef struct {
+    uint8_t priority;
+    uint8_t shift;
+    uint8_t is_congested;
+    uint16_t sequence;
+    uint32_t send_failures;
+    uint32_t dropped;
+} rcluc_congestion_t;
+
+struct rcluc_publisher_s {
+    uint8_t is_used;
+    uint8_t is_pending;
+    rmwu_publisher_t rmwu_publisher;
+    void * user_metadata;
+    rcluc_publisher_exception_callback_t exception_callback;
+    uint8_t packed;
+    rcluc_packed_queue_t queue;
+#if configRCLUC_ENABLE_RECORDER
+    rcluc_record_topic_t record;
+#endif
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+    rcluc_congestion_t congestion;
+#endif
+};
+
+/**
+ *  @brief A request that has been sent by a service client and is waiting for its response
+ */
+typedef struct {
+    uint8_t is_used;
+    int64_t sequence_number;
+    uint64_t request_id;
+    int64_t deadline_ms;
+} rcluc_pending_request_t;
+
+struct rcluc_client_s {
+    uint8_t is_used;
+    uint8_t is_pending;
+    rmwu_client_t rmwu_client;
+    void * user_metadata;
+    const rcluc_service_type_support_t * service_type;
+    rcluc_client_response_callback_t callback;
+    uint32_t request_timeout_ms;
+    int64_t next_sequence_number;
+    size_t requests_in_flight;
+    rcluc_pending_request_t pending_requests[configRCLUC_MAX_REQUESTS_IN_FLIGHT];
+    rcluc_queue_t response_queue;
+    int64_t response_reception_timestamp;
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT == RCLUC_SUBSCRIPTION_DESERIALIZATION_STATIC_ALLOCATION
+    uint64_t deserialized_response[RCLUC_DESERIALIZED_MESSAGE_WORDS];
+#endif
+};
+
+struct rcluc_session_s {
+    uint8_t is_used;
+    uint32_t client_key;
+    rmwu_session_t rmwu_session;
+};
+
+struct rcluc_node_s {
+    uint8_t is_used;
+    uint8_t is_pending;
+    rcluc_session_handle_t session;
+    rmwu_node_t rmwu_node;
+#if configRCLUC_ENABLE_SUBSCRIPTIONS
+    struct rcluc_subscription_s subscriptions[configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE];
+#endif
+#if configRCLUC_ENABLE_PUBLISHERS
+    struct rcluc_publisher_s publishers[configRCLUC_MAX_PUBLISHERS_PER_NODE];
+#endif
+#if configRCLUC_ENABLE_SERVICES
+    struct rcluc_client_s clients[configRCLUC_MAX_CLIENTS_PER_NODE];
+#endif
+};
+
+/**
+ *  @brief Initializes a queue over a message_buffer
+ *
+ *  @param queue The queue to initialize
+ *  @param buffer The message_buffer holding the queue entries
+ *  @param queue_length The number of entries in the queue
+ *  @param max_serialized_size The largest serialized sample an entry can hold
+ */
+void rcluc_queue_init(rcluc_queue_t * queue, uint8_t * buffer, size_t queue_length, size_t max_serialized_size);
+
+/**
+ *  @brief Writes serialized data received from the rmwu layer into the queue.
+ *  Data is copied straight into the free entry after the last queued sample, so samples that arrive in several
+ *  fragments are reassembled in place. Once the queue is full the oldest sample is dropped to make room for the newest.
+ *
+ *  @param flags The RCLUC_QUEUE_FLAG_* flags of the sample, taken from the call with offset 0
+ *  @return Returns RCLUC_RET_ERR_SPACE if the sample is larger than an entry of the queue
+ */
+rcluc_ret_t rcluc_queue_write(rcluc_queue_t * queue, const uint8_t * data, size_t offset, size_t length,
+    size_t total_length, uint32_t flags);
+
+/**
+ *  @brief Abandons the sample being received, so that its remaining fragments are ignored
+ *
+ *  @param queue The queue
+ */
+void rcluc_queue_discard(rcluc_queue_t * queue);
+
+/**
+ *  @brief Gets the oldest sample in the queue without removing it
+ *
+ *  @param queue The queue
+ *  @param length (output) The size (in bytes) of the serialized sample
+ *  @param reception_timestamp (output) The local time (in nanoseconds) the sample was received at. May be NULL.
+ *  @param flags (output) The RCLUC_QUEUE_FLAG_* flags of the sample. May be NULL.
+ *  @return The serialized sample or NULL if the queue is empty
+ */
+uint8_t * rcluc_queue_peek(rcluc_queue_t * queue, size_t * length, int64_t * reception_timestamp, uint32_t * flags);
+
+/**
+ *  @brief Gets the arrival of the oldest sample in the queue, which must not be empty. Arrivals count up across all
+ *  queues and wrap around, so two of them are compared by the sign of their difference, which orders samples received
+ *  less than 32768 samples apart.
+ *
+ *  @param queue The queue
+ *  @return The arrival of the sample
+ */
+uint16_t rcluc_queue_peek_arrival(rcluc_queue_t * queue);
+
+/**
+ *  @brief Removes the oldest sample from the queue
+ *
+ *  @param queue The queue
+ */
+void rcluc_queue_pop(rcluc_queue_t * queue);
+
+/**
+ *  @brief Takes a loan on the oldest sample of the queue, so that its entry is not reused once it is removed
+ *
+ *  @param queue The queue
+ *  @return The entry holding the sample, or NULL if the queue is empty or the sample has too many loans
+ */
+uint8_t * rcluc_queue_retain(rcluc_queue_t * queue);
+
+/**
+ *  @brief Gives back a loan taken with rcluc_queue_retain
+ *
+ *  @param slot The entry returned by rcluc_queue_retain
+ */
+void rcluc_queue_release(uint8_t * slot);
+
+/**
+ *  @brief Initializes a packed queue over a message_buffer
+ *
+ *  @param queue The queue to initialize
+ *  @param buffer The message_buffer holding the records
+ *  @param size The size (in bytes) of the message_buffer
+ */
+void rcluc_packed_queue_init(rcluc_packed_queue_t * queue, uint8_t * buffer, size_t size);
+
+/**
+ *  @brief Reserves room for a record at the end of a packed queue, which is added by rcluc_packed_queue_commit
+ *
+ *  @param queue The queue
+ *  @param length The size (in bytes) of the serialized sample
+ *  @return Where to write the sample, or NULL if the queue has no room for it
+ */
+uint8_t * rcluc_packed_queue_reserve(rcluc_packed_queue_t * queue, size_t length);
+
+/**
+ *  @brief Adds the record reserved by the last call to rcluc_packed_queue_reserve to the queue
+ *
+ *  @param queue The queue
+ */
+void rcluc_packed_queue_commit(rcluc_packed_queue_t * queue);
+
+/**
+ *  @brief Gets the oldest sample in a packed queue without removing it
+ *
+ *  @param queue The queue
+ *  @param length (output) The size (in bytes) of the sample
+ *  @return The serialized sample, or NULL if the queue is empty
+ */
+uint8_t * rcluc_packed_queue_peek(rcluc_packed_queue_t * queue, size_t * length);
+
+/**
+ *  @brief Removes the oldest sample from a packed queue
+ *
+ *  @param queue The queue
+ */
+void rcluc_packed_queue_pop(rcluc_packed_queue_t * queue);
+
+/**
+ *  @brief Checks that a content filter is well formed
+ *
+ *  @param filter The filter
+ *  @param extent (output) The number of serialized bytes needed to evaluate every check of the filter
+ *  @return Returns RCLUC_RET_ERR_PARAM if a check has an unknown type or operation, or a misaligned offset
+ */
+rcluc_ret_t rcluc_filter_validate(const rcluc_content_filter_t * filter, size_t * extent);
+
+/**
+ *  @brief Evaluates a content filter on a serialized message
+ *
+ *  @param filter The filter, which must have been validated
+ *  @param data The serialized message
+ *  @param length The size (in bytes) of the serialized message
+ *  @return 1 if every check holds, 0 otherwise. A check on a field that lies beyond length does not hold.
+ */
+uint8_t rcluc_filter_match(const rcluc_content_filter_t * filter, const uint8_t * data, size_t length);
+
+/**
+ *  @brief Builds the DDS topic name for a ROS name by adding the ROS prefix and suffix
+ *
+ *  @param prefix The ROS prefix, for example "rt/" for topics or "rq/" for service requests
+ *  @param name The ROS name
+ *  @param suffix The ROS suffix, for example "Request" for service requests
+ *  @param topic_name (output) A buffer of at least RCLUC_DDS_TOPIC_NAME_SIZE bytes
+ *  @return Returns RCLUC_RET_ERR_PARAM if the name is longer than configRCLUC_MAX_TOPIC_NAME_LEN
+ */
+rcluc_ret_t rcluc_format_topic_name(const char * prefix, const char * name, const char * suffix, char * topic_name);
+
+/**
+ *  @brief Tells if a batch of entity creations is open, in which case new entities are pending until it is committed
+ */
+uint8_t rcluc_batch_is_active(void);
+
+/**
+ *  @brief Dispatches the responses received by a service client and expires the requests that timed out
+ *
+ *  @param client The client to service
+ */
+void rcluc_client_spin(rcluc_client_handle_t client);
+
+/**
+ *  @brief Sends the next time synchronization request if the time synchronization runs on the node and it is due
+ *
+ *  @param node The node being spun
+ */
+void rcluc_time_sync_spin(rcluc_node_handle_t node);
+
+/**
+ *  @brief Publishes the buffered log records if the log is published by the node
+ *
+ *  @param node The node being spun
+ */
+void rcluc_log_spin(rcluc_node_handle_t node);
+
+/**
+ *  @brief Prepares the congestion control of a new publisher
+ *
+ *  @param publisher The publisher, which is created on the rmwu layer
+ *  @param priority The priority of the publisher
+ */
+void rcluc_congestion_init(rcluc_publisher_handle_t publisher, uint8_t priority);
+
+/**
+ *  @brief Decides whether a message of a publisher goes to the transport or is dropped
+ *
+ *  @param publisher The publisher
+ *  @return Returns RCLUC_RET_ERR_CONGESTION if the message has to be dropped
+ */
+rcluc_ret_t rcluc_congestion_admit(rcluc_publisher_handle_t publisher);
+
+/**
+ *  @brief Takes note of the outcome of handing a message to the transport
+ *
+ *  @param publisher The publisher
+ *  @param status The error code returned by the rmwu layer
+ */
+void rcluc_congestion_report(rcluc_publisher_handle_t publisher, rcluc_ret_t status);
+
+/**
+ *  @brief Adapts the throttling of the low priority publishers of a node to the feedback of the transport
+ *
+ *  @param node The node being spun, after its transport was serviced
+ */
+void rcluc_congestion_spin(rcluc_node_handle_t node);
+
+/**
+ *  @brief Remembers the topic of a publisher or subscription for the recorder
+ *
+ *  @param topic The recorder state of the entity
+ *  @param topic_name The ROS name of the topic, which has been checked by rcluc_format_topic_name
+ */
+void rcluc_record_topic_init(rcluc_record_topic_t * topic, const char * topic_name);
+
+/**
+ *  @brief Records a message that a publisher handed to the transport, serialized again into the log
+ *
+ *  @param topic The recorder state of the publisher
+ *  @param publisher The rmwu publisher, whose timestamp goes in front of the sample if it sends one
+ *  @param message The message
+ */
+void rcluc_record_message(rcluc_record_topic_t * topic, const rmwu_publisher_t * publisher, const void * message);
+
+/**
+ *  @brief Records a serialized message that a publisher handed to the transport
+ *
+ *  @param topic The recorder state of the publisher
+ *  @param publisher The rmwu publisher, whose timestamp goes in front of the sample if it sends one
+ *  @param fragments The pieces of the serialized message, without the timestamp
+ *  @param count The number of pieces
+ */
+void rcluc_record_fragments(rcluc_record_topic_t * topic, const rmwu_publisher_t * publisher,
+        const rcluc_buffer_fragment_t * fragments, size_t count);
+
+/**
+ *  @brief Records a sample delivered by a subscription
+ *
+ *  @param subscription The subscription
+ *  @param data The serialized sample as received, including the source timestamp if the subscription expects one
+ *  @param length The size (in bytes) of the sample
+ *  @param reception_timestamp The time of the local clock at which the sample was received
+ */
+void rcluc_record_reception(rcluc_subscription_handle_t subscription, const uint8_t * data, size_t length,
+        int64_t reception_timestamp);
+
+/**
+ *  @brief Writes a replayed sample into the queues of the subscriptions on its topic
+ *
+ *  @param record The sample
+ */
+void rcluc_replay_deliver(const rcluc_record_t * record);
+
+/**
+ *  @brief Converts a time of the local clock (rmwu_get_time_ns) to the time returned by rcluc_time_now
+ *
+ *  @param local_time The local time in nanoseconds
+ *  @return The synchronized time in nanoseconds
+ */
+int64_t rcluc_time_from_local(int64_t local_time);
+
+#endif /* ifndef RCLUC__RCLUC_INTERNAL_H_ */
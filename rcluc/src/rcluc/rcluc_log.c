@@ -0,0 +1,215 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the deferred logging
+ *
+ *  The records are kept back to back in a byte ring, where a record may wrap around the end of the buffer. A record is
+ *  a 4 byte header (the level in the lowest byte, the number of words in the next one), the 8 byte timestamp and the
+ *  words, all in the byte order of the microcontroller. A batch is published as a std_msgs/msg/UInt8MultiArray with no
+ *  dimensions, the number of records dropped since rcluc_log_start in data_offset and whole records as the data, which
+ *  are sent straight from the ring with rcluc_publisher_publish_fragments.
+ */
+
+#include "rcluc/rcluc_log.h"
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc_internal.h"
+
+#if configRCLUC_ENABLE_LOGGING
+
+#if !configRCLUC_ENABLE_PUBLISHERS
+#error "configRCLUC_ENABLE_LOGGING needs configRCLUC_ENABLE_PUBLISHERS"
+#endif
+
+#define LOG_RECORD_HEADER_SIZE      12
+#define LOG_RECORD_MAX_SIZE         (LOG_RECORD_HEADER_SIZE + 8 * (RCLUC_LOG_MAX_ARGS + 1))
+/* The layout dimension count, the data_offset and the length of the data of the UInt8MultiArray */
+#define LOG_BATCH_HEADER_SIZE       12
+
+#if configRCLUC_LOG_BATCH_SIZE < LOG_RECORD_MAX_SIZE
+#error "configRCLUC_LOG_BATCH_SIZE must hold the largest log record"
+#endif
+
+static rcluc_ret_t log_batch_serialize(const void * message, rcluc_cdr_buffer_t * buffer) {
+    // Batches are only published from the ring as fragments
+    return RCLUC_RET_ERROR;
+}
+
+static size_t log_batch_get_serialized_size(const void * message) {
+    return LOG_BATCH_HEADER_SIZE + configRCLUC_LOG_BATCH_SIZE;
+}
+
+static const rcluc_message_type_support_t log_batch_type_support = {
+    "std_msgs::msg::dds_::UInt8MultiArray_",
+    0,
+    LOG_BATCH_HEADER_SIZE + configRCLUC_LOG_BATCH_SIZE,
+    (rcluc_message_serialization_func_t)log_batch_serialize,
+    NULL,
+    (rcluc_message_serialized_size_func_t)log_batch_get_serialized_size
+};
+
+static uint8_t log_buffer[configRCLUC_LOG_BUFFER_SIZE];
+/* Free running positions, the writer only moves the head and the spin only moves the tail */
+static volatile uint32_t log_head = 0;
+static volatile uint32_t log_tail = 0;
+static volatile uint32_t log_dropped = 0;
+static uint32_t log_dropped_reported = 0;
+static rcluc_node_handle_t log_node = NULL;
+static rcluc_publisher_handle_t log_publisher = NULL;
+
+static void log_ring_write(uint32_t position, const void * data, size_t length) {
+    size_t offset = position % configRCLUC_LOG_BUFFER_SIZE;
+    size_t first = configRCLUC_LOG_BUFFER_SIZE - offset;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(&log_buffer[offset], data, first);
+    memcpy(log_buffer, (const uint8_t *)data + first, length - first);
+}
+
+static void log_ring_read(uint32_t position, void * data, size_t length) {
+    size_t offset = position % configRCLUC_LOG_BUFFER_SIZE;
+    size_t first = configRCLUC_LOG_BUFFER_SIZE - offset;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(data, &log_buffer[offset], first);
+    memcpy((uint8_t *)data + first, log_buffer, length - first);
+}
+
+void rcluc_log_write(uint8_t level, const uint64_t * words, size_t count) {
+    uint32_t head = log_head;
+    uint32_t header = 0;
+    int64_t timestamp = 0;
+    size_t size = LOG_RECORD_HEADER_SIZE + count * sizeof(uint64_t);
+
+    if (NULL == words || 0 == count || count > RCLUC_LOG_MAX_ARGS + 1) {
+        return;
+    } else if (configRCLUC_LOG_BUFFER_SIZE - (head - log_tail) < size) {
+        log_dropped = log_dropped + 1;
+        return;
+    }
+
+    header = (uint32_t)level | ((uint32_t)count << 8);
+    timestamp = rcluc_time_now();
+    log_ring_write(head, &header, sizeof(header));
+    log_ring_write(head + sizeof(header), &timestamp, sizeof(timestamp));
+    log_ring_write(head + LOG_RECORD_HEADER_SIZE, words, count * sizeof(uint64_t));
+    // The record is complete before the spin can see it
+    RCLUC_ATOMIC_FENCE();
+    log_head = head + (uint32_t)size;
+}
+
+void rcluc_log_spin(rcluc_node_handle_t node) {
+    uint8_t batch_header[LOG_BATCH_HEADER_SIZE];
+    rcluc_buffer_fragment_t fragments[3];
+    rcluc_cdr_buffer_t buffer;
+
+    if (NULL == log_publisher || node != log_node) {
+        return;
+    }
+
+    while (log_head != log_tail || log_dropped != log_dropped_reported) {
+        uint32_t tail = log_tail;
+        uint32_t head = log_head;
+        uint32_t dropped = log_dropped;
+        uint32_t length = 0;
+        uint32_t header = 0;
+        size_t count = 1;
+
+        // Whole records only, as many as fit into a batch
+        while (tail + length != head) {
+            log_ring_read(tail + length, &header, sizeof(header));
+            uint32_t size = LOG_RECORD_HEADER_SIZE + ((header >> 8) & 0xFF) * sizeof(uint64_t);
+            if (length + size > configRCLUC_LOG_BATCH_SIZE) {
+                break;
+            }
+            length += size;
+        }
+
+        rcluc_cdr_init(&buffer, batch_header, sizeof(batch_header));
+        (void) rcluc_cdr_serialize_uint32(&buffer, 0);
+        (void) rcluc_cdr_serialize_uint32(&buffer, dropped);
+        (void) rcluc_cdr_serialize_uint32(&buffer, length);
+        fragments[0].data = batch_header;
+        fragments[0].length = sizeof(batch_header);
+        if (length > 0) {
+            size_t offset = tail % configRCLUC_LOG_BUFFER_SIZE;
+            size_t first = configRCLUC_LOG_BUFFER_SIZE - offset;
+            fragments[1].data = &log_buffer[offset];
+            fragments[1].length = (first < length) ? first : length;
+            count = 2;
+            if (fragments[1].length < length) {
+                fragments[2].data = log_buffer;
+                fragments[2].length = length - fragments[1].length;
+                count = 3;
+            }
+        }
+
+        // The records stay in the ring until the publisher takes them, the next spin tries again
+        if (RCLUC_RET_OK != rcluc_publisher_publish_fragments(log_publisher, fragments, count)) {
+            return;
+        }
+        log_tail = tail + length;
+        log_dropped_reported = dropped;
+    }
+}
+
+rcluc_ret_t rcluc_log_start(rcluc_node_handle_t node_handle) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    rcluc_publisher_config_t config;
+
+    if (NULL == node_handle) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (NULL != log_publisher) {
+        return RCLUC_RET_ERR_ALREADY;
+    }
+
+    rcluc_publisher_get_default_config(&config);
+    config.qos.reliability = RCLUC_TOPIC_RELIABILITY_RELIABLE;
+    // The message_buffer of a publisher without a packed queue is not used, the ring takes its place
+    status = rcluc_publisher_create(node_handle, &log_batch_type_support, configRCLUC_LOG_TOPIC_NAME, 1, log_buffer,
+            &config, &log_publisher);
+
+    if (RCLUC_RET_OK == status) {
+        log_node = node_handle;
+        log_dropped = 0;
+        log_dropped_reported = 0;
+    } else {
+        log_publisher = NULL;
+    }
+    return status;
+}
+
+rcluc_ret_t rcluc_log_stop(void) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL == log_publisher) {
+        return RCLUC_RET_ERR_ALREADY;
+    }
+
+    status = rcluc_publisher_destroy(log_publisher);
+    if (RCLUC_RET_OK == status) {
+        log_publisher = NULL;
+        log_node = NULL;
+    }
+    return status;
+}
+
+uint32_t rcluc_log_get_dropped(void) {
+    return log_dropped;
+}
+
+#endif /* configRCLUC_ENABLE_LOGGING */
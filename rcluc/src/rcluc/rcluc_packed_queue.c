@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the packed queue of serialized samples used by publishers
+ */
+
+#include "rcluc_internal.h"
+#include <string.h>
+
+#if configRCLUC_ENABLE_PUBLISHERS
+
+/* Length of the marker record that sends readers back to the start of the buffer */
+#define PACKED_QUEUE_WRAP UINT32_MAX
+
+static uint32_t read_length(const rcluc_packed_queue_t * queue, size_t offset) {
+    uint32_t length;
+    memcpy(&length, &queue->buffer[offset], sizeof(length));
+    return length;
+}
+
+static void write_length(rcluc_packed_queue_t * queue, size_t offset, uint32_t length) {
+    memcpy(&queue->buffer[offset], &length, sizeof(length));
+}
+
+void rcluc_packed_queue_init(rcluc_packed_queue_t * queue, uint8_t * buffer, size_t size) {
+    queue->buffer = buffer;
+    queue->size = size & ~((size_t)3);
+    queue->head = 0;
+    queue->tail = 0;
+    queue->count = 0;
+    queue->reserved = 0;
+}
+
+uint8_t * rcluc_packed_queue_reserve(rcluc_packed_queue_t * queue, size_t length) {
+    size_t record_size = RCLUC_PUBLISHER_RECORD_SIZE(length);
+    if (0 == queue->count) {
+        queue->head = 0;
+        queue->tail = 0;
+    }
+
+    if (0 == queue->count) {
+        if (record_size > queue->size) {
+            return NULL;
+        }
+    } else if (queue->tail == queue->head) {
+        return NULL;
+    } else if (queue->tail > queue->head) {
+        // The free space is after tail and before head, a record never straddles the end of the buffer
+        if (queue->tail + record_size > queue->size) {
+            if (record_size > queue->head) {
+                return NULL;
+            }
+            if (queue->tail + RCLUC_PUBLISHER_RECORD_HEADER_SIZE <= queue->size) {
+                write_length(queue, queue->tail, PACKED_QUEUE_WRAP);
+            }
+            queue->tail = 0;
+        }
+    } else if (queue->tail + record_size > queue->head) {
+        return NULL;
+    }
+
+    queue->reserved = length;
+    return &queue->buffer[queue->tail + RCLUC_PUBLISHER_RECORD_HEADER_SIZE];
+}
+
+void rcluc_packed_queue_commit(rcluc_packed_queue_t * queue) {
+    write_length(queue, queue->tail, (uint32_t)queue->reserved);
+    queue->tail += RCLUC_PUBLISHER_RECORD_SIZE(queue->reserved);
+    if (queue->tail == queue->size) {
+        queue->tail = 0;
+    }
+    queue->count++;
+}
+
+uint8_t * rcluc_packed_queue_peek(rcluc_packed_queue_t * queue, size_t * length) {
+    if (0 == queue->count) {
+        return NULL;
+    }
+    if (PACKED_QUEUE_WRAP == read_length(queue, queue->head)) {
+        queue->head = 0;
+    }
+    *length = read_length(queue, queue->head);
+    return &queue->buffer[queue->head + RCLUC_PUBLISHER_RECORD_HEADER_SIZE];
+}
+
+void rcluc_packed_queue_pop(rcluc_packed_queue_t * queue) {
+    size_t length = 0;
+    if (NULL == rcluc_packed_queue_peek(queue, &length)) {
+        return;
+    }
+    queue->head += RCLUC_PUBLISHER_RECORD_SIZE(length);
+    if (queue->head == queue->size) {
+        queue->head = 0;
+    }
+    queue->count--;
+}
+
+#endif /* configRCLUC_ENABLE_PUBLISHERS */
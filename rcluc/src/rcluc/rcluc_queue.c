@@ -0,0 +1,187 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the queue of serialized samples used by subscriptions and service clients
+ */
+
+#include "rcluc_internal.h"
+#include <string.h>
+
+#if configRCLUC_ENABLE_SUBSCRIPTIONS || configRCLUC_ENABLE_SERVICES
+
+/* Counts the samples completed in all queues, so that samples of different queues can be put in order of arrival */
+static uint16_t arrivals = 0;
+
+static uint8_t * queue_slot(rcluc_queue_t * queue, size_t index) {
+    return &queue->buffer[(index % queue->queue_length) * queue->slot_size];
+}
+
+static void read_header(const uint8_t * slot, rcluc_subscription_slot_header_t * header) {
+    memcpy(header, slot, sizeof(*header));
+}
+
+static void write_header(uint8_t * slot, const rcluc_subscription_slot_header_t * header) {
+    memcpy(slot, header, sizeof(*header));
+}
+
+static uint8_t slot_is_loaned(const uint8_t * slot) {
+    rcluc_subscription_slot_header_t header;
+    read_header(slot, &header);
+    return header.loans > 0;
+}
+
+static uint8_t slot_is_queued(const uint8_t * slot) {
+    rcluc_subscription_slot_header_t header;
+    read_header(slot, &header);
+    return 0 != (header.flags & RCLUC_QUEUE_FLAG_QUEUED);
+}
+
+void rcluc_queue_init(rcluc_queue_t * queue, uint8_t * buffer, size_t queue_length, size_t max_serialized_size) {
+    rcluc_subscription_slot_header_t header = {0};
+    queue->buffer = buffer;
+    queue->queue_length = queue_length;
+    queue->slot_size = RCLUC_SUBSCRIPTION_SLOT_SIZE(max_serialized_size);
+    queue->head = 0;
+    queue->tail = 0;
+    queue->count = 0;
+    queue->receiving_length = 0;
+    queue->receiving_flags = 0;
+    for (size_t i = 0; i < queue_length; ++i) {
+        write_header(queue_slot(queue, i), &header);
+    }
+}
+
+rcluc_ret_t rcluc_queue_write(rcluc_queue_t * queue, const uint8_t * data, size_t offset, size_t length,
+        size_t total_length, uint32_t flags) {
+    rcluc_subscription_slot_header_t header = {0};
+    uint8_t * slot = NULL;
+
+    if (total_length > queue->slot_size - sizeof(header) || offset + length > total_length) {
+        queue->receiving_length = 0;
+        return RCLUC_RET_ERR_SPACE;
+    }
+
+    if (0 == offset) {
+        // Entries on loan stay where they are, the sample goes to the next entry that is not
+        for (size_t skipped = 0; slot_is_loaned(queue_slot(queue, queue->tail)); ++skipped) {
+            if (skipped == queue->queue_length) {
+                queue->receiving_length = 0;
+                return RCLUC_RET_ERR_SPACE;
+            }
+            queue->tail = (queue->tail + 1) % queue->queue_length;
+        }
+        if (queue->count > 0 && queue->tail == queue->head) {
+            rcluc_queue_pop(queue);
+        }
+        queue->receiving_length = total_length;
+        queue->receiving_flags = flags;
+    } else if (queue->receiving_length != total_length) {
+        // A fragment of a sample whose start was dropped
+        return RCLUC_RET_ERROR;
+    }
+
+    slot = queue_slot(queue, queue->tail);
+    memcpy(&slot[sizeof(header) + offset], data, length);
+
+    if (offset + length == total_length) {
+        header.length = (uint32_t)total_length;
+        header.flags = (uint8_t)(queue->receiving_flags | RCLUC_QUEUE_FLAG_QUEUED);
+        header.reception_timestamp = rmwu_get_time_ns();
+        header.arrival = arrivals++;
+        write_header(slot, &header);
+        queue->receiving_length = 0;
+        if (0 == queue->count) {
+            queue->head = queue->tail;
+        }
+        queue->count++;
+        queue->tail = (queue->tail + 1) % queue->queue_length;
+    }
+    return RCLUC_RET_OK;
+}
+
+uint8_t * rcluc_queue_peek(rcluc_queue_t * queue, size_t * length, int64_t * reception_timestamp, uint32_t * flags) {
+    rcluc_subscription_slot_header_t header;
+    uint8_t * slot = NULL;
+    if (0 == queue->count) {
+        return NULL;
+    }
+    slot = queue_slot(queue, queue->head);
+    read_header(slot, &header);
+    *length = header.length;
+    if (NULL != reception_timestamp) {
+        *reception_timestamp = header.reception_timestamp;
+    }
+    if (NULL != flags) {
+        *flags = header.flags;
+    }
+    return &slot[sizeof(header)];
+}
+
+uint16_t rcluc_queue_peek_arrival(rcluc_queue_t * queue) {
+    rcluc_subscription_slot_header_t header;
+    read_header(queue_slot(queue, queue->head), &header);
+    return header.arrival;
+}
+
+void rcluc_queue_discard(rcluc_queue_t * queue) {
+    queue->receiving_length = 0;
+}
+
+void rcluc_queue_pop(rcluc_queue_t * queue) {
+    rcluc_subscription_slot_header_t header;
+    uint8_t * slot = NULL;
+    if (0 == queue->count) {
+        return;
+    }
+    slot = queue_slot(queue, queue->head);
+    read_header(slot, &header);
+    header.flags = 0;
+    write_header(slot, &header);
+    queue->head = (queue->head + 1) % queue->queue_length;
+    queue->count--;
+    // Skip the entries that were on loan when later samples were written
+    while (queue->count > 0 && !slot_is_queued(queue_slot(queue, queue->head))) {
+        queue->head = (queue->head + 1) % queue->queue_length;
+    }
+}
+
+uint8_t * rcluc_queue_retain(rcluc_queue_t * queue) {
+    rcluc_subscription_slot_header_t header;
+    uint8_t * slot = NULL;
+    if (0 == queue->count) {
+        return NULL;
+    }
+    slot = queue_slot(queue, queue->head);
+    read_header(slot, &header);
+    if (UINT8_MAX == header.loans) {
+        return NULL;
+    }
+    header.loans++;
+    write_header(slot, &header);
+    return slot;
+}
+
+void rcluc_queue_release(uint8_t * slot) {
+    rcluc_subscription_slot_header_t header;
+    read_header(slot, &header);
+    if (header.loans > 0) {
+        header.loans--;
+        write_header(slot, &header);
+    }
+}
+
+#endif /* configRCLUC_ENABLE_SUBSCRIPTIONS || configRCLUC_ENABLE_SERVICES */
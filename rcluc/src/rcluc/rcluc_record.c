@@ -0,0 +1,434 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the recording and replay of serialized samples
+ *
+ *  A record is written in place at the end of the log and only becomes part of it when the length in the log header
+ *  moves past it, so the log is valid at any time, including in a file mapped by a process that gets killed.
+ */
+
+#include "rcluc/rcluc_record.h"
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc_internal.h"
+#include <string.h>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if configRCLUC_ENABLE_RECORDER
+
+#define RECORD_ALIGN(length) ((((size_t)(length)) + 3u) & ~((size_t)3u))
+
+static uint8_t * record_log = NULL;
+static size_t record_log_size = 0;
+/* Moved by every rcluc_record_start and never 0, the generation of an entity that was not recorded yet */
+static uint16_t record_generation = 0;
+static uint16_t record_topic_count = 0;
+#ifdef __linux__
+static int record_file = -1;
+#endif
+
+/* Writes the header of a record at the end of the log, and returns where its data goes or NULL if it does not fit */
+static uint8_t * record_reserve(uint16_t topic_id, uint8_t kind, int64_t timestamp, size_t length) {
+    rcluc_record_log_header_t * log_header = (rcluc_record_log_header_t *)record_log;
+    rcluc_record_header_t header;
+    size_t position = sizeof(rcluc_record_log_header_t) + log_header->length;
+
+    if (record_log_size - position < sizeof(header) + RECORD_ALIGN(length)) {
+        log_header->dropped++;
+        return NULL;
+    }
+    header.topic_id = topic_id;
+    header.kind = kind;
+    header.reserved = 0;
+    header.length = (uint32_t)length;
+    header.timestamp = timestamp;
+    memcpy(&record_log[position], &header, sizeof(header));
+    memset(&record_log[position + sizeof(header) + length], 0, RECORD_ALIGN(length) - length);
+    return &record_log[position + sizeof(header)];
+}
+
+/* Adds the record written by record_reserve to the log */
+static void record_commit(size_t length) {
+    rcluc_record_log_header_t * log_header = (rcluc_record_log_header_t *)record_log;
+    RCLUC_ATOMIC_FENCE();
+    log_header->length += (uint32_t)(sizeof(rcluc_record_header_t) + RECORD_ALIGN(length));
+}
+
+/* Returns the topic_id of an entity, after writing its topic record if it is new to the log, or 0 if the log is full */
+static uint16_t record_topic_id(rcluc_record_topic_t * topic, const char * type_name, uint8_t flags) {
+    uint16_t topic_id = (uint16_t)(record_topic_count + 1);
+    uint8_t * data = NULL;
+
+    if (topic->generation == record_generation) {
+        return topic->topic_id;
+    }
+    size_t name_length = strlen(topic->topic_name) + 1;
+    size_t type_length = strlen(type_name) + 1;
+    size_t length = 1 + name_length + type_length;
+    data = record_reserve(topic_id, RCLUC_RECORD_KIND_TOPIC, rcluc_time_now(), length);
+    if (NULL == data) {
+        return 0;
+    }
+    data[0] = flags;
+    memcpy(&data[1], topic->topic_name, name_length);
+    memcpy(&data[1 + name_length], type_name, type_length);
+    record_commit(length);
+    record_topic_count = topic_id;
+    topic->generation = record_generation;
+    topic->topic_id = topic_id;
+    return topic_id;
+}
+
+void rcluc_record_topic_init(rcluc_record_topic_t * topic, const char * topic_name) {
+    while ('/' == *topic_name) {
+        ++topic_name;
+    }
+    strncpy(topic->topic_name, topic_name, sizeof(topic->topic_name) - 1);
+    topic->topic_name[sizeof(topic->topic_name) - 1] = '\0';
+    topic->generation = 0;
+    topic->topic_id = 0;
+}
+
+void rcluc_record_message(rcluc_record_topic_t * topic, const rmwu_publisher_t * publisher, const void * message) {
+    const rcluc_message_type_support_t * message_type = publisher->message_type;
+    rcluc_cdr_buffer_t buffer;
+    uint16_t topic_id = 0;
+    uint8_t * data = NULL;
+
+    if (NULL == record_log) {
+        return;
+    }
+    topic_id = record_topic_id(topic, message_type->type_name,
+            publisher->source_timestamp ? RCLUC_RECORD_FLAG_SOURCE_TIMESTAMP : 0);
+    if (0 == topic_id) {
+        return;
+    }
+    size_t length = message_type->get_serialized_size(message);
+    if (publisher->source_timestamp) {
+        length += RCLUC_SOURCE_TIMESTAMP_SIZE;
+    }
+    data = record_reserve(topic_id, RCLUC_RECORD_KIND_PUBLISHED, rcluc_time_now(), length);
+    if (NULL == data) {
+        return;
+    }
+
+    rcluc_cdr_init(&buffer, data, length);
+    if (publisher->source_timestamp) {
+        (void) rcluc_cdr_serialize_uint64(&buffer, (uint64_t)publisher->timestamp);
+    }
+    if (RCLUC_RET_OK == message_type->serialize(message, &buffer) && rcluc_cdr_get_length(&buffer) == length) {
+        record_commit(length);
+    }
+}
+
+void rcluc_record_fragments(rcluc_record_topic_t * topic, const rmwu_publisher_t * publisher,
+        const rcluc_buffer_fragment_t * fragments, size_t count) {
+    rcluc_cdr_buffer_t buffer;
+    uint16_t topic_id = 0;
+    uint8_t * data = NULL;
+    size_t length = publisher->source_timestamp ? RCLUC_SOURCE_TIMESTAMP_SIZE : 0;
+
+    if (NULL == record_log) {
+        return;
+    }
+    topic_id = record_topic_id(topic, publisher->message_type->type_name,
+            publisher->source_timestamp ? RCLUC_RECORD_FLAG_SOURCE_TIMESTAMP : 0);
+    if (0 == topic_id) {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        length += fragments[i].length;
+    }
+    data = record_reserve(topic_id, RCLUC_RECORD_KIND_PUBLISHED, rcluc_time_now(), length);
+    if (NULL == data) {
+        return;
+    }
+
+    if (publisher->source_timestamp) {
+        rcluc_cdr_init(&buffer, data, RCLUC_SOURCE_TIMESTAMP_SIZE);
+        (void) rcluc_cdr_serialize_uint64(&buffer, (uint64_t)publisher->timestamp);
+        data += RCLUC_SOURCE_TIMESTAMP_SIZE;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        memcpy(data, fragments[i].data, fragments[i].length);
+        data += fragments[i].length;
+    }
+    record_commit(length);
+}
+
+void rcluc_record_reception(rcluc_subscription_handle_t subscription, const uint8_t * data, size_t length,
+        int64_t reception_timestamp) {
+    uint16_t topic_id = 0;
+    uint8_t * record = NULL;
+
+    if (NULL == record_log) {
+        return;
+    }
+    topic_id = record_topic_id(&subscription->record, subscription->message_type->type_name,
+            subscription->source_timestamp ? RCLUC_RECORD_FLAG_SOURCE_TIMESTAMP : 0);
+    if (0 == topic_id) {
+        return;
+    }
+    record = record_reserve(topic_id, RCLUC_RECORD_KIND_RECEIVED, rcluc_time_from_local(reception_timestamp), length);
+    if (NULL != record) {
+        memcpy(record, data, length);
+        record_commit(length);
+    }
+}
+
+rcluc_ret_t rcluc_record_start(uint8_t * buffer, size_t size) {
+    rcluc_record_log_header_t * log_header = (rcluc_record_log_header_t *)buffer;
+    if (NULL == buffer) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (size < sizeof(rcluc_record_log_header_t)) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    if (NULL != record_log) {
+        (void) rcluc_record_stop(NULL);
+    }
+
+    log_header->magic = RCLUC_RECORD_LOG_MAGIC;
+    log_header->version = RCLUC_RECORD_LOG_VERSION;
+    log_header->reserved = 0;
+    log_header->length = 0;
+    log_header->dropped = 0;
+    record_log = buffer;
+    record_log_size = size;
+    record_topic_count = 0;
+    record_generation = (uint16_t)(record_generation + 1);
+    if (0 == record_generation) {
+        record_generation = 1;
+    }
+    return RCLUC_RET_OK;
+}
+
+#ifdef __linux__
+rcluc_ret_t rcluc_record_start_file(const char * path, size_t size) {
+    void * mapping = MAP_FAILED;
+    int file = -1;
+    if (NULL == path) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (size < sizeof(rcluc_record_log_header_t)) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    if (NULL != record_log) {
+        (void) rcluc_record_stop(NULL);
+    }
+
+    file = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file < 0) {
+        return RCLUC_RET_ERROR;
+    }
+    if (0 == ftruncate(file, (off_t)size)) {
+        mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    }
+    if (MAP_FAILED == mapping) {
+        (void) close(file);
+        return RCLUC_RET_ERROR;
+    }
+    (void) rcluc_record_start((uint8_t *)mapping, size);
+    record_file = file;
+    return RCLUC_RET_OK;
+}
+#endif
+
+rcluc_ret_t rcluc_record_stop(size_t * length) {
+    size_t log_length = 0;
+    if (NULL == record_log) {
+        return RCLUC_RET_ERR_ALREADY;
+    }
+
+    log_length = sizeof(rcluc_record_log_header_t) + ((const rcluc_record_log_header_t *)record_log)->length;
+#ifdef __linux__
+    if (record_file >= 0) {
+        (void) munmap(record_log, record_log_size);
+        (void) ftruncate(record_file, (off_t)log_length);
+        (void) close(record_file);
+        record_file = -1;
+    }
+#endif
+    record_log = NULL;
+    record_log_size = 0;
+    if (NULL != length) {
+        *length = log_length;
+    }
+    return RCLUC_RET_OK;
+}
+
+rcluc_ret_t rcluc_replay_init(rcluc_replay_t * replay, const uint8_t * log, size_t size, uint32_t speed_percent) {
+    rcluc_record_log_header_t log_header;
+    if (NULL == replay || NULL == log) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (size < sizeof(log_header)) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    memcpy(&log_header, log, sizeof(log_header));
+    if (RCLUC_RECORD_LOG_MAGIC != log_header.magic || RCLUC_RECORD_LOG_VERSION != log_header.version) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+
+    memset(replay, 0, sizeof(*replay));
+    replay->log = log;
+    replay->end = sizeof(log_header) + log_header.length;
+    if (replay->end > size) {
+        replay->end = size;
+    }
+    replay->position = sizeof(log_header);
+    replay->speed_percent = speed_percent;
+    return RCLUC_RET_OK;
+}
+
+#ifdef __linux__
+rcluc_ret_t rcluc_replay_open_file(rcluc_replay_t * replay, const char * path, uint32_t speed_percent) {
+    rcluc_ret_t status = RCLUC_RET_ERROR;
+    struct stat file_status;
+    void * mapping = MAP_FAILED;
+    int file = -1;
+    if (NULL == replay || NULL == path) {
+        return RCLUC_RET_NULL_PTR;
+    }
+
+    file = open(path, O_RDONLY);
+    if (file < 0) {
+        return RCLUC_RET_ERROR;
+    }
+    if (0 == fstat(file, &file_status) && file_status.st_size > 0) {
+        mapping = mmap(NULL, (size_t)file_status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    // The mapping stays valid after the file is closed
+    (void) close(file);
+    if (MAP_FAILED == mapping) {
+        return RCLUC_RET_ERROR;
+    }
+
+    status = rcluc_replay_init(replay, (const uint8_t *)mapping, (size_t)file_status.st_size, speed_percent);
+    if (RCLUC_RET_OK == status) {
+        replay->mapping = mapping;
+        replay->mapping_size = (size_t)file_status.st_size;
+    } else {
+        (void) munmap(mapping, (size_t)file_status.st_size);
+    }
+    return status;
+}
+
+void rcluc_replay_close(rcluc_replay_t * replay) {
+    if (NULL != replay && NULL != replay->mapping) {
+        (void) munmap(replay->mapping, replay->mapping_size);
+        replay->mapping = NULL;
+        replay->log = NULL;
+        replay->end = 0;
+        replay->position = 0;
+    }
+}
+#endif
+
+/* Remembers the names of a topic record, which are trusted only if both are terminated within the record */
+static void replay_define_topic(rcluc_replay_t * replay, const rcluc_record_header_t * header, const uint8_t * data) {
+    const uint8_t * name_end = NULL;
+    const uint8_t * type_end = NULL;
+    size_t index = (size_t)header->topic_id - 1;
+
+    if (0 == header->topic_id || index >= configRCLUC_RECORD_MAX_TOPICS || header->length < 3) {
+        return;
+    }
+    name_end = (const uint8_t *)memchr(&data[1], '\0', header->length - 1);
+    if (NULL != name_end) {
+        type_end = (const uint8_t *)memchr(name_end + 1, '\0', header->length - (size_t)(name_end + 1 - data));
+    }
+    if (NULL != type_end) {
+        replay->topic_flags[index] = data[0];
+        replay->topic_names[index] = (const char *)&data[1];
+        replay->type_names[index] = (const char *)(name_end + 1);
+    }
+}
+
+rcluc_ret_t rcluc_replay_next(rcluc_replay_t * replay, rcluc_record_t * record) {
+    rcluc_record_header_t header;
+    if (NULL == replay || NULL == record) {
+        return RCLUC_RET_NULL_PTR;
+    }
+
+    while (replay->end - replay->position >= sizeof(header)) {
+        memcpy(&header, &replay->log[replay->position], sizeof(header));
+        const uint8_t * data = &replay->log[replay->position + sizeof(header)];
+        size_t size = sizeof(header) + RECORD_ALIGN(header.length);
+        if (replay->end - replay->position < size) {
+            break;
+        }
+
+        if (RCLUC_RECORD_KIND_TOPIC == header.kind) {
+            replay_define_topic(replay, &header, data);
+            replay->position += size;
+            continue;
+        }
+        if (replay->speed_percent > 0) {
+            int64_t now = rmwu_get_time_ns();
+            if (0 == replay->start_time) {
+                replay->start_time = now;
+                replay->first_timestamp = header.timestamp;
+            } else if (now - replay->start_time
+                    < (header.timestamp - replay->first_timestamp) * 100 / (int64_t)replay->speed_percent) {
+                return RCLUC_RET_TIMEOUT;
+            }
+        }
+        replay->position += size;
+
+        // Samples of a topic whose record is missing or beyond configRCLUC_RECORD_MAX_TOPICS cannot be told apart
+        size_t index = (size_t)header.topic_id - 1;
+        if (0 == header.topic_id || index >= configRCLUC_RECORD_MAX_TOPICS || NULL == replay->topic_names[index]) {
+            continue;
+        }
+        record->topic_id = header.topic_id;
+        record->kind = header.kind;
+        record->flags = replay->topic_flags[index];
+        record->timestamp = header.timestamp;
+        record->topic_name = replay->topic_names[index];
+        record->type_name = replay->type_names[index];
+        record->data = data;
+        record->length = header.length;
+        return RCLUC_RET_OK;
+    }
+    return RCLUC_RET_NO_DATA;
+}
+
+rcluc_ret_t rcluc_replay_step(rcluc_replay_t * replay) {
+    rcluc_record_t record;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    uint8_t delivered = 0;
+    if (NULL == replay) {
+        return RCLUC_RET_NULL_PTR;
+    }
+
+    while (RCLUC_RET_OK == (status = rcluc_replay_next(replay, &record))) {
+        if (RCLUC_RECORD_KIND_RECEIVED != record.kind) {
+            continue;
+        }
+        rcluc_replay_deliver(&record);
+        delivered = 1;
+        if (0 == replay->speed_percent) {
+            return RCLUC_RET_OK;
+        }
+    }
+    // The end of the log is only reported once the samples of the last step had a spin to be dispatched
+    return (RCLUC_RET_TIMEOUT == status || delivered) ? RCLUC_RET_OK : status;
+}
+
+#endif /* configRCLUC_ENABLE_RECORDER */
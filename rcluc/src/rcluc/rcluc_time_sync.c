@@ -0,0 +1,270 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the time synchronization with the ROS graph
+ *
+ *  Every exchange records four times: t0 when the request is sent (local clock), t1 when the server received it and t2
+ *  when the server sent the response (server clock), and t3 when the response was received (local clock). As with NTP
+ *  the clock offset is ((t1 - t0) + (t2 - t3)) / 2 and the round trip time is (t3 - t0) - (t2 - t1). The offset is only
+ *  exact if both legs of the round trip took the same time, so the exchange with the lowest round trip time among the
+ *  recent ones is trusted the most.
+ *
+ *  The server is a ROS 2 node answering rcluc_msgs/srv/TimeSync requests with its clock, for example
+ *  rcluc/tools/rcluc_time_sync_server.py running next to the agent. The request_id that starts the request and the
+ *  response of rcluc/tools/TimeSync.srv is the header of the service client, the types below only hold the times.
+ */
+
+#include "rcluc/rcluc.h"
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc_internal.h"
+#include <string.h>
+
+#define TIME_SYNC_REQUEST_SIZE      8
+#define TIME_SYNC_RESPONSE_SIZE     24
+#define TIME_SYNC_QUEUE_LENGTH      2
+
+/* The offset stays in use after the synchronization stopped, and is 0 if it never ran or is compiled out */
+static rcluc_time_sync_status_t sync_status = {0};
+
+int64_t rcluc_time_from_local(int64_t local_time) {
+    return local_time + sync_status.offset;
+}
+
+int64_t rcluc_time_now(void) {
+    return rcluc_time_from_local(rmwu_get_time_ns());
+}
+
+#if configRCLUC_ENABLE_SERVICES
+
+typedef struct {
+    int64_t client_transmit_time;
+} rcluc_time_sync_request_t;
+
+typedef struct {
+    int64_t client_transmit_time;
+    int64_t server_receive_time;
+    int64_t server_transmit_time;
+} rcluc_time_sync_response_t;
+
+typedef struct {
+    int64_t offset;
+    int64_t round_trip_time;
+} rcluc_time_sync_sample_t;
+
+/*
+ * The functions of the type supports take the void pointers of the function types they are stored as, calling them
+ * through a cast function pointer would be undefined behavior
+ */
+static rcluc_ret_t request_serialize(const void * message, rcluc_cdr_buffer_t * buffer) {
+    const rcluc_time_sync_request_t * request = (const rcluc_time_sync_request_t *)message;
+    return rcluc_cdr_serialize_uint64(buffer, (uint64_t)request->client_transmit_time);
+}
+
+static rcluc_ret_t request_deserialize(void * message_buffer, size_t message_buffer_size, void * message,
+        size_t request_size) {
+    rcluc_time_sync_request_t * request = (rcluc_time_sync_request_t *)message;
+    rcluc_cdr_buffer_t buffer;
+    if (NULL == message_buffer || NULL == request) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (request_size < sizeof(rcluc_time_sync_request_t)) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    rcluc_cdr_init(&buffer, (uint8_t *)message_buffer, message_buffer_size);
+    return rcluc_cdr_deserialize_uint64(&buffer, (uint64_t *)&request->client_transmit_time);
+}
+
+static size_t request_get_serialized_size(const void * request) {
+    (void) request;
+    return TIME_SYNC_REQUEST_SIZE;
+}
+
+static rcluc_ret_t response_serialize(const void * message, rcluc_cdr_buffer_t * buffer) {
+    const rcluc_time_sync_response_t * response = (const rcluc_time_sync_response_t *)message;
+    (void) rcluc_cdr_serialize_uint64(buffer, (uint64_t)response->client_transmit_time);
+    (void) rcluc_cdr_serialize_uint64(buffer, (uint64_t)response->server_receive_time);
+    return rcluc_cdr_serialize_uint64(buffer, (uint64_t)response->server_transmit_time);
+}
+
+static rcluc_ret_t response_deserialize(void * message_buffer, size_t message_buffer_size, void * message,
+        size_t response_size) {
+    rcluc_time_sync_response_t * response = (rcluc_time_sync_response_t *)message;
+    rcluc_cdr_buffer_t buffer;
+    if (NULL == message_buffer || NULL == response) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (response_size < sizeof(rcluc_time_sync_response_t)) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    rcluc_cdr_init(&buffer, (uint8_t *)message_buffer, message_buffer_size);
+    (void) rcluc_cdr_deserialize_uint64(&buffer, (uint64_t *)&response->client_transmit_time);
+    (void) rcluc_cdr_deserialize_uint64(&buffer, (uint64_t *)&response->server_receive_time);
+    return rcluc_cdr_deserialize_uint64(&buffer, (uint64_t *)&response->server_transmit_time);
+}
+
+static size_t response_get_serialized_size(const void * response) {
+    (void) response;
+    return TIME_SYNC_RESPONSE_SIZE;
+}
+
+static const rcluc_message_type_support_t request_type_support = {
+    "rcluc_msgs::srv::dds_::TimeSync_Request_",
+    sizeof(rcluc_time_sync_request_t),
+    TIME_SYNC_REQUEST_SIZE,
+    request_serialize,
+    request_deserialize,
+    request_get_serialized_size
+};
+
+static const rcluc_message_type_support_t response_type_support = {
+    "rcluc_msgs::srv::dds_::TimeSync_Response_",
+    sizeof(rcluc_time_sync_response_t),
+    TIME_SYNC_RESPONSE_SIZE,
+    response_serialize,
+    response_deserialize,
+    response_get_serialized_size
+};
+
+static const rcluc_service_type_support_t service_type_support = {
+    &request_type_support,
+    &response_type_support
+};
+
+static uint8_t response_buffer[RCLUC_SUBSCRIPTION_BUFFER_SIZE(TIME_SYNC_RESPONSE_SIZE + RCLUC_SERVICE_HEADER_SIZE,
+        TIME_SYNC_QUEUE_LENGTH)];
+static rcluc_node_handle_t sync_node = NULL;
+static rcluc_client_handle_t sync_client = NULL;
+static uint32_t sync_period_ms = 0;
+static int64_t next_request_ms = 0;
+static rcluc_time_sync_sample_t samples[configRCLUC_TIME_SYNC_FILTER_SAMPLES];
+
+/* Picks the offset of the exchange with the lowest round trip time among the recent ones */
+static void time_sync_filter(void) {
+    size_t count = (sync_status.samples < configRCLUC_TIME_SYNC_FILTER_SAMPLES) ? sync_status.samples
+            : configRCLUC_TIME_SYNC_FILTER_SAMPLES;
+    const rcluc_time_sync_sample_t * best = &samples[0];
+    for (size_t i = 1; i < count; ++i) {
+        if (samples[i].round_trip_time < best->round_trip_time) {
+            best = &samples[i];
+        }
+    }
+    sync_status.offset = best->offset;
+    sync_status.round_trip_time = best->round_trip_time;
+    sync_status.is_synchronized = 1;
+}
+
+static void time_sync_on_response(const rcluc_client_handle_t client, int64_t sequence_number, const void * response,
+        rcluc_ret_t status, const void * args) {
+    rcluc_time_sync_response_t times;
+    rcluc_time_sync_sample_t sample;
+    int64_t reception_time = client->response_reception_timestamp;
+    // The response echoes the transmit time of its request, which is all the exchange needs from the request
+    (void) sequence_number;
+    (void) args;
+
+    if (RCLUC_RET_OK != status) {
+        return;
+    }
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT == RCLUC_SUBSCRIPTION_DESERIALIZATION_DISABLED
+    if (RCLUC_RET_OK != response_deserialize((void *)response, TIME_SYNC_RESPONSE_SIZE, &times, sizeof(times))) {
+        return;
+    }
+#else
+    memcpy(&times, response, sizeof(times));
+#endif
+
+    sample.round_trip_time = (reception_time - times.client_transmit_time)
+            - (times.server_transmit_time - times.server_receive_time);
+    sample.offset = ((times.server_receive_time - times.client_transmit_time)
+            + (times.server_transmit_time - reception_time)) / 2;
+    // The server's processing time cannot exceed the whole round trip, drop the exchange if its clock misbehaves
+    if (sample.round_trip_time < 0) {
+        return;
+    }
+    samples[sync_status.samples % configRCLUC_TIME_SYNC_FILTER_SAMPLES] = sample;
+    sync_status.samples++;
+    time_sync_filter();
+}
+
+void rcluc_time_sync_spin(rcluc_node_handle_t node) {
+    rcluc_time_sync_request_t request;
+    int64_t sequence_number = 0;
+    int64_t now = 0;
+
+    if (NULL == sync_client || node != sync_node) {
+        return;
+    }
+    now = rmwu_get_time_ms();
+    if (now < next_request_ms) {
+        return;
+    }
+
+    request.client_transmit_time = rmwu_get_time_ns();
+    // A request still waiting for its response is not worth another one, so a full client just skips a period
+    (void) rcluc_client_send_request(sync_client, &request, &sequence_number);
+    next_request_ms = now + sync_period_ms;
+}
+
+rcluc_ret_t rcluc_time_sync_start(rcluc_node_handle_t node_handle, uint32_t period_ms) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    rcluc_service_client_config_t config;
+
+    if (NULL == node_handle) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (0 == period_ms) {
+        return RCLUC_RET_ERR_PARAM;
+    } else if (NULL != sync_client) {
+        return RCLUC_RET_ERR_ALREADY;
+    }
+
+    rcluc_client_get_default_config(&config);
+    config.request_timeout_ms = period_ms;
+    config.max_serialized_size = TIME_SYNC_RESPONSE_SIZE;
+    status = rcluc_client_create(node_handle, &service_type_support, configRCLUC_TIME_SYNC_SERVICE_NAME,
+            time_sync_on_response, TIME_SYNC_QUEUE_LENGTH, response_buffer, &config, &sync_client);
+
+    if (RCLUC_RET_OK == status) {
+        sync_node = node_handle;
+        sync_period_ms = period_ms;
+        next_request_ms = rmwu_get_time_ms();
+    } else {
+        sync_client = NULL;
+    }
+    return status;
+}
+
+rcluc_ret_t rcluc_time_sync_stop(void) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL == sync_client) {
+        return RCLUC_RET_ERR_ALREADY;
+    }
+
+    status = rcluc_client_destroy(sync_client);
+    if (RCLUC_RET_OK == status) {
+        sync_client = NULL;
+        sync_node = NULL;
+    }
+    return status;
+}
+
+rcluc_ret_t rcluc_time_sync_get_status(rcluc_time_sync_status_t * status) {
+    if (NULL == status) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    *status = sync_status;
+    return RCLUC_RET_OK;
+}
+
+#endif /* configRCLUC_ENABLE_SERVICES */
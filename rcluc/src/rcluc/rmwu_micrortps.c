@@ -19,55 +19,1479 @@
  *  library micro-RTPS.
  */
 
+#include "rcluc/rmwu.h"
 #include "rcluc/rmwu_types.h"
 #include "rcluc/rcluc_types.h"
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc/rcluc_default_configs.h"
+#include "rmwu_micrortps_stream.h"
+#include "rmwu_xrce.h"
+#include <stdio.h>
+#include <string.h>
+#ifndef configRCLUC_GET_TIME_NS
+#include <time.h>
+#endif
 
-static mrSession session;
+/* The largest XRCE message header: session id, stream id, sequence number and client key */
+#define RMWU_MAX_MESSAGE_HEADER_SIZE    (RMWU_XRCE_MESSAGE_HEADER_SIZE + RMWU_XRCE_CLIENT_KEY_SIZE)
+/* Messages sent around the output streams go on the none stream, which the agent does not order */
+#define RMWU_STREAM_ID_NONE             0
+/* The headers sent in front of the fragments of a gathered sample */
+#define RMWU_GATHER_HEADER_SIZE \
+    (RMWU_MAX_MESSAGE_HEADER_SIZE + RMWU_XRCE_SUBHEADER_SIZE + RMWU_XRCE_DATA_HEADER_SIZE + RCLUC_SOURCE_TIMESTAMP_SIZE)
+/* Samples in more pieces than this are copied into the stream instead */
+#define RMWU_MAX_GATHER_FRAGMENTS       8
+/* The largest fragment that fits into a single slot of the reliable output stream, kept 4 byte aligned */
+#define RMWU_FRAGMENT_PAYLOAD_SIZE \
+    (((configRCLUC_RELIABLE_STREAM_BUFFER_SIZE / configRCLUC_RELIABLE_STREAM_HISTORY) \
+        - RMWU_MAX_MESSAGE_HEADER_SIZE - RMWU_XRCE_SUBHEADER_SIZE) & ~((size_t)3))
+/* Subsystems compiled out with configRCLUC_ENABLE_* take no room in the tables */
+#define RMWU_SUBSCRIPTIONS_PER_NODE     (configRCLUC_ENABLE_SUBSCRIPTIONS ? configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE : 0)
+#define RMWU_PUBLISHERS_PER_NODE        (configRCLUC_ENABLE_PUBLISHERS ? configRCLUC_MAX_PUBLISHERS_PER_NODE : 0)
+#define RMWU_CLIENTS_PER_NODE           (configRCLUC_ENABLE_SERVICES ? configRCLUC_MAX_CLIENTS_PER_NODE : 0)
+/* Service clients are built from a datawriter for their requests and a datareader for their replies */
+#define RMWU_ENABLE_DATAREADERS         (configRCLUC_ENABLE_SUBSCRIPTIONS || configRCLUC_ENABLE_SERVICES)
+#define RMWU_ENABLE_DATAWRITERS         (configRCLUC_ENABLE_PUBLISHERS || configRCLUC_ENABLE_SERVICES)
+/* Service clients register their reply subscription next to the node's subscriptions */
+#define RMWU_MAX_SUBSCRIPTIONS \
+    (configRCLUC_MAX_NUM_NODES * (RMWU_SUBSCRIPTIONS_PER_NODE + RMWU_CLIENTS_PER_NODE))
+/* Every publisher and subscription owns a topic, a publisher or subscriber and a datawriter or datareader */
+#define RMWU_MAX_TOPICS \
+    (configRCLUC_MAX_NUM_NODES * (RMWU_PUBLISHERS_PER_NODE + RMWU_SUBSCRIPTIONS_PER_NODE \
+        + (2 * RMWU_CLIENTS_PER_NODE)))
+#define RMWU_MAX_ENTITIES               (configRCLUC_MAX_NUM_NODES + (3 * RMWU_MAX_TOPICS))
+#define RMWU_MAX_NAMES                  (configRCLUC_MAX_NUM_NODES + RMWU_MAX_TOPICS)
+#define RMWU_NAME_SIZE                  (configRCLUC_MAX_TOPIC_NAME_LEN + 16)
+#define RMWU_NO_NAME                    0xFF
+/* request_index of an entity without a pending request, or whose request could not be written */
+#define RMWU_NO_REQUEST                 0xFFFF
+#define RMWU_REQUEST_NOT_SENT           0xFFFE
+/* Every entity is created by one request, and every datareader needs one more to start the flow of data */
+#define RMWU_MAX_REQUESTS               (RMWU_MAX_ENTITIES + RMWU_MAX_SUBSCRIPTIONS)
+/* Entities that already exist on the agent with a matching definition are reused instead of being re-created */
+#define RMWU_ENTITY_CREATION_FLAGS      (MR_REUSE | MR_REPLACE)
+/* The number of samples of a batch publish whose sizes are computed ahead of a single stream reservation */
+#define RMWU_PUBLISH_BATCH_SIZE         16
+#define RMWU_XML_BUFFER_SIZE            (384 + (2 * configRCLUC_MAX_TOPIC_NAME_LEN))
 
-rcluc_ret_t rmwu_init(const rcluc_client_config_t * config) {
+#if RMWU_MAX_NAMES >= RMWU_NO_NAME
+#error "Too many nodes and topics for the entity table"
+#endif
+
+/*
+ * A session with the agent over one transport. Every session has its own streams and keeps the creation requests it
+ * has outstanding, so traffic on one link never waits behind another.
+ */
+typedef struct {
+    uint8_t is_used;
+    int16_t dds_domain;
+    /* Keeps the request ids of the service clients of different devices apart, see rmwu_client_send_request */
+    uint32_t client_key;
+    mrSession session;
+    mrStreamId reliable_output;
+    mrStreamId best_effort_input;
+    mrStreamId reliable_input;
+#if RMWU_ENABLE_DATAWRITERS
+    mrStreamId best_effort_output;
+    uint8_t best_effort_output_buffer[configRCLUC_BEST_EFFORT_STREAM_BUFFER_SIZE];
+    /* A fragmented message was cut short and still needs its last fragment, see close_fragments */
+    uint8_t fragments_open;
+#endif
+    uint8_t reliable_output_buffer[configRCLUC_RELIABLE_STREAM_BUFFER_SIZE];
+    uint8_t reliable_input_buffer[configRCLUC_RELIABLE_STREAM_BUFFER_SIZE];
+    rmwu_transport_send_fragments_func_t send_fragments;
+    void * send_fragments_args;
+    size_t send_fragments_mtu;
+    /* The session receives through link, which takes the fragments out of the messages, see link_recv */
+    mrCommunication link;
+    mrCommunication * transport;
+#if RMWU_ENABLE_DATAREADERS
+    rmwu_xrce_reassembler_t reassembler;
+#endif
+    uint16_t requests[RMWU_MAX_REQUESTS];
+    uint8_t request_status[RMWU_MAX_REQUESTS];
+    /* Creation requests written since the last flush, and how many of them already had their status collected */
+    size_t request_count;
+    size_t waited_count;
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+    /* The messages the transport failed to send, counted by link_send */
+    uint32_t send_failures;
+    /*
+     * How full the output streams are: the reliable submessages and bytes written since the session last confirmed
+     * that the agent acknowledged everything, whether the reliable stream refused a submessage since then, and the
+     * bytes written to the best effort stream since it was last sent
+     */
+    uint16_t pending_acks;
+    size_t reliable_used;
+    uint8_t reliable_full;
+    size_t best_effort_used;
+#endif
+} rmwu_session_state_t;
+
+/* A WRITE_DATA submessage being written as fragments into the reliable stream of a session, and when it gives up */
+typedef struct {
+    rmwu_xrce_fragment_writer_t fragments;
+    rmwu_session_state_t * state;
+    mrStreamId stream_id;
+    int64_t deadline;
+} rmwu_fragment_writer_t;
+
+#if configRCLUC_ENABLE_SERVICES
+/* A request of a service client, written behind its request id */
+typedef struct {
+    uint64_t request_id;
+    const void * request;
+} rmwu_request_t;
+#endif
+
+/* A sample that is already serialized, see rmwu_publisher_publish_fragments */
+typedef struct {
+    const rcluc_buffer_fragment_t * fragments;
+    size_t count;
+} rmwu_fragment_list_t;
+
+/* Writes a sample into a CDR buffer, either serializing a message or copying serialized fragments */
+typedef rcluc_ret_t (*rmwu_sample_writer_func_t)(const rmwu_publisher_t * publisher, const void * sample,
+    rcluc_cdr_buffer_t * buffer);
+
+/*
+ * Descriptor of an entity created on the agent. The table of descriptors holds everything needed to write the
+ * creation request of the entity again, so the whole graph can be restored after the link to the agent was lost.
+ * The name is held by participants and topics, datawriters and datareaders share the name of their topic.
+ * Samples with a source timestamp get a type name of their own, see RCLUC_SOURCE_TIMESTAMP_TYPE_SUFFIX.
+ * request_index points into the requests of the session of the entity and status holds the outcome of the creation.
+ */
+typedef struct {
+    uint8_t is_used;
+    uint8_t session;
+    uint8_t reliability;
+    uint8_t name_index;
+    mrObjectId id;
+    mrObjectId parent_id;
+    const rcluc_message_type_support_t * message_type;
+    /* The samples of topics, datawriters and datareaders start with a source timestamp */
+    uint8_t source_timestamp;
+    uint16_t request_index;
+    rcluc_ret_t status;
+} rmwu_entity_t;
+
+static rmwu_session_state_t sessions[configRCLUC_MAX_SESSIONS];
+static uint16_t next_object_id;
+static char xml[RMWU_XML_BUFFER_SIZE];
+#if RMWU_ENABLE_DATAREADERS
+static rmwu_subscription_t * subscriptions[RMWU_MAX_SUBSCRIPTIONS];
+#endif
+static rmwu_entity_t entities[RMWU_MAX_ENTITIES];
+static char names[RMWU_MAX_NAMES][RMWU_NAME_SIZE];
+static uint8_t batch_active;
+#if configRCLUC_ENABLE_SERVICES
+/* Numbers the service clients, it is not reset so that a new client never takes the replies meant for an old one */
+static uint16_t next_client;
+#endif
+
+static mrObjectId new_object_id(uint8_t type) {
+    return mr_object_id(next_object_id++, type);
+}
+
+static int object_id_equals(mrObjectId a, mrObjectId b) {
+    return a.id == b.id && a.type == b.type;
+}
+
+static const char * reliability_kind(rcluc_topic_reliability_t reliability) {
+    return (RCLUC_TOPIC_RELIABILITY_RELIABLE == reliability) ? "RELIABLE_RELIABILITY_QOS" : "BEST_EFFORT_RELIABILITY_QOS";
+}
+
+static rcluc_ret_t request_result(uint8_t status) {
+    if (MR_STATUS_NONE == status) {
+        return RCLUC_RET_TIMEOUT;
+    } else if (MR_STATUS_OK != status && MR_STATUS_OK_MATCHED != status) {
+        return RCLUC_RET_ERROR;
+    }
+    return RCLUC_RET_OK;
+}
+
+/* Waits for the agent to report the status of count requests of a session, starting at requests[first] */
+static rcluc_ret_t wait_for_status(rmwu_session_state_t * state, size_t first, size_t count) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (first + count > RMWU_MAX_REQUESTS) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    for (size_t i = first; i < first + count; ++i) {
+        if (MR_INVALID_REQUEST_ID == state->requests[i]) {
+            return RCLUC_RET_ERROR;
+        }
+    }
+    // Reused entities report OK_MATCHED, so the result of the whole run does not tell success from failure
+    (void) mr_run_session_until_all_status(&state->session, configRCLUC_ENTITY_CREATION_TIMEOUT_MS,
+            &state->requests[first], &state->request_status[first], count);
+    for (size_t i = first; i < first + count && RCLUC_RET_OK == status; ++i) {
+        status = request_result(state->request_status[i]);
+    }
+    return status;
+}
+
+static rmwu_session_state_t * get_session(uint8_t index) {
+    if (index >= configRCLUC_MAX_SESSIONS || 0 == sessions[index].is_used) {
+        return NULL;
+    }
+    return &sessions[index];
+}
+
+#if RMWU_ENABLE_DATAREADERS || RMWU_ENABLE_DATAWRITERS
+/* The object id of an entity as the submessages of rmwu_xrce.h carry it */
+static uint16_t wire_object_id(mrObjectId id) {
+    return RMWU_XRCE_OBJECT_ID(id.id, id.type);
+}
+#endif
+
+static bool link_send(void * instance, const uint8_t * buf, size_t len) {
+    rmwu_session_state_t * state = (rmwu_session_state_t *)instance;
+    bool sent = state->transport->send_msg(state->transport->instance, buf, len);
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+    if (!sent) {
+        state->send_failures++;
+    }
+#endif
+    return sent;
+}
+
+/*
+ * Receives a message for the session. The session does not reassemble fragments, so the samples of the fragments on
+ * the reliable input stream are handed to the subscriptions here and the session reads the rest of the message.
+ */
+static bool link_recv(void * instance, uint8_t ** buf, size_t * len, int timeout) {
+    rmwu_session_state_t * state = (rmwu_session_state_t *)instance;
+    if (!state->transport->recv_msg(state->transport->instance, buf, len, timeout)) {
+        return false;
+    }
+#if RMWU_ENABLE_DATAREADERS
+    *len = rmwu_xrce_reassemble(&state->reassembler, *buf, *len);
+#endif
+    return true;
+}
+
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+/* The output streams were sent, the best effort stream is empty again */
+static void note_flashed(rmwu_session_state_t * state) {
+    state->best_effort_used = 0;
+}
+
+/* The session confirmed that the agent acknowledged everything written to the reliable stream */
+static void note_confirmed(rmwu_session_state_t * state) {
+    state->pending_acks = 0;
+    state->reliable_used = 0;
+    state->reliable_full = 0;
+}
+#endif /* configRCLUC_ENABLE_CONGESTION_CONTROL */
+
+#if RMWU_ENABLE_DATAWRITERS
+static size_t align_to_4(size_t size) {
+    return (size + 3) & ~((size_t)3);
+}
+
+/* Sends what is waiting in the output streams of a session */
+static void flash_streams(rmwu_session_state_t * state) {
+    mr_flash_output_streams(&state->session);
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+    note_flashed(state);
+#endif
+}
+
+/*
+ * Reserves room for a submessage in an output stream. The session only tells whether the agent acknowledged everything
+ * written to the reliable stream, so for congestion control the submessages written since it last did are counted here.
+ */
+static bool reserve_room(rmwu_session_state_t * state, mrStreamId stream_id, size_t length, MicroBuffer * mb) {
+    if (!rmwu_stream_reserve(&state->session, stream_id, length, mb)) {
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+        if (state->reliable_output.raw == stream_id.raw) {
+            state->reliable_full = 1;
+        }
+#endif
+        return false;
+    }
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+    length = align_to_4(length);
+    if (state->reliable_output.raw != stream_id.raw) {
+        state->best_effort_used += length;
+    } else {
+        state->reliable_used += length;
+        if (state->pending_acks < UINT16_MAX) {
+            state->pending_acks++;
+        }
+    }
+#endif
+    return true;
+}
+
+/* Gives back the end of the latest reservation of an output stream, see rmwu_stream_release */
+static void release_stream(rmwu_session_state_t * state, mrStreamId stream_id, size_t length) {
+    rmwu_stream_release(&state->session, stream_id, length);
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+    size_t * used = (state->reliable_output.raw == stream_id.raw) ? &state->reliable_used : &state->best_effort_used;
+    *used -= (length < *used) ? length : *used;
+#endif
+}
+
+/*
+ * Terminates a fragmented message that was cut short with an empty last fragment. The agent then reassembles a
+ * WRITE_DATA submessage shorter than its header says and drops it, instead of joining the fragments of the next
+ * message to it. Nothing else can go on the reliable stream before this succeeds.
+ */
+static bool close_fragments(rmwu_session_state_t * state) {
+    MicroBuffer mb;
+    if (0 == state->fragments_open) {
+        return true;
+    } else if (!reserve_room(state, state->reliable_output, RMWU_XRCE_SUBHEADER_SIZE, &mb)) {
+        return false;
+    }
+    (void) rmwu_xrce_write_fragment_header(mb.iterator, 0, true);
+    state->fragments_open = 0;
+    return true;
+}
+
+/* Reserves room for submessages of their own, once the reliable stream is free of a message cut short */
+static bool reserve_stream(rmwu_session_state_t * state, mrStreamId stream_id, size_t length, MicroBuffer * mb) {
+    if (state->reliable_output.raw == stream_id.raw && !close_fragments(state)) {
+        return false;
+    }
+    return reserve_room(state, stream_id, length, mb);
+}
+#endif /* RMWU_ENABLE_DATAWRITERS */
+
+/* Whether requests can be written to the reliable stream, see close_fragments */
+static bool reliable_stream_ready(rmwu_session_state_t * state) {
+#if RMWU_ENABLE_DATAWRITERS
+    return close_fragments(state);
+#else
+    (void) state;
+    return true;
+#endif
+}
+
+static rcluc_ret_t format_xml(const char * format, const char * topic_name, const char * type_name,
+        const char * type_suffix, const char * reliability) {
+    int length = snprintf(xml, sizeof(xml), format, topic_name, type_name, type_suffix, reliability);
+    if (length < 0 || (size_t)length >= sizeof(xml)) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    return RCLUC_RET_OK;
+}
+
+static uint8_t add_name(const char * name) {
+    if ('\0' == name[0] || strlen(name) >= RMWU_NAME_SIZE) {
+        return RMWU_NO_NAME;
+    }
+    for (size_t i = 0; i < RMWU_MAX_NAMES; ++i) {
+        if ('\0' == names[i][0]) {
+            strcpy(names[i], name);
+            return (uint8_t)i;
+        }
+    }
+    return RMWU_NO_NAME;
+}
+
+static rmwu_entity_t * add_entity(uint8_t session, uint8_t type, mrObjectId parent_id, uint8_t name_index,
+        const rcluc_message_type_support_t * message_type, rcluc_topic_reliability_t reliability) {
+    for (size_t i = 0; i < RMWU_MAX_ENTITIES; ++i) {
+        rmwu_entity_t * entity = &entities[i];
+        if (0 == entity->is_used) {
+            entity->is_used = 1;
+            entity->session = session;
+            entity->reliability = (uint8_t)reliability;
+            entity->name_index = name_index;
+            entity->id = new_object_id(type);
+            entity->parent_id = parent_id;
+            entity->message_type = message_type;
+            entity->source_timestamp = 0;
+            entity->request_index = RMWU_NO_REQUEST;
+            entity->status = RCLUC_RET_OK;
+            return entity;
+        }
+    }
+    return NULL;
+}
+
+/* Forgets an entity and everything created under it, as the agent deletes those together with their parent */
+static void remove_entity(mrObjectId id) {
+    for (size_t i = 0; i < RMWU_MAX_ENTITIES; ++i) {
+        rmwu_entity_t * entity = &entities[i];
+        if (entity->is_used && object_id_equals(entity->parent_id, id)) {
+            remove_entity(entity->id);
+        }
+    }
+    for (size_t i = 0; i < RMWU_MAX_ENTITIES; ++i) {
+        rmwu_entity_t * entity = &entities[i];
+        if (entity->is_used && object_id_equals(entity->id, id)) {
+            if ((MR_PARTICIPANT_ID == id.type || MR_TOPIC_ID == id.type)
+                    && RMWU_NO_NAME != entity->name_index) {
+                names[entity->name_index][0] = '\0';
+            }
+            entity->is_used = 0;
+        }
+    }
+}
+
+/* Writes the creation request of an entity on the reliable stream, without waiting for its status */
+static uint16_t write_entity(const rmwu_entity_t * entity) {
+    rmwu_session_state_t * state = &sessions[entity->session];
+    const char * name = (RMWU_NO_NAME == entity->name_index) ? "" : names[entity->name_index];
+    const char * type_name = (NULL == entity->message_type) ? "" : entity->message_type->type_name;
+    const char * type_suffix = entity->source_timestamp ? RCLUC_SOURCE_TIMESTAMP_TYPE_SUFFIX : "";
+    const char * reliability = reliability_kind((rcluc_topic_reliability_t)entity->reliability);
+    uint16_t request = MR_INVALID_REQUEST_ID;
+    if (!reliable_stream_ready(state)) {
+        return MR_INVALID_REQUEST_ID;
+    }
+
+    switch (entity->id.type) {
+    case MR_PARTICIPANT_ID:
+        if (RCLUC_RET_OK == format_xml("<dds><participant><rtps><name>%s</name></rtps></participant></dds>", name,
+                "", "", "")) {
+            request = mr_write_configured_participant(&state->session, state->reliable_output, entity->id,
+                    state->dds_domain, xml, RMWU_ENTITY_CREATION_FLAGS);
+        }
+        break;
+    case MR_TOPIC_ID:
+        if (RCLUC_RET_OK == format_xml("<dds><topic><name>%s</name><dataType>%s%s</dataType></topic></dds>", name,
+                type_name, type_suffix, "")) {
+            request = mr_write_configured_topic(&state->session, state->reliable_output, entity->id,
+                    entity->parent_id, xml, RMWU_ENTITY_CREATION_FLAGS);
+        }
+        break;
+    case MR_PUBLISHER_ID:
+        request = mr_write_configured_publisher(&state->session, state->reliable_output, entity->id,
+                entity->parent_id, "", RMWU_ENTITY_CREATION_FLAGS);
+        break;
+    case MR_SUBSCRIBER_ID:
+        request = mr_write_configured_subscriber(&state->session, state->reliable_output, entity->id,
+                entity->parent_id, "", RMWU_ENTITY_CREATION_FLAGS);
+        break;
+    case MR_DATAWRITER_ID:
+        if (RCLUC_RET_OK == format_xml("<dds><data_writer><topic><kind>NO_KEY</kind><name>%s</name><dataType>%s%s"
+                "</dataType></topic><qos><reliability><kind>%s</kind></reliability></qos></data_writer></dds>", name,
+                type_name, type_suffix, reliability)) {
+            request = mr_write_configured_datawriter(&state->session, state->reliable_output, entity->id,
+                    entity->parent_id, xml, RMWU_ENTITY_CREATION_FLAGS);
+        }
+        break;
+    case MR_DATAREADER_ID:
+        if (RCLUC_RET_OK == format_xml("<dds><data_reader><topic><kind>NO_KEY</kind><name>%s</name><dataType>%s%s"
+                "</dataType></topic><qos><reliability><kind>%s</kind></reliability></qos></data_reader></dds>", name,
+                type_name, type_suffix, reliability)) {
+            request = mr_write_configured_datareader(&state->session, state->reliable_output, entity->id,
+                    entity->parent_id, xml, RMWU_ENTITY_CREATION_FLAGS);
+        }
+        break;
+    default:
+        break;
+    }
+    return request;
+}
+
+/* Datareaders ask for their data with a second request, right after their creation */
+static int requests_data(const rmwu_entity_t * entity) {
+    return MR_DATAREADER_ID == entity->id.type;
+}
+
+/* Asks the agent to start sending the samples received by a datareader */
+static uint16_t write_request_data(const rmwu_entity_t * entity) {
+    rmwu_session_state_t * state = &sessions[entity->session];
+    mrDeliveryControl delivery_control = {0};
+    mrStreamId input = (RCLUC_TOPIC_RELIABILITY_RELIABLE == entity->reliability) ? state->reliable_input
+            : state->best_effort_input;
+    if (!reliable_stream_ready(state)) {
+        return MR_INVALID_REQUEST_ID;
+    }
+    delivery_control.max_samples = MR_MAX_SAMPLES_UNLIMITED;
+    delivery_control.max_elapsed_time = MR_MAX_ELAPSED_TIME_UNLIMITED;
+    delivery_control.max_bytes_per_second = MR_MAX_BYTES_PER_SECOND_UNLIMITED;
+    return mr_write_request_data(&state->session, state->reliable_output, entity->id, input, &delivery_control);
+}
+
+static rmwu_entity_t * find_entity(mrObjectId id) {
+    for (size_t i = 0; i < RMWU_MAX_ENTITIES; ++i) {
+        if (entities[i].is_used && object_id_equals(entities[i].id, id)) {
+            return &entities[i];
+        }
+    }
+    return NULL;
+}
+
+/* Deletes a group of entities, which all belong to the same session */
+static void delete_entities(const mrObjectId * object_ids, size_t count) {
+    const rmwu_entity_t * first = find_entity(object_ids[0]);
+    rmwu_session_state_t * state = NULL;
+    if (NULL == first) {
+        return;
+    }
+    state = &sessions[first->session];
+    for (size_t i = 0; i < count; ++i) {
+        state->requests[i] = MR_INVALID_REQUEST_ID;
+        if (reliable_stream_ready(state)) {
+            state->requests[i] = mr_write_delete_entity(&state->session, state->reliable_output, object_ids[i]);
+        }
+        remove_entity(object_ids[i]);
+    }
+    (void) wait_for_status(state, 0, count);
+}
+
+/*
+ * Writes the creation request of an entity, or the request for data of a datareader, without waiting for its status.
+ * If the output stream is full the statuses of the requests written so far are collected first to make room.
+ */
+static void queue_request(rmwu_entity_t * entity, uint8_t request_data) {
+    rmwu_session_state_t * state = &sessions[entity->session];
+    uint16_t request = request_data ? write_request_data(entity) : write_entity(entity);
+    if (MR_INVALID_REQUEST_ID == request && state->request_count > state->waited_count) {
+        (void) wait_for_status(state, state->waited_count, state->request_count - state->waited_count);
+        state->waited_count = state->request_count;
+        request = request_data ? write_request_data(entity) : write_entity(entity);
+    }
+
+    if (MR_INVALID_REQUEST_ID == request || state->request_count >= RMWU_MAX_REQUESTS) {
+        entity->request_index = RMWU_REQUEST_NOT_SENT;
+    } else if (!request_data) {
+        entity->request_index = (uint16_t)state->request_count;
+        state->requests[state->request_count++] = request;
+    } else {
+        // The request for data always directly follows the creation of its datareader
+        state->requests[state->request_count++] = request;
+    }
+}
+
+static void queue_entity(rmwu_entity_t * entity) {
+    queue_request(entity, 0);
+    if (requests_data(entity) && RMWU_REQUEST_NOT_SENT != entity->request_index) {
+        queue_request(entity, 1);
+    }
+}
+
+/* The outcome of the requests of an entity whose statuses have been collected */
+static rcluc_ret_t entity_result(const rmwu_entity_t * entity) {
+    const rmwu_session_state_t * state = &sessions[entity->session];
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (RMWU_REQUEST_NOT_SENT == entity->request_index) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    status = request_result(state->request_status[entity->request_index]);
+    if (RCLUC_RET_OK == status && requests_data(entity)) {
+        status = request_result(state->request_status[entity->request_index + 1]);
+    }
+    return status;
+}
+
+/*
+ * Collects the statuses of every queued request, in one round trip per session, and records the outcome in the
+ * entities
+ */
+static rcluc_ret_t flush_requests(void) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    for (size_t i = 0; i < configRCLUC_MAX_SESSIONS; ++i) {
+        rmwu_session_state_t * state = &sessions[i];
+        if (state->is_used && state->request_count > state->waited_count) {
+            (void) wait_for_status(state, state->waited_count, state->request_count - state->waited_count);
+        }
+    }
+    for (size_t i = 0; i < RMWU_MAX_ENTITIES; ++i) {
+        rmwu_entity_t * entity = &entities[i];
+        if (entity->is_used && RMWU_NO_REQUEST != entity->request_index) {
+            entity->status = entity_result(entity);
+            entity->request_index = RMWU_NO_REQUEST;
+            if (RCLUC_RET_OK == status) {
+                status = entity->status;
+            }
+        }
+    }
+    for (size_t i = 0; i < configRCLUC_MAX_SESSIONS; ++i) {
+        sessions[i].request_count = 0;
+        sessions[i].waited_count = 0;
+    }
+    return status;
+}
+
+/* The creation status of a group of entities, such as the topic, publisher and datawriter of a ROS publisher */
+static rcluc_ret_t entities_status(const mrObjectId * object_ids, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const rmwu_entity_t * entity = find_entity(object_ids[i]);
+        if (NULL == entity) {
+            return RCLUC_RET_ERROR;
+        } else if (RCLUC_RET_OK != entity->status) {
+            return entity->status;
+        }
+    }
+    return RCLUC_RET_OK;
+}
+
+#if RMWU_ENABLE_DATAREADERS || RMWU_ENABLE_DATAWRITERS
+/*
+ * Creates the topic, publisher or subscriber and datawriter or datareader behind a ROS publisher or subscription.
+ * The requests are pipelined on the reliable stream and, unless a batch is open, their statuses are collected in a
+ * single round trip.
+ */
+static rcluc_ret_t create_endpoint(const rmwu_node_t * node, uint8_t endpoint_type, const char * topic_name,
+        const rcluc_message_type_support_t * message_type, rcluc_topic_reliability_t reliability,
+        uint8_t source_timestamp, mrObjectId ids[3]) {
+    uint8_t group_type = (MR_DATAREADER_ID == endpoint_type) ? MR_SUBSCRIBER_ID : MR_PUBLISHER_ID;
+    uint8_t name_index = add_name(topic_name);
+    rmwu_entity_t * topic = NULL;
+    rmwu_entity_t * group = NULL;
+    rmwu_entity_t * endpoint = NULL;
+    rcluc_ret_t status = RCLUC_RET_OK;
+
+    if (RMWU_NO_NAME == name_index) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    topic = add_entity(node->session, MR_TOPIC_ID, node->participant_id, name_index, message_type, reliability);
+    if (NULL == topic) {
+        names[name_index][0] = '\0';
+        return RCLUC_RET_ERR_SPACE;
+    }
+    group = add_entity(node->session, group_type, node->participant_id, RMWU_NO_NAME, NULL, reliability);
+    if (NULL != group) {
+        endpoint = add_entity(node->session, endpoint_type, group->id, name_index, message_type, reliability);
+    }
+    if (NULL == endpoint) {
+        remove_entity(topic->id);
+        if (NULL != group) {
+            remove_entity(group->id);
+        }
+        return RCLUC_RET_ERR_SPACE;
+    }
+
+    topic->source_timestamp = source_timestamp;
+    endpoint->source_timestamp = source_timestamp;
+    ids[0] = topic->id;
+    ids[1] = group->id;
+    ids[2] = endpoint->id;
+    queue_entity(topic);
+    queue_entity(group);
+    queue_entity(endpoint);
+    if (batch_active) {
+        return RCLUC_RET_OK;
+    }
+
+    (void) flush_requests();
+    status = entities_status(ids, 3);
+    if (RCLUC_RET_OK != status) {
+        mrObjectId created[3] = {ids[2], ids[1], ids[0]};
+        delete_entities(created, 3);
+    }
+    return status;
+}
+#endif
+
+#if RMWU_ENABLE_DATAREADERS
+/* Hands received data to the subscription of the datareader it is for */
+static void on_fragment_data(void * args, uint16_t object_id, const uint8_t * data, size_t offset, size_t length,
+        size_t total_length) {
+    (void) args;
+    for (size_t i = 0; i < RMWU_MAX_SUBSCRIPTIONS; ++i) {
+        rmwu_subscription_t * subscription = subscriptions[i];
+        if (NULL != subscription && wire_object_id(subscription->datareader_id) == object_id) {
+            (void) subscription->on_data(subscription->on_data_args, data, offset, length, total_length);
+            break;
+        }
+    }
+}
+
+/* The session hands over the samples that were received whole, see link_recv for the others */
+static void on_topic(mrSession * session_, mrObjectId object_id, uint16_t request_id, mrStreamId stream_id,
+        MicroBuffer * mb, void * args) {
+    size_t length = (size_t)(mb->final - mb->iterator);
+    (void) session_;
+    (void) request_id;
+    (void) stream_id;
+    on_fragment_data(args, wire_object_id(object_id), mb->iterator, 0, length, length);
+}
+#endif
+
+#if RMWU_ENABLE_DATAWRITERS
+/*
+ * Reserves the next FRAGMENT submessage on the reliable stream. If the stream history is full this waits for the agent
+ * to acknowledge the fragments that were already sent, until the deadline of the whole message.
+ */
+static rcluc_ret_t reserve_fragment(void * args, size_t length, uint8_t ** data) {
+    rmwu_fragment_writer_t * writer = (rmwu_fragment_writer_t *)args;
+    rmwu_session_state_t * state = writer->state;
+    MicroBuffer mb;
+    if (!reserve_room(state, writer->stream_id, length, &mb)) {
+        int64_t wait_ms = writer->deadline - rmwu_get_time_ms();
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+        note_flashed(state);
+        if (wait_ms > 0 && mr_run_session_until_confirm_delivery(&state->session, (int)wait_ms)) {
+            note_confirmed(state);
+        }
+#else
+        if (wait_ms > 0) {
+            (void) mr_run_session_until_confirm_delivery(&state->session, (int)wait_ms);
+        }
+#endif
+        if (!reserve_room(state, writer->stream_id, length, &mb)) {
+            return RCLUC_RET_TIMEOUT;
+        }
+    }
+    *data = mb.iterator;
+    return RCLUC_RET_OK;
+}
+
+/* The serialized size of a sample, including the source timestamp in front of the message */
+static size_t sample_length(const rmwu_publisher_t * publisher, const void * message) {
+    size_t length = publisher->message_type->get_serialized_size(message);
+    if (publisher->source_timestamp) {
+        length += RCLUC_SOURCE_TIMESTAMP_SIZE;
+    }
+    return length;
+}
+
+static rcluc_ret_t serialize_sample(const rmwu_publisher_t * publisher, const void * message,
+        rcluc_cdr_buffer_t * buffer) {
+    if (publisher->source_timestamp
+            && RCLUC_RET_OK != rcluc_cdr_serialize_uint64(buffer, (uint64_t)publisher->timestamp)) {
+        return buffer->error;
+    }
+    return publisher->message_type->serialize(message, buffer);
+}
+
+static rcluc_ret_t copy_fragments(const rmwu_publisher_t * publisher, const void * sample,
+        rcluc_cdr_buffer_t * buffer) {
+    const rmwu_fragment_list_t * list = (const rmwu_fragment_list_t *)sample;
+    if (publisher->source_timestamp
+            && RCLUC_RET_OK != rcluc_cdr_serialize_uint64(buffer, (uint64_t)publisher->timestamp)) {
+        return buffer->error;
+    }
+    for (size_t i = 0; i < list->count; ++i) {
+        if (RCLUC_RET_OK != rcluc_cdr_serialize_bytes(buffer, list->fragments[i].data, list->fragments[i].length)) {
+            return buffer->error;
+        }
+    }
+    return RCLUC_RET_OK;
+}
+
+/* Writes the WRITE_DATA header of a sample of the publisher */
+static void write_data_header(const rmwu_publisher_t * publisher, MicroBuffer * mb, uint32_t topic_length) {
+    mb->iterator += rmwu_xrce_write_data_header(mb->iterator, wire_object_id(publisher->datawriter_id), topic_length);
+}
+
+/*
+ * Gives up on a fragmented message. The fragment being written is given back unless it may already have been sent,
+ * and if fragments went out before it the message is terminated now, or by the next write to the reliable stream.
+ */
+static void abort_fragments(rmwu_fragment_writer_t * writer) {
+    if (writer->fragments.reserved > 0) {
+        release_stream(writer->state, writer->stream_id, writer->fragments.reserved);
+        writer->fragments.opened--;
+    }
+    if (writer->fragments.opened > 0) {
+        writer->state->fragments_open = 1;
+        (void) close_fragments(writer->state);
+    }
+}
+
+/*
+ * Publishes a message that does not fit into a single stream slot. The WRITE_DATA submessage is split into FRAGMENT
+ * submessages on the reliable stream and the message is serialized straight into them, one fragment at a time. The
+ * whole message waits at most configRCLUC_FRAGMENT_TIMEOUT_MS for the agent to make room in the stream history.
+ */
+static rcluc_ret_t publish_fragmented(rmwu_publisher_t * publisher, rmwu_sample_writer_func_t write_sample,
+        const void * sample, size_t topic_length) {
+    rmwu_fragment_writer_t writer;
+    rcluc_cdr_buffer_t buffer;
     rcluc_ret_t status = RCLUC_RET_OK;
-    if (NULL == config) {
+
+    writer.state = &sessions[publisher->session];
+    writer.stream_id = writer.state->reliable_output;
+    writer.deadline = rmwu_get_time_ms() + configRCLUC_FRAGMENT_TIMEOUT_MS;
+    if (!close_fragments(writer.state)) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+
+    status = rmwu_xrce_fragments_begin(&writer.fragments, reserve_fragment, &writer, RMWU_FRAGMENT_PAYLOAD_SIZE,
+            wire_object_id(publisher->datawriter_id), (uint32_t)topic_length, &buffer);
+    if (RCLUC_RET_OK != status) {
+        return status;
+    }
+    status = write_sample(publisher, sample, &buffer);
+    if (RCLUC_RET_OK == status) {
+        status = rmwu_xrce_fragments_end(&writer.fragments, &buffer, (uint32_t)topic_length);
+    }
+    if (RCLUC_RET_OK != status) {
+        abort_fragments(&writer);
+    }
+    return status;
+}
+#endif /* RMWU_ENABLE_DATAWRITERS */
+
+rcluc_ret_t rmwu_init(const rcluc_client_config_t * config, rmwu_session_t * session) {
+    next_object_id = 1;
+#if RMWU_ENABLE_DATAREADERS
+    memset(subscriptions, 0, sizeof(subscriptions));
+#endif
+    memset(entities, 0, sizeof(entities));
+    memset(names, 0, sizeof(names));
+    batch_active = 0;
+    for (size_t i = 0; i < configRCLUC_MAX_SESSIONS; ++i) {
+        sessions[i].is_used = 0;
+    }
+    return rmwu_session_create(config, session);
+}
+
+rcluc_ret_t rmwu_session_create(const rcluc_client_config_t * config, rmwu_session_t * session) {
+    rmwu_session_state_t * state = NULL;
+    uint8_t index = 0;
+    if (NULL == config || NULL == config->transport_layer_config || NULL == session) {
         return RCLUC_RET_NULL_PTR;
     }
+    for (index = 0; index < configRCLUC_MAX_SESSIONS && NULL == state; ++index) {
+        if (0 == sessions[index].is_used) {
+            state = &sessions[index];
+        }
+    }
+    if (NULL == state) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+
     rmwu_transport_config_t * t_config = (rmwu_transport_config_t*)config->transport_layer_config;
-    mr_init_session(&session, t_config->comm, config->client_key);
-    if (!mr_create_session(&session)) {
-        status = RCLUC_RET_ERROR;
+    state->transport = t_config->comm;
+    state->link = *t_config->comm;
+    state->link.instance = state;
+    state->link.send_msg = link_send;
+    state->link.recv_msg = link_recv;
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+    state->send_failures = 0;
+    note_confirmed(state);
+    note_flashed(state);
+#endif
+#if RMWU_ENABLE_DATAREADERS
+    // Nothing is reassembled until the reliable input stream exists
+    rmwu_xrce_reassembler_init(&state->reassembler, RMWU_STREAM_ID_NONE, on_fragment_data, NULL);
+#endif
+    mr_init_session(&state->session, &state->link, config->client_key);
+    state->send_fragments = t_config->send_fragments;
+    state->send_fragments_args = t_config->send_fragments_args;
+    state->send_fragments_mtu = t_config->send_fragments_mtu;
+#if RMWU_ENABLE_DATAREADERS
+    mr_set_topic_callback(&state->session, on_topic, NULL);
+#endif
+    if (!mr_create_session(&state->session)) {
+        return RCLUC_RET_ERROR;
     }
-    return status;
+
+    state->is_used = 1;
+    state->dds_domain = config->dds_domain;
+    state->client_key = config->client_key;
+    state->request_count = 0;
+    state->waited_count = 0;
+#if RMWU_ENABLE_DATAWRITERS
+    state->fragments_open = 0;
+    state->best_effort_output = mr_create_output_best_effort_stream(&state->session, state->best_effort_output_buffer,
+            sizeof(state->best_effort_output_buffer));
+#endif
+    state->reliable_output = mr_create_output_reliable_stream(&state->session, state->reliable_output_buffer,
+            sizeof(state->reliable_output_buffer), configRCLUC_RELIABLE_STREAM_HISTORY);
+    state->best_effort_input = mr_create_input_best_effort_stream(&state->session);
+    state->reliable_input = mr_create_input_reliable_stream(&state->session, state->reliable_input_buffer,
+            sizeof(state->reliable_input_buffer), configRCLUC_RELIABLE_STREAM_HISTORY);
+#if RMWU_ENABLE_DATAREADERS
+    state->reassembler.stream_id = state->reliable_input.raw;
+#endif
+    session->index = (uint8_t)(index - 1);
+    return RCLUC_RET_OK;
 }
 
-rcluc_ret_t rmwu_node_create(const char * name, const char * namespace_, rmwu_node_t * node) {
-    if (NULL == name || NULL == namespace_ || NULL == node) {
+rcluc_ret_t rmwu_node_create(const rmwu_session_t * session, const char * name, const char * namespace_,
+        rmwu_node_t * node) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    rmwu_entity_t * participant = NULL;
+    uint8_t name_index = RMWU_NO_NAME;
+    if (NULL == session || NULL == name || NULL == namespace_ || NULL == node) {
         return RCLUC_RET_NULL_PTR;
+    } else if (NULL == get_session(session->index)) {
+        return RCLUC_RET_ERR_INIT;
+    }
+
+    name_index = add_name(name);
+    if (RMWU_NO_NAME == name_index) {
+        return RCLUC_RET_ERR_PARAM;
     }
-    return RCLUC_RET_ERROR;
+    participant = add_entity(session->index, MR_PARTICIPANT_ID, mr_object_id(0, MR_PARTICIPANT_ID), name_index, NULL,
+            RCLUC_TOPIC_RELIABILITY_RELIABLE);
+    if (NULL == participant) {
+        names[name_index][0] = '\0';
+        return RCLUC_RET_ERR_SPACE;
+    }
+
+    node->participant_id = participant->id;
+    node->session = session->index;
+    queue_entity(participant);
+    if (batch_active) {
+        return RCLUC_RET_OK;
+    }
+
+    status = flush_requests();
+    if (RCLUC_RET_OK != status) {
+        remove_entity(node->participant_id);
+    }
+    return status;
 }
 
 rcluc_ret_t rmwu_node_destroy(rmwu_node_t * node) {
-    return RCLUC_RET_ERROR;
+    rmwu_session_state_t * state = NULL;
+    if (NULL == node) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    state = get_session(node->session);
+    if (NULL == state) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    // Deleting the participant deletes every entity that was created under it on the agent
+    state->requests[0] = MR_INVALID_REQUEST_ID;
+    if (reliable_stream_ready(state)) {
+        state->requests[0] = mr_write_delete_entity(&state->session, state->reliable_output, node->participant_id);
+    }
+    remove_entity(node->participant_id);
+    return wait_for_status(state, 0, 1);
+}
+
+rcluc_ret_t rmwu_node_get_status(const rmwu_node_t * node) {
+    if (NULL == node) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    return entities_status(&node->participant_id, 1);
+}
+
+rcluc_ret_t rmwu_begin_batch(void) {
+    if (batch_active) {
+        return RCLUC_RET_ERR_ALREADY;
+    }
+    batch_active = 1;
+    return RCLUC_RET_OK;
+}
+
+rcluc_ret_t rmwu_commit_batch(void) {
+    if (0 == batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    batch_active = 0;
+    return flush_requests();
+}
+
+rcluc_ret_t rmwu_restore(void) {
+    static const uint8_t creation_order[] = {MR_PARTICIPANT_ID, MR_TOPIC_ID, MR_PUBLISHER_ID, MR_SUBSCRIBER_ID,
+            MR_DATAWRITER_ID, MR_DATAREADER_ID};
+    uint8_t restored[configRCLUC_MAX_SESSIONS];
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    for (size_t i = 0; i < configRCLUC_MAX_SESSIONS; ++i) {
+#if RMWU_ENABLE_DATAREADERS
+        // The new session numbers its streams from the start, the fragments of the old one are not completed
+        rmwu_xrce_reassembler_init(&sessions[i].reassembler, sessions[i].reliable_input.raw, on_fragment_data, NULL);
+#endif
+        restored[i] = sessions[i].is_used && mr_create_session(&sessions[i].session);
+#if RMWU_ENABLE_DATAWRITERS
+        // The new session starts its streams over, without the fragments of a message cut short
+        sessions[i].fragments_open = 0;
+#endif
+        if (sessions[i].is_used && !restored[i]) {
+            status = RCLUC_RET_ERROR;
+        }
+    }
+
+    // Parents are written before their children and the reliable stream keeps them in order, so the whole graph of
+    // every session is sent in one burst and only the statuses are waited for
+    for (size_t i = 0; i < sizeof(creation_order); ++i) {
+        for (size_t j = 0; j < RMWU_MAX_ENTITIES; ++j) {
+            rmwu_entity_t * entity = &entities[j];
+            if (entity->is_used && restored[entity->session] && creation_order[i] == entity->id.type) {
+                queue_entity(entity);
+            }
+        }
+    }
+    if (RCLUC_RET_OK == status) {
+        status = flush_requests();
+    } else {
+        (void) flush_requests();
+    }
+    return status;
+}
+
+rcluc_ret_t rmwu_node_spin_once(rmwu_node_t * node, uint32_t timeout_ms) {
+    if (NULL == node) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active) {
+        // Statuses received now would be lost to the commit of the batch
+        return RCLUC_RET_ERR_INIT;
+    }
+    rmwu_session_state_t * state = get_session(node->session);
+    if (NULL == state) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    mr_run_session_time(&state->session, (int)timeout_ms);
+    // Terminates a fragmented message cut short as soon as the reliable stream has room again
+    (void) reliable_stream_ready(state);
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+    note_flashed(state);
+    // Polls once more without waiting, only to learn whether the agent acknowledged everything
+    if (state->pending_acks > 0 && mr_run_session_until_confirm_delivery(&state->session, 0)) {
+        note_confirmed(state);
+    }
+#endif
+    return RCLUC_RET_OK;
+}
+
+int64_t rmwu_get_time_ms(void) {
+    return rmwu_get_time_ns() / 1000000;
+}
+
+int64_t rmwu_get_time_ns(void) {
+#ifdef configRCLUC_GET_TIME_NS
+    return configRCLUC_GET_TIME_NS();
+#else
+    struct timespec now;
+    (void) clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t)now.tv_sec * 1000000000) + now.tv_nsec;
+#endif
 }
 
+#if RMWU_ENABLE_DATAREADERS
 rcluc_ret_t rmwu_subscription_create(rmwu_node_t * node, const rcluc_message_type_support_t * message_type,
-    const char * topic_name, rcluc_subscription_callback_t callback, const size_t queue_length, uint8_t *message_buffer,
-    const rcluc_subscription_config_t * config, rmwu_subscription_t * subscription) {
-    return RCLUC_RET_ERROR;
+    const char * topic_name, const rcluc_subscription_config_t * config, rmwu_subscription_data_func_t on_data,
+    void * on_data_args, rmwu_subscription_t * subscription) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    rmwu_subscription_t ** registry_entry = NULL;
+    mrObjectId ids[3];
+    if (NULL == node || NULL == message_type || NULL == topic_name || NULL == config || NULL == on_data
+            || NULL == subscription) {
+        return RCLUC_RET_NULL_PTR;
+    }
+
+    for (size_t i = 0; i < RMWU_MAX_SUBSCRIPTIONS && NULL == registry_entry; ++i) {
+        if (NULL == subscriptions[i]) {
+            registry_entry = &subscriptions[i];
+        }
+    }
+    if (NULL == registry_entry) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+
+    status = create_endpoint(node, MR_DATAREADER_ID, topic_name, message_type,
+            config->qos.reliability, config->source_timestamp, ids);
+
+    if (RCLUC_RET_OK == status) {
+        subscription->topic_id = ids[0];
+        subscription->subscriber_id = ids[1];
+        subscription->datareader_id = ids[2];
+        subscription->on_data = on_data;
+        subscription->on_data_args = on_data_args;
+        *registry_entry = subscription;
+    }
+    return status;
 }
 
 rcluc_ret_t rmwu_subscription_destroy(rmwu_subscription_t * subscription) {
-    return RCLUC_RET_ERROR;
+    if (NULL == subscription) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    for (size_t i = 0; i < RMWU_MAX_SUBSCRIPTIONS; ++i) {
+        if (subscription == subscriptions[i]) {
+            subscriptions[i] = NULL;
+        }
+    }
+    mrObjectId ids[3] = {subscription->datareader_id, subscription->subscriber_id, subscription->topic_id};
+    delete_entities(ids, 3);
+    return RCLUC_RET_OK;
+}
+
+rcluc_ret_t rmwu_subscription_get_status(const rmwu_subscription_t * subscription) {
+    if (NULL == subscription) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    mrObjectId ids[3] = {subscription->topic_id, subscription->subscriber_id, subscription->datareader_id};
+    return entities_status(ids, 3);
 }
+#endif /* RMWU_ENABLE_DATAREADERS */
 
+#if RMWU_ENABLE_DATAWRITERS
 rcluc_ret_t rmwu_publisher_create(rmwu_node_t * node, const rcluc_message_type_support_t * message_type,
-    size_t queue_length, uint8_t * message_buffer, const rcluc_publisher_config_t * config,
-    rmwu_publisher_t * publisher) {
-    return RCLUC_RET_ERROR;
+    const char * topic_name, const rcluc_publisher_config_t * config, rmwu_publisher_t * publisher) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    mrObjectId ids[3];
+    if (NULL == node || NULL == message_type || NULL == topic_name || NULL == config || NULL == publisher) {
+        return RCLUC_RET_NULL_PTR;
+    }
+
+    status = create_endpoint(node, MR_DATAWRITER_ID, topic_name, message_type,
+            config->qos.reliability, config->source_timestamp, ids);
+
+    if (RCLUC_RET_OK == status) {
+        publisher->topic_id = ids[0];
+        publisher->publisher_id = ids[1];
+        publisher->datawriter_id = ids[2];
+        publisher->message_type = message_type;
+        publisher->source_timestamp = config->source_timestamp;
+        publisher->timestamp = 0;
+        publisher->session = node->session;
+        publisher->stream_id = (RCLUC_TOPIC_RELIABILITY_RELIABLE == config->qos.reliability)
+                ? sessions[node->session].reliable_output : sessions[node->session].best_effort_output;
+    }
+    return status;
 }
 
 rcluc_ret_t rmwu_publisher_destroy(rmwu_publisher_t * publisher) {
-    return RCLUC_RET_ERROR;
+    if (NULL == publisher) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    mrObjectId ids[3] = {publisher->datawriter_id, publisher->publisher_id, publisher->topic_id};
+    delete_entities(ids, 3);
+    return RCLUC_RET_OK;
+}
+
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+rcluc_ret_t rmwu_publisher_get_link_status(const rmwu_publisher_t * publisher, rcluc_link_status_t * status) {
+    size_t occupancy = 0;
+    if (NULL == publisher || NULL == status) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    rmwu_session_state_t * state = get_session(publisher->session);
+    if (NULL == state) {
+        return RCLUC_RET_ERR_INIT;
+    }
+
+    if (state->reliable_output.raw == publisher->stream_id.raw) {
+        occupancy = state->reliable_full ? 100 : (100 * state->reliable_used) / configRCLUC_RELIABLE_STREAM_BUFFER_SIZE;
+    } else {
+        occupancy = (100 * state->best_effort_used) / configRCLUC_BEST_EFFORT_STREAM_BUFFER_SIZE;
+    }
+    status->occupancy_percent = (uint8_t)((occupancy > 100) ? 100 : occupancy);
+    status->pending_acks = state->pending_acks;
+    status->send_failures = state->send_failures;
+    return RCLUC_RET_OK;
+}
+#endif /* configRCLUC_ENABLE_CONGESTION_CONTROL */
+
+rcluc_ret_t rmwu_publisher_get_status(const rmwu_publisher_t * publisher) {
+    if (NULL == publisher) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    mrObjectId ids[3] = {publisher->topic_id, publisher->publisher_id, publisher->datawriter_id};
+    return entities_status(ids, 3);
+}
+
+/* Writes one sample into the publisher's stream, or into reliable fragments if it is too large for a stream slot */
+static rcluc_ret_t publish_sample(rmwu_publisher_t * publisher, rmwu_sample_writer_func_t write_sample,
+        const void * sample, size_t topic_length) {
+    rcluc_cdr_buffer_t buffer;
+    MicroBuffer mb;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (topic_length > configRCLUC_MAX_MESSAGE_SIZE_BYTES) {
+        return publish_fragmented(publisher, write_sample, sample, topic_length);
+    }
+
+    rmwu_session_state_t * state = &sessions[publisher->session];
+    size_t submessage_length = RMWU_XRCE_SUBHEADER_SIZE + RMWU_XRCE_DATA_HEADER_SIZE + topic_length;
+    if (!reserve_stream(state, publisher->stream_id, submessage_length, &mb)) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    write_data_header(publisher, &mb, (uint32_t)topic_length);
+
+    rcluc_cdr_init(&buffer, mb.iterator, topic_length);
+    status = write_sample(publisher, sample, &buffer);
+    if (RCLUC_RET_OK == status && rcluc_cdr_get_length(&buffer) != topic_length) {
+        status = RCLUC_RET_ERROR;
+    }
+    if (RCLUC_RET_OK != status) {
+        // A sample that did not serialize completely is not sent
+        release_stream(state, publisher->stream_id, submessage_length);
+    }
+    return status;
+}
+
+/*
+ * Sends a serialized best effort sample in one transport message through the transport's send_fragments function. The
+ * headers are written into a buffer of their own and the fragments are sent from where they are, without a copy. The
+ * message goes on the none stream so that it needs no sequence number of the best effort stream, and the stream is
+ * flushed first so that the sample does not overtake samples already waiting in it.
+ */
+static rcluc_ret_t publish_gathered(rmwu_publisher_t * publisher, const rcluc_buffer_fragment_t * fragments,
+        size_t count, size_t topic_length) {
+    rmwu_session_state_t * state = &sessions[publisher->session];
+    rcluc_buffer_fragment_t message[1 + RMWU_MAX_GATHER_FRAGMENTS];
+    uint8_t header[RMWU_GATHER_HEADER_SIZE];
+    rcluc_cdr_buffer_t buffer;
+    MicroBuffer mb;
+    size_t header_length = 4;
+
+    header[0] = state->session.info.id;
+    header[1] = RMWU_STREAM_ID_NONE;
+    header[2] = 0;
+    header[3] = 0;
+    if (state->session.info.id < RMWU_XRCE_SESSION_ID_WITHOUT_KEY) {
+        memcpy(&header[header_length], state->session.info.key, sizeof(state->session.info.key));
+        header_length += sizeof(state->session.info.key);
+    }
+    init_micro_buffer(&mb, &header[header_length], (uint32_t)(sizeof(header) - header_length));
+    write_data_header(publisher, &mb, (uint32_t)topic_length);
+    header_length = (size_t)(mb.iterator - header);
+    if (publisher->source_timestamp) {
+        rcluc_cdr_init(&buffer, &header[header_length], RCLUC_SOURCE_TIMESTAMP_SIZE);
+        (void) rcluc_cdr_serialize_uint64(&buffer, (uint64_t)publisher->timestamp);
+        header_length += RCLUC_SOURCE_TIMESTAMP_SIZE;
+    }
+
+    message[0].data = header;
+    message[0].length = header_length;
+    memcpy(&message[1], fragments, count * sizeof(*fragments));
+    flash_streams(state);
+    if (!state->send_fragments(state->send_fragments_args, message, 1 + count)) {
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+        state->send_failures++;
+#endif
+        return RCLUC_RET_ERROR;
+    }
+    return RCLUC_RET_OK;
+}
+
+rcluc_ret_t rmwu_publisher_publish_fragments(rmwu_publisher_t * publisher, const rcluc_buffer_fragment_t * fragments,
+        size_t count) {
+    rmwu_fragment_list_t list = {fragments, count};
+    size_t topic_length = 0;
+    if (NULL == publisher || (NULL == fragments && count > 0)) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    if (publisher->source_timestamp) {
+        topic_length = RCLUC_SOURCE_TIMESTAMP_SIZE;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (NULL == fragments[i].data && fragments[i].length > 0) {
+            return RCLUC_RET_NULL_PTR;
+        }
+        topic_length += fragments[i].length;
+    }
+
+    rmwu_session_state_t * state = &sessions[publisher->session];
+    if (NULL != state->send_fragments && state->reliable_output.raw != publisher->stream_id.raw
+            && count <= RMWU_MAX_GATHER_FRAGMENTS && RMWU_GATHER_HEADER_SIZE + topic_length <= state->send_fragments_mtu) {
+        return publish_gathered(publisher, fragments, count, topic_length);
+    }
+    return publish_sample(publisher, copy_fragments, &list, topic_length);
 }
 
 rcluc_ret_t rmwu_publisher_publish(rmwu_publisher_t * publisher, const void * message) {
-    return RCLUC_RET_ERROR;
+    if (NULL == publisher || NULL == message) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active) {
+        // The datawriter may not exist yet and waiting on the stream would lose the statuses of the batch
+        return RCLUC_RET_ERR_INIT;
+    }
+
+    return publish_sample(publisher, serialize_sample, message, sample_length(publisher, message));
+}
+
+/*
+ * Writes a run of samples that fit into a single message of the publisher's stream. The sizes of the samples are
+ * computed first so that the stream is reserved once for the whole run, then the samples are serialized back to back.
+ * If a sample fails to serialize the reservation is cut back to the samples before it, which are the only ones sent.
+ */
+static rcluc_ret_t publish_run(rmwu_publisher_t * publisher, const uint8_t * messages, size_t count, size_t stride,
+        size_t * published) {
+    rmwu_session_state_t * state = &sessions[publisher->session];
+    size_t lengths[RMWU_PUBLISH_BATCH_SIZE];
+    size_t capacity = (state->reliable_output.raw == publisher->stream_id.raw)
+            ? (configRCLUC_RELIABLE_STREAM_BUFFER_SIZE / configRCLUC_RELIABLE_STREAM_HISTORY)
+            : configRCLUC_BEST_EFFORT_STREAM_BUFFER_SIZE;
+    size_t total = 0;
+    size_t run = 0;
+    MicroBuffer mb;
+    rcluc_ret_t status = RCLUC_RET_OK;
+
+    capacity -= RMWU_MAX_MESSAGE_HEADER_SIZE;
+    while (run < count && run < RMWU_PUBLISH_BATCH_SIZE) {
+        size_t length = sample_length(publisher, &messages[run * stride]);
+        size_t submessage_length = RMWU_XRCE_SUBHEADER_SIZE + RMWU_XRCE_DATA_HEADER_SIZE + length;
+        if (length > configRCLUC_MAX_MESSAGE_SIZE_BYTES || align_to_4(total) + submessage_length > capacity) {
+            break;
+        }
+        lengths[run++] = length;
+        total = align_to_4(total) + submessage_length;
+    }
+
+    *published = 0;
+    if (0 == run) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    if (!reserve_stream(state, publisher->stream_id, total, &mb)) {
+        // Send what is already waiting in the stream and try once more with an empty buffer
+        flash_streams(state);
+        if (!reserve_stream(state, publisher->stream_id, total, &mb)) {
+            return RCLUC_RET_ERR_SPACE;
+        }
+    }
+
+    uint8_t * start = mb.iterator;
+    size_t written = 0;
+    size_t i = 0;
+    for (i = 0; i < run; ++i) {
+        rcluc_cdr_buffer_t buffer;
+        write_data_header(publisher, &mb, (uint32_t)lengths[i]);
+        rcluc_cdr_init(&buffer, mb.iterator, lengths[i]);
+        status = serialize_sample(publisher, &messages[i * stride], &buffer);
+        if (RCLUC_RET_OK == status && rcluc_cdr_get_length(&buffer) != lengths[i]) {
+            status = RCLUC_RET_ERROR;
+        }
+        if (RCLUC_RET_OK != status) {
+            break;
+        }
+        mb.iterator += lengths[i];
+        written = (size_t)(mb.iterator - start);
+        if (i + 1 < run) {
+            size_t padding = align_to_4(lengths[i]) - lengths[i];
+            memset(mb.iterator, 0, padding);
+            mb.iterator += padding;
+        }
+    }
+
+    if (i < run) {
+        release_stream(state, publisher->stream_id, total - written);
+    }
+    *published = i;
+    return status;
+}
+
+rcluc_ret_t rmwu_publisher_publish_many(rmwu_publisher_t * publisher, const void * messages, size_t count,
+        size_t stride, size_t * published_count) {
+    const uint8_t * samples = (const uint8_t *)messages;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    size_t published = 0;
+    if (NULL == publisher || NULL == messages || NULL == published_count) {
+        return RCLUC_RET_NULL_PTR;
+    }
+
+    *published_count = 0;
+    if (batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    while (*published_count < count && RCLUC_RET_OK == status) {
+        const uint8_t * next = &samples[*published_count * stride];
+        size_t length = sample_length(publisher, next);
+        if (length > configRCLUC_MAX_MESSAGE_SIZE_BYTES) {
+            status = publish_fragmented(publisher, serialize_sample, next, length);
+            published = (RCLUC_RET_OK == status) ? 1 : 0;
+        } else {
+            if (*published_count > 0) {
+                // The previous run filled a message, send it before starting the next one
+                flash_streams(&sessions[publisher->session]);
+            }
+            status = publish_run(publisher, next, count - *published_count, stride, &published);
+        }
+        *published_count += published;
+    }
+    return status;
+}
+
+#if configRCLUC_ENABLE_SERVICES
+static rcluc_ret_t serialize_request(const rmwu_publisher_t * publisher, const void * sample,
+        rcluc_cdr_buffer_t * buffer) {
+    const rmwu_request_t * request = (const rmwu_request_t *)sample;
+    if (RCLUC_RET_OK != rcluc_cdr_serialize_uint64(buffer, request->request_id)) {
+        return buffer->error;
+    }
+    return publisher->message_type->serialize(request->request, buffer);
+}
+
+/*
+ * A service client is a ROS publisher on the request topic of the service and a ROS subscription to its reply topic,
+ * with the names a client of any other ROS 2 node uses. DDS-XRCE topics do not carry the identity of a sample, so the
+ * request id goes in front of the request and the server echoes it in front of its reply.
+ */
+rcluc_ret_t rmwu_client_create(rmwu_node_t * node, const rcluc_service_type_support_t * service_type,
+    const char * service_name, rcluc_topic_reliability_t reliability, rmwu_subscription_data_func_t on_data,
+    void * on_data_args, rmwu_client_t * client) {
+    rcluc_publisher_config_t publisher_config;
+    rcluc_subscription_config_t subscription_config;
+    char topic_name[RMWU_NAME_SIZE];
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL == node || NULL == service_type || NULL == service_name || NULL == on_data || NULL == client) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    rmwu_session_state_t * state = get_session(node->session);
+    if (NULL == state) {
+        return RCLUC_RET_ERR_INIT;
+    }
+
+    memset(&publisher_config, 0, sizeof(publisher_config));
+    memset(&subscription_config, 0, sizeof(subscription_config));
+    publisher_config.qos.reliability = reliability;
+    subscription_config.qos.reliability = reliability;
+    int length = snprintf(topic_name, sizeof(topic_name), "rq/%sRequest", service_name);
+    if (length < 0 || (size_t)length >= sizeof(topic_name)) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    status = rmwu_publisher_create(node, service_type->request, topic_name, &publisher_config, &client->requests);
+    if (RCLUC_RET_OK != status) {
+        return status;
+    }
+    (void) snprintf(topic_name, sizeof(topic_name), "rr/%sReply", service_name);
+    status = rmwu_subscription_create(node, service_type->response, topic_name, &subscription_config, on_data,
+            on_data_args, &client->replies);
+    if (RCLUC_RET_OK != status) {
+        (void) rmwu_publisher_destroy(&client->requests);
+        return status;
+    }
+    client->request_id_base = ((uint64_t)state->client_key << 32) | ((uint64_t)++next_client << 16);
+    return RCLUC_RET_OK;
+}
+
+rcluc_ret_t rmwu_client_destroy(rmwu_client_t * client) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL == client) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    status = rmwu_subscription_destroy(&client->replies);
+    if (RCLUC_RET_OK == status) {
+        status = rmwu_publisher_destroy(&client->requests);
+    }
+    return status;
+}
+
+rcluc_ret_t rmwu_client_get_status(const rmwu_client_t * client) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL == client) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    status = rmwu_publisher_get_status(&client->requests);
+    if (RCLUC_RET_OK == status) {
+        status = rmwu_subscription_get_status(&client->replies);
+    }
+    return status;
+}
+
+rcluc_ret_t rmwu_client_send_request(rmwu_client_t * client, const void * request, int64_t sequence_number,
+        uint64_t * request_id) {
+    rmwu_request_t sample;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL == client || NULL == request || NULL == request_id) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    sample.request_id = client->request_id_base | (uint16_t)sequence_number;
+    sample.request = request;
+    status = publish_sample(&client->requests, serialize_request, &sample,
+            RCLUC_SERVICE_HEADER_SIZE + client->requests.message_type->get_serialized_size(request));
+    if (RCLUC_RET_OK == status) {
+        *request_id = sample.request_id;
+    }
+    return status;
 }
+#endif /* configRCLUC_ENABLE_SERVICES */
+#endif /* RMWU_ENABLE_DATAWRITERS */
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the stream reservations of the micro-RTPS backend over the internals of the client
+ */
+
+#include "rmwu_micrortps_stream.h"
+#include "rmwu_xrce.h"
+#include <micrortps/client/core/session/submessage.h>
+#include <micrortps/client/core/session/stream/stream_storage.h>
+
+#if SUBHEADER_SIZE != RMWU_XRCE_SUBHEADER_SIZE
+#error "The submessage header of the micro-RTPS client changed size"
+#endif
+
+bool rmwu_stream_reserve(mrSession * session, mrStreamId stream_id, size_t length, MicroBuffer * mb) {
+    return prepare_stream_to_write(&session->streams, stream_id, length, mb);
+}
+
+void rmwu_stream_release(mrSession * session, mrStreamId stream_id, size_t length) {
+    if (MR_BEST_EFFORT_STREAM == stream_id.type) {
+        mrOutputBestEffortStream * stream = get_output_best_effort_stream(&session->streams, stream_id.index);
+        stream->writer -= length;
+    } else if (MR_RELIABLE_STREAM == stream_id.type) {
+        // A reservation is always at the end of the last slot written
+        mrOutputReliableStream * stream = get_output_reliable_stream(&session->streams, stream_id.index);
+        uint8_t * slot = get_output_buffer(stream, stream->last_written % stream->history);
+        set_output_buffer_length(slot, get_output_buffer_length(slot) - length);
+    }
+}
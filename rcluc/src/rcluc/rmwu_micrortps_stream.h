@@ -0,0 +1,58 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Reserving room for submessages in the output streams of a micro-RTPS session. Not part of the public
+ *  interface.
+ *
+ *  The public interface of the micro-RTPS client only writes whole entity requests, so samples serialized in place
+ *  need the internals of its sessions and streams. rmwu_micrortps_stream.c is the only file that includes them, which
+ *  keeps the rest of the backend on the public interface and confines an update of the client to that one file. What
+ *  goes into the reserved room is encoded by rmwu_xrce.h, without the client.
+ */
+
+#ifndef RCLUC__RMWU_MICRORTPS_STREAM_H_
+#define RCLUC__RMWU_MICRORTPS_STREAM_H_
+
+#include <micrortps/client/client.h>
+#include <microcdr/microcdr.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ *  @brief Reserves room for submessages at the end of an output stream
+ *
+ *  @param session The session owning the stream
+ *  @param stream_id The output stream
+ *  @param length The size (in bytes) of the submessages
+ *  @param mb (output) A buffer over the reserved room
+ *  @return true if the stream had room for length bytes
+ */
+bool rmwu_stream_reserve(mrSession * session, mrStreamId stream_id, size_t length, MicroBuffer * mb);
+
+/**
+ *  @brief Gives back the end of the latest reservation of an output stream, so that the stream sends only what was
+ *  written into it. Nothing else may be reserved on the stream in between. A reliable message left without any
+ *  submessage is still sent, as a header that the agent acknowledges like any other message.
+ *
+ *  @param session The session owning the stream
+ *  @param stream_id The output stream
+ *  @param length The size (in bytes) to take off the end of the reservation, at most its whole length
+ */
+void rmwu_stream_release(mrSession * session, mrStreamId stream_id, size_t length);
+
+#endif /* ifndef RCLUC__RMWU_MICRORTPS_STREAM_H_ */
@@ -0,0 +1,801 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the rmwu layer over POSIX shared memory, for processes of the same Linux host
+ *
+ *  Every topic is a shared memory segment named after the domain and the topic, holding a ring of
+ *  configRCLUC_SHM_SLOT_COUNT slots. Publishers of any process claim the next slot with an atomic increment and
+ *  serialize the sample straight into it. Each slot has a sequence counter that is odd while the slot is written and
+ *  tells which sample it holds once complete, so subscribers read without locks and detect a slot that was overwritten
+ *  while they read it. A subscriber that falls more than a ring behind skips to the oldest sample still held.
+ *
+ *  Every publish also increments a host wide doorbell word, on which spinning nodes wait with a futex.
+ *
+ *  Segments are never unlinked, so that a process that starts later still finds the topics of the others. A segment
+ *  left over with another layout or type is reported as RCLUC_RET_ERR_PARAM and has to be removed from /dev/shm.
+ */
+
+#include "rcluc/rmwu.h"
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc/rcluc_default_configs.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RMWU_SHM_MAGIC                  0x52434C55u
+#define RMWU_SHM_VERSION                1
+#define RMWU_SHM_NAME_SIZE              (configRCLUC_MAX_TOPIC_NAME_LEN + 48)
+#define RMWU_SHM_TYPE_NAME_SIZE         64
+#define RMWU_SHM_DOORBELL_NAME          "/rcluc_doorbell"
+/* How long a process waits for the process that created a segment to initialize it */
+#define RMWU_SHM_OPEN_ATTEMPTS          100
+#define RMWU_SHM_OPEN_RETRY_NS          1000000
+/* Length of a slot whose publisher failed to serialize the sample, which subscribers skip */
+#define RMWU_SHM_ABANDONED              UINT32_MAX
+#define RMWU_SUBSCRIPTIONS_PER_NODE     (configRCLUC_ENABLE_SUBSCRIPTIONS ? configRCLUC_MAX_SUBSCRIPTIONS_PER_NODE : 0)
+#define RMWU_PUBLISHERS_PER_NODE        (configRCLUC_ENABLE_PUBLISHERS ? configRCLUC_MAX_PUBLISHERS_PER_NODE : 0)
+#define RMWU_CLIENTS_PER_NODE           (configRCLUC_ENABLE_SERVICES ? configRCLUC_MAX_CLIENTS_PER_NODE : 0)
+/* Service clients register their response subscription next to the node's subscriptions */
+#define RMWU_MAX_SUBSCRIPTIONS \
+    (configRCLUC_MAX_NUM_NODES * (RMWU_SUBSCRIPTIONS_PER_NODE + RMWU_CLIENTS_PER_NODE))
+#define RMWU_MAX_TOPICS \
+    (configRCLUC_MAX_NUM_NODES * (RMWU_PUBLISHERS_PER_NODE + RMWU_SUBSCRIPTIONS_PER_NODE \
+        + (2 * RMWU_CLIENTS_PER_NODE)))
+
+/* The layout of a topic segment: this header followed by slot_count slots of slot_stride bytes */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    uint32_t slot_stride;
+    /* The number of samples claimed by publishers, the next one goes to slot claimed % slot_count */
+    uint32_t claimed;
+    char type_name[RMWU_SHM_TYPE_NAME_SIZE];
+} rmwu_shm_topic_header_t;
+
+/* In front of the serialized sample of every slot */
+typedef struct {
+    /* 2 * sample + 1 while the sample is written, 2 * sample + 2 once it is complete */
+    uint32_t sequence;
+    uint32_t length;
+} rmwu_shm_slot_header_t;
+
+typedef struct {
+    /* Incremented by every publish of the host */
+    uint32_t sequence;
+    uint32_t waiters;
+} rmwu_shm_doorbell_t;
+
+/* A topic segment mapped by this process, shared by its publishers and subscriptions */
+typedef struct {
+    char name[RMWU_SHM_NAME_SIZE];
+    rmwu_shm_topic_header_t * header;
+    size_t mapped_size;
+    size_t references;
+} rmwu_shm_topic_t;
+
+typedef struct {
+    uint8_t is_used;
+    int16_t dds_domain;
+} rmwu_shm_session_t;
+
+/* A sample that is already serialized, see rmwu_publisher_publish_fragments */
+typedef struct {
+    const rcluc_buffer_fragment_t * fragments;
+    size_t count;
+} rmwu_fragment_list_t;
+
+#if configRCLUC_ENABLE_SERVICES
+/* A request of a service client, written behind its request id */
+typedef struct {
+    uint64_t request_id;
+    const void * request;
+} rmwu_shm_request_t;
+#endif
+
+/* Writes a sample into a slot, either serializing a message or copying serialized fragments */
+typedef rcluc_ret_t (*rmwu_sample_writer_func_t)(const rmwu_publisher_t * publisher, const void * sample,
+    rcluc_cdr_buffer_t * buffer);
+
+static rmwu_shm_session_t sessions[configRCLUC_MAX_SESSIONS];
+static rmwu_shm_topic_t topics[RMWU_MAX_TOPICS];
+#if RMWU_MAX_SUBSCRIPTIONS > 0
+static rmwu_subscription_t * subscriptions[RMWU_MAX_SUBSCRIPTIONS];
+#endif
+static rmwu_shm_doorbell_t * doorbell = NULL;
+static uint8_t batch_active;
+#if configRCLUC_ENABLE_SERVICES
+/* Numbers the service clients, it is not reset so that a new client never takes the replies meant for an old one */
+static uint16_t next_client;
+#endif
+
+static size_t align_to_8(size_t size) {
+    return (size + 7) & ~((size_t)7);
+}
+
+static void sleep_ns(long duration_ns) {
+    struct timespec duration = {0, duration_ns};
+    (void) nanosleep(&duration, NULL);
+}
+
+static int futex(uint32_t * word, int operation, uint32_t value, const struct timespec * timeout) {
+    return (int)syscall(SYS_futex, word, operation, value, timeout, NULL, 0);
+}
+
+static void doorbell_ring(void) {
+    (void) __atomic_add_fetch(&doorbell->sequence, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&doorbell->waiters, __ATOMIC_SEQ_CST) > 0) {
+        (void) futex(&doorbell->sequence, FUTEX_WAKE, INT_MAX, NULL);
+    }
+}
+
+/* Waits for a publish after the doorbell read seen, or for timeout_ms */
+static void doorbell_wait(uint32_t seen, uint32_t timeout_ms) {
+    struct timespec timeout = {(time_t)(timeout_ms / 1000), (long)(timeout_ms % 1000) * 1000000};
+    (void) __atomic_add_fetch(&doorbell->waiters, 1, __ATOMIC_SEQ_CST);
+    (void) futex(&doorbell->sequence, FUTEX_WAIT, seen, &timeout);
+    (void) __atomic_sub_fetch(&doorbell->waiters, 1, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Maps a shared memory segment, creating it with size bytes if it does not exist yet. The size of an existing segment
+ * is taken from the segment once its creator has sized it.
+ */
+static void * map_segment(const char * name, size_t * size, uint8_t * created) {
+    struct stat segment_stat;
+    void * segment = MAP_FAILED;
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0666);
+    *created = (fd >= 0);
+    if (fd >= 0) {
+        if (0 != ftruncate(fd, (off_t)*size)) {
+            (void) close(fd);
+            (void) shm_unlink(name);
+            return NULL;
+        }
+    } else if (EEXIST == errno) {
+        fd = shm_open(name, O_RDWR, 0666);
+        for (size_t attempt = 0; fd >= 0 && attempt < RMWU_SHM_OPEN_ATTEMPTS; ++attempt) {
+            if (0 == fstat(fd, &segment_stat) && segment_stat.st_size > 0) {
+                *size = (size_t)segment_stat.st_size;
+                break;
+            }
+            sleep_ns(RMWU_SHM_OPEN_RETRY_NS);
+        }
+    }
+    if (fd < 0) {
+        return NULL;
+    }
+    segment = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    (void) close(fd);
+    return (MAP_FAILED == segment) ? NULL : segment;
+}
+
+static rcluc_ret_t open_doorbell(void) {
+    size_t size = sizeof(rmwu_shm_doorbell_t);
+    uint8_t created = 0;
+    if (NULL == doorbell) {
+        // A zero filled segment is a valid doorbell, whoever creates it
+        doorbell = (rmwu_shm_doorbell_t *)map_segment(RMWU_SHM_DOORBELL_NAME, &size, &created);
+    }
+    return (NULL == doorbell || size < sizeof(rmwu_shm_doorbell_t)) ? RCLUC_RET_ERROR : RCLUC_RET_OK;
+}
+
+static rcluc_ret_t format_segment_name(int16_t dds_domain, const char * topic_name, const char * type_suffix,
+        char * name) {
+    int length = snprintf(name, RMWU_SHM_NAME_SIZE, "/rcluc_%d_%s%s", (int)dds_domain, topic_name, type_suffix);
+    if (length < 0 || length >= RMWU_SHM_NAME_SIZE) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    // A shared memory name is a single path component
+    for (char * c = &name[1]; '\0' != *c; ++c) {
+        if ('/' == *c) {
+            *c = '_';
+        }
+    }
+    return RCLUC_RET_OK;
+}
+
+static rcluc_ret_t check_topic(const rmwu_shm_topic_header_t * header, size_t mapped_size, size_t slot_size,
+        const char * type_name) {
+    for (size_t attempt = 0; RMWU_SHM_MAGIC != __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE); ++attempt) {
+        if (attempt == RMWU_SHM_OPEN_ATTEMPTS) {
+            return RCLUC_RET_TIMEOUT;
+        }
+        sleep_ns(RMWU_SHM_OPEN_RETRY_NS);
+    }
+    if (RMWU_SHM_VERSION != header->version || 0 == header->slot_count || header->slot_size < slot_size
+            || mapped_size < sizeof(*header) + ((size_t)header->slot_count * header->slot_stride)
+            || 0 != strncmp(header->type_name, type_name, RMWU_SHM_TYPE_NAME_SIZE - 1)) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    return RCLUC_RET_OK;
+}
+
+/*
+ * Maps the segment of a topic, or takes one more reference on it if this process already mapped it. Samples with a
+ * source timestamp go to a segment of their own, so that they only reach subscriptions expecting one, like the
+ * distinct type name of such topics does over DDS.
+ */
+static rcluc_ret_t acquire_topic(const rmwu_node_t * node, const char * topic_name,
+        const rcluc_message_type_support_t * message_type, uint8_t source_timestamp, rmwu_shm_topic_t ** topic) {
+    const char * type_suffix = source_timestamp ? RCLUC_SOURCE_TIMESTAMP_TYPE_SUFFIX : "";
+    char name[RMWU_SHM_NAME_SIZE];
+    char type_name[RMWU_SHM_TYPE_NAME_SIZE];
+    rmwu_shm_topic_t * free_topic = NULL;
+    rmwu_shm_topic_header_t * header = NULL;
+    uint8_t created = 0;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    // Every slot has room for 8 bytes in front of the message, the source timestamp or the request id of a service
+    size_t slot_size = message_type->max_serialized_size;
+    if (0 == slot_size) {
+        slot_size = configRCLUC_MAX_MESSAGE_SIZE_BYTES;
+    }
+    slot_size += RCLUC_SOURCE_TIMESTAMP_SIZE;
+    size_t slot_stride = align_to_8(sizeof(rmwu_shm_slot_header_t) + slot_size);
+    size_t mapped_size = sizeof(rmwu_shm_topic_header_t) + (configRCLUC_SHM_SLOT_COUNT * slot_stride);
+
+    if (node->session >= configRCLUC_MAX_SESSIONS || 0 == sessions[node->session].is_used) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    status = format_segment_name(sessions[node->session].dds_domain, topic_name, type_suffix, name);
+    if (RCLUC_RET_OK != status) {
+        return status;
+    }
+    (void) snprintf(type_name, sizeof(type_name), "%s%s", message_type->type_name, type_suffix);
+
+    for (size_t i = 0; i < RMWU_MAX_TOPICS; ++i) {
+        if (topics[i].references > 0 && 0 == strcmp(topics[i].name, name)) {
+            status = check_topic(topics[i].header, topics[i].mapped_size, slot_size, type_name);
+            if (RCLUC_RET_OK == status) {
+                topics[i].references++;
+                *topic = &topics[i];
+            }
+            return status;
+        } else if (0 == topics[i].references && NULL == free_topic) {
+            free_topic = &topics[i];
+        }
+    }
+    if (NULL == free_topic) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+
+    header = (rmwu_shm_topic_header_t *)map_segment(name, &mapped_size, &created);
+    if (NULL == header) {
+        return RCLUC_RET_ERROR;
+    }
+    if (created) {
+        header->version = RMWU_SHM_VERSION;
+        header->slot_count = configRCLUC_SHM_SLOT_COUNT;
+        header->slot_size = (uint32_t)slot_size;
+        header->slot_stride = (uint32_t)slot_stride;
+        header->claimed = 0;
+        strncpy(header->type_name, type_name, RMWU_SHM_TYPE_NAME_SIZE - 1);
+        __atomic_store_n(&header->magic, RMWU_SHM_MAGIC, __ATOMIC_RELEASE);
+    }
+    status = check_topic(header, mapped_size, slot_size, type_name);
+    if (RCLUC_RET_OK != status) {
+        (void) munmap(header, mapped_size);
+        return status;
+    }
+
+    strcpy(free_topic->name, name);
+    free_topic->header = header;
+    free_topic->mapped_size = mapped_size;
+    free_topic->references = 1;
+    *topic = free_topic;
+    return RCLUC_RET_OK;
+}
+
+static void release_topic(rmwu_shm_topic_t * topic) {
+    if (NULL != topic && topic->references > 0 && 0 == --topic->references) {
+        (void) munmap(topic->header, topic->mapped_size);
+        topic->header = NULL;
+    }
+}
+
+static rmwu_shm_slot_header_t * topic_slot(const rmwu_shm_topic_header_t * header, uint32_t sample) {
+    return (rmwu_shm_slot_header_t *)((uint8_t *)header + sizeof(*header)
+            + ((size_t)(sample % header->slot_count) * header->slot_stride));
+}
+
+rcluc_ret_t rmwu_init(const rcluc_client_config_t * config, rmwu_session_t * session) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    for (size_t i = 0; i < RMWU_MAX_TOPICS; ++i) {
+        if (topics[i].references > 0) {
+            topics[i].references = 1;
+            release_topic(&topics[i]);
+        }
+    }
+#if RMWU_MAX_SUBSCRIPTIONS > 0
+    memset(subscriptions, 0, sizeof(subscriptions));
+#endif
+    batch_active = 0;
+    for (size_t i = 0; i < configRCLUC_MAX_SESSIONS; ++i) {
+        sessions[i].is_used = 0;
+    }
+    status = open_doorbell();
+    if (RCLUC_RET_OK != status) {
+        return status;
+    }
+    return rmwu_session_create(config, session);
+}
+
+rcluc_ret_t rmwu_session_create(const rcluc_client_config_t * config, rmwu_session_t * session) {
+    if (NULL == config || NULL == session) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (NULL == doorbell) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    for (uint8_t index = 0; index < configRCLUC_MAX_SESSIONS; ++index) {
+        if (0 == sessions[index].is_used) {
+            sessions[index].is_used = 1;
+            sessions[index].dds_domain = config->dds_domain;
+            session->index = index;
+            return RCLUC_RET_OK;
+        }
+    }
+    return RCLUC_RET_ERR_SPACE;
+}
+
+rcluc_ret_t rmwu_restore(void) {
+    // There is no agent, the segments outlive any process and every mapping of this process is still valid
+    if (batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    return (NULL == doorbell) ? RCLUC_RET_ERR_INIT : RCLUC_RET_OK;
+}
+
+rcluc_ret_t rmwu_begin_batch(void) {
+    if (batch_active) {
+        return RCLUC_RET_ERR_ALREADY;
+    }
+    batch_active = 1;
+    return RCLUC_RET_OK;
+}
+
+rcluc_ret_t rmwu_commit_batch(void) {
+    // Entities are created as soon as they are requested, so there is nothing left to wait for
+    if (0 == batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    batch_active = 0;
+    return RCLUC_RET_OK;
+}
+
+rcluc_ret_t rmwu_node_get_status(const rmwu_node_t * node) {
+    if (NULL == node) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    return (node->session < configRCLUC_MAX_SESSIONS && sessions[node->session].is_used)
+            ? RCLUC_RET_OK : RCLUC_RET_ERR_INIT;
+}
+
+rcluc_ret_t rmwu_subscription_get_status(const rmwu_subscription_t * subscription) {
+    if (NULL == subscription) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    return (NULL != subscription->topic) ? RCLUC_RET_OK : RCLUC_RET_ERROR;
+}
+
+rcluc_ret_t rmwu_publisher_get_status(const rmwu_publisher_t * publisher) {
+    if (NULL == publisher) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    return (NULL != publisher->topic) ? RCLUC_RET_OK : RCLUC_RET_ERROR;
+}
+
+rcluc_ret_t rmwu_node_create(const rmwu_session_t * session, const char * name, const char * namespace_,
+        rmwu_node_t * node) {
+    if (NULL == session || NULL == name || NULL == namespace_ || NULL == node) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (session->index >= configRCLUC_MAX_SESSIONS || 0 == sessions[session->index].is_used) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    // Nodes have no representation in shared memory, only their topics do
+    node->session = session->index;
+    return RCLUC_RET_OK;
+}
+
+rcluc_ret_t rmwu_node_destroy(rmwu_node_t * node) {
+    if (NULL == node) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    return RCLUC_RET_OK;
+}
+
+#if RMWU_MAX_SUBSCRIPTIONS > 0
+rcluc_ret_t rmwu_subscription_create(rmwu_node_t * node, const rcluc_message_type_support_t * message_type,
+    const char * topic_name, const rcluc_subscription_config_t * config, rmwu_subscription_data_func_t on_data,
+    void * on_data_args, rmwu_subscription_t * subscription) {
+    rmwu_subscription_t ** registry_entry = NULL;
+    rmwu_shm_topic_t * topic = NULL;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL == node || NULL == message_type || NULL == topic_name || NULL == config || NULL == on_data
+            || NULL == subscription) {
+        return RCLUC_RET_NULL_PTR;
+    }
+
+    for (size_t i = 0; i < RMWU_MAX_SUBSCRIPTIONS && NULL == registry_entry; ++i) {
+        if (NULL == subscriptions[i]) {
+            registry_entry = &subscriptions[i];
+        }
+    }
+    if (NULL == registry_entry) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+
+    status = acquire_topic(node, topic_name, message_type, config->source_timestamp, &topic);
+    if (RCLUC_RET_OK == status) {
+        subscription->node = node;
+        subscription->topic = topic;
+        // Only samples published from now on are received, like from a volatile datareader
+        subscription->next_sample = __atomic_load_n(&topic->header->claimed, __ATOMIC_ACQUIRE);
+        subscription->on_data = on_data;
+        subscription->on_data_args = on_data_args;
+        *registry_entry = subscription;
+    }
+    return status;
+}
+
+rcluc_ret_t rmwu_subscription_destroy(rmwu_subscription_t * subscription) {
+    if (NULL == subscription) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    for (size_t i = 0; i < RMWU_MAX_SUBSCRIPTIONS; ++i) {
+        if (subscription == subscriptions[i]) {
+            subscriptions[i] = NULL;
+        }
+    }
+    release_topic((rmwu_shm_topic_t *)subscription->topic);
+    subscription->topic = NULL;
+    return RCLUC_RET_OK;
+}
+
+/*
+ * Hands a complete sample to the subscription straight from its slot. All but the last byte go first, and the last
+ * byte only once the sequence counter shows that the slot was not overwritten in the meantime. The rcluc layer commits
+ * a sample with its last byte, so a torn sample is never queued and is replaced by the next one.
+ */
+static uint8_t deliver_in_place(rmwu_subscription_t * subscription, const rmwu_shm_slot_header_t * slot,
+        uint32_t sequence, uint32_t length) {
+    const uint8_t * data = (const uint8_t *)&slot[1];
+    uint8_t last = 0;
+    if (length > 1) {
+        (void) subscription->on_data(subscription->on_data_args, data, 0, length - 1, length);
+    }
+    if (length > 0) {
+        last = data[length - 1];
+    }
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != sequence) {
+        return 0;
+    }
+    (void) subscription->on_data(subscription->on_data_args, &last, (length > 0) ? length - 1 : 0,
+            (length > 0) ? 1 : 0, length);
+    return 1;
+}
+
+/* Delivers the complete samples the subscription has not seen yet, and returns their number */
+static size_t subscription_take(rmwu_subscription_t * subscription) {
+    const rmwu_shm_topic_header_t * header = ((rmwu_shm_topic_t *)subscription->topic)->header;
+    size_t delivered = 0;
+    for (;;) {
+        uint32_t claimed = __atomic_load_n(&header->claimed, __ATOMIC_ACQUIRE);
+        uint32_t sample = subscription->next_sample;
+        if ((int32_t)(claimed - sample) <= 0) {
+            break;
+        } else if (claimed - sample > header->slot_count) {
+            // Lapped by the publishers, the older samples are gone
+            sample = claimed - header->slot_count;
+        }
+
+        const rmwu_shm_slot_header_t * slot = topic_slot(header, sample);
+        uint32_t sequence = (2 * sample) + 2;
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != sequence) {
+            // Still being written, it is picked up by a later spin
+            subscription->next_sample = sample;
+            break;
+        }
+        uint32_t length = __atomic_load_n(&slot->length, __ATOMIC_RELAXED);
+        subscription->next_sample = sample + 1;
+        if (length <= header->slot_size && deliver_in_place(subscription, slot, sequence, length)) {
+            delivered++;
+        }
+    }
+    return delivered;
+}
+
+static size_t node_take(const rmwu_node_t * node) {
+    size_t delivered = 0;
+    for (size_t i = 0; i < RMWU_MAX_SUBSCRIPTIONS; ++i) {
+        if (NULL != subscriptions[i] && node == subscriptions[i]->node) {
+            delivered += subscription_take(subscriptions[i]);
+        }
+    }
+    return delivered;
+}
+#else
+static size_t node_take(const rmwu_node_t * node) {
+    return 0;
+}
+#endif /* RMWU_MAX_SUBSCRIPTIONS > 0 */
+
+rcluc_ret_t rmwu_publisher_create(rmwu_node_t * node, const rcluc_message_type_support_t * message_type,
+    const char * topic_name, const rcluc_publisher_config_t * config, rmwu_publisher_t * publisher) {
+    rmwu_shm_topic_t * topic = NULL;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL == node || NULL == message_type || NULL == topic_name || NULL == config || NULL == publisher) {
+        return RCLUC_RET_NULL_PTR;
+    }
+
+    status = acquire_topic(node, topic_name, message_type, config->source_timestamp, &topic);
+    if (RCLUC_RET_OK == status) {
+        publisher->topic = topic;
+        publisher->session = node->session;
+        publisher->message_type = message_type;
+        publisher->source_timestamp = config->source_timestamp;
+        publisher->timestamp = 0;
+    }
+    return status;
+}
+
+rcluc_ret_t rmwu_publisher_destroy(rmwu_publisher_t * publisher) {
+    if (NULL == publisher) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    release_topic((rmwu_shm_topic_t *)publisher->topic);
+    publisher->topic = NULL;
+    return RCLUC_RET_OK;
+}
+
+#if configRCLUC_ENABLE_CONGESTION_CONTROL
+rcluc_ret_t rmwu_publisher_get_link_status(const rmwu_publisher_t * publisher, rcluc_link_status_t * status) {
+    if (NULL == publisher || NULL == status) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    // The ring never holds a publisher back, subscribers that fall behind lose the oldest samples instead
+    status->occupancy_percent = 0;
+    status->pending_acks = 0;
+    status->send_failures = 0;
+    return RCLUC_RET_OK;
+}
+#endif /* configRCLUC_ENABLE_CONGESTION_CONTROL */
+
+static rcluc_ret_t serialize_sample(const rmwu_publisher_t * publisher, const void * message,
+        rcluc_cdr_buffer_t * buffer) {
+    return publisher->message_type->serialize(message, buffer);
+}
+
+static rcluc_ret_t copy_fragments(const rmwu_publisher_t * publisher, const void * sample,
+        rcluc_cdr_buffer_t * buffer) {
+    const rmwu_fragment_list_t * list = (const rmwu_fragment_list_t *)sample;
+    (void) publisher;
+    for (size_t i = 0; i < list->count; ++i) {
+        if (RCLUC_RET_OK != rcluc_cdr_serialize_bytes(buffer, list->fragments[i].data, list->fragments[i].length)) {
+            return buffer->error;
+        }
+    }
+    return RCLUC_RET_OK;
+}
+
+/* Claims the next slot of the publisher's topic and writes the sample into it, behind the source timestamp */
+static rcluc_ret_t publish_sample(rmwu_publisher_t * publisher, rmwu_sample_writer_func_t write_sample,
+        const void * sample, size_t length) {
+    rcluc_cdr_buffer_t buffer;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    rmwu_shm_topic_header_t * header = ((rmwu_shm_topic_t *)publisher->topic)->header;
+    if (publisher->source_timestamp) {
+        length += RCLUC_SOURCE_TIMESTAMP_SIZE;
+    }
+    if (length > header->slot_size) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+
+    uint32_t sample_index = __atomic_fetch_add(&header->claimed, 1, __ATOMIC_ACQ_REL);
+    rmwu_shm_slot_header_t * slot = topic_slot(header, sample_index);
+    __atomic_store_n(&slot->sequence, (2 * sample_index) + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    rcluc_cdr_init(&buffer, (uint8_t *)&slot[1], header->slot_size);
+    if (publisher->source_timestamp) {
+        (void) rcluc_cdr_serialize_uint64(&buffer, (uint64_t)publisher->timestamp);
+    }
+    status = write_sample(publisher, sample, &buffer);
+    if (RCLUC_RET_OK == status && rcluc_cdr_get_length(&buffer) != length) {
+        status = RCLUC_RET_ERROR;
+    }
+
+    // The slot is completed either way, a failed sample is marked so that subscribers skip it instead of waiting
+    __atomic_store_n(&slot->length, (RCLUC_RET_OK == status) ? (uint32_t)length : RMWU_SHM_ABANDONED,
+            __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->sequence, (2 * sample_index) + 2, __ATOMIC_RELEASE);
+    doorbell_ring();
+    return status;
+}
+
+rcluc_ret_t rmwu_publisher_publish(rmwu_publisher_t * publisher, const void * message) {
+    if (NULL == publisher || NULL == message) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active || NULL == publisher->topic) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    return publish_sample(publisher, serialize_sample, message, publisher->message_type->get_serialized_size(message));
+}
+
+rcluc_ret_t rmwu_publisher_publish_fragments(rmwu_publisher_t * publisher, const rcluc_buffer_fragment_t * fragments,
+        size_t count) {
+    // The slot is the only copy, there is no transport to gather the fragments for
+    rmwu_fragment_list_t list = {fragments, count};
+    size_t length = 0;
+    if (NULL == publisher || (NULL == fragments && count > 0)) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active || NULL == publisher->topic) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (NULL == fragments[i].data && fragments[i].length > 0) {
+            return RCLUC_RET_NULL_PTR;
+        }
+        length += fragments[i].length;
+    }
+    return publish_sample(publisher, copy_fragments, &list, length);
+}
+
+rcluc_ret_t rmwu_publisher_publish_many(rmwu_publisher_t * publisher, const void * messages, size_t count,
+    size_t stride, size_t * published_count) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    size_t published = 0;
+    if (NULL == publisher || NULL == messages || NULL == published_count) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    for (; published < count && RCLUC_RET_OK == status; ++published) {
+        status = rmwu_publisher_publish(publisher, (const uint8_t *)messages + (published * stride));
+    }
+    *published_count = (RCLUC_RET_OK == status) ? published : published - 1;
+    return status;
+}
+
+#if configRCLUC_ENABLE_SERVICES
+static rcluc_ret_t serialize_request(const rmwu_publisher_t * publisher, const void * sample,
+        rcluc_cdr_buffer_t * buffer) {
+    const rmwu_shm_request_t * request = (const rmwu_shm_request_t *)sample;
+    if (RCLUC_RET_OK != rcluc_cdr_serialize_uint64(buffer, request->request_id)) {
+        return buffer->error;
+    }
+    return publisher->message_type->serialize(request->request, buffer);
+}
+
+rcluc_ret_t rmwu_client_create(rmwu_node_t * node, const rcluc_service_type_support_t * service_type,
+    const char * service_name, rcluc_topic_reliability_t reliability, rmwu_subscription_data_func_t on_data,
+    void * on_data_args, rmwu_client_t * client) {
+    rcluc_publisher_config_t publisher_config;
+    rcluc_subscription_config_t subscription_config;
+    char topic_name[configRCLUC_MAX_TOPIC_NAME_LEN + 16];
+    rcluc_ret_t status = RCLUC_RET_OK;
+    // Slots never lose a sample to the transport, so both reliabilities behave the same
+    (void) reliability;
+    if (NULL == node || NULL == service_type || NULL == service_name || NULL == on_data || NULL == client) {
+        return RCLUC_RET_NULL_PTR;
+    }
+
+    // The room for a source timestamp in every slot holds the request id, which takes the same 8 bytes
+    memset(&publisher_config, 0, sizeof(publisher_config));
+    memset(&subscription_config, 0, sizeof(subscription_config));
+    int length = snprintf(topic_name, sizeof(topic_name), "rq/%sRequest", service_name);
+    if (length < 0 || (size_t)length >= sizeof(topic_name)) {
+        return RCLUC_RET_ERR_PARAM;
+    }
+    status = rmwu_publisher_create(node, service_type->request, topic_name, &publisher_config, &client->requests);
+    if (RCLUC_RET_OK != status) {
+        return status;
+    }
+    (void) snprintf(topic_name, sizeof(topic_name), "rr/%sReply", service_name);
+    status = rmwu_subscription_create(node, service_type->response, topic_name, &subscription_config, on_data,
+            on_data_args, &client->replies);
+    if (RCLUC_RET_OK != status) {
+        (void) rmwu_publisher_destroy(&client->requests);
+        return status;
+    }
+    // The process id keeps the ids of the clients of different processes apart on the shared reply topic
+    client->request_id_base = ((uint64_t)(uint32_t)getpid() << 32) | ((uint64_t)++next_client << 16);
+    return RCLUC_RET_OK;
+}
+
+rcluc_ret_t rmwu_client_destroy(rmwu_client_t * client) {
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL == client) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    status = rmwu_subscription_destroy(&client->replies);
+    if (RCLUC_RET_OK == status) {
+        status = rmwu_publisher_destroy(&client->requests);
+    }
+    return status;
+}
+
+rcluc_ret_t rmwu_client_get_status(const rmwu_client_t * client) {
+    if (NULL == client) {
+        return RCLUC_RET_NULL_PTR;
+    }
+    return (NULL != client->requests.topic && NULL != client->replies.topic) ? RCLUC_RET_OK : RCLUC_RET_ERROR;
+}
+
+rcluc_ret_t rmwu_client_send_request(rmwu_client_t * client, const void * request, int64_t sequence_number,
+        uint64_t * request_id) {
+    rmwu_shm_request_t sample;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    if (NULL == client || NULL == request || NULL == request_id) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active || NULL == client->requests.topic) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    sample.request_id = client->request_id_base | (uint16_t)sequence_number;
+    sample.request = request;
+    status = publish_sample(&client->requests, serialize_request, &sample,
+            RCLUC_SERVICE_HEADER_SIZE + client->requests.message_type->get_serialized_size(request));
+    if (RCLUC_RET_OK == status) {
+        *request_id = sample.request_id;
+    }
+    return status;
+}
+#endif /* configRCLUC_ENABLE_SERVICES */
+
+rcluc_ret_t rmwu_node_spin_once(rmwu_node_t * node, uint32_t timeout_ms) {
+    if (NULL == node) {
+        return RCLUC_RET_NULL_PTR;
+    } else if (batch_active) {
+        return RCLUC_RET_ERR_INIT;
+    } else if (NULL == doorbell) {
+        return RCLUC_RET_ERR_INIT;
+    }
+    // The doorbell is read before looking at the topics, so a publish in between ends the wait right away
+    uint32_t seen = __atomic_load_n(&doorbell->sequence, __ATOMIC_SEQ_CST);
+    if (0 == node_take(node) && timeout_ms > 0) {
+        doorbell_wait(seen, timeout_ms);
+        (void) node_take(node);
+    }
+    return RCLUC_RET_OK;
+}
+
+int64_t rmwu_get_time_ms(void) {
+    return rmwu_get_time_ns() / 1000000;
+}
+
+int64_t rmwu_get_time_ns(void) {
+#ifdef configRCLUC_GET_TIME_NS
+    return configRCLUC_GET_TIME_NS();
+#else
+    struct timespec now;
+    (void) clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t)now.tv_sec * 1000000000) + now.tv_nsec;
+#endif
+}
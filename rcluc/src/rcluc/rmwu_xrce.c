@@ -0,0 +1,259 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Implementation of the DDS-XRCE submessages written and read by the micro-RTPS backend
+ */
+
+#include "rmwu_xrce.h"
+#include <string.h>
+
+#define RMWU_XRCE_FORMAT_MASK           0x0E
+#define RMWU_XRCE_FORMAT_DATA           0x00
+#define RMWU_XRCE_DATA_REQUEST_ID       0
+
+/* What a reassembler does with the next fragment */
+#define RMWU_XRCE_COLLECTING_HEADER     0
+#define RMWU_XRCE_RECEIVING_SAMPLE      1
+#define RMWU_XRCE_DISCARDING            2
+
+/* Submessage lengths and sequence numbers are always little endian, the payloads follow their endianness flag */
+static uint16_t read_uint16(const uint8_t * data) {
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t read_uint32(const uint8_t * data, bool little_endian) {
+    if (little_endian) {
+        return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    }
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | (uint32_t)data[3];
+}
+
+static void write_uint16(uint8_t * data, uint16_t value) {
+    data[0] = (uint8_t)value;
+    data[1] = (uint8_t)(value >> 8);
+}
+
+static void write_uint32(uint8_t * data, uint32_t value) {
+    write_uint16(data, (uint16_t)value);
+    write_uint16(&data[2], (uint16_t)(value >> 16));
+}
+
+static size_t align_to_4(size_t size) {
+    return (size + 3) & ~((size_t)3);
+}
+
+static size_t write_subheader(uint8_t * data, uint8_t id, uint8_t flags, uint16_t length) {
+    data[0] = id;
+    data[1] = flags;
+    write_uint16(&data[2], length);
+    return RMWU_XRCE_SUBHEADER_SIZE;
+}
+
+size_t rmwu_xrce_write_data_header(uint8_t * data, uint16_t object_id, uint32_t topic_length) {
+    size_t offset = write_subheader(data, RMWU_XRCE_SUBMESSAGE_WRITE_DATA, RMWU_XRCE_FLAG_LITTLE_ENDIAN
+            | RMWU_XRCE_FORMAT_DATA, (uint16_t)(RMWU_XRCE_DATA_HEADER_SIZE + topic_length));
+    // The request id and the object id are arrays of bytes, most significant first
+    data[offset] = (uint8_t)(RMWU_XRCE_DATA_REQUEST_ID >> 8);
+    data[offset + 1] = (uint8_t)RMWU_XRCE_DATA_REQUEST_ID;
+    data[offset + 2] = (uint8_t)(object_id >> 8);
+    data[offset + 3] = (uint8_t)object_id;
+    write_uint32(&data[offset + 4], topic_length);
+    return offset + RMWU_XRCE_DATA_HEADER_SIZE;
+}
+
+size_t rmwu_xrce_write_fragment_header(uint8_t * data, uint16_t length, bool last) {
+    return write_subheader(data, RMWU_XRCE_SUBMESSAGE_FRAGMENT,
+            RMWU_XRCE_FLAG_LITTLE_ENDIAN | (last ? RMWU_XRCE_FLAG_LAST_FRAGMENT : 0), length);
+}
+
+/* Reserves the next fragment and writes its header, leaving the room for its payload in data and length */
+static rcluc_ret_t open_fragment(rmwu_xrce_fragment_writer_t * writer, uint8_t ** data, size_t * length) {
+    size_t fragment_length = writer->remaining;
+    uint8_t * submessage = NULL;
+    if (fragment_length > writer->max_fragment_length) {
+        fragment_length = writer->max_fragment_length;
+    }
+
+    // The previous fragment is complete and may be sent while reserving, it is no longer given back on failure
+    writer->reserved = 0;
+    rcluc_ret_t status = writer->reserve(writer->reserve_args, RMWU_XRCE_SUBHEADER_SIZE + fragment_length, &submessage);
+    if (RCLUC_RET_OK != status) {
+        return status;
+    }
+    writer->remaining -= fragment_length;
+    writer->opened++;
+    writer->reserved = RMWU_XRCE_SUBHEADER_SIZE + fragment_length;
+    *data = submessage + rmwu_xrce_write_fragment_header(submessage, (uint16_t)fragment_length,
+            0 == writer->remaining);
+    *length = fragment_length;
+    return RCLUC_RET_OK;
+}
+
+/* Flush function for the CDR buffer that moves the serialization on to the next fragment once one is full */
+static rcluc_ret_t fragment_flush(rcluc_cdr_buffer_t * buffer, void * args) {
+    rmwu_xrce_fragment_writer_t * writer = (rmwu_xrce_fragment_writer_t *)args;
+    uint8_t * data = NULL;
+    size_t length = 0;
+    rcluc_ret_t status = RCLUC_RET_ERR_SPACE;
+
+    // The serializer is writing more data than the header announced
+    if (writer->remaining > 0) {
+        status = open_fragment(writer, &data, &length);
+    }
+    if (RCLUC_RET_OK == status) {
+        rcluc_cdr_set_window(buffer, data, length);
+    }
+    return status;
+}
+
+rcluc_ret_t rmwu_xrce_fragments_begin(rmwu_xrce_fragment_writer_t * writer, rmwu_xrce_reserve_func_t reserve,
+        void * reserve_args, size_t max_fragment_length, uint16_t object_id, uint32_t topic_length,
+        rcluc_cdr_buffer_t * buffer) {
+    uint8_t * data = NULL;
+    size_t length = 0;
+    writer->reserve = reserve;
+    writer->reserve_args = reserve_args;
+    writer->max_fragment_length = max_fragment_length;
+    writer->remaining = RMWU_XRCE_SUBHEADER_SIZE + RMWU_XRCE_DATA_HEADER_SIZE + topic_length;
+    writer->opened = 0;
+    writer->reserved = 0;
+
+    rcluc_ret_t status = open_fragment(writer, &data, &length);
+    if (RCLUC_RET_OK != status) {
+        return status;
+    }
+    size_t header_length = rmwu_xrce_write_data_header(data, object_id, topic_length);
+    rcluc_cdr_init(buffer, data + header_length, length - header_length);
+    rcluc_cdr_set_flush(buffer, fragment_flush, writer);
+    return RCLUC_RET_OK;
+}
+
+rcluc_ret_t rmwu_xrce_fragments_end(rmwu_xrce_fragment_writer_t * writer, const rcluc_cdr_buffer_t * buffer,
+        uint32_t topic_length) {
+    if (0 != writer->remaining || rcluc_cdr_get_length(buffer) != topic_length) {
+        return RCLUC_RET_ERROR;
+    }
+    writer->reserved = 0;
+    return RCLUC_RET_OK;
+}
+
+void rmwu_xrce_reassembler_init(rmwu_xrce_reassembler_t * reassembler, uint8_t stream_id, rmwu_xrce_data_func_t on_data,
+        void * on_data_args) {
+    memset(reassembler, 0, sizeof(*reassembler));
+    reassembler->stream_id = stream_id;
+    reassembler->state = RMWU_XRCE_COLLECTING_HEADER;
+    reassembler->on_data = on_data;
+    reassembler->on_data_args = on_data_args;
+}
+
+/* Checks the header of the DATA submessage collected from the first fragments and starts handing over its sample */
+static void start_sample(rmwu_xrce_reassembler_t * reassembler, const uint8_t * data) {
+    const uint8_t * header = reassembler->header;
+    uint8_t flags = header[1];
+    size_t submessage_length = read_uint16(&header[2]);
+    reassembler->total_length = read_uint32(&header[RMWU_XRCE_SUBHEADER_SIZE + 4],
+            0 != (flags & RMWU_XRCE_FLAG_LITTLE_ENDIAN));
+    reassembler->offset = 0;
+    if (RMWU_XRCE_SUBMESSAGE_DATA != header[0] || RMWU_XRCE_FORMAT_DATA != (flags & RMWU_XRCE_FORMAT_MASK)
+            || submessage_length < RMWU_XRCE_DATA_HEADER_SIZE
+            || reassembler->total_length > submessage_length - RMWU_XRCE_DATA_HEADER_SIZE) {
+        reassembler->state = RMWU_XRCE_DISCARDING;
+        return;
+    }
+    reassembler->state = RMWU_XRCE_RECEIVING_SAMPLE;
+    if (0 == reassembler->total_length) {
+        reassembler->on_data(reassembler->on_data_args, (uint16_t)((header[6] << 8) | header[7]), data, 0, 0, 0);
+    }
+}
+
+static void reassemble_fragment(rmwu_xrce_reassembler_t * reassembler, uint8_t flags, const uint8_t * data,
+        size_t length) {
+    if (RMWU_XRCE_COLLECTING_HEADER == reassembler->state) {
+        size_t header_length = sizeof(reassembler->header) - reassembler->header_length;
+        if (header_length > length) {
+            header_length = length;
+        }
+        memcpy(&reassembler->header[reassembler->header_length], data, header_length);
+        reassembler->header_length += header_length;
+        data += header_length;
+        length -= header_length;
+        if (sizeof(reassembler->header) == reassembler->header_length) {
+            start_sample(reassembler, data);
+        }
+    }
+    if (RMWU_XRCE_RECEIVING_SAMPLE == reassembler->state && length > 0) {
+        const uint8_t * header = reassembler->header;
+        if (length > reassembler->total_length - reassembler->offset) {
+            length = reassembler->total_length - reassembler->offset;
+        }
+        if (length > 0) {
+            reassembler->on_data(reassembler->on_data_args, (uint16_t)((header[6] << 8) | header[7]), data,
+                    reassembler->offset, length, reassembler->total_length);
+            reassembler->offset += length;
+        }
+    }
+    if (0 != (flags & RMWU_XRCE_FLAG_LAST_FRAGMENT)) {
+        reassembler->state = RMWU_XRCE_COLLECTING_HEADER;
+        reassembler->header_length = 0;
+    }
+}
+
+size_t rmwu_xrce_reassemble(rmwu_xrce_reassembler_t * reassembler, uint8_t * message, size_t length) {
+    size_t offset = RMWU_XRCE_MESSAGE_HEADER_SIZE;
+    if (length < RMWU_XRCE_MESSAGE_HEADER_SIZE || reassembler->stream_id < RMWU_XRCE_STREAM_ID_RELIABLE
+            || message[1] != reassembler->stream_id) {
+        return length;
+    }
+    if (message[0] < RMWU_XRCE_SESSION_ID_WITHOUT_KEY) {
+        offset += RMWU_XRCE_CLIENT_KEY_SIZE;
+    }
+
+    // The session reorders the messages of a reliable stream, the fragments taken out of them are reassembled now
+    uint16_t sequence = read_uint16(&message[2]);
+    int16_t ahead = (int16_t)(uint16_t)(sequence - reassembler->next_sequence);
+    bool duplicate = reassembler->synced && ahead < 0;
+    if (!duplicate) {
+        if (reassembler->synced && ahead > 0) {
+            // The skipped message may have held fragments of the sample being received or of the next one
+            reassembler->state = RMWU_XRCE_DISCARDING;
+        }
+        reassembler->synced = 1;
+        reassembler->next_sequence = (uint16_t)(sequence + 1);
+    }
+
+    while (offset + RMWU_XRCE_SUBHEADER_SIZE <= length) {
+        size_t end = offset + RMWU_XRCE_SUBHEADER_SIZE + read_uint16(&message[offset + 2]);
+        if (end > length) {
+            break;
+        }
+        size_t next = align_to_4(end);
+        if (next > length) {
+            next = length;
+        }
+        if (RMWU_XRCE_SUBMESSAGE_FRAGMENT != message[offset]) {
+            offset = next;
+            continue;
+        }
+        if (!duplicate) {
+            reassemble_fragment(reassembler, message[offset + 1], &message[offset + RMWU_XRCE_SUBHEADER_SIZE],
+                    end - offset - RMWU_XRCE_SUBHEADER_SIZE);
+        }
+        memmove(&message[offset], &message[next], length - next);
+        length -= next - offset;
+    }
+    return length;
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief The DDS-XRCE submessages that the micro-RTPS backend writes and reads on its own. Not part of the public
+ *  interface.
+ *
+ *  Samples serialized in place and samples split into fragments are written around the entity requests of the
+ *  micro-RTPS client, and the client does not reassemble the fragments it receives. The encoding of these submessages
+ *  follows the DDS-XRCE specification and needs nothing from the client, so it lives here, where the unit tests can
+ *  check it against the mock agent without a client library.
+ */
+
+#ifndef RCLUC__RMWU_XRCE_H_
+#define RCLUC__RMWU_XRCE_H_
+
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc/rcluc_types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ *  @brief The size (in bytes) of the header of a message: session id, stream id and sequence number. Sessions with an
+ *  id below RMWU_XRCE_SESSION_ID_WITHOUT_KEY follow it with the client key.
+ */
+#define RMWU_XRCE_MESSAGE_HEADER_SIZE       4
+#define RMWU_XRCE_CLIENT_KEY_SIZE           4
+#define RMWU_XRCE_SESSION_ID_WITHOUT_KEY    0x80
+
+/**
+ *  @brief Stream ids from this one on are reliable streams
+ */
+#define RMWU_XRCE_STREAM_ID_RELIABLE        0x80
+
+/**
+ *  @brief The size (in bytes) of the header in front of every submessage
+ */
+#define RMWU_XRCE_SUBHEADER_SIZE            4
+
+/**
+ *  @brief The size (in bytes) of the payload in front of the sample of a WRITE_DATA or DATA submessage: the base object
+ *  request and the length of the sample
+ */
+#define RMWU_XRCE_DATA_HEADER_SIZE          8
+
+#define RMWU_XRCE_SUBMESSAGE_WRITE_DATA     7
+#define RMWU_XRCE_SUBMESSAGE_DATA           9
+#define RMWU_XRCE_SUBMESSAGE_FRAGMENT       13
+
+#define RMWU_XRCE_FLAG_LITTLE_ENDIAN        (1 << 0)
+#define RMWU_XRCE_FLAG_LAST_FRAGMENT        (1 << 1)
+
+/**
+ *  @brief The object id of an entity as it goes on the wire: the 12 bit id followed by the 4 bit entity kind
+ */
+#define RMWU_XRCE_OBJECT_ID(id, kind)       ((uint16_t)(((id) << 4) | ((kind) & 0x0F)))
+
+/**
+ *  @brief The construct for a function that reserves room for a FRAGMENT submessage, see rmwu_xrce_fragments_begin
+ *
+ *  @param args The reserve_args of the fragment writer
+ *  @param length The size (in bytes) of the submessage, header included
+ *  @param data (output) Where the submessage is to be written
+ *  @return Returns an error code that will be RCLUC_RET_OK if length bytes were reserved
+ */
+typedef rcluc_ret_t (*rmwu_xrce_reserve_func_t)(void * args, size_t length, uint8_t ** data);
+
+/**
+ *  @struct rmwu_xrce_fragment_writer_t
+ *  @brief A WRITE_DATA submessage being written as FRAGMENT submessages
+ *
+ *  @var rmwu_xrce_fragment_writer_t::remaining
+ *      The bytes of the WRITE_DATA submessage that no fragment was opened for yet
+ *  @var rmwu_xrce_fragment_writer_t::opened
+ *      The number of fragments opened so far
+ *  @var rmwu_xrce_fragment_writer_t::reserved
+ *      The size (in bytes) of the reservation of the latest fragment while it is being written, 0 once it is complete
+ */
+typedef struct {
+    rmwu_xrce_reserve_func_t reserve;
+    void * reserve_args;
+    size_t max_fragment_length;
+    size_t remaining;
+    size_t opened;
+    size_t reserved;
+} rmwu_xrce_fragment_writer_t;
+
+/**
+ *  @brief The construct for the function a reassembler hands the samples of DATA submessages to, one fragment at a
+ *  time, see rmwu_subscription_data_func_t
+ *
+ *  @param args The on_data_args of the reassembler
+ *  @param object_id The datareader the sample is for, see RMWU_XRCE_OBJECT_ID
+ *  @param data The bytes of the sample in this fragment
+ *  @param offset The offset of data within the sample
+ *  @param length The number of bytes in data
+ *  @param total_length The size (in bytes) of the sample
+ */
+typedef void (*rmwu_xrce_data_func_t)(void * args, uint16_t object_id, const uint8_t * data, size_t offset,
+    size_t length, size_t total_length);
+
+/**
+ *  @struct rmwu_xrce_reassembler_t
+ *  @brief Reassembles the DATA submessages that arrive as FRAGMENT submessages on one reliable input stream
+ *
+ *  @var rmwu_xrce_reassembler_t::stream_id
+ *      The reliable stream whose fragments are reassembled
+ *  @var rmwu_xrce_reassembler_t::next_sequence
+ *      The sequence number of the next message expected on the stream, once synced is set
+ *  @var rmwu_xrce_reassembler_t::state
+ *      Whether the header of a DATA submessage is being collected, its sample is being handed over, or the fragments
+ *      are discarded up to the last one
+ *  @var rmwu_xrce_reassembler_t::header
+ *      The submessage header and data header of the DATA submessage, which may span fragments
+ */
+typedef struct {
+    uint8_t stream_id;
+    uint8_t synced;
+    uint16_t next_sequence;
+    uint8_t state;
+    uint8_t header[RMWU_XRCE_SUBHEADER_SIZE + RMWU_XRCE_DATA_HEADER_SIZE];
+    size_t header_length;
+    size_t offset;
+    size_t total_length;
+    rmwu_xrce_data_func_t on_data;
+    void * on_data_args;
+} rmwu_xrce_reassembler_t;
+
+/**
+ *  @brief Writes the header of a WRITE_DATA submessage carrying a sample of topic_length bytes, which follow it. The
+ *  agent does not answer WRITE_DATA, so it goes with the request id 0 that no request of a session is given.
+ *
+ *  @param data Where to write the RMWU_XRCE_SUBHEADER_SIZE + RMWU_XRCE_DATA_HEADER_SIZE bytes of the header
+ *  @param object_id The datawriter writing the sample, see RMWU_XRCE_OBJECT_ID
+ *  @param topic_length The size (in bytes) of the sample
+ *  @return The size (in bytes) of the header
+ */
+size_t rmwu_xrce_write_data_header(uint8_t * data, uint16_t object_id, uint32_t topic_length);
+
+/**
+ *  @brief Writes the header of a FRAGMENT submessage carrying length bytes of a submessage split over several messages
+ *  of a reliable stream
+ *
+ *  @param data Where to write the RMWU_XRCE_SUBHEADER_SIZE bytes of the header
+ *  @param length The size (in bytes) of the fragment
+ *  @param last true for the fragment that completes the split submessage
+ *  @return The size (in bytes) of the header
+ */
+size_t rmwu_xrce_write_fragment_header(uint8_t * data, uint16_t length, bool last);
+
+/**
+ *  @brief Starts a WRITE_DATA submessage split into fragments of at most max_fragment_length bytes. The first fragment
+ *  is reserved and given the WRITE_DATA header, and buffer is set up to serialize the sample into it. Once a fragment
+ *  is full the buffer reserves the next one with the reserve function.
+ *
+ *  @param writer The fragment writer
+ *  @param reserve The function reserving the room for each FRAGMENT submessage
+ *  @param reserve_args The first argument of reserve
+ *  @param max_fragment_length The largest fragment (in bytes), without its submessage header. Has to hold the
+ *      WRITE_DATA header.
+ *  @param object_id The datawriter writing the sample, see RMWU_XRCE_OBJECT_ID
+ *  @param topic_length The size (in bytes) of the sample
+ *  @param buffer (output) The buffer to serialize the sample into
+ *  @return Returns an error code that will be RCLUC_RET_OK if the first fragment was reserved, or the error of reserve
+ */
+rcluc_ret_t rmwu_xrce_fragments_begin(rmwu_xrce_fragment_writer_t * writer, rmwu_xrce_reserve_func_t reserve,
+    void * reserve_args, size_t max_fragment_length, uint16_t object_id, uint32_t topic_length,
+    rcluc_cdr_buffer_t * buffer);
+
+/**
+ *  @brief Checks that the sample serialized into buffer filled the fragments exactly. Otherwise the fragments written
+ *  so far carry a submessage that does not match its header, and are to be given up by the caller with the help of
+ *  the opened and reserved fields of the writer.
+ *
+ *  @param writer The fragment writer
+ *  @param buffer The buffer the sample was serialized into
+ *  @param topic_length The size (in bytes) of the sample given to rmwu_xrce_fragments_begin
+ *  @return Returns an error code that will be RCLUC_RET_OK if the sample had the size announced in its header
+ */
+rcluc_ret_t rmwu_xrce_fragments_end(rmwu_xrce_fragment_writer_t * writer, const rcluc_cdr_buffer_t * buffer,
+    uint32_t topic_length);
+
+/**
+ *  @brief Sets up a reassembler for a reliable stream, with nothing received yet
+ *
+ *  @param reassembler The reassembler
+ *  @param stream_id The reliable input stream to reassemble the fragments of. Other streams are left alone.
+ *  @param on_data The function to hand the samples to
+ *  @param on_data_args The first argument of on_data
+ */
+void rmwu_xrce_reassembler_init(rmwu_xrce_reassembler_t * reassembler, uint8_t stream_id, rmwu_xrce_data_func_t on_data,
+    void * on_data_args);
+
+/**
+ *  @brief Hands the samples of the fragments in a received message to on_data and takes the fragments out of the
+ *  message, so that only the other submessages remain for the session to read. Messages are expected in the order of
+ *  their sequence numbers: fragments of a message received twice are dropped, and a sample whose fragments arrive
+ *  around a message that was skipped is dropped up to its last fragment. Its receiver is left with a partial sample,
+ *  which the next sample, starting at offset 0, replaces.
+ *
+ *  @param reassembler The reassembler
+ *  @param message The message as received from the agent
+ *  @param length The size (in bytes) of the message
+ *  @return The size (in bytes) of what is left of the message
+ */
+size_t rmwu_xrce_reassemble(rmwu_xrce_reassembler_t * reassembler, uint8_t * message, size_t length);
+
+#endif /* ifndef RCLUC__RMWU_XRCE_H_ */
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Checks shared by the unit tests. Every test is a function returning the number of failed checks, and the
+ *  test program fails if any test does.
+ */
+
+#ifndef RCLUC__RCLUC_TEST_H_
+#define RCLUC__RCLUC_TEST_H_
+
+#include <stdio.h>
+
+/**
+ *  @brief Counts a failure and prints where it happened if condition does not hold, then carries on with the test
+ */
+#define RCLUC_TEST_CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+/**
+ *  @brief Runs a test function and adds its failures to the ones of the program
+ */
+#define RCLUC_TEST_RUN(test) \
+    do { \
+        int test_failures = test(); \
+        printf("%s %s\n", (0 == test_failures) ? "PASS" : "FAIL", #test); \
+        failures += test_failures; \
+    } while (0)
+
+#endif /* ifndef RCLUC__RCLUC_TEST_H_ */
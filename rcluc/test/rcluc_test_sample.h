@@ -0,0 +1,109 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief The message type of the unit tests that publish and subscribe over the shm backend. Every word of a sample
+ *  holds its index, so that a sample made of two shows as words that differ.
+ */
+
+#ifndef RCLUC__RCLUC_TEST_SAMPLE_H_
+#define RCLUC__RCLUC_TEST_SAMPLE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "rcluc/rcluc.h"
+#include "rcluc/rcluc_cdr.h"
+
+#define RCLUC_TEST_SAMPLE_WORDS 16
+#define RCLUC_TEST_SAMPLE_SERIALIZED_SIZE (RCLUC_TEST_SAMPLE_WORDS * sizeof(uint32_t))
+
+typedef struct {
+    uint32_t words[RCLUC_TEST_SAMPLE_WORDS];
+} rcluc_test_sample_t;
+
+static inline void rcluc_test_sample_fill(rcluc_test_sample_t * sample, uint32_t index) {
+    for (size_t i = 0; i < RCLUC_TEST_SAMPLE_WORDS; ++i) {
+        sample->words[i] = index;
+    }
+}
+
+static inline rcluc_ret_t rcluc_test_sample_serialize(const void * message, rcluc_cdr_buffer_t * buffer) {
+    const rcluc_test_sample_t * sample = message;
+    return rcluc_cdr_serialize_array(buffer, sample->words, RCLUC_TEST_SAMPLE_WORDS, sizeof(uint32_t));
+}
+
+static inline rcluc_ret_t rcluc_test_sample_deserialize(void * message_buffer, size_t message_buffer_size,
+        void * deserialized_buffer, size_t deserialized_buffer_size) {
+    rcluc_test_sample_t * sample = deserialized_buffer;
+    rcluc_cdr_buffer_t buffer;
+    if (deserialized_buffer_size < sizeof(*sample)) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    rcluc_cdr_init(&buffer, message_buffer, message_buffer_size);
+    return rcluc_cdr_deserialize_array(&buffer, sample->words, RCLUC_TEST_SAMPLE_WORDS, sizeof(uint32_t));
+}
+
+static inline size_t rcluc_test_sample_get_serialized_size(const void * message) {
+    (void) message;
+    return rcluc_cdr_array_end(0, RCLUC_TEST_SAMPLE_WORDS, sizeof(uint32_t));
+}
+
+/**
+ *  @brief Gets the type support of the test samples, published under type_name so that a test can also make a type
+ *  mismatch
+ */
+static inline rcluc_message_type_support_t rcluc_test_sample_type_support(const char * type_name) {
+    rcluc_message_type_support_t type_support = {
+        type_name,
+        sizeof(rcluc_test_sample_t),
+        RCLUC_TEST_SAMPLE_SERIALIZED_SIZE,
+        rcluc_test_sample_serialize,
+        rcluc_test_sample_deserialize,
+        rcluc_test_sample_get_serialized_size,
+    };
+    return type_support;
+}
+
+/**
+ *  @brief Reads the index of a sample as the library hands it to the application, serialized if deserialization is
+ *  disabled and deserialized otherwise
+ *
+ *  @param message The sample
+ *  @param index (output) The index held by the first word
+ *  @param torn (output) Set to 1 if any other word holds a different index, 0 otherwise
+ *  @return Returns an error code that will be RCLUC_RET_OK if the sample is read
+ */
+static inline rcluc_ret_t rcluc_test_sample_read(const void * message, uint32_t * index, int * torn) {
+    uint32_t words[RCLUC_TEST_SAMPLE_WORDS];
+    rcluc_ret_t status = RCLUC_RET_OK;
+#if configRCLUC_SUBSCRIPTION_DESERIALIZATION_SUPPORT == RCLUC_SUBSCRIPTION_DESERIALIZATION_DISABLED
+    for (size_t i = 0; RCLUC_RET_OK == status && i < RCLUC_TEST_SAMPLE_WORDS; ++i) {
+        status = rcluc_cdr_get_uint32(message, RCLUC_TEST_SAMPLE_SERIALIZED_SIZE, i * sizeof(uint32_t), &words[i]);
+    }
+#else
+    memcpy(words, ((const rcluc_test_sample_t *)message)->words, sizeof(words));
+#endif
+    if (RCLUC_RET_OK == status) {
+        *index = words[0];
+        *torn = 0;
+        for (size_t i = 1; i < RCLUC_TEST_SAMPLE_WORDS; ++i) {
+            *torn |= (words[i] != words[0]);
+        }
+    }
+    return status;
+}
+
+#endif /* ifndef RCLUC__RCLUC_TEST_SAMPLE_H_ */
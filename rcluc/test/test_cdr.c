@@ -0,0 +1,157 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Unit tests of the bulk array serialization of rcluc_cdr.h, in both byte orders and over a buffer flushed in
+ *  small windows
+ */
+
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc_test.h"
+#include <string.h>
+
+#define WINDOW_SIZE 16
+
+/* Collects the windows of a buffer serialized in small pieces into one stream */
+typedef struct {
+    uint8_t stream[256];
+    size_t length;
+    uint8_t window[WINDOW_SIZE];
+} window_collector_t;
+
+static rcluc_ret_t collect_window(rcluc_cdr_buffer_t * buffer, void * args) {
+    window_collector_t * collector = (window_collector_t *)args;
+    memcpy(&collector->stream[collector->length], buffer->data, buffer->position);
+    collector->length += buffer->position;
+    rcluc_cdr_set_window(buffer, collector->window, sizeof(collector->window));
+    return RCLUC_RET_OK;
+}
+
+static int test_array_round_trip(rcluc_cdr_endianness_t endianness) {
+    int failures = 0;
+    uint8_t data[128];
+    uint16_t shorts[5] = {0x0102, 0x0304, 0x0506, 0x0708, 0x090A};
+    uint64_t longs[3] = {0x0102030405060708ull, 0, UINT64_MAX};
+    uint16_t shorts_out[5] = {0};
+    uint64_t longs_out[3] = {0};
+    uint8_t byte = 0;
+    rcluc_cdr_buffer_t buffer;
+
+    rcluc_cdr_init(&buffer, data, sizeof(data));
+    buffer.endianness = endianness;
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_serialize_uint8(&buffer, 0xAB));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_serialize_array(&buffer, shorts, 5, sizeof(shorts[0])));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_serialize_array(&buffer, longs, 3, sizeof(longs[0])));
+    // Each array is aligned to its element size: 1 byte, 1 of padding, 10 of shorts, 4 of padding, 24 of longs
+    RCLUC_TEST_CHECK(rcluc_cdr_array_end(rcluc_cdr_array_end(1, 5, 2), 3, 8) == rcluc_cdr_get_length(&buffer));
+    RCLUC_TEST_CHECK(40 == rcluc_cdr_get_length(&buffer));
+    RCLUC_TEST_CHECK(((RCLUC_CDR_BIG_ENDIAN == endianness) ? 0x01 : 0x02) == data[2]);
+    RCLUC_TEST_CHECK(((RCLUC_CDR_BIG_ENDIAN == endianness) ? 0x01 : 0x08) == data[16]);
+
+    rcluc_cdr_init(&buffer, data, 40);
+    buffer.endianness = endianness;
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_deserialize_uint8(&buffer, &byte));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_deserialize_array(&buffer, shorts_out, 5, sizeof(shorts_out[0])));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_deserialize_array(&buffer, longs_out, 3, sizeof(longs_out[0])));
+    RCLUC_TEST_CHECK(0xAB == byte);
+    RCLUC_TEST_CHECK(0 == memcmp(shorts, shorts_out, sizeof(shorts)));
+    RCLUC_TEST_CHECK(0 == memcmp(longs, longs_out, sizeof(longs)));
+    return failures;
+}
+
+static int test_array_little_endian(void) {
+    return test_array_round_trip(RCLUC_CDR_LITTLE_ENDIAN);
+}
+
+static int test_array_big_endian(void) {
+    return test_array_round_trip(RCLUC_CDR_BIG_ENDIAN);
+}
+
+static int test_array_over_windows(void) {
+    int failures = 0;
+    static window_collector_t collector;
+    uint32_t values[40];
+    uint32_t values_out[40] = {0};
+    size_t count = 0;
+    uint8_t byte = 0;
+    rcluc_cdr_buffer_t buffer;
+
+    for (uint32_t i = 0; i < 40; ++i) {
+        values[i] = 0x01000000u * i + i;
+    }
+    // Swapped arrays go out a block at a time, which has to carry on across windows smaller than the block
+    for (int order = 0; order < 2; ++order) {
+        collector.length = 0;
+        rcluc_cdr_init(&buffer, collector.window, sizeof(collector.window));
+        rcluc_cdr_set_flush(&buffer, collect_window, &collector);
+        buffer.endianness = (0 == order) ? RCLUC_CDR_LITTLE_ENDIAN : RCLUC_CDR_BIG_ENDIAN;
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_serialize_uint8(&buffer, 7));
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_serialize_sequence(&buffer, values, 40, sizeof(values[0])));
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == collect_window(&buffer, &collector));
+        RCLUC_TEST_CHECK(rcluc_cdr_sequence_end(1, 40, 4) == collector.length);
+
+        rcluc_cdr_init(&buffer, collector.stream, collector.length);
+        buffer.endianness = (0 == order) ? RCLUC_CDR_LITTLE_ENDIAN : RCLUC_CDR_BIG_ENDIAN;
+        memset(values_out, 0, sizeof(values_out));
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_deserialize_uint8(&buffer, &byte));
+        RCLUC_TEST_CHECK(7 == byte);
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_deserialize_sequence(&buffer, values_out, 40, sizeof(values_out[0]),
+                &count));
+        RCLUC_TEST_CHECK(40 == count);
+        RCLUC_TEST_CHECK(0 == memcmp(values, values_out, sizeof(values)));
+    }
+    return failures;
+}
+
+static int test_sequence_limits(void) {
+    int failures = 0;
+    uint8_t data[64];
+    uint16_t values[4] = {1, 2, 3, 4};
+    uint16_t values_out[3] = {0};
+    size_t count = 1;
+    rcluc_cdr_buffer_t buffer;
+
+    rcluc_cdr_init(&buffer, data, sizeof(data));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_serialize_sequence(&buffer, values, 4, sizeof(values[0])));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_serialize_sequence(&buffer, NULL, 0, sizeof(values[0])));
+    RCLUC_TEST_CHECK(16 == rcluc_cdr_get_length(&buffer));
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_PARAM == rcluc_cdr_serialize_array(&buffer, values, 1, 3));
+
+    // A sequence longer than the array leaves the buffer in error instead of writing past the array
+    rcluc_cdr_init(&buffer, data, 16);
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_SPACE == rcluc_cdr_deserialize_sequence(&buffer, values_out, 3,
+            sizeof(values_out[0]), &count));
+    RCLUC_TEST_CHECK(0 == count);
+    RCLUC_TEST_CHECK(0 == values_out[0]);
+
+    // An array running past the end of the data is an error, whatever fits of it
+    rcluc_cdr_init(&buffer, data, 6);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK != rcluc_cdr_deserialize_array(&buffer, values_out, 4, sizeof(values_out[0])));
+
+    // Arrays into a full window without a flush function fail the same way
+    rcluc_cdr_init(&buffer, data, 6);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK != rcluc_cdr_serialize_array(&buffer, values, 4, sizeof(values[0])));
+    return failures;
+}
+
+int main(void) {
+    int failures = 0;
+    RCLUC_TEST_RUN(test_array_little_endian);
+    RCLUC_TEST_RUN(test_array_big_endian);
+    RCLUC_TEST_RUN(test_array_over_windows);
+    RCLUC_TEST_RUN(test_sequence_limits);
+    return (0 == failures) ? 0 : 1;
+}
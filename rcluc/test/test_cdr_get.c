@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Unit tests of the in-place field readers of rcluc_cdr.h
+ */
+
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc_test.h"
+#include <string.h>
+
+static int test_get_fields(void) {
+    int failures = 0;
+    uint8_t data[32];
+    uint16_t u16 = 0;
+    uint64_t u64 = 0;
+    double f64 = 0;
+    rcluc_cdr_buffer_t buffer;
+
+    rcluc_cdr_init(&buffer, data, sizeof(data));
+    (void) rcluc_cdr_serialize_uint8(&buffer, 1);
+    (void) rcluc_cdr_serialize_uint16(&buffer, 0xBEEF);
+    (void) rcluc_cdr_serialize_uint64(&buffer, 0x1122334455667788ull);
+    (void) rcluc_cdr_serialize_double(&buffer, -2.5);
+    RCLUC_TEST_CHECK(24 == rcluc_cdr_get_length(&buffer));
+
+    // The offset is the end of the previous field, the reader aligns it like the deserializer does
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_get_uint16(data, 24, 1, &u16));
+    RCLUC_TEST_CHECK(0xBEEF == u16);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_get_uint64(data, 24, 4, &u64));
+    RCLUC_TEST_CHECK(0x1122334455667788ull == u64);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_get_double(data, 24, 16, &f64));
+    RCLUC_TEST_CHECK(-2.5 == f64);
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_SPACE == rcluc_cdr_get_double(data, 23, 16, &f64));
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_SPACE == rcluc_cdr_get_uint64(data, 24, 17, &u64));
+    return failures;
+}
+
+static int test_get_string(void) {
+    int failures = 0;
+    uint8_t data[32];
+    const char * string = NULL;
+    size_t end = 0;
+    rcluc_cdr_buffer_t buffer;
+
+    rcluc_cdr_init(&buffer, data, sizeof(data));
+    (void) rcluc_cdr_serialize_uint8(&buffer, 1);
+    (void) rcluc_cdr_serialize_string(&buffer, "hello");
+    (void) rcluc_cdr_serialize_string(&buffer, "");
+    RCLUC_TEST_CHECK(21 == rcluc_cdr_get_length(&buffer));
+
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_get_string(data, 21, 1, &string, &end));
+    RCLUC_TEST_CHECK(0 == strcmp("hello", string));
+    RCLUC_TEST_CHECK(rcluc_cdr_string_end(1, "hello") == end);
+
+    // The empty string ends exactly at the end of the message
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_get_string(data, 21, end, &string, &end));
+    RCLUC_TEST_CHECK(0 == strcmp("", string));
+    RCLUC_TEST_CHECK(21 == end);
+
+    // One byte short, the characters or the length prefix go past the end of the message
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_SPACE == rcluc_cdr_get_string(data, 20, 14, &string, NULL));
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_SPACE == rcluc_cdr_get_string(data, 13, 1, &string, NULL));
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_SPACE == rcluc_cdr_get_string(data, 7, 1, &string, NULL));
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_SPACE == rcluc_cdr_get_string(data, 21, 21, &string, NULL));
+
+    // A string that is not null terminated, or has no room for the terminator, is rejected
+    data[13] = 'x';
+    RCLUC_TEST_CHECK(RCLUC_RET_ERROR == rcluc_cdr_get_string(data, 21, 1, &string, NULL));
+    memset(&data[4], 0, 4);
+    RCLUC_TEST_CHECK(RCLUC_RET_ERROR == rcluc_cdr_get_string(data, 21, 1, &string, NULL));
+    RCLUC_TEST_CHECK(RCLUC_RET_NULL_PTR == rcluc_cdr_get_string(data, 21, 1, NULL, NULL));
+    return failures;
+}
+
+int main(void) {
+    int failures = 0;
+    RCLUC_TEST_RUN(test_get_fields);
+    RCLUC_TEST_RUN(test_get_string);
+    return (0 == failures) ? 0 : 1;
+}
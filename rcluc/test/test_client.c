@@ -0,0 +1,258 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Unit tests of the service clients over the shm backend: responses find their request from the request id
+ *  in front of them, in any order, and responses to other requests are ignored. The server side is written straight
+ *  on the rmwu layer, as it sees the request ids that the rcluc layer hides.
+ */
+
+#include "rcluc/rcluc.h"
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc_internal.h"
+#include "rcluc_test.h"
+#include "rcluc_test_sample.h"
+#include <string.h>
+
+#define SERVICE_NAME "rcluc_test/echo"
+#define REQUEST_TYPE_NAME "rcluc_test::srv::dds_::Echo_Request_"
+#define RESPONSE_TYPE_NAME "rcluc_test::srv::dds_::Echo_Response_"
+#define QUEUE_LENGTH 4
+#define SERVED_MAX 8
+#define RESPONSES_MAX 8
+
+/* A request or a response as the server sees it, with the request id in front of the sample */
+typedef struct {
+    uint8_t bytes[RCLUC_SERVICE_HEADER_SIZE + RCLUC_TEST_SAMPLE_SERIALIZED_SIZE];
+} raw_sample_t;
+
+/* The number of bytes the server writes, shortened to send a response that cannot hold its header */
+static size_t raw_length = sizeof(raw_sample_t);
+
+static rcluc_ret_t raw_serialize(const void * message, rcluc_cdr_buffer_t * buffer) {
+    const raw_sample_t * sample = message;
+    return rcluc_cdr_serialize_bytes(buffer, sample->bytes, raw_length);
+}
+
+static size_t raw_get_serialized_size(const void * message) {
+    (void) message;
+    return raw_length;
+}
+
+static rcluc_message_type_support_t request_type;
+static rcluc_message_type_support_t response_type;
+static rcluc_service_type_support_t service_type;
+static rcluc_message_type_support_t raw_request_type;
+static rcluc_message_type_support_t raw_response_type;
+static uint8_t client_buffer[RCLUC_SUBSCRIPTION_BUFFER_SIZE(RCLUC_TEST_SAMPLE_SERIALIZED_SIZE
+    + RCLUC_SERVICE_HEADER_SIZE, QUEUE_LENGTH)];
+static rcluc_node_handle_t node;
+static rcluc_client_handle_t client;
+static rmwu_subscription_t server_requests;
+static rmwu_publisher_t server_responses;
+/* The requests the server received and has not answered yet */
+static raw_sample_t served[SERVED_MAX];
+static size_t served_count;
+/* The sequence numbers and indices of the responses delivered to the client */
+static int64_t response_sequence[RESPONSES_MAX];
+static uint32_t response_index[RESPONSES_MAX];
+static size_t response_count;
+
+static rcluc_ret_t server_on_request(void * args, const uint8_t * data, size_t offset, size_t length,
+        size_t total_length) {
+    (void) args;
+    if (served_count >= SERVED_MAX || offset + length > sizeof(raw_sample_t)) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    memcpy(&served[served_count].bytes[offset], data, length);
+    if (offset + length == total_length) {
+        served_count++;
+    }
+    return RCLUC_RET_OK;
+}
+
+static uint64_t served_request_id(size_t i) {
+    uint64_t request_id = 0;
+    (void) rcluc_cdr_get_uint64(served[i].bytes, sizeof(served[i].bytes), 0, &request_id);
+    return request_id;
+}
+
+/* Answers a received request with a response under request_id, which holds its index plus 100 */
+static rcluc_ret_t serve(size_t i, uint64_t request_id) {
+    raw_sample_t response;
+    rcluc_test_sample_t sample;
+    rcluc_cdr_buffer_t buffer;
+    uint32_t index = 0;
+    (void) rcluc_cdr_get_uint32(served[i].bytes, sizeof(served[i].bytes), RCLUC_SERVICE_HEADER_SIZE, &index);
+    rcluc_test_sample_fill(&sample, index + 100);
+    rcluc_cdr_init(&buffer, response.bytes, sizeof(response.bytes));
+    (void) rcluc_cdr_serialize_uint64(&buffer, request_id);
+    (void) rcluc_test_sample_serialize(&sample, &buffer);
+    return rmwu_publisher_publish(&server_responses, &response);
+}
+
+static void on_response(const rcluc_client_handle_t client_handle, int64_t sequence_number, const void * response,
+        rcluc_ret_t status, const void * args) {
+    uint32_t index = 0;
+    int torn = 0;
+    (void) client_handle;
+    (void) args;
+    if (response_count < RESPONSES_MAX && RCLUC_RET_OK == status
+            && RCLUC_RET_OK == rcluc_test_sample_read(response, &index, &torn) && !torn) {
+        response_sequence[response_count] = sequence_number;
+        response_index[response_count] = index;
+        response_count++;
+    }
+}
+
+static rcluc_ret_t send_request(uint32_t index, int64_t * sequence_number) {
+    rcluc_test_sample_t sample;
+    rcluc_test_sample_fill(&sample, index);
+    return rcluc_client_send_request(client, &sample, sequence_number);
+}
+
+static void spin(void) {
+    rcluc_node_spin_once(node);
+    rcluc_node_spin_once(node);
+}
+
+static int test_responses_out_of_order(void) {
+    int failures = 0;
+    int64_t sequence[3] = {0};
+    served_count = 0;
+    response_count = 0;
+    for (uint32_t i = 0; i < 3; ++i) {
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == send_request(i + 1, &sequence[i]));
+    }
+    spin();
+    RCLUC_TEST_CHECK(3 == served_count);
+    if (3 != served_count) {
+        return failures;
+    }
+    // The low bits of the request id are the ones of the sequence number, the rest keep clients apart
+    for (size_t i = 0; i < 3; ++i) {
+        RCLUC_TEST_CHECK((uint16_t)served_request_id(i) == (uint16_t)sequence[i]);
+        RCLUC_TEST_CHECK(served_request_id(i) >> 16 == served_request_id(0) >> 16);
+    }
+    for (size_t i = 3; i > 0; --i) {
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == serve(i - 1, served_request_id(i - 1)));
+    }
+    spin();
+    RCLUC_TEST_CHECK(3 == response_count);
+    for (size_t i = 0; i < response_count; ++i) {
+        RCLUC_TEST_CHECK(sequence[2 - i] == response_sequence[i]);
+        RCLUC_TEST_CHECK(103 - i == response_index[i]);
+    }
+    return failures;
+}
+
+static int test_requests_in_flight(void) {
+    int failures = 0;
+    int64_t sequence = 0;
+    served_count = 0;
+    response_count = 0;
+    for (uint32_t i = 0; i < configRCLUC_MAX_REQUESTS_IN_FLIGHT; ++i) {
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == send_request(i, &sequence));
+    }
+    // The entry of the next request still holds the oldest one, which is waiting for its response
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_SPACE == send_request(0, &sequence));
+    spin();
+    RCLUC_TEST_CHECK(configRCLUC_MAX_REQUESTS_IN_FLIGHT == served_count);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == serve(0, served_request_id(0)));
+    spin();
+    RCLUC_TEST_CHECK(1 == response_count);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == send_request(0, &sequence));
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_SPACE == send_request(0, &sequence));
+    // Answer everything that is still in flight, so that the next test starts with free entries
+    spin();
+    for (size_t i = 1; i < served_count; ++i) {
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == serve(i, served_request_id(i)));
+    }
+    spin();
+    RCLUC_TEST_CHECK(configRCLUC_MAX_REQUESTS_IN_FLIGHT + 1 == response_count);
+    return failures;
+}
+
+static int test_foreign_responses(void) {
+    int failures = 0;
+    int64_t sequence = 0;
+    served_count = 0;
+    response_count = 0;
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == send_request(7, &sequence));
+    spin();
+    RCLUC_TEST_CHECK(1 == served_count);
+    uint64_t request_id = served_request_id(0);
+    // Another client's request in the same entry, an older request of this client and a response too short for its
+    // header are all ignored
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == serve(0, request_id ^ ((uint64_t)1 << 40)));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == serve(0, request_id - configRCLUC_MAX_REQUESTS_IN_FLIGHT));
+    raw_length = RCLUC_SERVICE_HEADER_SIZE - 1;
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == serve(0, request_id));
+    raw_length = sizeof(raw_sample_t);
+    spin();
+    RCLUC_TEST_CHECK(0 == response_count);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == serve(0, request_id));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == serve(0, request_id));
+    spin();
+    // A second response to the same request finds the entry free and is dropped
+    RCLUC_TEST_CHECK(1 == response_count && sequence == response_sequence[0] && 107 == response_index[0]);
+    return failures;
+}
+
+int main(void) {
+    rcluc_client_config_t client_config = {0};
+    rcluc_subscription_config_t subscription_config;
+    rcluc_publisher_config_t publisher_config;
+    int failures = 0;
+
+    request_type = rcluc_test_sample_type_support(REQUEST_TYPE_NAME);
+    response_type = rcluc_test_sample_type_support(RESPONSE_TYPE_NAME);
+    service_type.request = &request_type;
+    service_type.response = &response_type;
+    raw_request_type = rcluc_test_sample_type_support(REQUEST_TYPE_NAME);
+    raw_request_type.serialize = raw_serialize;
+    raw_request_type.get_serialized_size = raw_get_serialized_size;
+    raw_response_type = raw_request_type;
+    raw_response_type.type_name = RESPONSE_TYPE_NAME;
+    memset(&subscription_config, 0, sizeof(subscription_config));
+    memset(&publisher_config, 0, sizeof(publisher_config));
+
+    rcluc_ret_t err = rcluc_init(&client_config);
+    if (RCLUC_RET_OK == err) {
+        err = rcluc_node_create("rcluc_test_client", "", &node);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = rcluc_client_create(node, &service_type, SERVICE_NAME, on_response, QUEUE_LENGTH, client_buffer, NULL,
+            &client);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = rmwu_subscription_create(&node->rmwu_node, &raw_request_type, "rq/" SERVICE_NAME "Request",
+            &subscription_config, server_on_request, NULL, &server_requests);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = rmwu_publisher_create(&node->rmwu_node, &raw_response_type, "rr/" SERVICE_NAME "Reply",
+            &publisher_config, &server_responses);
+    }
+    if (RCLUC_RET_OK != err) {
+        printf("File: %s, $Line: %d, Error: %d\n", __FILE__, __LINE__, err);
+        return 1;
+    }
+
+    RCLUC_TEST_RUN(test_responses_out_of_order);
+    RCLUC_TEST_RUN(test_requests_in_flight);
+    RCLUC_TEST_RUN(test_foreign_responses);
+    return (0 == failures) ? 0 : 1;
+}
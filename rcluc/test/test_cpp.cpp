@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Unit tests of the C++ interface over the shm backend: a Publisher serializes with the MessageTraits of its
+ *  type exactly like the type support does, and its messages reach a Subscription
+ */
+
+#include "rcluc/rcluc.hpp"
+#include "rcluc_HelloWorld.hpp"
+#include "rcluc_test.h"
+#include <string.h>
+
+#define TOPIC_NAME "rcluc_test/cpp"
+#define QUEUE_LENGTH 2
+#define RECEIVED_MAX 8
+
+namespace {
+
+struct Received {
+    rcluc_HelloWorld_t messages[RECEIVED_MAX];
+    size_t count;
+};
+
+Received received;
+
+struct OnHelloWorld {
+    void operator()(const rcluc_HelloWorld_t & message) const {
+        if (received.count < RECEIVED_MAX) {
+            received.messages[received.count++] = message;
+        }
+    }
+};
+
+rcluc::Node node;
+rcluc::Publisher<rcluc_HelloWorld_t> publisher;
+rcluc::Subscription<rcluc_HelloWorld_t, QUEUE_LENGTH, OnHelloWorld> subscription;
+
+void fill(rcluc_HelloWorld_t & message, uint32_t index, const char * text) {
+    memset(&message, 0, sizeof(message));
+    message.index = index;
+    strncpy(message.message, text, sizeof(message.message) - 1);
+}
+
+int test_serialize(void) {
+    int failures = 0;
+    rcluc_HelloWorld_t message;
+    uint8_t traits_buffer[RCLUC_HELLOWORLD_MAX_SERIALIZED_SIZE];
+    uint8_t type_buffer[RCLUC_HELLOWORLD_MAX_SERIALIZED_SIZE];
+    size_t traits_length = 0;
+    size_t type_length = 0;
+    fill(message, 7, "Hello World");
+
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == publisher.serialize(message, traits_buffer, sizeof(traits_buffer),
+            &traits_length));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_publisher_serialize(publisher.handle(), &message, type_buffer,
+            sizeof(type_buffer), &type_length));
+    RCLUC_TEST_CHECK(0 != traits_length && type_length == traits_length);
+    RCLUC_TEST_CHECK(0 == memcmp(traits_buffer, type_buffer, traits_length));
+    RCLUC_TEST_CHECK(rcluc_HelloWorld_get_serialized_size(&message) == traits_length);
+
+    // A buffer too small for the message is reported instead of overrun
+    RCLUC_TEST_CHECK(RCLUC_RET_OK != publisher.serialize(message, traits_buffer, traits_length - 1, &traits_length));
+    RCLUC_TEST_CHECK(0 == traits_length);
+    RCLUC_TEST_CHECK(RCLUC_RET_NULL_PTR == publisher.serialize(message, NULL, sizeof(traits_buffer), &traits_length));
+    return failures;
+}
+
+int test_round_trip(void) {
+    int failures = 0;
+    rcluc_HelloWorld_t message;
+    uint8_t serialized[RCLUC_HELLOWORLD_MAX_SERIALIZED_SIZE];
+    size_t length = 0;
+    received.count = 0;
+
+    fill(message, 1, "first");
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == publisher.publish(message));
+    node.spin_once();
+    fill(message, 2, "second");
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == publisher.serialize(message, serialized, sizeof(serialized), &length));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == publisher.publish_serialized(serialized, length));
+    node.spin_once();
+    node.spin_once();
+
+    RCLUC_TEST_CHECK(2 == received.count);
+    if (2 == received.count) {
+        RCLUC_TEST_CHECK(1 == received.messages[0].index && 0 == strcmp("first", received.messages[0].message));
+        RCLUC_TEST_CHECK(2 == received.messages[1].index && 0 == strcmp("second", received.messages[1].message));
+    }
+    return failures;
+}
+
+} // namespace
+
+int main(void) {
+    rcluc_client_config_t client_config = {};
+    int failures = 0;
+
+    rcluc_ret_t err = rcluc_init(&client_config);
+    if (RCLUC_RET_OK == err) {
+        err = node.create("rcluc_test_cpp");
+    }
+    if (RCLUC_RET_OK == err) {
+        err = subscription.create(node, TOPIC_NAME);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = publisher.create(node, TOPIC_NAME);
+    }
+    if (RCLUC_RET_OK != err) {
+        printf("File: %s, $Line: %d, Error: %d\n", __FILE__, __LINE__, err);
+        return 1;
+    }
+
+    RCLUC_TEST_RUN(test_serialize);
+    RCLUC_TEST_RUN(test_round_trip);
+    return (0 == failures) ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Unit tests of the content filters evaluated on serialized samples
+ */
+
+#include "rcluc/rcluc_cdr.h"
+#include "rcluc_internal.h"
+#include "rcluc_test.h"
+#include <math.h>
+
+/* A serialized sample: int16 at 0, uint32 at 4, float at 8, double at 16 */
+#define SAMPLE_SIZE 24
+
+static size_t serialize_sample(uint8_t * data, int16_t i16, uint32_t u32, float f32, double f64) {
+    rcluc_cdr_buffer_t buffer;
+    rcluc_cdr_init(&buffer, data, SAMPLE_SIZE);
+    (void) rcluc_cdr_serialize_uint16(&buffer, (uint16_t)i16);
+    (void) rcluc_cdr_serialize_uint32(&buffer, u32);
+    (void) rcluc_cdr_serialize_float(&buffer, f32);
+    (void) rcluc_cdr_serialize_double(&buffer, f64);
+    return rcluc_cdr_get_length(&buffer);
+}
+
+static uint8_t match_one(const rcluc_filter_check_t * check, const uint8_t * data, size_t length) {
+    rcluc_content_filter_t filter = {check, 1};
+    return rcluc_filter_match(&filter, data, length);
+}
+
+static int test_validate(void) {
+    int failures = 0;
+    size_t extent = 0;
+    rcluc_filter_check_t checks[2] = {
+        {4, RCLUC_FILTER_FIELD_UINT32, RCLUC_FILTER_OP_EQ, {0}},
+        {16, RCLUC_FILTER_FIELD_DOUBLE, RCLUC_FILTER_OP_LT, {0}}
+    };
+    rcluc_content_filter_t filter = {checks, 2};
+
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_filter_validate(&filter, &extent));
+    RCLUC_TEST_CHECK(SAMPLE_SIZE == extent);
+
+    // Fields must be aligned to their size as CDR puts them
+    checks[1].offset = 12;
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_PARAM == rcluc_filter_validate(&filter, &extent));
+    checks[1].offset = 16;
+    checks[1].op = (rcluc_filter_op_t)(RCLUC_FILTER_OP_GE + 1);
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_PARAM == rcluc_filter_validate(&filter, &extent));
+    checks[1].op = RCLUC_FILTER_OP_LT;
+    checks[1].type = (rcluc_filter_field_type_t)(RCLUC_FILTER_FIELD_DOUBLE + 1);
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_PARAM == rcluc_filter_validate(&filter, &extent));
+
+    filter.checks = NULL;
+    RCLUC_TEST_CHECK(RCLUC_RET_NULL_PTR == rcluc_filter_validate(&filter, &extent));
+    filter.check_count = 0;
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_filter_validate(&filter, &extent));
+    RCLUC_TEST_CHECK(0 == extent);
+    return failures;
+}
+
+static int test_integers(void) {
+    int failures = 0;
+    uint8_t data[SAMPLE_SIZE];
+    size_t length = serialize_sample(data, -5, 3000000000u, 0.0f, 0.0);
+    rcluc_filter_check_t check = {0, RCLUC_FILTER_FIELD_INT16, RCLUC_FILTER_OP_LT, {0}};
+
+    // Signed fields compare as signed, a negative value is below 0 rather than a large unsigned number
+    check.constant.signed_value = 0;
+    RCLUC_TEST_CHECK(match_one(&check, data, length));
+    check.constant.signed_value = -5;
+    RCLUC_TEST_CHECK(!match_one(&check, data, length));
+    check.op = RCLUC_FILTER_OP_LE;
+    RCLUC_TEST_CHECK(match_one(&check, data, length));
+    check.op = RCLUC_FILTER_OP_EQ;
+    RCLUC_TEST_CHECK(match_one(&check, data, length));
+
+    // Unsigned fields above INT32_MAX compare as unsigned
+    check.offset = 4;
+    check.type = RCLUC_FILTER_FIELD_UINT32;
+    check.op = RCLUC_FILTER_OP_GT;
+    check.constant.unsigned_value = 2147483647u;
+    RCLUC_TEST_CHECK(match_one(&check, data, length));
+    check.op = RCLUC_FILTER_OP_NE;
+    check.constant.unsigned_value = 3000000000u;
+    RCLUC_TEST_CHECK(!match_one(&check, data, length));
+    check.op = RCLUC_FILTER_OP_GE;
+    RCLUC_TEST_CHECK(match_one(&check, data, length));
+    return failures;
+}
+
+static int test_floating_point(void) {
+    int failures = 0;
+    uint8_t data[SAMPLE_SIZE];
+    size_t length = serialize_sample(data, 0, 0, 1.5f, -0.25);
+    rcluc_filter_check_t check = {8, RCLUC_FILTER_FIELD_FLOAT, RCLUC_FILTER_OP_GT, {0}};
+
+    check.constant.float_value = 1.0;
+    RCLUC_TEST_CHECK(match_one(&check, data, length));
+    check.op = RCLUC_FILTER_OP_EQ;
+    check.constant.float_value = 1.5;
+    RCLUC_TEST_CHECK(match_one(&check, data, length));
+
+    check.offset = 16;
+    check.type = RCLUC_FILTER_FIELD_DOUBLE;
+    check.op = RCLUC_FILTER_OP_LT;
+    check.constant.float_value = 0.0;
+    RCLUC_TEST_CHECK(match_one(&check, data, length));
+    check.op = RCLUC_FILTER_OP_GE;
+    RCLUC_TEST_CHECK(!match_one(&check, data, length));
+    return failures;
+}
+
+static int test_nan(void) {
+    int failures = 0;
+    uint8_t data[SAMPLE_SIZE];
+    size_t length = serialize_sample(data, 0, 0, NAN, NAN);
+    rcluc_filter_check_t check = {8, RCLUC_FILTER_FIELD_FLOAT, RCLUC_FILTER_OP_EQ, {0}};
+
+    // A NaN field is unordered: of all the comparisons, only NE holds, whatever the constant
+    for (int type = 0; type < 2; ++type) {
+        check.offset = (0 == type) ? 8 : 16;
+        check.type = (0 == type) ? RCLUC_FILTER_FIELD_FLOAT : RCLUC_FILTER_FIELD_DOUBLE;
+        for (int constant = 0; constant < 2; ++constant) {
+            check.constant.float_value = (0 == constant) ? 0.0 : NAN;
+            for (int op = RCLUC_FILTER_OP_EQ; op <= RCLUC_FILTER_OP_GE; ++op) {
+                check.op = (rcluc_filter_op_t)op;
+                RCLUC_TEST_CHECK((RCLUC_FILTER_OP_NE == op) == match_one(&check, data, length));
+            }
+        }
+    }
+
+    // A NaN constant never orders a regular field either
+    length = serialize_sample(data, 0, 0, 1.0f, 1.0);
+    check.constant.float_value = NAN;
+    for (int op = RCLUC_FILTER_OP_EQ; op <= RCLUC_FILTER_OP_GE; ++op) {
+        check.op = (rcluc_filter_op_t)op;
+        RCLUC_TEST_CHECK((RCLUC_FILTER_OP_NE == op) == match_one(&check, data, length));
+    }
+    return failures;
+}
+
+static int test_short_samples(void) {
+    int failures = 0;
+    uint8_t data[SAMPLE_SIZE];
+    size_t length = serialize_sample(data, 1, 2, 3.0f, 4.0);
+    rcluc_filter_check_t checks[2] = {
+        {4, RCLUC_FILTER_FIELD_UINT32, RCLUC_FILTER_OP_EQ, {0}},
+        {16, RCLUC_FILTER_FIELD_DOUBLE, RCLUC_FILTER_OP_EQ, {0}}
+    };
+    rcluc_content_filter_t filter = {checks, 2};
+    checks[0].constant.unsigned_value = 2;
+    checks[1].constant.float_value = 4.0;
+
+    RCLUC_TEST_CHECK(rcluc_filter_match(&filter, data, length));
+    // Every check has to hold, and a field past the end of the sample does not
+    RCLUC_TEST_CHECK(!rcluc_filter_match(&filter, data, length - 1));
+    checks[1].constant.float_value = 5.0;
+    RCLUC_TEST_CHECK(!rcluc_filter_match(&filter, data, length));
+    filter.check_count = 0;
+    RCLUC_TEST_CHECK(rcluc_filter_match(&filter, data, 0));
+    return failures;
+}
+
+int main(void) {
+    int failures = 0;
+    RCLUC_TEST_RUN(test_validate);
+    RCLUC_TEST_RUN(test_integers);
+    RCLUC_TEST_RUN(test_floating_point);
+    RCLUC_TEST_RUN(test_nan);
+    RCLUC_TEST_RUN(test_short_samples);
+    return (0 == failures) ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Unit tests of the seqlock of mailbox subscriptions: a reader never sees a torn sample, nor an older one than
+ *  it saw before, while the spinning thread keeps writing newer ones
+ */
+
+#include "rcluc/rcluc.h"
+#include "rcluc_internal.h"
+#include "rcluc_test.h"
+#include "rcluc_test_sample.h"
+#include <pthread.h>
+
+#define SAMPLE_COUNT 2000
+#define TOPIC_NAME "rcluc_test/mailbox"
+
+static rcluc_message_type_support_t sample_type;
+static rcluc_node_handle_t node;
+static rcluc_subscription_handle_t subscription;
+static rcluc_publisher_handle_t publisher;
+static volatile int publishing;
+
+/* Reads the latest sample into index, and checks that all of its words agree */
+static rcluc_ret_t read_latest(uint32_t * index, int * torn) {
+    rcluc_test_sample_t sample;
+    rcluc_ret_t status = rcluc_subscription_read_latest(subscription, &sample, sizeof(sample), NULL);
+    if (RCLUC_RET_OK == status) {
+        status = rcluc_test_sample_read(&sample, index, torn);
+    }
+    return status;
+}
+
+static rcluc_ret_t publish(uint32_t index) {
+    rcluc_test_sample_t sample;
+    rcluc_test_sample_fill(&sample, index);
+    rcluc_ret_t status = rcluc_publisher_publish(publisher, &sample);
+    rcluc_node_spin_once(node);
+    return status;
+}
+
+static int test_empty_and_latest(void) {
+    int failures = 0;
+    uint32_t index = 0;
+    int torn = 0;
+    int64_t age = -1;
+    uint8_t message[sizeof(rcluc_test_sample_t)];
+
+    RCLUC_TEST_CHECK(RCLUC_RET_NO_DATA == read_latest(&index, &torn));
+    RCLUC_TEST_CHECK(RCLUC_RET_NULL_PTR == rcluc_subscription_read_latest(subscription, NULL, 0, NULL));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == publish(1));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == publish(2));
+    // Only the latest sample is kept, however many arrived since the last read
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == read_latest(&index, &torn));
+    RCLUC_TEST_CHECK(2 == index && !torn);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_subscription_read_latest(subscription, message, sizeof(message), &age));
+    RCLUC_TEST_CHECK(age >= 0);
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_SPACE == rcluc_subscription_read_latest(subscription, message, 4, NULL));
+    return failures;
+}
+
+static int test_write_in_progress(void) {
+    int failures = 0;
+    uint32_t index = 0;
+    int torn = 0;
+    uint32_t entry = subscription->mailbox_latest;
+    uint32_t sequence = subscription->mailbox_sequence[entry];
+
+    // An odd sequence is a writer inside the entry, which the reader gives up on after a few attempts
+    subscription->mailbox_sequence[entry] = sequence | 1u;
+    RCLUC_TEST_CHECK(RCLUC_RET_TIMEOUT == read_latest(&index, &torn));
+    subscription->mailbox_sequence[entry] = sequence;
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == read_latest(&index, &torn));
+    RCLUC_TEST_CHECK(2 == index && !torn);
+    return failures;
+}
+
+static void * reader_thread(void * args) {
+    int * failures_out = args;
+    int failures = 0;
+    uint32_t last_index = 0;
+    while (publishing) {
+        uint32_t index = 0;
+        int torn = 0;
+        rcluc_ret_t status = read_latest(&index, &torn);
+        // A reader that keeps losing the race to the writer times out, it never gets a mix of two samples
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == status || RCLUC_RET_TIMEOUT == status);
+        if (RCLUC_RET_OK == status) {
+            RCLUC_TEST_CHECK(!torn);
+            RCLUC_TEST_CHECK(index >= last_index);
+            last_index = index;
+        }
+    }
+    *failures_out = failures;
+    return NULL;
+}
+
+static int test_concurrent_reader(void) {
+    int failures = 0;
+    int reader_failures = 0;
+    pthread_t reader;
+    uint32_t index = 0;
+    int torn = 0;
+
+    publishing = 1;
+    RCLUC_TEST_CHECK(0 == pthread_create(&reader, NULL, reader_thread, &reader_failures));
+    for (uint32_t i = 3; i < SAMPLE_COUNT; ++i) {
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == publish(i));
+    }
+    publishing = 0;
+    RCLUC_TEST_CHECK(0 == pthread_join(reader, NULL));
+    failures += reader_failures;
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == read_latest(&index, &torn));
+    RCLUC_TEST_CHECK(SAMPLE_COUNT - 1 == index && !torn);
+    return failures;
+}
+
+int main(void) {
+    static uint8_t subscription_buffer[RCLUC_SUBSCRIPTION_MAILBOX_BUFFER_SIZE(RCLUC_TEST_SAMPLE_SERIALIZED_SIZE)];
+    static uint8_t publisher_buffer[2 * sizeof(rcluc_test_sample_t)];
+    rcluc_client_config_t client_config = {0};
+    rcluc_subscription_config_t subscription_config;
+    rcluc_publisher_config_t publisher_config;
+    int failures = 0;
+
+    sample_type = rcluc_test_sample_type_support("rcluc_test::msg::dds_::Mailbox_");
+    rcluc_subscription_get_default_config(&subscription_config);
+    subscription_config.mailbox = 1;
+    rcluc_publisher_get_default_config(&publisher_config);
+    rcluc_ret_t err = rcluc_init(&client_config);
+    if (RCLUC_RET_OK == err) {
+        err = rcluc_node_create("rcluc_test_mailbox", "", &node);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = rcluc_subscription_create(node, &sample_type, TOPIC_NAME, NULL, 2, subscription_buffer,
+            &subscription_config, &subscription);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = rcluc_publisher_create(node, &sample_type, TOPIC_NAME, 2, publisher_buffer,
+            &publisher_config, &publisher);
+    }
+    if (RCLUC_RET_OK != err) {
+        printf("File: %s, $Line: %d, Error: %d\n", __FILE__, __LINE__, err);
+        return 1;
+    }
+
+    RCLUC_TEST_RUN(test_empty_and_latest);
+    RCLUC_TEST_RUN(test_write_in_progress);
+    RCLUC_TEST_RUN(test_concurrent_reader);
+    return (0 == failures) ? 0 : 1;
+}
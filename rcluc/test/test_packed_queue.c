@@ -0,0 +1,133 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Unit tests of the packed queue of serialized samples of publishers
+ */
+
+#include "rcluc_internal.h"
+#include "rcluc_test.h"
+#include <string.h>
+
+#define DEPTH 3
+#define SAMPLE_SIZE 8
+
+static uint8_t buffer[RCLUC_PUBLISHER_PACKED_BUFFER_SIZE(SAMPLE_SIZE, DEPTH)];
+
+static uint8_t push_sample(rcluc_packed_queue_t * queue, char name, size_t length) {
+    uint8_t * record = rcluc_packed_queue_reserve(queue, length);
+    if (NULL == record) {
+        return 0;
+    }
+    memset(record, name, length);
+    rcluc_packed_queue_commit(queue);
+    return 1;
+}
+
+/* Checks that the oldest record is the expected sample and removes it */
+static uint8_t pop_sample(rcluc_packed_queue_t * queue, char name, size_t length) {
+    size_t queued_length = 0;
+    uint8_t * record = rcluc_packed_queue_peek(queue, &queued_length);
+    uint8_t is_expected = NULL != record && queued_length == length;
+    for (size_t i = 0; i < length && is_expected; ++i) {
+        is_expected = name == (char)record[i];
+    }
+    rcluc_packed_queue_pop(queue);
+    return is_expected;
+}
+
+static int test_full_ring(void) {
+    int failures = 0;
+    rcluc_packed_queue_t queue;
+    size_t length = 0;
+    rcluc_packed_queue_init(&queue, buffer, sizeof(buffer));
+
+    RCLUC_TEST_CHECK(NULL == rcluc_packed_queue_peek(&queue, &length));
+    // The buffer is sized for one record more than the depth, so that records of any size up to the largest fit
+    for (size_t i = 0; i <= DEPTH; ++i) {
+        RCLUC_TEST_CHECK(push_sample(&queue, (char)('A' + i), SAMPLE_SIZE));
+    }
+    // The last record ends at the end of the buffer, so tail is back on head and the ring is full
+    RCLUC_TEST_CHECK(DEPTH + 1 == queue.count);
+    RCLUC_TEST_CHECK(queue.tail == queue.head);
+    RCLUC_TEST_CHECK(!push_sample(&queue, 'X', 1));
+    RCLUC_TEST_CHECK(DEPTH + 1 == queue.count);
+
+    // Popping one makes room for exactly one more record of the same size, written at the start of the buffer
+    RCLUC_TEST_CHECK(pop_sample(&queue, 'A', SAMPLE_SIZE));
+    RCLUC_TEST_CHECK(!push_sample(&queue, 'X', SAMPLE_SIZE + 1));
+    RCLUC_TEST_CHECK(push_sample(&queue, 'E', SAMPLE_SIZE));
+    RCLUC_TEST_CHECK(!push_sample(&queue, 'X', 1));
+    for (size_t i = 1; i <= DEPTH + 1; ++i) {
+        RCLUC_TEST_CHECK(pop_sample(&queue, (char)('A' + i), SAMPLE_SIZE));
+    }
+    RCLUC_TEST_CHECK(0 == queue.count);
+    RCLUC_TEST_CHECK(NULL == rcluc_packed_queue_peek(&queue, &length));
+    return failures;
+}
+
+static int test_wrap_marker(void) {
+    int failures = 0;
+    rcluc_packed_queue_t queue;
+    rcluc_packed_queue_init(&queue, buffer, sizeof(buffer));
+
+    RCLUC_TEST_CHECK(push_sample(&queue, 'A', SAMPLE_SIZE));
+    RCLUC_TEST_CHECK(push_sample(&queue, 'B', SAMPLE_SIZE));
+    RCLUC_TEST_CHECK(push_sample(&queue, 'C', SAMPLE_SIZE));
+    RCLUC_TEST_CHECK(pop_sample(&queue, 'A', SAMPLE_SIZE));
+    RCLUC_TEST_CHECK(pop_sample(&queue, 'B', SAMPLE_SIZE));
+
+    // A record that does not fit before the end of the buffer starts over at its beginning, behind a marker
+    RCLUC_TEST_CHECK(push_sample(&queue, 'D', 2 * SAMPLE_SIZE));
+    RCLUC_TEST_CHECK(0 == queue.head % RCLUC_PUBLISHER_RECORD_SIZE(SAMPLE_SIZE) && queue.tail < queue.head);
+    // The room between the new record and the oldest one is too small for another
+    RCLUC_TEST_CHECK(!push_sample(&queue, 'X', 1));
+    RCLUC_TEST_CHECK(pop_sample(&queue, 'C', SAMPLE_SIZE));
+    RCLUC_TEST_CHECK(pop_sample(&queue, 'D', 2 * SAMPLE_SIZE));
+    RCLUC_TEST_CHECK(0 == queue.count);
+
+    // Once empty, the queue starts again at the beginning of the buffer and takes the largest record it can hold
+    RCLUC_TEST_CHECK(push_sample(&queue, 'E', sizeof(buffer) - RCLUC_PUBLISHER_RECORD_HEADER_SIZE));
+    RCLUC_TEST_CHECK(!push_sample(&queue, 'X', 1));
+    RCLUC_TEST_CHECK(pop_sample(&queue, 'E', sizeof(buffer) - RCLUC_PUBLISHER_RECORD_HEADER_SIZE));
+    RCLUC_TEST_CHECK(!push_sample(&queue, 'X', sizeof(buffer)));
+    return failures;
+}
+
+static int test_unaligned_lengths(void) {
+    int failures = 0;
+    rcluc_packed_queue_t queue;
+    rcluc_packed_queue_init(&queue, buffer, sizeof(buffer));
+
+    // Records are padded to 4 bytes, so a cycle of odd lengths keeps wrapping around without losing a sample
+    for (size_t round = 0; round < 20; ++round) {
+        size_t length = 1 + (round % 7);
+        RCLUC_TEST_CHECK(push_sample(&queue, (char)('a' + round), length));
+        RCLUC_TEST_CHECK(push_sample(&queue, (char)('A' + round), length + 2));
+        RCLUC_TEST_CHECK(pop_sample(&queue, (char)('a' + round), length));
+        RCLUC_TEST_CHECK(pop_sample(&queue, (char)('A' + round), length + 2));
+        RCLUC_TEST_CHECK(0 == queue.count);
+    }
+    return failures;
+}
+
+int main(void) {
+    int failures = 0;
+    RCLUC_TEST_RUN(test_full_ring);
+    RCLUC_TEST_RUN(test_wrap_marker);
+    RCLUC_TEST_RUN(test_unaligned_lengths);
+    return (0 == failures) ? 0 : 1;
+}
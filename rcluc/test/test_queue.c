@@ -0,0 +1,174 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Unit tests of the queue of serialized samples of subscriptions and service clients
+ */
+
+#include "rcluc_internal.h"
+#include "rcluc_test.h"
+#include <string.h>
+
+#define QUEUE_LENGTH 3
+#define SAMPLE_SIZE 8
+
+static uint8_t buffer[RCLUC_SUBSCRIPTION_BUFFER_SIZE(SAMPLE_SIZE, QUEUE_LENGTH)];
+
+static rcluc_ret_t write_sample(rcluc_queue_t * queue, char name) {
+    uint8_t sample[SAMPLE_SIZE];
+    memset(sample, name, sizeof(sample));
+    return rcluc_queue_write(queue, sample, 0, sizeof(sample), sizeof(sample), 0);
+}
+
+/* The name of the oldest queued sample, or 0 if the queue is empty */
+static char peek_sample(rcluc_queue_t * queue) {
+    size_t length = 0;
+    uint8_t * sample = rcluc_queue_peek(queue, &length, NULL, NULL);
+    return (NULL == sample || SAMPLE_SIZE != length) ? 0 : (char)sample[0];
+}
+
+static int test_order_and_overflow(void) {
+    int failures = 0;
+    rcluc_queue_t queue;
+    rcluc_queue_init(&queue, buffer, QUEUE_LENGTH, SAMPLE_SIZE);
+
+    RCLUC_TEST_CHECK(0 == peek_sample(&queue));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, 'A'));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, 'B'));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, 'C'));
+    // A full queue drops its oldest sample for the newest
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, 'D'));
+    RCLUC_TEST_CHECK(3 == queue.count);
+    RCLUC_TEST_CHECK('B' == peek_sample(&queue));
+    rcluc_queue_pop(&queue);
+    RCLUC_TEST_CHECK('C' == peek_sample(&queue));
+    rcluc_queue_pop(&queue);
+    RCLUC_TEST_CHECK('D' == peek_sample(&queue));
+    rcluc_queue_pop(&queue);
+    RCLUC_TEST_CHECK(0 == peek_sample(&queue));
+    RCLUC_TEST_CHECK(0 == queue.count);
+
+    // Samples larger than an entry are refused
+    uint8_t large[SAMPLE_SIZE + 8] = {0};
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_SPACE == rcluc_queue_write(&queue, large, 0, sizeof(large), sizeof(large), 0));
+    RCLUC_TEST_CHECK(0 == queue.count);
+    return failures;
+}
+
+static int test_fragments(void) {
+    int failures = 0;
+    rcluc_queue_t queue;
+    const uint8_t sample[SAMPLE_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8};
+    size_t length = 0;
+    uint32_t flags = 0;
+    rcluc_queue_init(&queue, buffer, QUEUE_LENGTH, SAMPLE_SIZE);
+
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_queue_write(&queue, sample, 0, 3, SAMPLE_SIZE,
+            RCLUC_QUEUE_FLAG_UNFILTERED));
+    RCLUC_TEST_CHECK(0 == queue.count);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_queue_write(&queue, &sample[3], 3, 5, SAMPLE_SIZE, 0));
+    RCLUC_TEST_CHECK(1 == queue.count);
+    uint8_t * queued = rcluc_queue_peek(&queue, &length, NULL, &flags);
+    RCLUC_TEST_CHECK(NULL != queued && SAMPLE_SIZE == length && 0 == memcmp(sample, queued, SAMPLE_SIZE));
+    // The flags are the ones given with the first fragment
+    RCLUC_TEST_CHECK(0 != (flags & RCLUC_QUEUE_FLAG_UNFILTERED));
+
+    // The rest of a sample whose first fragment was discarded is ignored
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_queue_write(&queue, sample, 0, 3, SAMPLE_SIZE, 0));
+    rcluc_queue_discard(&queue);
+    RCLUC_TEST_CHECK(RCLUC_RET_ERROR == rcluc_queue_write(&queue, &sample[3], 3, 5, SAMPLE_SIZE, 0));
+    RCLUC_TEST_CHECK(1 == queue.count);
+    return failures;
+}
+
+static int test_wrap_with_loans(void) {
+    int failures = 0;
+    rcluc_queue_t queue;
+    rcluc_queue_init(&queue, buffer, QUEUE_LENGTH, SAMPLE_SIZE);
+
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, 'A'));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, 'B'));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, 'C'));
+    uint8_t * loan = rcluc_queue_retain(&queue);
+    RCLUC_TEST_CHECK(NULL != loan);
+    rcluc_queue_pop(&queue);
+
+    // The write wraps onto the loaned entry of A, skips it and drops B, the oldest queued sample, to make room
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, 'D'));
+    RCLUC_TEST_CHECK(2 == queue.count);
+    RCLUC_TEST_CHECK('A' == (char)loan[sizeof(rcluc_subscription_slot_header_t)]);
+    RCLUC_TEST_CHECK('C' == peek_sample(&queue));
+    rcluc_queue_pop(&queue);
+    // Reading on skips the loaned entry, which holds no queued sample
+    RCLUC_TEST_CHECK('D' == peek_sample(&queue));
+
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, 'E'));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, 'F'));
+    RCLUC_TEST_CHECK(2 == queue.count);
+    RCLUC_TEST_CHECK('E' == peek_sample(&queue));
+    rcluc_queue_pop(&queue);
+    RCLUC_TEST_CHECK('F' == peek_sample(&queue));
+    RCLUC_TEST_CHECK('A' == (char)loan[sizeof(rcluc_subscription_slot_header_t)]);
+
+    // Once the loan is given back its entry takes samples again
+    rcluc_queue_release(loan);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, 'G'));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, 'H'));
+    RCLUC_TEST_CHECK(3 == queue.count);
+    RCLUC_TEST_CHECK('F' == peek_sample(&queue));
+    rcluc_queue_pop(&queue);
+    RCLUC_TEST_CHECK('G' == peek_sample(&queue));
+    rcluc_queue_pop(&queue);
+    RCLUC_TEST_CHECK('H' == peek_sample(&queue));
+    rcluc_queue_pop(&queue);
+    RCLUC_TEST_CHECK(0 == queue.count);
+    return failures;
+}
+
+static int test_all_loaned(void) {
+    int failures = 0;
+    rcluc_queue_t queue;
+    uint8_t * loans[QUEUE_LENGTH];
+    rcluc_queue_init(&queue, buffer, QUEUE_LENGTH, SAMPLE_SIZE);
+
+    for (size_t i = 0; i < QUEUE_LENGTH; ++i) {
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, (char)('A' + i)));
+        loans[i] = rcluc_queue_retain(&queue);
+        RCLUC_TEST_CHECK(NULL != loans[i]);
+        rcluc_queue_pop(&queue);
+    }
+    // With every entry on loan there is nowhere to write, and the loaned samples stay intact
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_SPACE == write_sample(&queue, 'X'));
+    RCLUC_TEST_CHECK(0 == queue.count);
+    for (size_t i = 0; i < QUEUE_LENGTH; ++i) {
+        RCLUC_TEST_CHECK((char)('A' + i) == (char)loans[i][sizeof(rcluc_subscription_slot_header_t)]);
+    }
+
+    rcluc_queue_release(loans[1]);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == write_sample(&queue, 'Y'));
+    RCLUC_TEST_CHECK('Y' == peek_sample(&queue));
+    RCLUC_TEST_CHECK('B' != (char)loans[1][sizeof(rcluc_subscription_slot_header_t)]);
+    return failures;
+}
+
+int main(void) {
+    int failures = 0;
+    RCLUC_TEST_RUN(test_order_and_overflow);
+    RCLUC_TEST_RUN(test_fragments);
+    RCLUC_TEST_RUN(test_wrap_with_loans);
+    RCLUC_TEST_RUN(test_all_loaned);
+    return (0 == failures) ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Unit tests of the shm backend through the rcluc API: samples are delivered in order, a subscription only
+ *  sees the samples published after it was created, a subscriber that falls a ring behind keeps the newest samples and
+ *  a topic keeps the type it was created with
+ */
+
+#include "rcluc/rcluc.h"
+#include "rcluc_test.h"
+#include "rcluc_test_sample.h"
+
+#define TOPIC_NAME "rcluc_test/shm"
+#define QUEUE_LENGTH 4
+#define RECEIVED_MAX 64
+
+static rcluc_message_type_support_t sample_type;
+static rcluc_message_type_support_t other_type;
+static uint8_t subscription_buffer[RCLUC_SUBSCRIPTION_BUFFER_SIZE(RCLUC_TEST_SAMPLE_SERIALIZED_SIZE, QUEUE_LENGTH)];
+static rcluc_node_handle_t node;
+static rcluc_subscription_handle_t subscription;
+static rcluc_publisher_handle_t publisher;
+static uint32_t received[RECEIVED_MAX];
+static size_t received_count;
+static int received_torn;
+
+static void on_sample(const rcluc_subscription_handle_t subscription_handle, const void * message, const void * args) {
+    uint32_t index = 0;
+    int torn = 0;
+    (void) subscription_handle;
+    (void) args;
+    if (RCLUC_RET_OK != rcluc_test_sample_read(message, &index, &torn) || torn) {
+        received_torn = 1;
+    } else if (received_count < RECEIVED_MAX) {
+        received[received_count++] = index;
+    }
+}
+
+static rcluc_ret_t subscribe(const rcluc_message_type_support_t * type) {
+    rcluc_subscription_config_t config;
+    rcluc_subscription_get_default_config(&config);
+    received_count = 0;
+    received_torn = 0;
+    return rcluc_subscription_create(node, type, TOPIC_NAME, on_sample, QUEUE_LENGTH, subscription_buffer, &config,
+        &subscription);
+}
+
+static rcluc_ret_t publish(uint32_t index) {
+    rcluc_test_sample_t sample;
+    rcluc_test_sample_fill(&sample, index);
+    return rcluc_publisher_publish(publisher, &sample);
+}
+
+static int test_delivery_in_order(void) {
+    int failures = 0;
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == publish(1));
+    rcluc_node_spin_once(node);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == publish(2));
+    rcluc_node_spin_once(node);
+    rcluc_node_spin_once(node);
+    RCLUC_TEST_CHECK(2 == received_count && !received_torn);
+    RCLUC_TEST_CHECK(1 == received[0] && 2 == received[1]);
+    return failures;
+}
+
+static int test_late_subscription(void) {
+    int failures = 0;
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_subscription_destroy(subscription));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == publish(3));
+    rcluc_node_spin_once(node);
+    // Like a volatile datareader, the new subscription never sees the sample published before it existed
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == subscribe(&sample_type));
+    rcluc_node_spin_once(node);
+    RCLUC_TEST_CHECK(0 == received_count);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == publish(4));
+    rcluc_node_spin_once(node);
+    rcluc_node_spin_once(node);
+    RCLUC_TEST_CHECK(1 == received_count && 4 == received[0] && !received_torn);
+    return failures;
+}
+
+static int test_overrun(void) {
+    int failures = 0;
+    const uint32_t first = 10;
+    const uint32_t last = first + 3 * configRCLUC_SHM_SLOT_COUNT;
+    received_count = 0;
+    // A publish writes straight into the ring, which goes around three times before the subscriber looks at it again
+    for (uint32_t i = first; i <= last; ++i) {
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == publish(i));
+    }
+    rcluc_node_spin_once(node);
+    rcluc_node_spin_once(node);
+    // The queue of the subscription keeps the newest of the samples still in the ring
+    RCLUC_TEST_CHECK(received_count > 0 && received_count <= QUEUE_LENGTH && !received_torn);
+    if (received_count > 0) {
+        RCLUC_TEST_CHECK(last == received[received_count - 1]);
+    }
+    for (size_t i = 1; i < received_count; ++i) {
+        RCLUC_TEST_CHECK(received[i] > received[i - 1]);
+    }
+    return failures;
+}
+
+static int test_type_mismatch(void) {
+    int failures = 0;
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_subscription_destroy(subscription));
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_PARAM == subscribe(&other_type));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == subscribe(&sample_type));
+    return failures;
+}
+
+int main(void) {
+    static uint8_t publisher_buffer[2 * sizeof(rcluc_test_sample_t)];
+    rcluc_client_config_t client_config = {0};
+    rcluc_publisher_config_t publisher_config;
+    int failures = 0;
+
+    sample_type = rcluc_test_sample_type_support("rcluc_test::msg::dds_::Shm_");
+    other_type = rcluc_test_sample_type_support("rcluc_test::msg::dds_::Other_");
+    rcluc_publisher_get_default_config(&publisher_config);
+    rcluc_ret_t err = rcluc_init(&client_config);
+    if (RCLUC_RET_OK == err) {
+        err = rcluc_node_create("rcluc_test_shm", "", &node);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = subscribe(&sample_type);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = rcluc_publisher_create(node, &sample_type, TOPIC_NAME, 2, publisher_buffer, &publisher_config,
+            &publisher);
+    }
+    if (RCLUC_RET_OK != err) {
+        printf("File: %s, $Line: %d, Error: %d\n", __FILE__, __LINE__, err);
+        return 1;
+    }
+
+    RCLUC_TEST_RUN(test_delivery_in_order);
+    RCLUC_TEST_RUN(test_late_subscription);
+    RCLUC_TEST_RUN(test_overrun);
+    RCLUC_TEST_RUN(test_type_mismatch);
+    return (0 == failures) ? 0 : 1;
+}
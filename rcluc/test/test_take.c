@@ -0,0 +1,162 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Unit tests of rcluc_subscription_take and rcluc_subscription_take_many on a subscription created without a
+ *  callback, over the shm backend
+ */
+
+#include "rcluc/rcluc.h"
+#include "rcluc_test.h"
+#include "rcluc_test_sample.h"
+
+#define TOPIC_NAME "rcluc_test/take"
+#define QUEUE_LENGTH 4
+
+static rcluc_message_type_support_t sample_type;
+static uint8_t subscription_buffer[RCLUC_SUBSCRIPTION_BUFFER_SIZE(RCLUC_TEST_SAMPLE_SERIALIZED_SIZE, QUEUE_LENGTH)];
+static rcluc_node_handle_t node;
+static rcluc_subscription_handle_t subscription;
+static rcluc_publisher_handle_t publisher;
+
+static void on_sample(const rcluc_subscription_handle_t subscription_handle, const void * message, const void * args) {
+    (void) subscription_handle;
+    (void) message;
+    (void) args;
+}
+
+static rcluc_ret_t subscribe(rcluc_subscription_callback_t callback) {
+    rcluc_subscription_config_t config;
+    rcluc_subscription_get_default_config(&config);
+    return rcluc_subscription_create(node, &sample_type, TOPIC_NAME, callback, QUEUE_LENGTH, subscription_buffer,
+        &config, &subscription);
+}
+
+/* Publishes the samples first to last, then spins once so that the subscription queues them */
+static rcluc_ret_t publish(uint32_t first, uint32_t last) {
+    rcluc_test_sample_t sample;
+    rcluc_ret_t status = RCLUC_RET_OK;
+    for (uint32_t i = first; RCLUC_RET_OK == status && i <= last; ++i) {
+        rcluc_test_sample_fill(&sample, i);
+        status = rcluc_publisher_publish(publisher, &sample);
+    }
+    rcluc_node_spin_once(node);
+    return status;
+}
+
+/* The index of a taken sample, or 0 if it is torn */
+static uint32_t sample_index(const rcluc_test_sample_t * sample) {
+    uint32_t index = 0;
+    int torn = 0;
+    return (RCLUC_RET_OK == rcluc_test_sample_read(sample, &index, &torn) && !torn) ? index : 0;
+}
+
+static int test_take_empty(void) {
+    int failures = 0;
+    rcluc_test_sample_t samples[2];
+    size_t count = 1;
+    RCLUC_TEST_CHECK(RCLUC_RET_NO_DATA == rcluc_subscription_take(subscription, &samples[0], sizeof(samples[0]),
+        NULL));
+    RCLUC_TEST_CHECK(RCLUC_RET_NO_DATA == rcluc_subscription_take_many(subscription, samples, sizeof(samples[0]),
+        NULL, 2, &count));
+    RCLUC_TEST_CHECK(0 == count);
+    RCLUC_TEST_CHECK(RCLUC_RET_NULL_PTR == rcluc_subscription_take_many(subscription, samples, sizeof(samples[0]),
+        NULL, 2, NULL));
+    return failures;
+}
+
+static int test_take_in_order(void) {
+    int failures = 0;
+    rcluc_test_sample_t samples[QUEUE_LENGTH];
+    rcluc_message_info_t infos[QUEUE_LENGTH];
+    size_t count = 0;
+
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == publish(1, 3));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_subscription_take(subscription, &samples[0], sizeof(samples[0]),
+        &infos[0]));
+    RCLUC_TEST_CHECK(1 == sample_index(&samples[0]));
+    RCLUC_TEST_CHECK(RCLUC_TEST_SAMPLE_SERIALIZED_SIZE == infos[0].serialized_length);
+    RCLUC_TEST_CHECK(0 == infos[0].source_timestamp && infos[0].reception_timestamp > 0);
+    // Asking for more messages than are queued takes what there is
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_subscription_take_many(subscription, samples, sizeof(samples[0]), infos,
+        QUEUE_LENGTH, &count));
+    RCLUC_TEST_CHECK(2 == count);
+    RCLUC_TEST_CHECK(2 == sample_index(&samples[0]) && 3 == sample_index(&samples[1]));
+    RCLUC_TEST_CHECK(infos[1].reception_timestamp >= infos[0].reception_timestamp);
+    RCLUC_TEST_CHECK(RCLUC_RET_NO_DATA == rcluc_subscription_take(subscription, &samples[0], sizeof(samples[0]),
+        NULL));
+    return failures;
+}
+
+static int test_take_many_limit(void) {
+    int failures = 0;
+    rcluc_test_sample_t samples[QUEUE_LENGTH];
+    size_t count = 0;
+
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == publish(4, 6));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_subscription_take_many(subscription, samples, sizeof(samples[0]), NULL, 2,
+        &count));
+    RCLUC_TEST_CHECK(2 == count);
+    RCLUC_TEST_CHECK(4 == sample_index(&samples[0]) && 5 == sample_index(&samples[1]));
+    // A message too large for the buffer of the application stays queued
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_SPACE == rcluc_subscription_take(subscription, &samples[0], 4, NULL));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_subscription_take(subscription, &samples[0], sizeof(samples[0]), NULL));
+    RCLUC_TEST_CHECK(6 == sample_index(&samples[0]));
+    return failures;
+}
+
+static int test_take_with_callback(void) {
+    int failures = 0;
+    rcluc_test_sample_t sample;
+    size_t count = 0;
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_subscription_destroy(subscription));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == subscribe(on_sample));
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_INIT == rcluc_subscription_take(subscription, &sample, sizeof(sample), NULL));
+    RCLUC_TEST_CHECK(RCLUC_RET_ERR_INIT == rcluc_subscription_take_many(subscription, &sample, sizeof(sample), NULL,
+        1, &count));
+    return failures;
+}
+
+int main(void) {
+    static uint8_t publisher_buffer[2 * sizeof(rcluc_test_sample_t)];
+    rcluc_client_config_t client_config = {0};
+    rcluc_publisher_config_t publisher_config;
+    int failures = 0;
+
+    sample_type = rcluc_test_sample_type_support("rcluc_test::msg::dds_::Take_");
+    rcluc_publisher_get_default_config(&publisher_config);
+    rcluc_ret_t err = rcluc_init(&client_config);
+    if (RCLUC_RET_OK == err) {
+        err = rcluc_node_create("rcluc_test_take", "", &node);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = subscribe(NULL);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = rcluc_publisher_create(node, &sample_type, TOPIC_NAME, 2, publisher_buffer, &publisher_config,
+            &publisher);
+    }
+    if (RCLUC_RET_OK != err) {
+        printf("File: %s, $Line: %d, Error: %d\n", __FILE__, __LINE__, err);
+        return 1;
+    }
+
+    RCLUC_TEST_RUN(test_take_empty);
+    RCLUC_TEST_RUN(test_take_in_order);
+    RCLUC_TEST_RUN(test_take_many_limit);
+    RCLUC_TEST_RUN(test_take_with_callback);
+    return (0 == failures) ? 0 : 1;
+}
@@ -0,0 +1,324 @@
+/*
+ * Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ *  @file
+ *  @brief Unit tests of the DDS-XRCE submessages written and read by the micro-RTPS backend, against the mock agent
+ *  over the loopback interface: samples split into fragments by the backend's fragment writer are reassembled by the
+ *  agent, and fragments sent by the agent are reassembled in place, in order, and dropped around a lost message.
+ */
+
+#include "mock_agent.h"
+#include "rcluc_test.h"
+#include "rmwu_xrce.h"
+#include <arpa/inet.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define FIRST_PORT 28900
+#define LAST_PORT 28999
+#define CLIENT_KEY 0x0A0B0C0D
+#define SESSION_ID 0x81
+#define OUTPUT_STREAM 0x81
+#define INPUT_STREAM 0x82
+/* A datareader with the id 0x12, of entity kind 6 */
+#define DATAREADER_ID RMWU_XRCE_OBJECT_ID(0x12, 6)
+#define DATAWRITER_ID RMWU_XRCE_OBJECT_ID(0x13, 5)
+#define SAMPLE_LENGTH 300
+#define FRAGMENT_LENGTH 64
+#define MAX_MESSAGES 16
+#define MESSAGE_SIZE 128
+#define RECEIVE_TIMEOUT_MS 100
+
+/* The client side of the link: each reserved fragment goes in a message of its own on the reliable output stream */
+typedef struct {
+    int socket;
+    uint8_t message[MESSAGE_SIZE];
+    size_t length;
+    uint16_t sequence;
+    size_t reserve_count;
+} test_link_t;
+
+/* The calls a reassembler made to hand over samples, and the samples put together from them in place */
+typedef struct {
+    size_t calls;
+    size_t completed;
+    size_t next_offset;
+    uint16_t object_id;
+    int in_order;
+    uint8_t sample[SAMPLE_LENGTH];
+} test_receiver_t;
+
+typedef struct {
+    uint8_t data[MESSAGE_SIZE];
+    size_t length;
+} test_message_t;
+
+static mock_agent_t agent;
+static uint8_t agent_sample[MOCK_AGENT_MESSAGE_SIZE];
+static size_t agent_sample_length;
+static uint32_t agent_client_key;
+static test_link_t link_to_agent;
+
+static void on_agent_data(void * args, uint32_t client_key, const uint8_t * data, size_t length) {
+    (void) args;
+    agent_client_key = client_key;
+    agent_sample_length = length;
+    memcpy(agent_sample, data, length);
+}
+
+static void fill_sample(uint8_t * sample, uint8_t seed) {
+    for (size_t i = 0; i < SAMPLE_LENGTH; ++i) {
+        sample[i] = (uint8_t)(seed + (i * 7));
+    }
+}
+
+static void link_flush(test_link_t * link) {
+    if (link->length > RMWU_XRCE_MESSAGE_HEADER_SIZE) {
+        (void) send(link->socket, link->message, link->length, 0);
+    }
+    link->length = 0;
+}
+
+static rcluc_ret_t link_reserve(void * args, size_t length, uint8_t ** data) {
+    test_link_t * link = (test_link_t *)args;
+    link_flush(link);
+    if (RMWU_XRCE_MESSAGE_HEADER_SIZE + length > sizeof(link->message)) {
+        return RCLUC_RET_ERR_SPACE;
+    }
+    link->message[0] = SESSION_ID;
+    link->message[1] = OUTPUT_STREAM;
+    link->message[2] = (uint8_t)link->sequence;
+    link->message[3] = (uint8_t)(link->sequence >> 8);
+    link->sequence++;
+    link->reserve_count++;
+    *data = &link->message[RMWU_XRCE_MESSAGE_HEADER_SIZE];
+    link->length = RMWU_XRCE_MESSAGE_HEADER_SIZE + length;
+    return RCLUC_RET_OK;
+}
+
+static void on_fragment_data(void * args, uint16_t object_id, const uint8_t * data, size_t offset, size_t length,
+        size_t total_length) {
+    test_receiver_t * receiver = (test_receiver_t *)args;
+    receiver->calls++;
+    receiver->object_id = object_id;
+    if (0 == offset) {
+        receiver->next_offset = 0;
+        receiver->in_order = 1;
+    }
+    if (offset != receiver->next_offset || SAMPLE_LENGTH != total_length || offset + length > total_length) {
+        receiver->in_order = 0;
+        return;
+    }
+    memcpy(&receiver->sample[offset], data, length);
+    receiver->next_offset = offset + length;
+    if (receiver->in_order && offset + length == total_length) {
+        receiver->completed++;
+    }
+}
+
+/* Receives the messages the agent sent on the client's input stream, leaving out its acknowledgements */
+static size_t receive_messages(test_message_t * messages) {
+    struct pollfd poll_fd = {link_to_agent.socket, POLLIN, 0};
+    size_t count = 0;
+    while (count < MAX_MESSAGES && poll(&poll_fd, 1, RECEIVE_TIMEOUT_MS) > 0) {
+        ssize_t length = recv(link_to_agent.socket, messages[count].data, sizeof(messages[count].data), 0);
+        if (length >= RMWU_XRCE_MESSAGE_HEADER_SIZE && INPUT_STREAM == messages[count].data[1]) {
+            messages[count].length = (size_t)length;
+            count++;
+        }
+    }
+    return count;
+}
+
+static void spin_agent(void) {
+    while (RCLUC_RET_OK == mock_agent_spin_once(&agent, RECEIVE_TIMEOUT_MS)) {
+    }
+}
+
+static int test_fragmented_write(void) {
+    int failures = 0;
+    rmwu_xrce_fragment_writer_t writer;
+    rcluc_cdr_buffer_t buffer;
+    uint8_t sample[SAMPLE_LENGTH];
+    fill_sample(sample, 3);
+    link_to_agent.reserve_count = 0;
+    agent_sample_length = 0;
+    memset(&agent.stats, 0, sizeof(agent.stats));
+
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rmwu_xrce_fragments_begin(&writer, link_reserve, &link_to_agent, FRAGMENT_LENGTH,
+        DATAWRITER_ID, SAMPLE_LENGTH, &buffer));
+    // Pieces that do not line up with the fragments are split between them
+    for (size_t offset = 0; offset < SAMPLE_LENGTH; offset += 50) {
+        RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_serialize_bytes(&buffer, &sample[offset], 50));
+    }
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rmwu_xrce_fragments_end(&writer, &buffer, SAMPLE_LENGTH));
+    link_flush(&link_to_agent);
+    spin_agent();
+
+    size_t fragments = (RMWU_XRCE_SUBHEADER_SIZE + RMWU_XRCE_DATA_HEADER_SIZE + SAMPLE_LENGTH + FRAGMENT_LENGTH - 1)
+            / FRAGMENT_LENGTH;
+    RCLUC_TEST_CHECK(fragments == writer.opened && fragments == link_to_agent.reserve_count);
+    RCLUC_TEST_CHECK(fragments == agent.stats.fragments);
+    RCLUC_TEST_CHECK(1 == agent.stats.samples && 0 == agent.stats.dropped);
+    RCLUC_TEST_CHECK(CLIENT_KEY == agent_client_key);
+    RCLUC_TEST_CHECK(SAMPLE_LENGTH == agent_sample_length && 0 == memcmp(sample, agent_sample, SAMPLE_LENGTH));
+    return failures;
+}
+
+static int test_fragmented_write_too_short(void) {
+    int failures = 0;
+    rmwu_xrce_fragment_writer_t writer;
+    rcluc_cdr_buffer_t buffer;
+    uint8_t sample[SAMPLE_LENGTH];
+    fill_sample(sample, 5);
+    memset(&agent.stats, 0, sizeof(agent.stats));
+
+    // A serializer writing less than its size said leaves fragments that the caller has to give up
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rmwu_xrce_fragments_begin(&writer, link_reserve, &link_to_agent, FRAGMENT_LENGTH,
+        DATAWRITER_ID, SAMPLE_LENGTH, &buffer));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rcluc_cdr_serialize_bytes(&buffer, sample, SAMPLE_LENGTH - 10));
+    RCLUC_TEST_CHECK(RCLUC_RET_ERROR == rmwu_xrce_fragments_end(&writer, &buffer, SAMPLE_LENGTH));
+    RCLUC_TEST_CHECK(writer.reserved > 0 && writer.opened > 1);
+    link_to_agent.length = 0;
+
+    // Writing more than its size said runs out of fragments
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == rmwu_xrce_fragments_begin(&writer, link_reserve, &link_to_agent, FRAGMENT_LENGTH,
+        DATAWRITER_ID, SAMPLE_LENGTH - 10, &buffer));
+    RCLUC_TEST_CHECK(RCLUC_RET_OK != rcluc_cdr_serialize_bytes(&buffer, sample, SAMPLE_LENGTH));
+    link_to_agent.length = 0;
+    spin_agent();
+    RCLUC_TEST_CHECK(0 == agent.stats.samples);
+    return failures;
+}
+
+static int test_fragmented_read(void) {
+    int failures = 0;
+    test_message_t messages[MAX_MESSAGES];
+    test_receiver_t receiver;
+    rmwu_xrce_reassembler_t reassembler;
+    uint8_t sample[SAMPLE_LENGTH];
+    fill_sample(sample, 11);
+    memset(&receiver, 0, sizeof(receiver));
+    rmwu_xrce_reassembler_init(&reassembler, INPUT_STREAM, on_fragment_data, &receiver);
+
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == mock_agent_write_data(&agent, CLIENT_KEY, INPUT_STREAM, DATAREADER_ID, sample,
+        SAMPLE_LENGTH, FRAGMENT_LENGTH));
+    size_t count = receive_messages(messages);
+    RCLUC_TEST_CHECK(count > 1);
+    for (size_t i = 0; i < count; ++i) {
+        // Only the message header is left for the session, which still acknowledges the message
+        RCLUC_TEST_CHECK(RMWU_XRCE_MESSAGE_HEADER_SIZE == rmwu_xrce_reassemble(&reassembler, messages[i].data,
+            messages[i].length));
+    }
+    RCLUC_TEST_CHECK(1 == receiver.completed && receiver.calls == count);
+    RCLUC_TEST_CHECK(DATAREADER_ID == receiver.object_id);
+    RCLUC_TEST_CHECK(0 == memcmp(sample, receiver.sample, SAMPLE_LENGTH));
+
+    // A sample sent whole is left to the session
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == mock_agent_write_data(&agent, CLIENT_KEY, INPUT_STREAM, DATAREADER_ID, sample,
+        FRAGMENT_LENGTH, 0));
+    count = receive_messages(messages);
+    RCLUC_TEST_CHECK(1 == count);
+    RCLUC_TEST_CHECK(1 == count && messages[0].length == rmwu_xrce_reassemble(&reassembler, messages[0].data,
+        messages[0].length));
+    RCLUC_TEST_CHECK(1 == receiver.completed);
+    return failures;
+}
+
+static int test_lost_fragment(void) {
+    int failures = 0;
+    test_message_t messages[MAX_MESSAGES];
+    test_message_t retransmitted;
+    test_receiver_t receiver;
+    rmwu_xrce_reassembler_t reassembler;
+    uint8_t sample[SAMPLE_LENGTH];
+    memset(&receiver, 0, sizeof(receiver));
+    rmwu_xrce_reassembler_init(&reassembler, INPUT_STREAM, on_fragment_data, &receiver);
+
+    fill_sample(sample, 17);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == mock_agent_write_data(&agent, CLIENT_KEY, INPUT_STREAM, DATAREADER_ID, sample,
+        SAMPLE_LENGTH, FRAGMENT_LENGTH));
+    size_t count = receive_messages(messages);
+    RCLUC_TEST_CHECK(count > 2);
+    retransmitted = messages[1];
+    for (size_t i = 0; i < count; ++i) {
+        if (1 != i) {
+            (void) rmwu_xrce_reassemble(&reassembler, messages[i].data, messages[i].length);
+        }
+    }
+    // The message arriving after the ones that followed it is taken out of the stream without being reassembled
+    RCLUC_TEST_CHECK(RMWU_XRCE_MESSAGE_HEADER_SIZE == rmwu_xrce_reassemble(&reassembler, retransmitted.data,
+        retransmitted.length));
+    RCLUC_TEST_CHECK(0 == receiver.completed);
+
+    // The next sample starts over at offset 0 and is received whole
+    fill_sample(sample, 19);
+    RCLUC_TEST_CHECK(RCLUC_RET_OK == mock_agent_write_data(&agent, CLIENT_KEY, INPUT_STREAM, DATAREADER_ID, sample,
+        SAMPLE_LENGTH, FRAGMENT_LENGTH));
+    count = receive_messages(messages);
+    for (size_t i = 0; i < count; ++i) {
+        (void) rmwu_xrce_reassemble(&reassembler, messages[i].data, messages[i].length);
+    }
+    RCLUC_TEST_CHECK(1 == receiver.completed);
+    RCLUC_TEST_CHECK(0 == memcmp(sample, receiver.sample, SAMPLE_LENGTH));
+    return failures;
+}
+
+/* Opens a session with the agent the way the client does, with a CREATE_CLIENT on the none stream */
+static rcluc_ret_t connect_to_agent(uint16_t port) {
+    static const uint8_t create_client[] = {SESSION_ID, 0, 0, 0, 0, 0x01, 16, 0, 'X', 'R', 'C', 'E', 1, 0, 0x0F, 0x0F,
+        0x0A, 0x0B, 0x0C, 0x0D, SESSION_ID, 0, 0, 2};
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    link_to_agent.socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (link_to_agent.socket < 0 || 0 != connect(link_to_agent.socket, (const struct sockaddr *)&address,
+            sizeof(address))) {
+        return RCLUC_RET_ERROR;
+    } else if (send(link_to_agent.socket, create_client, sizeof(create_client), 0) < 0) {
+        return RCLUC_RET_ERROR;
+    }
+    spin_agent();
+    return (1 == agent.stats.sessions) ? RCLUC_RET_OK : RCLUC_RET_ERR_INIT;
+}
+
+int main(void) {
+    int failures = 0;
+    uint16_t port = FIRST_PORT;
+    rcluc_ret_t err = RCLUC_RET_ERROR;
+    for (; port <= LAST_PORT && RCLUC_RET_OK != err; ++port) {
+        err = mock_agent_open(&agent, port, on_agent_data, NULL);
+    }
+    if (RCLUC_RET_OK == err) {
+        err = connect_to_agent((uint16_t)(port - 1));
+    }
+    if (RCLUC_RET_OK != err) {
+        printf("File: %s, $Line: %d, Error: %d\n", __FILE__, __LINE__, err);
+        return 1;
+    }
+
+    RCLUC_TEST_RUN(test_fragmented_write);
+    RCLUC_TEST_RUN(test_fragmented_write_too_short);
+    RCLUC_TEST_RUN(test_fragmented_read);
+    RCLUC_TEST_RUN(test_lost_fragment);
+    (void) close(link_to_agent.socket);
+    mock_agent_close(&agent);
+    return (0 == failures) ? 0 : 1;
+}
@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+#
+# Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License").
+# You may not use this file except in compliance with the License.
+# A copy of the License is located at
+#
+#  http://aws.amazon.com/apache2.0
+#
+# or in the "license" file accompanying this file. This file is distributed
+# on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+# express or implied. See the License for the specific language governing
+# permissions and limitations under the License.
+
+"""Formats the deferred log records of rcluc_log.h and republishes them on /rosout.
+
+The microcontroller only sends the address of each format string, so the ELF file of its firmware is needed to read
+them back. Usage:
+
+    rcluc_log_bridge.py firmware.elf [--topic rcluc/log] [--name my_node]
+
+subscribes to the batches with rclpy and publishes an rcl_interfaces/msg/Log for every record, and
+
+    rcluc_log_bridge.py firmware.elf --decode batch.bin ...
+
+prints the records of serialized batches saved to files instead.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LEVEL_NAMES = {10: 'DEBUG', 20: 'INFO', 30: 'WARN', 40: 'ERROR', 50: 'FATAL'}
+RECORD_HEADER_SIZE = 12
+BATCH_HEADER_SIZE = 12
+CONVERSION = re.compile(r'%([-+ #0]*)(\d+|\*)?(\.(?:\d+|\*))?(hh|h|ll|l|j|z|t|L)?([diouxXeEfFgGaAcsp%])')
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+
+class ElfImage(object):
+    """The allocated sections of an ELF file, to read the strings the firmware refers to by address."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as elf:
+            data = elf.read()
+        if data[:4] != b'\x7fELF':
+            raise ValueError('%s is not an ELF file' % path)
+        self.is_64 = data[4] == 2
+        self.byte_order = '<' if data[5] == 1 else '>'
+        if self.is_64:
+            shoff, = struct.unpack_from(self.byte_order + 'Q', data, 0x28)
+            shentsize, shnum = struct.unpack_from(self.byte_order + 'HH', data, 0x3A)
+            section_format = 'IIQQQQ'
+        else:
+            shoff, = struct.unpack_from(self.byte_order + 'I', data, 0x20)
+            shentsize, shnum = struct.unpack_from(self.byte_order + 'HH', data, 0x2E)
+            section_format = 'IIIIII'
+        self.sections = []
+        for i in range(shnum):
+            _, kind, flags, address, offset, size = struct.unpack_from(self.byte_order + section_format, data,
+                                                                       shoff + i * shentsize)
+            if flags & SHF_ALLOC and kind != SHT_NOBITS and size > 0:
+                self.sections.append((address, size, data[offset:offset + size]))
+
+    def read_string(self, address):
+        for start, size, content in self.sections:
+            if start <= address < start + size:
+                end = content.find(b'\0', address - start)
+                if end < 0:
+                    end = size
+                return content[address - start:end].decode('utf-8', 'replace')
+        return None
+
+
+def _integer(word, bits, signed):
+    word &= (1 << bits) - 1
+    if signed and word >> (bits - 1):
+        word -= 1 << bits
+    return word
+
+
+def format_record(elf, words, int_bits=32, long_bits=32):
+    """Formats the words of a record, the address of the format string followed by the arguments."""
+    text = elf.read_string(words[0])
+    if text is None:
+        return '<unknown format string at 0x%x>' % words[0]
+    arguments = list(words[1:])
+    pieces = []
+    position = 0
+    for match in CONVERSION.finditer(text):
+        pieces.append(text[position:match.start()])
+        position = match.end()
+        flags, width, precision, length, conversion = match.groups()
+        if conversion == '%':
+            pieces.append('%')
+            continue
+        if '*' in (width or '') + (precision or '') or not arguments:
+            pieces.append(match.group(0))
+            continue
+        word = arguments.pop(0)
+        bits = {'hh': 8, 'h': 16, 'l': long_bits, 'll': 64, 'j': 64, 'z': long_bits, 't': long_bits}.get(length, int_bits)
+        spec = '%' + flags + (width or '') + (precision or '')
+        if conversion in 'di':
+            value = spec + 'd', _integer(word, bits, True)
+        elif conversion in 'ouxX':
+            value = spec + ('d' if conversion == 'u' else conversion), _integer(word, bits, False)
+        elif conversion in 'eEfFgGaA':
+            value = spec + ('e' if conversion in 'aA' else conversion), struct.unpack('<d', struct.pack('<Q', word))[0]
+        elif conversion == 'c':
+            value = spec + 'c', chr(word & 0xFF)
+        elif conversion == 's':
+            string = elf.read_string(word)
+            value = spec + 's', string if string is not None else '<0x%x>' % word
+        else:
+            value = '%#x', word
+        pieces.append(value[0] % value[1])
+    pieces.append(text[position:])
+    return ''.join(pieces)
+
+
+def decode_records(data, byte_order='<'):
+    """Splits the data of a batch into (level, timestamp in ns, words) records."""
+    records = []
+    offset = 0
+    while offset + RECORD_HEADER_SIZE <= len(data):
+        header, timestamp = struct.unpack_from(byte_order + 'Iq', data, offset)
+        count = (header >> 8) & 0xFF
+        end = offset + RECORD_HEADER_SIZE + 8 * count
+        if 0 == count or end > len(data):
+            break
+        words = struct.unpack_from(byte_order + '%dQ' % count, data, offset + RECORD_HEADER_SIZE)
+        records.append((header & 0xFF, timestamp, words))
+        offset = end
+    return records
+
+
+def decode_file(elf, path, arguments):
+    with open(path, 'rb') as batch:
+        payload = batch.read()
+    _, dropped, length = struct.unpack_from('<III', payload, 0)
+    data = payload[BATCH_HEADER_SIZE:BATCH_HEADER_SIZE + length]
+    for level, timestamp, words in decode_records(data, arguments.byte_order):
+        print('[%s] [%d.%09d] %s' % (LEVEL_NAMES.get(level, level), timestamp // 1000000000, timestamp % 1000000000,
+                                     format_record(elf, words, arguments.int_bits, arguments.long_bits)))
+    if dropped:
+        print('[WARN] %d log records dropped so far' % dropped)
+
+
+def bridge(elf, arguments):
+    import rclpy
+    from rcl_interfaces.msg import Log
+    from std_msgs.msg import UInt8MultiArray
+
+    rclpy.init()
+    node = rclpy.create_node('rcluc_log_bridge')
+    rosout = node.create_publisher(Log, '/rosout', 10)
+    state = {'dropped': 0}
+
+    def publish(level, timestamp, text):
+        log = Log()
+        log.stamp.sec = timestamp // 1000000000
+        log.stamp.nanosec = timestamp % 1000000000
+        log.level = level
+        log.name = arguments.name
+        log.msg = text
+        rosout.publish(log)
+
+    def on_batch(batch):
+        for level, timestamp, words in decode_records(bytes(batch.data), arguments.byte_order):
+            publish(level, timestamp, format_record(elf, words, arguments.int_bits, arguments.long_bits))
+        if batch.layout.data_offset != state['dropped']:
+            missed = (batch.layout.data_offset - state['dropped']) & 0xFFFFFFFF
+            state['dropped'] = batch.layout.data_offset
+            publish(30, node.get_clock().now().nanoseconds, '%d log records dropped' % missed)
+
+    node.create_subscription(UInt8MultiArray, arguments.topic, on_batch, 10)
+    try:
+        rclpy.spin(node)
+    except KeyboardInterrupt:
+        pass
+    node.destroy_node()
+    rclpy.shutdown()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Formats the deferred log records of an rcluc application')
+    parser.add_argument('elf', help='the ELF file of the firmware, to read the format strings from')
+    parser.add_argument('--topic', default='rcluc/log', help='the topic of configRCLUC_LOG_TOPIC_NAME')
+    parser.add_argument('--name', default='rcluc', help='the logger name of the records on /rosout')
+    parser.add_argument('--int-bits', type=int, default=32, help='the size of int on the microcontroller')
+    parser.add_argument('--long-bits', type=int, default=32, help='the size of long and size_t on the microcontroller')
+    parser.add_argument('--big-endian', dest='byte_order', action='store_const', const='>', default='<',
+                        help='the records come from a big endian microcontroller')
+    parser.add_argument('--decode', nargs='+', metavar='BATCH', help='print the records of serialized batches')
+    arguments = parser.parse_args()
+
+    elf = ElfImage(arguments.elf)
+    if arguments.decode:
+        for path in arguments.decode:
+            decode_file(elf, path, arguments)
+    else:
+        bridge(elf, arguments)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
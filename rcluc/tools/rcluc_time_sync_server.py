@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+#
+# Copyright 2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License").
+# You may not use this file except in compliance with the License.
+# A copy of the License is located at
+#
+#  http://aws.amazon.com/apache2.0
+#
+# or in the "license" file accompanying this file. This file is distributed
+# on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+# express or implied. See the License for the specific language governing
+# permissions and limitations under the License.
+
+"""Serves the time synchronization requests of rcluc_time_sync_start with the clock of a ROS 2 node.
+
+The service type is rcluc_msgs/srv/TimeSync: build TimeSync.srv of this directory in an interface package named
+rcluc_msgs, as srv/TimeSync.srv, and source it before running
+
+    rcluc_time_sync_server.py [--service rcluc/time_sync] [--use-sim-time]
+
+on a host close to the agent. The clients follow the clock of this node, so its round trips to them should be short
+and steady.
+"""
+
+import argparse
+import sys
+
+
+def serve(arguments):
+    import rclpy
+    from rclpy.parameter import Parameter
+    from rcluc_msgs.srv import TimeSync
+
+    rclpy.init()
+    node = rclpy.create_node('rcluc_time_sync_server')
+    if arguments.use_sim_time:
+        node.set_parameters([Parameter('use_sim_time', Parameter.Type.BOOL, True)])
+    clock = node.get_clock()
+
+    def on_request(request, response):
+        # The callback runs once the request is taken from the middleware, which is as close to its reception as rclpy
+        # gets. The time spent queued before counts as network delay and is filtered out with the round trip time.
+        response.server_receive_time = clock.now().nanoseconds
+        # The client matches the response to its request by the id in front of both
+        response.request_id = request.request_id
+        response.client_transmit_time = request.client_transmit_time
+        response.server_transmit_time = clock.now().nanoseconds
+        return response
+
+    node.create_service(TimeSync, arguments.service, on_request)
+    try:
+        rclpy.spin(node)
+    except KeyboardInterrupt:
+        pass
+    node.destroy_node()
+    rclpy.shutdown()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Serves the time synchronization of rcluc applications')
+    parser.add_argument('--service', default='rcluc/time_sync', help='the service of configRCLUC_TIME_SYNC_SERVICE_NAME')
+    parser.add_argument('--use-sim-time', action='store_true', help='answer with the simulated time of /clock')
+    serve(parser.parse_args())
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())